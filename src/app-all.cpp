@@ -0,0 +1,436 @@
+#ifndef __ARCSTOOLS_APPALL_HPP__
+#include "app-all.hpp"
+#endif
+
+#include <chrono>           // for milliseconds
+#include <cstdlib>          // for EXIT_SUCCESS, EXIT_FAILURE
+#include <iterator>         // for end
+#include <memory>           // for unique_ptr, make_unique
+#include <sstream>          // for ostringstream
+#include <string>           // for string, to_string
+#include <tuple>            // for get
+#include <utility>          // for move, make_pair, pair
+#include <vector>           // for vector
+
+#ifndef __LIBARCSTK_DBAR_HPP__
+#include <arcstk/dbar.hpp>
+#endif
+#ifndef __LIBARCSTK_LOGGING_HPP__
+#include <arcstk/logging.hpp>
+#endif
+#ifndef __LIBARCSTK_VERIFY_HPP__
+#include <arcstk/verify.hpp>
+#endif
+
+#ifndef __ARCSTOOLS_APPREGISTRY_HPP__
+#include "appregistry.hpp"          // for RegisterApplicationType
+#endif
+#ifndef __ARCSTOOLS_CLITOKENS_HPP__
+#include "clitokens.hpp"            // for OP_VALUE
+#endif
+#ifndef __ARCSTOOLS_RESULT_HPP__
+#include "result.hpp"               // for ResultList, ResultObject
+#endif
+#ifndef __ARCSTOOLS_TOOLS_ARID_HPP__
+#include "tools-arid.hpp"           // for ARIdTableLayout
+#endif
+#ifndef __ARCSTOOLS_TOOLS_CALC_HPP__
+#include "tools-calc.hpp"           // for HexLayout, has_mismatch
+#endif
+#ifndef __ARCSTOOLS_TOOLS_TABLE_HPP__
+#include "tools-table.hpp"          // for StringTableLayout
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+
+namespace registered
+{
+// Enable ApplicationFactory::lookup() to find this application by its name
+const auto all = RegisterApplicationType<ARAllApplication>("all");
+}
+
+// libarcstk
+using arcstk::AlbumVerifier;
+using arcstk::DBARSource;
+
+// arcsapp
+using arid::ARIdTableLayout;
+using calc::HexLayout;
+using table::ATTR;
+using table::RowTableComposerBuilder;
+using table::StringTableLayout;
+
+
+// ALL
+
+constexpr OptionCode ALL::RESPONSEFILE;
+
+
+// ARAllConfigurator
+
+
+void ARAllConfigurator::do_flush_local_options(OptionRegistry& r) const
+{
+	using input::OP_VALUE;
+	using std::end;
+	r.insert(end(r),
+	{
+		// from FORMATBASE
+
+		{ ALL::READERID,
+		{  "reader", true, "auto",
+			"Force use of audio reader with specified id" }},
+
+		{ ALL::PARSERID,
+		{  "parser", true, "auto",
+			"Force use of toc parser with specified id" }},
+
+		{ ALL::LIST_TOC_FORMATS,
+		{  "list-toc-formats", false, "FALSE",
+			"List all supported file formats for TOC metadata" }},
+
+		{ ALL::LIST_AUDIO_FORMATS,
+		{  "list-audio-formats", false, "FALSE",
+			"List all supported audio codec/container formats" }},
+
+		// from CALCBASE, ARId and URL are always printed
+
+		{ ALL::METAFILE,
+		{  'm', "metafile", true, "none", "Specify toc metadata file to use" }},
+
+		{ ALL::NOTRACKS,
+		{  "no-track-nos", false, "FALSE", "Do not print track numbers" }},
+
+		{ ALL::NOFILENAMES,
+		{  "no-filenames", false, "FALSE", "Do not print the filenames" }},
+
+		{ ALL::NOOFFSETS,
+		{  "no-offsets", false, "FALSE", "Do not print track offsets" }},
+
+		{ ALL::NOLENGTHS,
+		{  "no-lengths", false, "FALSE", "Do not print track lengths" }},
+
+		{ ALL::NOLABELS,
+		{  "no-labels", false, "FALSE", "Do not print column or row labels" }},
+
+		{ ALL::COLDELIM,
+		{  "col-delim", true, "ASCII-32", "Specify column delimiter" }},
+
+		{ ALL::THREADS,
+		{  'j', "threads", true, "1",
+			"Number of threads for calculation, 0 for one per CPU" }},
+
+		{ ALL::CACHE,
+		{  "cache", true, "none",
+			"Reuse checksums from cache directory, add new ones" }},
+
+		{ ALL::CACHEKEY,
+		{  "cache-key", true, "file",
+			"Identify cached files by 'file' system or by 'content'" }},
+
+		{ ALL::READAHEAD,
+		{  "read-ahead", true, "0",
+			"Number of buffers to read ahead, 0 for none" }},
+
+		{ ALL::BUFFERSIZE,
+		{  "buffer-size", true, "1024",
+			"Size of each read-ahead buffer in KiB" }},
+
+		{ ALL::IO,
+		{  "io", true, "stdio",
+			"Read audio files by 'stdio', 'mmap' or 'io_uring'" }},
+
+		{ ALL::CHECKMD5,
+		{  "check-md5", false, "FALSE",
+			"Check the MD5 declared by FLAC files while calculating" }},
+
+		{ ALL::PROGRESS,
+		{  "progress", true, "none",
+			"Report progress and throughput to stderr every N seconds" }},
+
+		// from ALL
+
+		{ ALL::RESPONSEFILE,
+		{  'r', "response", true, OP_VALUE::NONE,
+			"Verify against the specified AccurateRip response file" }}
+	});
+}
+
+
+std::unique_ptr<Options> ARAllConfigurator::do_configure_options(
+		std::unique_ptr<Options> coptions) const
+{
+	auto options = this->configure_calcbase_options(std::move(coptions));
+
+	// The ARId requires the ToC, thus the album is always processed as a whole
+
+	if (not options->no_arguments() && options->value(ALL::METAFILE).empty())
+	{
+		throw ConfigurationException("Option -m/--metafile is required to "
+				"derive the AccurateRip id");
+	}
+
+	return options;
+}
+
+
+OptionParsers ARAllConfigurator::do_parser_list() const
+{
+	auto parsers { calcbase_parser_list() };
+
+	parsers.emplace_back(ALL::RESPONSEFILE,
+			[]{ return std::make_unique<DBARParser>(); });
+
+	return parsers;
+}
+
+
+// ARAllApplication
+
+
+std::unique_ptr<CalcTableCreator> ARAllApplication::create_calc_formatter(
+		const Configuration& config) const
+{
+	auto fmt { std::make_unique<CalcTableCreator>() };
+
+	fmt->set_checksum_layout(std::make_unique<HexLayout>());
+
+	fmt->set_arid_layout(std::make_unique<ARIdTableLayout>(
+			!config.is_set(ALL::NOLABELS),
+			true,  /* id */
+			true,  /* url */
+			false, /* no filenames */
+			false, /* no tracks */
+			false, /* no id 1 */
+			false, /* no id 2 */
+			false  /* no cddb id */
+	));
+
+	fmt->set_format_labels(!config.is_set(ALL::NOLABELS));
+
+	// A ToC is always present
+
+	fmt->set_format_field(ATTR::TRACK,    !config.is_set(ALL::NOTRACKS));
+	fmt->set_format_field(ATTR::OFFSET,   !config.is_set(ALL::NOOFFSETS));
+	fmt->set_format_field(ATTR::LENGTH,   !config.is_set(ALL::NOLENGTHS));
+	fmt->set_format_field(ATTR::FILENAME, false);
+
+	auto layout { std::make_unique<StringTableLayout>() };
+
+	layout->set_col_inner_delim(config.is_set(ALL::COLDELIM)
+		? config.value(ALL::COLDELIM)
+		: " ");
+
+	fmt->set_table_layout(std::move(layout));
+	fmt->set_builder(std::make_unique<RowTableComposerBuilder>());
+
+	return fmt;
+}
+
+
+std::unique_ptr<VerifyTableCreator> ARAllApplication::create_verify_formatter(
+		const Configuration& config) const
+{
+	std::unique_ptr<VerifyTableCreator> fmt {
+		std::make_unique<MonochromeVerifyTableCreator>() };
+
+	fmt->set_checksum_layout(std::make_unique<HexLayout>());
+
+	fmt->set_arid_layout(std::make_unique<ARIdTableLayout>(
+			!config.is_set(ALL::NOLABELS),
+			true,  /* id */
+			true,  /* url */
+			false, /* no filenames */
+			false, /* no tracks */
+			false, /* no id 1 */
+			false, /* no id 2 */
+			false  /* no cddb id */
+	));
+
+	fmt->set_format_labels(!config.is_set(ALL::NOLABELS));
+
+	// A ToC is always present
+
+	fmt->set_format_field(ATTR::TRACK,      !config.is_set(ALL::NOTRACKS));
+	fmt->set_format_field(ATTR::OFFSET,     !config.is_set(ALL::NOOFFSETS));
+	fmt->set_format_field(ATTR::LENGTH,     !config.is_set(ALL::NOLENGTHS));
+	fmt->set_format_field(ATTR::FILENAME,   false);
+	fmt->set_format_field(ATTR::CONFIDENCE, true);
+
+	fmt->set_match_symbol("==");
+
+	fmt->set_builder(std::make_unique<RowTableComposerBuilder>());
+
+	auto layout { std::make_unique<StringTableLayout>() };
+
+	layout->set_col_inner_delim(config.is_set(ALL::COLDELIM)
+		? config.value(ALL::COLDELIM)
+		: " ");
+
+	fmt->set_table_layout(std::move(layout));
+
+	return fmt;
+}
+
+
+bool ARAllApplication::do_calculation_requested(const Configuration& config)
+	const
+{
+	return config.is_set(ALL::METAFILE);
+}
+
+
+auto ARAllApplication::do_run_calculation(const Configuration& config) const
+	-> std::pair<int, std::unique_ptr<Result>>
+{
+	auto audio_selection = create_selection(ALL::READERID, config);
+	auto toc_selection   = create_selection(ALL::PARSERID, config);
+
+	const auto cache { create_cache(config) };
+
+	auto md5_status = std::vector<calc::MD5Status> {};
+	auto progress   = create_progress(config);
+
+	// Parse the ToC and decode the audio exactly once
+
+	auto [ checksums, arid, toc ] = ARCalcApplication::calculate(
+			*config.arguments(),
+			config.value(ALL::METAFILE),
+			true,
+			true,
+			{ arcstk::checksum::type::ARCS2 }, /* force ARCSv1 + ARCSv2 */
+			audio_selection.get(),
+			toc_selection.get(),
+			config.object<std::size_t>(ALL::THREADS),
+			cache.get(),
+			create_input_options(config),
+			{},
+			nullptr,
+			config.is_set(ALL::CHECKMD5),
+			&md5_status,
+			0,
+			affinity::Placement::NONE,
+			nullptr,
+			kernel::Engine::SCALAR,
+			{},
+			std::chrono::milliseconds { 0 },
+			progress.get()
+	);
+
+	progress.reset();
+
+	report_cache(cache.get());
+
+	if (checksums.size() == 0)
+	{
+		this->fatal_error("Calculation returned no checksums.");
+	}
+
+	if (!toc || arid.empty())
+	{
+		this->fatal_error("Calculation returned no AccurateRip id.");
+	}
+
+	auto exit_code = calc::has_mismatch(md5_status)
+		? EXIT_FAILURE : EXIT_SUCCESS;
+
+	using TYPE = arcstk::checksum::type;
+
+	const auto alt_prefix = std::string { /* TODO Alt-Prefix */ };
+
+	// Without a reference, just print ARId, URL and checksums
+
+	if (!config.is_set(ALL::RESPONSEFILE))
+	{
+		auto formatter { create_calc_formatter(config) };
+		formatter->set_md5_status(md5_status);
+
+		return std::make_pair(exit_code, formatter->format(
+			/* types  */  { TYPE::ARCS1, TYPE::ARCS2 },
+			/* ARCSs  */  checksums,
+			/* ARId   */  arid,
+			/* ToC    */  toc.get(),
+			/* files  */  toc->filenames(),
+			/* Prefix */  alt_prefix
+		));
+	}
+
+	// Verify against the response
+
+	const auto dbar { config.object<DBAR>(ALL::RESPONSEFILE) };
+	const auto ref_source { std::make_unique<DBARSource>(&dbar) };
+
+	ARCS_LOG_DEBUG << "Process reference input as AccurateRip response for album";
+
+	const auto vresult { AlbumVerifier(checksums, arid).perform(*ref_source) };
+
+	const auto best_b           { vresult->best_block() };
+	const auto best_block       { std::get<0>(best_b) };
+	const auto matching_version { std::get<1>(best_b) };
+	const auto difference       { std::get<2>(best_b) };
+
+	auto formatter { create_verify_formatter(config) };
+	formatter->set_md5_status(md5_status);
+
+	auto results { std::make_unique<ResultList>() };
+
+	results->append(formatter->format(
+		/* types to print */           { matching_version
+											? TYPE::ARCS2 : TYPE::ARCS1 },
+		/* verification results */     vresult.get(),
+		/* optional best match */      best_block,
+		/* mine ARCSs */               checksums,
+		/* optional mine ARId */       arid,
+		/* optional ToC */             toc.get(),
+		/* reference checksum source */ref_source.get(),
+		/* input audio filenames */    std::vector<std::string> {},
+		/* optional URL prefix */      alt_prefix
+	));
+
+	// Verdict
+
+	auto verdict = std::ostringstream {};
+
+	if (vresult->all_tracks_verified())
+	{
+		verdict << "Accurate: all tracks match block " << best_block
+			<< " (v" << (matching_version + 1) << ")\n";
+	} else
+	{
+		verdict << "Not accurate: " << difference << " of "
+			<< checksums.size() << " tracks differ from best block "
+			<< best_block << "\n";
+
+		exit_code = EXIT_FAILURE;
+	}
+
+	results->append(
+		std::make_unique<ResultObject<std::string>>(verdict.str()));
+
+	return std::make_pair(exit_code, std::move(results));
+}
+
+
+std::string ARAllApplication::do_name() const
+{
+	return "all";
+}
+
+
+std::string ARAllApplication::do_call_syntax() const
+{
+	return "[OPTIONS] -m <metafile> [ <filename1> ... ]";
+}
+
+
+std::unique_ptr<Configurator> ARAllApplication::do_create_configurator() const
+{
+	return std::make_unique<ARAllConfigurator>();
+}
+
+} // namespace v_1_0_0
+} // namespace arcsapp
+
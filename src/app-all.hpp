@@ -0,0 +1,117 @@
+#ifndef __ARCSTOOLS_APPALL_HPP__
+#define __ARCSTOOLS_APPALL_HPP__
+
+/**
+ * \file
+ *
+ * \brief Interface for ARAllApplication.
+ *
+ * Options, Configurator and Application for all.
+ */
+
+#include <memory>           // for unique_ptr
+#include <string>           // for string
+#include <utility>          // for pair
+
+#ifndef __ARCSTOOLS_APPCALC_HPP__
+#include "app-calc.hpp"     // for ARCalcApplicationBase, CALCBASE
+#endif
+#ifndef __ARCSTOOLS_APPVERIFY_HPP__
+#include "app-verify.hpp"   // for VerifyTableCreator
+#endif
+#ifndef __ARCSTOOLS_CONFIG_HPP__
+#include "config.hpp"       // for Configurator, OptionCode
+#endif
+
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+
+class Result;
+
+/**
+ * \brief Options for ARAllApplication.
+ */
+class ALL : public CALCBASE
+{
+	static constexpr auto& BASE = CALCBASE::SUBCLASS_BASE;
+
+public:
+
+	static constexpr OptionCode RESPONSEFILE = BASE + 0; // 28
+};
+
+
+/**
+ * \brief Configurator for ARAllApplication instances.
+ *
+ * Respects all ALL options. The ARId and its URL are always printed.
+ */
+class ARAllConfigurator final : public ARCalcConfiguratorBase
+{
+public:
+
+	using ARCalcConfiguratorBase::ARCalcConfiguratorBase;
+
+private:
+
+	// Configurator
+
+	void do_flush_local_options(OptionRegistry& r) const final;
+
+	std::unique_ptr<Options> do_configure_options(
+			std::unique_ptr<Options> options) const final;
+
+	OptionParsers do_parser_list() const final;
+};
+
+
+/**
+ * \brief Application to identify, calculate and verify an album at once.
+ *
+ * Parses the ToC of the album once and decodes its audio once. The ARId and
+ * its URL are derived from the same ToC and audio as the checksums. If a
+ * response file is passed, the checksums are verified against it, otherwise
+ * they are just printed.
+ */
+class ARAllApplication final : public ARCalcApplicationBase
+{
+	/**
+	 * \brief Create the format for the checksums without a reference.
+	 *
+	 * \param[in] config The Application configuration
+	 */
+	std::unique_ptr<CalcTableCreator> create_calc_formatter(
+			const Configuration& config) const;
+
+	/**
+	 * \brief Create the format for the checksums verified against a reference.
+	 *
+	 * \param[in] config The Application configuration
+	 */
+	std::unique_ptr<VerifyTableCreator> create_verify_formatter(
+			const Configuration& config) const;
+
+	// ARCalcApplicationBase
+
+	bool do_calculation_requested(const Configuration& config) const final;
+
+	std::pair<int, std::unique_ptr<Result>> do_run_calculation(
+			const Configuration& config) const final;
+
+	// Application
+
+	std::string do_name() const final;
+
+	std::string do_call_syntax() const final;
+
+	std::unique_ptr<Configurator> do_create_configurator() const final;
+};
+
+} // namespace v_1_0_0
+} // namespace arcsapp
+
+#endif
+
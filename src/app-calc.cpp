@@ -3,10 +3,18 @@
 #include "app-calc.hpp"
 #endif
 
-#include <algorithm>     // for find, set_intersection
-#include <cstdlib>       // for EXIT_SUCCESS
+#include <algorithm>     // for find, set_intersection, sort
+#include <chrono>        // for milliseconds, seconds
+#include <cstddef>       // for size_t
+#include <cstdlib>       // for EXIT_SUCCESS, EXIT_FAILURE
+#include <exception>     // for exception
+#include <iomanip>       // for setfill, setw
+#include <iostream>      // for cerr
 #include <iterator>      // for begin, end, back_inserter
 #include <memory>        // for unique_ptr, make_unique
+#include <mutex>         // for mutex, lock_guard
+#include <sstream>       // for ostringstream
+#include <stdexcept>     // for invalid_argument
 #include <string>        // for string
 #include <tuple>         // for get, make_tuple, tuple
 #include <utility>       // for move, make_pair, pair
@@ -35,21 +43,51 @@
 #ifndef __ARCSTOOLS_CONFIG_HPP__
 #include "config.hpp"               // for Options, Configurator
 #endif
+#ifndef __ARCSTOOLS_TOOLS_AFFINITY_HPP__
+#include "tools-affinity.hpp"       // for Placement, pinning
+#endif
 #ifndef __ARCSTOOLS_TOOLS_ARID_HPP__
 #include "tools-arid.hpp"           // for ARIdLayout
 #endif
+#ifndef __ARCSTOOLS_TOOLS_BATCH_HPP__
+#include "tools-batch.hpp"          // for read_manifest
+#endif
 #ifndef __ARCSTOOLS_TOOLS_CALC_HPP__
 #include "tools-calc.hpp"           // for ChecksumCalculator
 #endif
+#ifndef __ARCSTOOLS_TOOLS_DEADLINE_HPP__
+#include "tools-deadline.hpp"       // for Deadline, TimeoutException
+#endif
+#ifndef __ARCSTOOLS_TOOLS_DEVICE_HPP__
+#include "tools-device.hpp"         // for ReaderLimits, device_of
+#endif
 #ifndef __ARCSTOOLS_TOOLS_INFO_HPP__
 #include "tools-info.hpp"           // for AvailableFileReaders
 #endif
+#ifndef __ARCSTOOLS_TOOLS_JOURNAL_HPP__
+#include "tools-journal.hpp"        // for Journal, album_key, Fnv1a
+#endif
+#ifndef __ARCSTOOLS_TOOLS_PARALLEL_HPP__
+#include "tools-parallel.hpp"       // for run_ordered, GroupedTaskPool
+#endif
+#ifndef __ARCSTOOLS_TOOLS_PLAN_HPP__
+#include "tools-plan.hpp"           // for plan_album, calibrate, predict
+#endif
+#ifndef __ARCSTOOLS_TOOLS_PROGRESS_HPP__
+#include "tools-progress.hpp"       // for Reporter
+#endif
+#ifndef __ARCSTOOLS_TOOLS_WATCH_HPP__
+#include "tools-watch.hpp"          // for watch_albums, is_supported
+#endif
+#ifndef __ARCSTOOLS_TOOLS_WINDOW_HPP__
+#include "tools-window.hpp"         // for Windows, compare, read, write
+#endif
 //#ifndef __ARCSTOOLS_TOOLS_TABLE_HPP__
 //#include "tools-table.hpp"          // for StringTableLayout,
 //									// TableComposer
 //#endif
 #ifndef __ARCSTOOLS_RESULT_HPP__
-#include "result.hpp"               // for ResultObject, Result
+#include "result.hpp"               // for ResultObject, ResultList, Result
 #endif
 
 namespace arcsapp
@@ -94,6 +132,14 @@ constexpr OptionCode CALCBASE::NOLABELS;
 constexpr OptionCode CALCBASE::COLDELIM;
 constexpr OptionCode CALCBASE::PRINTID;
 constexpr OptionCode CALCBASE::PRINTURL;
+constexpr OptionCode CALCBASE::THREADS;
+constexpr OptionCode CALCBASE::CACHE;
+constexpr OptionCode CALCBASE::CACHEKEY;
+constexpr OptionCode CALCBASE::READAHEAD;
+constexpr OptionCode CALCBASE::BUFFERSIZE;
+constexpr OptionCode CALCBASE::IO;
+constexpr OptionCode CALCBASE::CHECKMD5;
+constexpr OptionCode CALCBASE::PROGRESS;
 
 constexpr OptionCode CALCBASE::SUBCLASS_BASE;
 
@@ -107,6 +153,23 @@ constexpr OptionCode CALC::NOV1;
 constexpr OptionCode CALC::NOV2;
 constexpr OptionCode CALC::SUMSONLY;
 constexpr OptionCode CALC::TRACKSASCOLS;
+constexpr OptionCode CALC::BATCH;
+constexpr OptionCode CALC::DIGESTS;
+constexpr OptionCode CALC::WINDOWS;
+constexpr OptionCode CALC::WINDOWSIZE;
+constexpr OptionCode CALC::COMPAREWINDOWS;
+constexpr OptionCode CALC::PREFLIGHT;
+constexpr OptionCode CALC::RECURSIVE;
+constexpr OptionCode CALC::WATCH;
+constexpr OptionCode CALC::RESUME;
+constexpr OptionCode CALC::MAXMEMORY;
+constexpr OptionCode CALC::DEVICEREADERS;
+constexpr OptionCode CALC::PIN;
+constexpr OptionCode CALC::ENGINE;
+constexpr OptionCode CALC::TIMEOUTALBUM;
+constexpr OptionCode CALC::TIMEOUTFILE;
+constexpr OptionCode CALC::PLAN;
+constexpr OptionCode CALC::CALIBRATION;
 
 
 // ARCalcConfiguratorBase
@@ -152,10 +215,99 @@ std::unique_ptr<Options> ARCalcConfiguratorBase::configure_calcbase_options(
 		}
 	}
 
+	// Threads: Process Sequentially If Not Specified
+
+	if (not options->is_set(CALCBASE::THREADS))
+	{
+		options->set(CALCBASE::THREADS, "1");
+	}
+
+	// Cache Key: Identify Audio Files By File System If Not Specified
+
+	if (options->is_set(CALCBASE::CACHEKEY))
+	{
+		const auto& mode { options->value(CALCBASE::CACHEKEY) };
+
+		if (mode != "file" && mode != "content")
+		{
+			throw ConfigurationException("Unknown cache key '" + mode
+					+ "', expected 'file' or 'content'");
+		}
+
+		if (not options->is_set(CALCBASE::CACHE))
+		{
+			ARCS_LOG_WARNING << "Option CACHEKEY is ignored without CACHE";
+		}
+	}
+
+	// Read-Ahead: Read Audio Files Synchronously If Not Specified
+
+	if (not options->is_set(CALCBASE::READAHEAD))
+	{
+		options->set(CALCBASE::READAHEAD, "0");
+	}
+
+	// Buffer Size: 1 MiB Per Read-Ahead Buffer If Not Specified
+
+	if (not options->is_set(CALCBASE::BUFFERSIZE))
+	{
+		options->set(CALCBASE::BUFFERSIZE, "1024");
+
+	} else if (options->value(CALCBASE::BUFFERSIZE) == "0")
+	{
+		throw ConfigurationException("Buffer size must not be 0");
+	}
+
+	// I/O Backend: Buffered Reading If Not Specified
+
+	if (not options->is_set(CALCBASE::IO))
+	{
+		options->set(CALCBASE::IO, "stdio");
+	} else
+	{
+		try
+		{
+			io::to_backend(options->value(CALCBASE::IO));
+
+		} catch (const std::invalid_argument& e)
+		{
+			throw ConfigurationException(e.what());
+		}
+	}
+
+	// Progress: Report Every Second If No Interval Is Specified
+
+	if (options->is_set(CALCBASE::PROGRESS))
+	{
+		if (options->value(CALCBASE::PROGRESS).empty())
+		{
+			options->set(CALCBASE::PROGRESS, "1");
+
+		} else if (options->value(CALCBASE::PROGRESS) == "0")
+		{
+			throw ConfigurationException("Progress interval must not be 0");
+		}
+	}
+
 	return options;
 }
 
 
+OptionParsers ARCalcConfiguratorBase::calcbase_parser_list() const
+{
+	return {
+		{ CALCBASE::THREADS,
+			[]{ return std::make_unique<NumberParser>(); } },
+		{ CALCBASE::READAHEAD,
+			[]{ return std::make_unique<NumberParser>(); } },
+		{ CALCBASE::BUFFERSIZE,
+			[]{ return std::make_unique<NumberParser>(); } },
+		{ CALCBASE::PROGRESS,
+			[]{ return std::make_unique<NumberParser>(); } }
+	};
+}
+
+
 // ARCalcConfigurator
 
 
@@ -211,6 +363,38 @@ void ARCalcConfigurator::do_flush_local_options(OptionRegistry& r) const
 		{ CALC::PRINTURL,
 		{  "print-url", false, "FALSE", "Print AccurateRip URL of the album" }},
 
+		{ CALC::THREADS,
+		{  'j', "threads", true, "1",
+			"Number of threads for calculation, 0 for one per CPU" }},
+
+		{ CALC::CACHE,
+		{  "cache", true, "none",
+			"Reuse checksums from cache directory, add new ones" }},
+
+		{ CALC::CACHEKEY,
+		{  "cache-key", true, "file",
+			"Identify cached files by 'file' system or by 'content'" }},
+
+		{ CALC::READAHEAD,
+		{  "read-ahead", true, "0",
+			"Number of buffers to read ahead, 0 for none" }},
+
+		{ CALC::BUFFERSIZE,
+		{  "buffer-size", true, "1024",
+			"Size of each read-ahead buffer in KiB" }},
+
+		{ CALC::IO,
+		{  "io", true, "stdio",
+			"Read audio files by 'stdio', 'mmap' or 'io_uring'" }},
+
+		{ CALC::CHECKMD5,
+		{  "check-md5", false, "FALSE",
+			"Check the MD5 declared by FLAC files while calculating" }},
+
+		{ CALC::PROGRESS,
+		{  "progress", true, "none",
+			"Report progress and throughput to stderr every N seconds" }},
+
 		// from CALC
 
 		{ CALC::FIRST,
@@ -232,7 +416,75 @@ void ARCalcConfigurator::do_flush_local_options(OptionRegistry& r) const
 		{  "print-sums-only", false, "FALSE", "Print only checksums" }},
 
 		{ CALC::TRACKSASCOLS,
-		{  "tracks-as-cols", false, "FALSE", "Print tracks as columns" }}
+		{  "tracks-as-cols", false, "FALSE", "Print tracks as columns" }},
+
+		{ CALC::BATCH,
+		{  "batch", true, "none",
+			"Read albums from manifest file, one album per line" }},
+
+		{ CALC::DIGESTS,
+		{  "digests", true, "none",
+			"Also calculate 'crc32', 'crc32-nosilence', 'ctdb' and/or 'md5'" }},
+
+		{ CALC::WINDOWS,
+		{  "windows", true, "none",
+			"Write the CRC32 of each window of each track to a file" }},
+
+		{ CALC::WINDOWSIZE,
+		{  "window-size", true, "75",
+			"Number of frames per window" }},
+
+		{ CALC::COMPAREWINDOWS,
+		{  "compare-windows", true, "none",
+			"Print the windows that differ from a window file" }},
+
+		{ CALC::PREFLIGHT,
+		{  "preflight", true, "none",
+			"Check all albums before calculating and 'abort' or 'skip'" }},
+
+		{ CALC::RECURSIVE,
+		{  "recursive", true, "none",
+			"Process every cuesheet in the directory tree" }},
+
+		{ CALC::WATCH,
+		{  "watch", true, "none",
+			"Process every album written to the directory tree" }},
+
+		{ CALC::RESUME,
+		{  "resume", true, "none",
+			"Skip albums completed in the journal file and add the others" }},
+
+		{ CALC::MAXMEMORY,
+		{  "max-memory", true, "none",
+			"Maximal memory of the albums processed at once in MiB" }},
+
+		{ CALC::DEVICEREADERS,
+		{  "device-readers", true, "auto",
+			"Number of albums read at once from each device, 0 for any" }},
+
+		{ CALC::PIN,
+		{  "pin", true, "none",
+			"Pin threads to CPUs 'compact' or 'spread' over NUMA nodes" }},
+
+		{ CALC::ENGINE,
+		{  "engine", true, "scalar",
+			"Sum up samples by 'scalar', 'simd' or 'checked' engine" }},
+
+		{ CALC::TIMEOUTALBUM,
+		{  "timeout-per-album", true, "none",
+			"Cancel each album not completed within these seconds" }},
+
+		{ CALC::TIMEOUTFILE,
+		{  "timeout-per-file", true, "none",
+			"Cancel each album with a file not read within these seconds" }},
+
+		{ CALC::PLAN,
+		{  "plan", true, "none",
+			"Only predict the cost, print it as 'table' or 'json'" }},
+
+		{ CALC::CALIBRATION,
+		{  "calibration", true, "none",
+			"Read and update the rates of the readers for --plan" }}
 	});
 }
 
@@ -240,11 +492,280 @@ void ARCalcConfigurator::do_flush_local_options(OptionRegistry& r) const
 std::unique_ptr<Options> ARCalcConfigurator::do_configure_options(
 		std::unique_ptr<Options> coptions) const
 {
+	// Memory limit: unless requested otherwise, use as many threads as fit
+
+	if (coptions->is_set(CALC::MAXMEMORY) && !coptions->is_set(CALC::THREADS))
+	{
+		coptions->set(CALC::THREADS, "0");
+	}
+
 	auto options = this->configure_calcbase_options(std::move(coptions));
 
+	// Batch: each album in the manifest is processed with its own metafile
+
+	if (options->is_set(CALC::BATCH))
+	{
+		if (options->is_set(CALC::METAFILE) || not options->no_arguments())
+		{
+			throw ConfigurationException("Option --batch cannot be combined "
+					"with --metafile or audio files");
+		}
+
+		if (options->value(CALC::BATCH).empty())
+		{
+			throw ConfigurationException("Option --batch requires a "
+					"manifest file");
+		}
+
+		if (options->is_set(CALC::WINDOWS)
+				|| options->is_set(CALC::COMPAREWINDOWS))
+		{
+			throw ConfigurationException("Option --batch cannot be combined "
+					"with --windows or --compare-windows");
+		}
+	}
+
+	// Recursive: each cuesheet in the tree is processed like a batch album
+
+	if (options->is_set(CALC::RECURSIVE))
+	{
+		if (options->is_set(CALC::BATCH) || options->is_set(CALC::METAFILE)
+				|| not options->no_arguments())
+		{
+			throw ConfigurationException("Option --recursive cannot be "
+					"combined with --batch, --metafile or audio files");
+		}
+
+		if (options->value(CALC::RECURSIVE).empty())
+		{
+			throw ConfigurationException("Option --recursive requires a "
+					"directory");
+		}
+
+		if (options->is_set(CALC::WINDOWS)
+				|| options->is_set(CALC::COMPAREWINDOWS))
+		{
+			throw ConfigurationException("Option --recursive cannot be "
+					"combined with --windows or --compare-windows");
+		}
+	}
+
+	// Watch: each album written to the tree is processed like a batch album
+
+	if (options->is_set(CALC::WATCH))
+	{
+		if (options->is_set(CALC::BATCH) || options->is_set(CALC::RECURSIVE)
+				|| options->is_set(CALC::PREFLIGHT)
+				|| options->is_set(CALC::METAFILE)
+				|| not options->no_arguments())
+		{
+			throw ConfigurationException("Option --watch cannot be combined "
+					"with --batch, --recursive, --preflight, --metafile or "
+					"audio files");
+		}
+
+		if (options->value(CALC::WATCH).empty())
+		{
+			throw ConfigurationException("Option --watch requires a "
+					"directory");
+		}
+
+		if (options->is_set(CALC::WINDOWS)
+				|| options->is_set(CALC::COMPAREWINDOWS))
+		{
+			throw ConfigurationException("Option --watch cannot be combined "
+					"with --windows or --compare-windows");
+		}
+
+		if (not watch::is_supported())
+		{
+			throw ConfigurationException("Option --watch is not supported "
+					"by this build");
+		}
+	}
+
+	// Resume: a journal requires multiple albums
+
+	if (options->is_set(CALC::RESUME))
+	{
+		if (not options->is_set(CALC::BATCH)
+				&& not options->is_set(CALC::RECURSIVE))
+		{
+			throw ConfigurationException("Option --resume requires "
+					"--batch or --recursive");
+		}
+
+		if (options->value(CALC::RESUME).empty())
+		{
+			throw ConfigurationException("Option --resume requires a "
+					"journal file");
+		}
+	}
+
+	// Memory limit: albums are admitted while their memory fits
+
+	if (options->is_set(CALC::MAXMEMORY))
+	{
+		if (not options->is_set(CALC::BATCH)
+				&& not options->is_set(CALC::RECURSIVE)
+				&& not options->is_set(CALC::WATCH))
+		{
+			throw ConfigurationException("Option --max-memory requires "
+					"--batch, --recursive or --watch");
+		}
+
+		if (options->value(CALC::MAXMEMORY).empty()
+				|| options->value(CALC::MAXMEMORY) == "0")
+		{
+			throw ConfigurationException("Option --max-memory requires a "
+					"limit greater than 0");
+		}
+	}
+
+	// Device readers: albums are scheduled by device
+
+	if (options->is_set(CALC::DEVICEREADERS))
+	{
+		if (not options->is_set(CALC::BATCH)
+				&& not options->is_set(CALC::RECURSIVE)
+				&& not options->is_set(CALC::WATCH))
+		{
+			throw ConfigurationException("Option --device-readers requires "
+					"--batch, --recursive or --watch");
+		}
+
+		if (options->value(CALC::DEVICEREADERS).empty())
+		{
+			throw ConfigurationException("Option --device-readers requires "
+					"a number");
+		}
+	}
+
+	// Pinning: threads are placed on the CPUs as requested
+
+	if (not options->is_set(CALC::PIN))
+	{
+		options->set(CALC::PIN, "none");
+	} else
+	{
+		try
+		{
+			affinity::to_placement(options->value(CALC::PIN));
+
+		} catch (const std::invalid_argument& e)
+		{
+			throw ConfigurationException(e.what());
+		}
+	}
+
+	// Engine: the kernel that sums up the samples read by arcs-tools
+
+	if (not options->is_set(CALC::ENGINE))
+	{
+		options->set(CALC::ENGINE, "scalar");
+	} else
+	{
+		try
+		{
+			kernel::to_engine(options->value(CALC::ENGINE));
+
+		} catch (const std::invalid_argument& e)
+		{
+			throw ConfigurationException(e.what());
+		}
+	}
+
+	// Timeouts: an album exceeding its timeout is cancelled, the others
+	// continue
+
+	for (const auto& [ option, name ] : {
+			std::make_pair(CALC::TIMEOUTALBUM, "--timeout-per-album"),
+			std::make_pair(CALC::TIMEOUTFILE,  "--timeout-per-file") })
+	{
+		if (not options->is_set(option))
+		{
+			continue;
+		}
+
+		if (not options->is_set(CALC::BATCH)
+				&& not options->is_set(CALC::RECURSIVE)
+				&& not options->is_set(CALC::WATCH))
+		{
+			throw ConfigurationException(std::string { "Option " } + name
+					+ " requires --batch, --recursive or --watch");
+		}
+
+		if (options->value(option).empty() || options->value(option) == "0")
+		{
+			throw ConfigurationException(std::string { "Option " } + name
+					+ " requires a number of seconds greater than 0");
+		}
+	}
+
+	// Preflight: the whole batch is checked before any album is calculated
+
+	if (options->is_set(CALC::PREFLIGHT))
+	{
+		if (not options->is_set(CALC::BATCH)
+				&& not options->is_set(CALC::RECURSIVE))
+		{
+			throw ConfigurationException("Option --preflight requires "
+					"--batch or --recursive");
+		}
+
+		if (options->value(CALC::PREFLIGHT).empty())
+		{
+			options->set(CALC::PREFLIGHT, "abort");
+
+		} else if (options->value(CALC::PREFLIGHT) != "abort"
+				&& options->value(CALC::PREFLIGHT) != "skip")
+		{
+			throw ConfigurationException("Option --preflight accepts only "
+					"'abort' or 'skip'");
+		}
+	}
+
+	// Plan: the cost is predicted from the headers, nothing is calculated
+
+	if (options->is_set(CALC::PLAN))
+	{
+		if (options->is_set(CALC::WATCH))
+		{
+			throw ConfigurationException("Option --plan cannot be combined "
+					"with --watch");
+		}
+
+		if (options->value(CALC::PLAN).empty())
+		{
+			options->set(CALC::PLAN, "table");
+
+		} else if (options->value(CALC::PLAN) != "table"
+				&& options->value(CALC::PLAN) != "json")
+		{
+			throw ConfigurationException("Option --plan accepts only "
+					"'table' or 'json'");
+		}
+	}
+
+	if (options->is_set(CALC::CALIBRATION))
+	{
+		if (not options->is_set(CALC::PLAN))
+		{
+			throw ConfigurationException("Option --calibration requires "
+					"--plan");
+		}
+
+		if (options->value(CALC::CALIBRATION).empty())
+		{
+			throw ConfigurationException("Option --calibration requires a "
+					"calibration file");
+		}
+	}
+
 	// Determine whether to set ALBUM mode
 
-	if (options->is_set(CALC::METAFILE))
+	if (options->is_set(CALC::METAFILE) || options->is_set(CALC::BATCH)
+			|| options->is_set(CALC::RECURSIVE) || options->is_set(CALC::WATCH))
 	{
 		// Activate Album Mode
 
@@ -316,6 +837,17 @@ std::unique_ptr<Options> ARCalcConfigurator::do_configure_options(
 		}
 	}
 
+	// Windows: One Second Per Window If Not Specified
+
+	if (not options->is_set(CALC::WINDOWSIZE))
+	{
+		options->set(CALC::WINDOWSIZE, "75");
+
+	} else if (options->value(CALC::WINDOWSIZE) == "0")
+	{
+		throw ConfigurationException("Window size must not be 0");
+	}
+
 	// Printing options
 
 	if (options->is_set(CALC::SUMSONLY))
@@ -331,40 +863,376 @@ std::unique_ptr<Options> ARCalcConfigurator::do_configure_options(
 }
 
 
-// CalcTableCreator
+OptionParsers ARCalcConfigurator::do_parser_list() const
+{
+	auto parsers { calcbase_parser_list() };
+
+	parsers.emplace_back(CALC::DIGESTS,
+			[]{ return std::make_unique<DigestListParser>(); });
+	parsers.emplace_back(CALC::WINDOWSIZE,
+			[]{ return std::make_unique<NumberParser>(); });
+	parsers.emplace_back(CALC::MAXMEMORY,
+			[]{ return std::make_unique<NumberParser>(); });
+	parsers.emplace_back(CALC::DEVICEREADERS,
+			[]{ return std::make_unique<NumberParser>(); });
+	parsers.emplace_back(CALC::TIMEOUTALBUM,
+			[]{ return std::make_unique<NumberParser>(); });
+	parsers.emplace_back(CALC::TIMEOUTFILE,
+			[]{ return std::make_unique<NumberParser>(); });
+
+	return parsers;
+}
 
 
-void CalcTableCreator::add_result_fields(std::vector<ATTR>& field_list,
-		const print_flag_t /*print_flags*/,
-		const std::vector<arcstk::checksum::type>& types_to_print) const
+// DigestListParser
+
+
+std::string DigestListParser::start_message() const
 {
-	using ChecksumType = arcstk::checksum::type;
+	return "List of digests";
+}
 
-	for (const auto& t : types_to_print)
+
+std::vector<digest::DigestType> DigestListParser::do_parse_nonempty(
+		const std::string& s) const
+{
+	try
 	{
-		if (ChecksumType::ARCS1 == t)
-		{
-			field_list.emplace_back(ATTR::CHECKSUM_ARCS1);
-		} else
-		{
-			if (ChecksumType::ARCS2 == t)
-			{
-				field_list.emplace_back(ATTR::CHECKSUM_ARCS2);
-			}
-		}
+		return digest::to_types(s);
+
+	} catch (const std::invalid_argument& e)
+	{
+		throw ConfigurationException(e.what());
 	}
 }
 
 
-void CalcTableCreator::populate_result_creators(
-		std::vector<std::unique_ptr<FieldCreator>>& creators,
-		const print_flag_t /*print_flags*/,
-		const std::vector<ATTR>& field_list,
-		const std::vector<arcstk::checksum::type>& /*types*/,
-		const Checksums& checksums) const
+namespace
 {
-	// do not repeat the find mechanism
-	const auto required = [](const std::vector<ATTR>& fields, const ATTR f)
+
+/**
+ * \brief Bytes per MiB for the memory limit.
+ */
+constexpr std::size_t MIB = 1024 * 1024;
+
+
+/**
+ * \brief Exit code if an album timed out, as returned by timeout(1).
+ */
+constexpr int EXIT_TIMEOUT = 124;
+
+
+/**
+ * \brief Timeout of an option in seconds, 0 if the option is not set.
+ */
+std::chrono::milliseconds timeout_of(const Configuration& config,
+		const OptionCode option)
+{
+	return std::chrono::seconds { config.is_set(option)
+		? config.object<std::size_t>(option) : 0 };
+}
+
+
+/**
+ * \brief Attribute of the column for a digest type.
+ */
+ATTR digest_attr(const digest::DigestType type)
+{
+	switch (type)
+	{
+		case digest::DigestType::CRC32_NOSILENCE:
+			return ATTR::DIGEST_CRC32_NOSILENCE;
+		case digest::DigestType::CTDB:
+			return ATTR::DIGEST_CTDB;
+		case digest::DigestType::MD5:
+			return ATTR::DIGEST_MD5;
+		default:
+			return ATTR::DIGEST_CRC32;
+	}
+}
+
+
+/**
+ * \brief Frames as minutes, seconds and frames.
+ */
+std::string to_msf(const std::size_t frames)
+{
+	using window::FRAMES_PER_SECOND;
+
+	auto out = std::ostringstream {};
+
+	out << std::setfill('0')
+		<< std::setw(2) << frames / FRAMES_PER_SECOND / 60 << ':'
+		<< std::setw(2) << frames / FRAMES_PER_SECOND % 60 << ':'
+		<< std::setw(2) << frames % FRAMES_PER_SECOND;
+
+	return out.str();
+}
+
+
+/**
+ * \brief Describe the differing windows as frame ranges within their tracks.
+ *
+ * If a ToC is available, the absolute sectors are added.
+ */
+std::string windows_report(const std::vector<window::Difference>& differences,
+		const std::size_t frames, const ToC* toc)
+{
+	auto out = std::ostringstream {};
+
+	if (differences.empty())
+	{
+		out << "No differing windows of " << frames << " frames\n";
+		return out.str();
+	}
+
+	out << "Differing windows of " << frames << " frames:\n";
+
+	const auto offsets { toc ? toc->offsets() : decltype(toc->offsets()) {} };
+
+	for (const auto& d : differences)
+	{
+		const auto first { d.first * frames };
+		const auto last  { (d.last + 1) * frames - 1 };
+
+		out << "Track " << d.track << ": frames " << first << "-" << last
+			<< " (" << to_msf(first) << "-" << to_msf(last) << ")";
+
+		if (d.track <= offsets.size())
+		{
+			const auto start { static_cast<std::size_t>(
+					offsets[d.track - 1].frames()) };
+
+			out << ", sectors " << start + first << "-" << start + last;
+		}
+
+		out << '\n';
+	}
+
+	return out.str();
+}
+
+
+/**
+ * \brief Check each album of a batch without decoding its audio.
+ *
+ * The albums are checked concurrently. Every problem found is reported on
+ * stderr in the order of the manifest.
+ *
+ * \return The albums without problems
+ */
+std::vector<batch::Album> preflight(const std::vector<batch::Album>& albums,
+		const std::size_t workers,
+		arcsdec::FileReaderSelection* audio_selection,
+		arcsdec::FileReaderSelection* toc_selection)
+{
+	auto passed = std::vector<batch::Album> {};
+
+	parallel::run_ordered<std::vector<std::string>>(albums.size(), workers,
+		albums.size(),
+		[&](const std::size_t i) -> std::vector<std::string>
+		{
+			calc::ChecksumCalculator c;
+			if (toc_selection)   { c.set_toc_selection  (toc_selection);   }
+			if (audio_selection) { c.set_audio_selection(audio_selection); }
+
+			return c.probe(albums[i].audiofiles, albums[i].metafile);
+		},
+		[&](const std::size_t i, std::vector<std::string>&& problems)
+		{
+			if (problems.empty())
+			{
+				passed.push_back(albums[i]);
+				return;
+			}
+
+			for (const auto& problem : problems)
+			{
+				std::cerr << "PREFLIGHT: " << albums[i].metafile << ": "
+					<< problem << '\n';
+			}
+		});
+
+	ARCS_LOG_INFO << "Preflight: " << passed.size() << " of " << albums.size()
+		<< " albums passed";
+
+	return passed;
+}
+
+
+/**
+ * \brief Digest of the checksums of an album for the journal.
+ */
+std::uint64_t result_digest(const Checksums& checksums)
+{
+	using arcstk::checksum::type;
+
+	auto hash = journal::Fnv1a {};
+
+	for (const auto& track : checksums)
+	{
+		hash.add(static_cast<std::uint64_t>(track.length()))
+			.add(track.get(type::ARCS1).value())
+			.add(track.get(type::ARCS2).value());
+	}
+
+	return hash.value();
+}
+
+
+/**
+ * \brief The album with the audio files referenced by its metafile.
+ *
+ * Albums found by --recursive and metafile-only manifest lines name no audio
+ * files. They are taken from the metafile once, thus the consumers of the
+ * album do not parse it again. If they cannot be taken, the album is returned
+ * as is and its calculation reports the problem.
+ */
+batch::Album resolve_audiofiles(const calc::ChecksumCalculator& calculator,
+		batch::Album album)
+{
+	if (!album.audiofiles.empty() || album.metafile.empty())
+	{
+		return album;
+	}
+
+	try
+	{
+		album.audiofiles = calculator.audiofiles({}, album.metafile);
+
+	} catch (const std::exception& e)
+	{
+		ARCS_LOG_DEBUG << "Cannot take audio files from " << album.metafile
+			<< ": " << e.what();
+	}
+
+	return album;
+}
+
+
+/**
+ * \brief The albums with the audio files referenced by their metafiles.
+ *
+ * The metafiles are parsed concurrently.
+ */
+std::vector<batch::Album> resolve_audiofiles(
+		const calc::ChecksumCalculator& calculator,
+		std::vector<batch::Album> albums, const std::size_t workers)
+{
+	parallel::TaskPool pool { workers };
+
+	for (auto& album : albums)
+	{
+		pool.submit([&calculator,&album]
+			{
+				album = resolve_audiofiles(calculator, std::move(album));
+			});
+	}
+
+	pool.wait();
+
+	return albums;
+}
+
+
+/**
+ * \brief Find all albums in a directory tree, ordered by their metafiles.
+ *
+ * The audio files of each album are resolved on the threads of the walk.
+ */
+std::vector<batch::Album> find_sorted_albums(const std::string& root,
+		const std::size_t workers, const calc::ChecksumCalculator& calculator)
+{
+	auto mutex  = std::mutex {};
+	auto albums = std::vector<batch::Album> {};
+
+	batch::find_albums(root, workers,
+		[&](batch::Album&& found)
+		{
+			auto album { resolve_audiofiles(calculator, std::move(found)) };
+
+			const std::lock_guard<std::mutex> lock(mutex);
+			albums.push_back(std::move(album));
+		});
+
+	std::sort(albums.begin(), albums.end(),
+		[](const batch::Album& lhs, const batch::Album& rhs)
+		{
+			return lhs.metafile < rhs.metafile;
+		});
+
+	return albums;
+}
+
+} // namespace
+
+
+// CalcTableCreator
+
+
+CalcTableCreator::CalcTableCreator()
+	: digests_ {}
+{
+	// empty
+}
+
+
+void CalcTableCreator::set_digests(const std::vector<digest::Digests>& digests)
+{
+	digests_ = digests;
+}
+
+
+const std::vector<digest::Digests>& CalcTableCreator::digests() const
+{
+	return digests_;
+}
+
+
+void CalcTableCreator::add_result_fields(std::vector<ATTR>& field_list,
+		const print_flag_t /*print_flags*/,
+		const std::vector<arcstk::checksum::type>& types_to_print) const
+{
+	using ChecksumType = arcstk::checksum::type;
+
+	for (const auto& t : types_to_print)
+	{
+		if (ChecksumType::ARCS1 == t)
+		{
+			field_list.emplace_back(ATTR::CHECKSUM_ARCS1);
+		} else
+		{
+			if (ChecksumType::ARCS2 == t)
+			{
+				field_list.emplace_back(ATTR::CHECKSUM_ARCS2);
+			}
+		}
+	}
+
+	if (!digests_.empty())
+	{
+		for (const auto& t : digests_.front().types())
+		{
+			field_list.emplace_back(digest_attr(t));
+		}
+	}
+
+	if (!md5_status().empty())
+	{
+		field_list.emplace_back(ATTR::MD5_CHECK);
+	}
+}
+
+
+void CalcTableCreator::populate_result_creators(
+		std::vector<std::unique_ptr<FieldCreator>>& creators,
+		const print_flag_t /*print_flags*/,
+		const std::vector<ATTR>& field_list,
+		const std::vector<arcstk::checksum::type>& /*types*/,
+		const Checksums& checksums) const
+{
+	// do not repeat the find mechanism
+	const auto required = [](const std::vector<ATTR>& fields, const ATTR f)
 			{
 				using std::cbegin;
 				using std::cend;
@@ -385,6 +1253,21 @@ void CalcTableCreator::populate_result_creators(
 			std::make_unique<AddField<ATTR::CHECKSUM_ARCS2>>(
 				&checksums, this->checksum_layout()));
 	}
+
+	if (!digests_.empty())
+	{
+		for (const auto& t : digests_.front().types())
+		{
+			creators.emplace_back(
+				std::make_unique<DigestField>(digest_attr(t), t, &digests_));
+		}
+	}
+
+	if (!md5_status().empty())
+	{
+		creators.emplace_back(
+			std::make_unique<AddField<ATTR::MD5_CHECK>>(&md5_status()));
+	}
 }
 
 
@@ -455,6 +1338,29 @@ std::unique_ptr<Result> CalcTableCreator::do_format(InputTuple t) const
 }
 
 
+// DigestField
+
+
+DigestField::DigestField(const ATTR field, const digest::DigestType type,
+		const std::vector<digest::Digests>* digests)
+	: field_   { field }
+	, type_    { type }
+	, digests_ { digests }
+{
+	/* empty */
+}
+
+
+void DigestField::do_create(TableComposer* c, const int record_idx) const
+{
+	const auto track { static_cast<std::size_t>(record_idx) };
+
+	table::add_field(c, record_idx, field_, track < digests_->size()
+			? digests_->at(track).value(type_)
+			: std::string { "-" });
+}
+
+
 // ARCalcApplicationBase
 
 
@@ -567,6 +1473,74 @@ std::unique_ptr<arcsdec::FileReaderSelection>
 }
 
 
+std::unique_ptr<cache::ChecksumCache> ARCalcApplicationBase::create_cache(
+		const Configuration& config) const
+{
+	if (!config.is_set(CALCBASE::CACHE))
+	{
+		return nullptr;
+	}
+
+	ARCS_LOG_INFO << "Use checksum cache in " << config.value(CALCBASE::CACHE);
+
+	auto cache { std::make_unique<cache::ChecksumCache>(
+			config.value(CALCBASE::CACHE)) };
+
+	if (config.is_set(CALCBASE::CACHEKEY)
+			&& config.value(CALCBASE::CACHEKEY) == "content")
+	{
+		cache->set_key_mode(cache::KeyMode::CONTENT);
+	}
+
+	return cache;
+}
+
+
+void ARCalcApplicationBase::report_cache(const cache::ChecksumCache* cache)
+	const
+{
+	if (cache)
+	{
+		ARCS_LOG_INFO << "Checksum cache: " << cache->hits() << " hits, "
+			<< cache->misses() << " misses";
+	}
+}
+
+
+io::InputOptions ARCalcApplicationBase::create_input_options(
+		const Configuration& config) const
+{
+	auto options = io::InputOptions {};
+
+	options.backend     = io::to_backend(config.value(CALCBASE::IO));
+	options.read_ahead  = config.object<std::size_t>(CALCBASE::READAHEAD);
+	options.buffer_size =
+		config.object<std::size_t>(CALCBASE::BUFFERSIZE) * 1024;
+
+	if (!io::is_default(options))
+	{
+		ARCS_LOG_INFO << "Read audio by " << io::name(options.backend)
+			<< " with read-ahead of " << options.read_ahead
+			<< " buffers of " << options.buffer_size << " bytes";
+	}
+
+	return options;
+}
+
+
+std::unique_ptr<progress::Reporter> ARCalcApplicationBase::create_progress(
+		const Configuration& config) const
+{
+	if (!config.is_set(CALCBASE::PROGRESS))
+	{
+		return nullptr;
+	}
+
+	return std::make_unique<progress::Reporter>(std::chrono::seconds {
+			config.object<std::size_t>(CALCBASE::PROGRESS) });
+}
+
+
 // ARCalcApplication
 
 
@@ -577,7 +1551,21 @@ std::tuple<Checksums, ARId, std::unique_ptr<ToC>> ARCalcApplication::calculate(
 	const bool last_file_is_last_track,
 	const std::vector<arcstk::checksum::type>& types_requested,
 	arcsdec::FileReaderSelection* audio_selection,
-	arcsdec::FileReaderSelection* toc_selection)
+	arcsdec::FileReaderSelection* toc_selection,
+	const std::size_t threads,
+	cache::ChecksumCache* cache,
+	const io::InputOptions& input,
+	const std::vector<digest::DigestType>& digest_types,
+	std::vector<digest::Digests>* digests,
+	const bool check_md5,
+	std::vector<calc::MD5Status>* md5_status,
+	const std::size_t window,
+	const affinity::Placement placement,
+	selection::SelectionCache* selections,
+	const kernel::Engine engine,
+	const deadline::Deadline& deadline,
+	const std::chrono::milliseconds file_timeout,
+	progress::Reporter* progress)
 {
 	// The types to calculate are allowed to differ from the explicitly
 	// requested types (since e.g. ARCS1 is a byproduct of ARCS2 and the
@@ -593,12 +1581,43 @@ std::tuple<Checksums, ARId, std::unique_ptr<ToC>> ARCalcApplication::calculate(
 	calc::ChecksumCalculator c { types_to_calculate };
 	if (toc_selection)   { c.set_toc_selection  (toc_selection);   }
 	if (audio_selection) { c.set_audio_selection(audio_selection); }
+	c.set_threads(threads);
+	c.set_placement(placement);
+	c.set_cache(cache);
+	c.set_input_options(input);
+	c.set_digests(digest_types);
+	c.set_check_md5(check_md5);
+	c.set_window(window);
+	c.set_selection_cache(selections);
+	c.set_engine(engine);
+	c.set_deadline(deadline);
+	c.set_file_timeout(file_timeout);
+	c.set_progress(progress);
 
 	auto [ checksums, arid, toc ] = metafilename.empty()
 		? c.calculate(audiofilenames,                    //Tracks/Album w/o ToC
 				first_file_is_first_track, last_file_is_last_track)
 		: c.calculate(audiofilenames, metafilename);     //Album: w ToC
 
+	if (!io::is_default(input))
+	{
+		const auto& counters { c.stall_counters() };
+
+		ARCS_LOG_INFO << "Read-ahead: " << counters.buffers << " buffers read, "
+			<< "I/O waited " << counters.io_waits << " times, "
+			<< "decoding waited " << counters.decode_waits << " times";
+	}
+
+	if (digests)
+	{
+		*digests = c.digests();
+	}
+
+	if (md5_status)
+	{
+		*md5_status = c.md5_status();
+	}
+
 	return std::make_tuple(checksums, arid, std::move(toc));
 }
 
@@ -637,7 +1656,9 @@ std::unique_ptr<CalcTableCreator> ARCalcApplication::create_formatter(
 	}
 
 	// ToC present? Helper for determining other properties
-	const bool has_toc = !config.value(CALC::METAFILE).empty();
+	const bool has_toc = !config.value(CALC::METAFILE).empty()
+		|| config.is_set(CALC::BATCH) || config.is_set(CALC::RECURSIVE)
+		|| config.is_set(CALC::WATCH);
 
 	// Tracks in order?
 	const bool tracks_numbered = config.is_set(CALC::FIRST)
@@ -725,8 +1746,30 @@ auto ARCalcApplication::do_run_calculation(const Configuration& config) const
 	// If no selections are assigned, the libarcsdec default selections
 	// will be used.
 
+	if (config.is_set(CALC::PLAN))
+	{
+		return run_plan(config, audio_selection.get(), toc_selection.get());
+	}
+
+	const auto cache { create_cache(config) };
+
+	if (config.is_set(CALC::BATCH) || config.is_set(CALC::RECURSIVE)
+			|| config.is_set(CALC::WATCH))
+	{
+		const auto exit_code { run_batch(config, requested_types,
+				audio_selection.get(), toc_selection.get(), cache.get()) };
+
+		report_cache(cache.get());
+
+		return { exit_code, nullptr };
+	}
+
 	// Perform the actual calculation
 
+	auto digests    = std::vector<digest::Digests> {};
+	auto md5_status = std::vector<calc::MD5Status> {};
+	auto progress   = create_progress(config);
+
 	auto [ checksums, arid, toc ] = ARCalcApplication::calculate(
 			*config.arguments(),
 			config.value(CALC::METAFILE),
@@ -734,14 +1777,83 @@ auto ARCalcApplication::do_run_calculation(const Configuration& config) const
 			config.is_set(CALC::LAST),
 			requested_types,
 			audio_selection.get(),
-			toc_selection.get()
+			toc_selection.get(),
+			config.object<std::size_t>(CALC::THREADS),
+			cache.get(),
+			create_input_options(config),
+			requested_digests(config),
+			&digests,
+			config.is_set(CALC::CHECKMD5),
+			&md5_status,
+			requested_window(config) * window::SAMPLES_PER_FRAME,
+			affinity::to_placement(config.value(CALC::PIN)),
+			nullptr,
+			kernel::to_engine(config.value(CALC::ENGINE)),
+			{},
+			std::chrono::milliseconds { 0 },
+			progress.get()
 	);
 
+	progress.reset();
+
+	report_cache(cache.get());
+
 	if (checksums.size() == 0)
 	{
 		fatal_error("Calculation returned no checksums");
 	}
 
+	auto exit_code = calc::has_mismatch(md5_status)
+		? EXIT_FAILURE : EXIT_SUCCESS;
+
+	auto result { format_result(*create_formatter(config), requested_types,
+			checksums, arid, toc.get(), *config.arguments(), digests,
+			md5_status) };
+
+	if (requested_window(config) == 0)
+	{
+		return std::make_pair(exit_code, std::move(result));
+	}
+
+	// Window checksums: store and/or compare with a previous rip
+
+	const auto windows {
+		window::to_windows(requested_window(config), digests) };
+
+	if (config.is_set(CALC::WINDOWS))
+	{
+		window::write(config.value(CALC::WINDOWS), windows);
+	}
+
+	auto results { std::make_unique<ResultList>() };
+	results->append(std::move(result));
+
+	if (config.is_set(CALC::COMPAREWINDOWS))
+	{
+		const auto differences { window::compare(
+			window::read(config.value(CALC::COMPAREWINDOWS)), windows) };
+
+		if (!differences.empty())
+		{
+			exit_code = EXIT_FAILURE;
+		}
+
+		results->append(std::make_unique<ResultObject<std::string>>(
+			windows_report(differences, windows.frames, toc.get())));
+	}
+
+	return std::make_pair(exit_code, std::move(results));
+}
+
+
+std::unique_ptr<Result> ARCalcApplication::format_result(
+		CalcTableCreator& formatter,
+		const std::vector<arcstk::checksum::type>& requested_types,
+		const Checksums& checksums, const ARId& arid, const ToC* toc,
+		const std::vector<std::string>& audiofilenames,
+		const std::vector<digest::Digests>& digests,
+		const std::vector<calc::MD5Status>& md5_status) const
+{
 	// Types to print = all types requested AND computed
 
 	std::vector<arcstk::checksum::type> types_to_print;
@@ -757,16 +1869,501 @@ auto ARCalcApplication::do_run_calculation(const Configuration& config) const
 				std::back_inserter(types_to_print));
 	}
 
-	auto result { create_formatter(config)->format(
+	formatter.set_digests(digests);
+	formatter.set_md5_status(md5_status);
+
+	return formatter.format(
 	/* types  */  types_to_print,
 	/* ARCSs  */  checksums,
 	/* ARId   */  arid,
-	/* ToC    */  toc ? toc.get() : nullptr,
-	/* files  */  toc ? toc->filenames() : *config.arguments(),
+	/* ToC    */  toc,
+	/* files  */  toc ? toc->filenames() : audiofilenames,
 	/* Prefix */  std::string { /* TODO Implement Alt-Prefix */ }
-	)};
+	);
+}
+
+
+int ARCalcApplication::run_batch(const Configuration& config,
+		const std::vector<arcstk::checksum::type>& requested_types,
+		arcsdec::FileReaderSelection* audio_selection,
+		arcsdec::FileReaderSelection* toc_selection,
+		cache::ChecksumCache* cache) const
+{
+	using Calculation = std::tuple<Checksums, ARId, std::unique_ptr<ToC>>;
+
+	// Either a calculation with its by-products or an error message
+	struct AlbumResult final
+	{
+		std::unique_ptr<Calculation> calculation;
+		std::vector<digest::Digests> digests;
+		std::vector<calc::MD5Status> md5_status;
+		std::string error;
+		std::uint64_t key;
+		bool completed_before;
+		bool timed_out;
+	};
+
+	const auto workers {
+		parallel::worker_count(config.object<std::size_t>(CALC::THREADS)) };
+	auto exit_code = EXIT_SUCCESS;
+
+	// Resume: albums in the journal are skipped, completed albums are added
+
+	const auto journal { config.is_set(CALC::RESUME)
+		? std::make_unique<journal::Journal>(config.value(CALC::RESUME))
+		: nullptr };
+	auto skipped = std::size_t { 0 };
+
+	const auto formatter { create_formatter(config) };
+	const auto input     { create_input_options(config) };
+	const auto digest_types { requested_digests(config) };
+	const auto check_md5    { config.is_set(CALC::CHECKMD5) };
+
+	// Memory: an album is only started while its estimated memory fits
+
+	parallel::MemoryGovernor governor { config.is_set(CALC::MAXMEMORY)
+		? config.object<std::size_t>(CALC::MAXMEMORY) * MIB : 0 };
+
+	calc::ChecksumCalculator estimator;
+	if (toc_selection)   { estimator.set_toc_selection  (toc_selection);   }
+	if (audio_selection) { estimator.set_audio_selection(audio_selection); }
+	estimator.set_input_options(input);
+	estimator.set_digests(digest_types);
+	estimator.set_check_md5(check_md5);
+
+	if (governor.limit() > 0)
+	{
+		ARCS_LOG_INFO << "Limit memory of albums processed at once to "
+			<< governor.limit() / MIB << " MiB";
+	}
+
+	// Devices: each device is read by a limited number of threads at once,
+	// the other threads process the albums on other devices
+
+	const auto limits { config.is_set(CALC::DEVICEREADERS)
+		? std::make_unique<device::ReaderLimits>(
+				config.object<std::size_t>(CALC::DEVICEREADERS))
+		: std::make_unique<device::ReaderLimits>() };
+
+	const auto device_limit = [&limits](const parallel::Group device)
+	{
+		return limits->readers(device);
+	};
+
+	// The audio files of each album are resolved before it is grouped, thus
+	// the album is placed on the device of its first audio file
+
+	const auto device_of = [](const batch::Album& album) -> parallel::Group
+	{
+		return device::device_of(album.audiofiles.empty()
+				? album.metafile : album.audiofiles.front());
+	};
+
+	// Selections: the albums share the readers selected for the signatures
+	// of their audio files and the calculators
+
+	selection::SelectionCache selections;
+
+	const auto engine { kernel::to_engine(config.value(CALC::ENGINE)) };
+
+	// Timeouts: an album exceeding its timeout is cancelled between two
+	// blocks of samples, the other albums continue
+
+	const auto album_timeout { timeout_of(config, CALC::TIMEOUTALBUM) };
+	const auto file_timeout  { timeout_of(config, CALC::TIMEOUTFILE)  };
+	auto timeouts = std::size_t { 0 };
+
+	// Pinning: each thread processes its albums on its CPU
+
+	const auto pinning {
+		affinity::pinning(affinity::to_placement(config.value(CALC::PIN))) };
+
+	// Progress: the albums found or read are counted when they are reported
+
+	const auto progress { create_progress(config) };
+
+	const auto report_totals = [&]
+	{
+		if (journal)
+		{
+			ARCS_LOG_INFO << "Skipped " << skipped
+				<< " albums completed before";
+		}
+
+		if (governor.limit() > 0)
+		{
+			ARCS_LOG_INFO << "Memory: " << governor.admitted()
+				<< " albums admitted, " << governor.deferred()
+				<< " deferred, peak estimate of " << governor.peak() / MIB
+				<< " MiB";
+		}
+
+		ARCS_LOG_INFO << "Reader selections: " << selections.hits()
+			<< " hits, " << selections.misses() << " misses, "
+			<< selections.calculators() << " calculators created";
+
+		if (album_timeout.count() > 0 || file_timeout.count() > 0)
+		{
+			ARCS_LOG_INFO << "Timeouts: " << timeouts << " albums cancelled";
+		}
+	};
+
+	// Each album is calculated by a single thread, the threads of the pool
+	// process different albums.
+
+	const auto process = [&](const batch::Album& album) -> AlbumResult
+	{
+		auto result = AlbumResult {};
+
+		try
+		{
+			if (journal)
+			{
+				result.key = journal::album_key(album, album.audiofiles);
+
+				if (journal->contains(result.key))
+				{
+					result.completed_before = true;
+					return result;
+				}
+			}
+
+			// The audio files are resolved, thus the estimate does not
+			// parse the metafile again
+
+			const parallel::Admission admission { governor,
+				governor.limit() > 0
+					? estimator.estimate_memory(album.audiofiles,
+						album.metafile)
+					: 0 };
+
+			// The album timeout starts when the album is admitted
+
+			const deadline::Deadline deadline { album_timeout,
+				album.metafile };
+
+			result.calculation = std::make_unique<Calculation>(calculate(
+					album.audiofiles, album.metafile, true, true,
+					requested_types, audio_selection, toc_selection, 1,
+					cache, input, digest_types, &result.digests,
+					check_md5, &result.md5_status, 0,
+					affinity::Placement::NONE, &selections, engine,
+					deadline, file_timeout, progress.get()));
+
+		} catch (const deadline::TimeoutException& e)
+		{
+			result.error     = e.what();
+			result.timed_out = true;
+
+		} catch (const std::exception& e)
+		{
+			result.error = e.what();
+		}
+
+		return result;
+	};
+
+	const auto report = [&](const batch::Album& album, AlbumResult&& r)
+	{
+		const auto& [ calculation, digests, md5_status, error, key,
+			completed_before, timed_out ] = r;
+
+		if (progress)
+		{
+			progress->album_done();
+		}
+
+		if (completed_before)
+		{
+			ARCS_LOG_DEBUG << "Skip " << album.metafile
+				<< ", completed before";
+
+			++skipped;
+			return;
+		}
+
+		if (timed_out)
+		{
+			std::cerr << "TIMEOUT: " << album.metafile << ": " << error
+				<< '\n';
+
+			if (EXIT_SUCCESS == exit_code)
+			{
+				exit_code = EXIT_TIMEOUT;
+			}
+
+			++timeouts;
+			return;
+		}
+
+		if (!calculation || std::get<0>(*calculation).size() == 0)
+		{
+			std::cerr << "ERROR: " << album.metafile << ": "
+				<< (error.empty()
+					? "Calculation returned no checksums" : error)
+				<< '\n';
+
+			exit_code = EXIT_FAILURE;
+			return;
+		}
+
+		const auto& [ checksums, arid, toc ] = *calculation;
+
+		output(format_result(*formatter, requested_types, checksums, arid,
+				toc.get(), album.audiofiles, digests, md5_status));
+
+		if (calc::has_mismatch(md5_status))
+		{
+			exit_code = EXIT_FAILURE;
+
+		} else if (journal)
+		{
+			journal->append(key, result_digest(checksums), album.metafile);
+		}
+	};
+
+	// Recursive or watched: each album is calculated as soon as it is found,
+	// thus the results are output in the order the calculations complete.
+
+	const auto streamed { config.is_set(CALC::WATCH)
+		|| (config.is_set(CALC::RECURSIVE)
+			&& !config.is_set(CALC::PREFLIGHT)) };
+
+	if (streamed)
+	{
+		auto mutex = std::mutex {};
+		parallel::GroupedTaskPool pool { workers, device_limit, pinning };
+
+		// The audio files are resolved on the threads of the walk
+
+		const auto submit = [&](batch::Album&& found)
+		{
+			auto album { resolve_audiofiles(estimator, std::move(found)) };
+			const auto device { device_of(album) };
+
+			if (progress)
+			{
+				progress->add_albums(1);
+			}
+
+			pool.submit(device, [&,album = std::move(album)]
+				{
+					auto result { process(album) };
+
+					const std::lock_guard<std::mutex> lock(mutex);
+					report(album, std::move(result));
+					std::cout.flush();
+				});
+		};
+
+		if (config.is_set(CALC::WATCH))
+		{
+			ARCS_LOG_INFO << "Watch " << config.value(CALC::WATCH)
+				<< " and process albums with " << workers << " threads";
+
+			watch::watch_albums(config.value(CALC::WATCH), watch::SETTLE_TIME,
+					submit);
+		} else
+		{
+			ARCS_LOG_INFO << "Process albums in "
+				<< config.value(CALC::RECURSIVE) << " with " << workers
+				<< " threads";
+
+			batch::find_albums(config.value(CALC::RECURSIVE), workers, submit);
+		}
+
+		pool.wait();
+
+		report_totals();
+
+		return exit_code;
+	}
+
+	auto albums { config.is_set(CALC::RECURSIVE)
+		? find_sorted_albums(config.value(CALC::RECURSIVE), workers,
+			estimator)
+		: resolve_audiofiles(estimator,
+			batch::read_manifest(config.value(CALC::BATCH)), workers) };
+
+	// Preflight: refuse the batch or skip the albums that would fail anyway
+
+	if (config.is_set(CALC::PREFLIGHT))
+	{
+		auto passed { preflight(albums, workers, audio_selection,
+				toc_selection) };
+
+		if (passed.size() < albums.size())
+		{
+			std::cerr << "PREFLIGHT: " << albums.size() - passed.size()
+				<< " of " << albums.size() << " albums failed\n";
+
+			if (config.value(CALC::PREFLIGHT) == "abort")
+			{
+				return EXIT_FAILURE;
+			}
+
+			exit_code = EXIT_FAILURE;
+			albums    = std::move(passed);
+		}
+	}
+
+	ARCS_LOG_INFO << "Process " << albums.size() << " albums with "
+		<< workers << " threads";
+
+	if (progress)
+	{
+		progress->add_albums(albums.size());
+	}
 
-	return std::make_pair(EXIT_SUCCESS, std::move(result));
+	// While the albums of a saturated device wait, the window leaves room
+	// for the albums of other devices, but bounds the results kept until
+	// their predecessors are reported
+
+	parallel::run_ordered<AlbumResult>(albums.size(), workers, 4 * workers,
+		[&](const std::size_t i)
+		{
+			return device_of(albums[i]);
+		},
+		device_limit,
+		[&](const std::size_t i) -> AlbumResult
+		{
+			return process(albums[i]);
+		},
+		[&](const std::size_t i, AlbumResult&& r)
+		{
+			report(albums[i], std::move(r));
+		},
+		pinning);
+
+	report_totals();
+
+	return exit_code;
+}
+
+
+std::vector<digest::DigestType> ARCalcApplication::requested_digests(
+		const Configuration& config) const
+{
+	if (!config.is_set(CALC::DIGESTS))
+	{
+		return {};
+	}
+
+	return config.object<std::vector<digest::DigestType>>(CALC::DIGESTS);
+}
+
+
+std::size_t ARCalcApplication::requested_window(const Configuration& config)
+	const
+{
+	if (!config.is_set(CALC::WINDOWS) && !config.is_set(CALC::COMPAREWINDOWS))
+	{
+		return 0;
+	}
+
+	return config.object<std::size_t>(CALC::WINDOWSIZE);
+}
+
+
+std::pair<int, std::unique_ptr<Result>> ARCalcApplication::run_plan(
+		const Configuration& config,
+		arcsdec::FileReaderSelection* audio_selection,
+		arcsdec::FileReaderSelection* toc_selection) const
+{
+	const auto batch { config.is_set(CALC::BATCH)
+		|| config.is_set(CALC::RECURSIVE) };
+	const auto threads { config.object<std::size_t>(CALC::THREADS) };
+	const auto workers { parallel::worker_count(threads) };
+
+	// The calculator is configured as for the calculation, thus the plan
+	// chooses the same decoders. In a batch, each album is calculated by a
+	// single thread. The timeouts apply to the calculation only, thus
+	// reading the headers is not bounded by them.
+
+	calc::ChecksumCalculator c;
+	if (toc_selection)   { c.set_toc_selection  (toc_selection);   }
+	if (audio_selection) { c.set_audio_selection(audio_selection); }
+	c.set_threads(batch ? 1 : threads);
+	c.set_input_options(create_input_options(config));
+	c.set_digests(requested_digests(config));
+	c.set_check_md5(config.is_set(CALC::CHECKMD5));
+	c.set_window(batch ? 0 : requested_window(config));
+	c.set_engine(kernel::to_engine(config.value(CALC::ENGINE)));
+
+	const auto albums { batch
+		? (config.is_set(CALC::RECURSIVE)
+			? find_sorted_albums(config.value(CALC::RECURSIVE), workers, c)
+			: batch::read_manifest(config.value(CALC::BATCH)))
+		: std::vector<batch::Album> { batch::Album {
+			config.value(CALC::METAFILE), *config.arguments() } } };
+
+	// Only the headers are read, thus the albums are planned concurrently
+
+	auto exit_code = EXIT_SUCCESS;
+	auto planned   = std::vector<plan::AlbumPlan> {};
+
+	parallel::run_ordered<plan::AlbumPlan>(albums.size(), workers,
+		albums.size(),
+		[&](const std::size_t i) -> plan::AlbumPlan
+		{
+			return plan::plan_album(c, albums[i]);
+		},
+		[&](const std::size_t, plan::AlbumPlan&& p)
+		{
+			if (!p.error.empty())
+			{
+				std::cerr << "PLAN: " << p.name << ": " << p.error << '\n';
+
+				exit_code = EXIT_FAILURE;
+			}
+
+			planned.push_back(std::move(p));
+		});
+
+	// Calibration: each reader type without a rate is measured
+
+	plan::Calibration calibration;
+
+	if (config.is_set(CALC::CALIBRATION)
+			&& calibration.read(config.value(CALC::CALIBRATION)))
+	{
+		ARCS_LOG_INFO << "Read " << calibration.rates().size()
+			<< " reader rates from " << config.value(CALC::CALIBRATION);
+	}
+
+	if (plan::calibrate(calibration, c, planned) > 0
+			&& config.is_set(CALC::CALIBRATION))
+	{
+		calibration.write(config.value(CALC::CALIBRATION));
+	}
+
+	const auto predicted { plan::predict(std::move(planned), calibration,
+			workers, batch) };
+
+	if (config.value(CALC::PLAN) == "json")
+	{
+		return { exit_code, std::make_unique<ResultObject<std::string>>(
+				plan::to_json(predicted, calibration)) };
+	}
+
+	auto results { std::make_unique<ResultList>() };
+
+	results->append(std::make_unique<ResultObject<table::StringTable>>(
+			plan::file_table(predicted)));
+	results->append(std::make_unique<ResultObject<std::string>>("\n"));
+	results->append(std::make_unique<ResultObject<table::StringTable>>(
+			plan::reader_table(predicted, calibration)));
+
+	return { exit_code, std::move(results) };
+}
+
+
+bool ARCalcApplication::do_calculation_requested(const Configuration& config)
+	const
+{
+	return config.is_set(CALC::BATCH) || config.is_set(CALC::RECURSIVE)
+		|| config.is_set(CALC::WATCH) || config.is_set(CALC::METAFILE)
+		|| not config.no_arguments();
 }
 
 
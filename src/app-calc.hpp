@@ -9,6 +9,8 @@
  * Options, Configurator and Application for calc application.
  */
 
+#include <chrono>      // for milliseconds
+#include <cstddef>     // for size_t
 #include <memory>      // for unique_ptr
 #include <string>      // for string
 #include <tuple>       // for tuple
@@ -32,6 +34,30 @@
 #ifndef __ARCSTOOLS_LAYOUTS_HPP__
 #include "layouts.hpp"             // for Layout
 #endif
+#ifndef __ARCSTOOLS_TOOLS_AFFINITY_HPP__
+#include "tools-affinity.hpp"      // for Placement
+#endif
+#ifndef __ARCSTOOLS_TOOLS_CACHE_HPP__
+#include "tools-cache.hpp"         // for ChecksumCache
+#endif
+#ifndef __ARCSTOOLS_TOOLS_DEADLINE_HPP__
+#include "tools-deadline.hpp"      // for Deadline
+#endif
+#ifndef __ARCSTOOLS_TOOLS_DIGEST_HPP__
+#include "tools-digest.hpp"        // for Digests, DigestType
+#endif
+#ifndef __ARCSTOOLS_TOOLS_IO_HPP__
+#include "tools-io.hpp"            // for InputOptions
+#endif
+#ifndef __ARCSTOOLS_TOOLS_KERNEL_HPP__
+#include "tools-kernel.hpp"        // for Engine
+#endif
+#ifndef __ARCSTOOLS_TOOLS_PROGRESS_HPP__
+#include "tools-progress.hpp"      // for Reporter
+#endif
+#ifndef __ARCSTOOLS_TOOLS_SELECTION_HPP__
+#include "tools-selection.hpp"     // for SelectionCache
+#endif
 #ifndef __ARCSTOOLS_TOOLS_TABLE_HPP__
 #include "tools-table.hpp"         // for TableCreator
 #endif
@@ -79,14 +105,25 @@ public:
 	static constexpr OptionCode NOLABELS      = BASE +  5;
 	static constexpr OptionCode COLDELIM      = BASE +  6;
 	static constexpr OptionCode PRINTID       = BASE +  7;
-	static constexpr OptionCode PRINTURL      = BASE +  8; // 19
+	static constexpr OptionCode PRINTURL      = BASE +  8;
+
+	// Calculation Processing Options
+
+	static constexpr OptionCode THREADS       = BASE +  9; // 20
+	static constexpr OptionCode CACHE         = BASE + 10; // 21
+	static constexpr OptionCode CACHEKEY      = BASE + 11; // 22
+	static constexpr OptionCode READAHEAD     = BASE + 12;
+	static constexpr OptionCode BUFFERSIZE    = BASE + 13;
+	static constexpr OptionCode IO            = BASE + 14; // 25
+	static constexpr OptionCode CHECKMD5      = BASE + 15; // 26
+	static constexpr OptionCode PROGRESS      = BASE + 16; // 27
 
 protected:
 
 	/**
 	 * \brief Max constant occurring in CALC
 	 */
-	static constexpr OptionCode SUBCLASS_BASE = BASE +  9;
+	static constexpr OptionCode SUBCLASS_BASE = BASE + 17;
 };
 
 
@@ -113,6 +150,13 @@ protected:
 	 */
 	std::unique_ptr<Options> configure_calcbase_options(
 			std::unique_ptr<Options> options) const;
+
+	/**
+	 * \brief Worker: parsers for the CALCBASE options for reuse in subclasses.
+	 *
+	 * \return Parsers for the CALCBASE options
+	 */
+	OptionParsers calcbase_parser_list() const;
 };
 
 
@@ -129,16 +173,52 @@ public:
 
 	// Calculation Input Options
 
-	static constexpr OptionCode FIRST        = BASE + 0; // 20
-	static constexpr OptionCode LAST         = BASE + 1;
-	static constexpr OptionCode ALBUM        = BASE + 2;
+	static constexpr OptionCode FIRST          = BASE + 0; // 28
+	static constexpr OptionCode LAST           = BASE + 1;
+	static constexpr OptionCode ALBUM          = BASE + 2;
 
 	// Calculation Output Options
 
-	static constexpr OptionCode NOV1         = BASE + 3;
-	static constexpr OptionCode NOV2         = BASE + 4;
-	static constexpr OptionCode SUMSONLY     = BASE + 5;
-	static constexpr OptionCode TRACKSASCOLS = BASE + 6; // 26
+	static constexpr OptionCode NOV1           = BASE + 3;
+	static constexpr OptionCode NOV2           = BASE + 4;
+	static constexpr OptionCode SUMSONLY       = BASE + 5;
+	static constexpr OptionCode TRACKSASCOLS   = BASE + 6;
+
+	// Calculation Processing Options
+
+	static constexpr OptionCode BATCH          = BASE + 7; // 35
+	static constexpr OptionCode DIGESTS        = BASE + 8; // 36
+	static constexpr OptionCode WINDOWS        = BASE + 9;
+	static constexpr OptionCode WINDOWSIZE     = BASE + 10;
+	static constexpr OptionCode COMPAREWINDOWS = BASE + 11; // 39
+	static constexpr OptionCode PREFLIGHT      = BASE + 12; // 40
+	static constexpr OptionCode RECURSIVE      = BASE + 13; // 41
+	static constexpr OptionCode WATCH          = BASE + 14; // 42
+	static constexpr OptionCode RESUME         = BASE + 15; // 43
+	static constexpr OptionCode MAXMEMORY      = BASE + 16; // 44
+	static constexpr OptionCode DEVICEREADERS  = BASE + 17; // 45
+	static constexpr OptionCode PIN            = BASE + 18; // 46
+	static constexpr OptionCode ENGINE         = BASE + 19; // 47
+	static constexpr OptionCode TIMEOUTALBUM   = BASE + 20; // 48
+	static constexpr OptionCode TIMEOUTFILE    = BASE + 21; // 49
+	static constexpr OptionCode PLAN           = BASE + 22; // 50
+	static constexpr OptionCode CALIBRATION    = BASE + 23; // 51
+};
+
+
+/**
+ * \brief Parser for the list of digests.
+ *
+ * Accepts a comma-separated list of digest names as input for option
+ * CALC::DIGESTS.
+ */
+class DigestListParser final
+	: public InputStringParser<std::vector<digest::DigestType>>
+{
+	std::string start_message() const final;
+
+	std::vector<digest::DigestType> do_parse_nonempty(const std::string& s)
+		const final;
 };
 
 
@@ -164,7 +244,7 @@ private:
 
 	// void do_validate(const Options& options) const;
 
-	// OptionParsers do_parser_list() const;
+	OptionParsers do_parser_list() const final;
 
 	// void do_validate(const Configuration& configuration) const;
 };
@@ -189,6 +269,30 @@ using Calc6Layout = Layout<std::unique_ptr<Result>
 class CalcTableCreator final	: public TableCreator
 								, public Calc6Layout
 {
+public:
+
+	/**
+	 * \brief Constructor.
+	 */
+	CalcTableCreator();
+
+	/**
+	 * \brief Set the digests calculated along with the checksums.
+	 *
+	 * If the list is not empty, a column for each digest type is printed
+	 * after the checksums.
+	 *
+	 * \param[in] digests Digests of each track
+	 */
+	void set_digests(const std::vector<digest::Digests>& digests);
+
+	/**
+	 * \brief The digests calculated along with the checksums.
+	 *
+	 * \return Digests of each track
+	 */
+	const std::vector<digest::Digests>& digests() const;
+
 protected:
 
 	/**
@@ -225,8 +329,46 @@ private:
 	void do_init_composer(TableComposer& c) const final;
 
 	std::unique_ptr<Result> do_format(InputTuple t) const final;
+
+	/**
+	 * \brief Digests of each track.
+	 */
+	std::vector<digest::Digests> digests_;
+};
+
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++"
+
+/**
+ * \brief Creates the column with a digest of each track.
+ *
+ * Since all digest columns are created alike, a single FieldCreator serves
+ * each of the digest attributes.
+ */
+class DigestField final : public FieldCreator
+{
+	const ATTR field_;
+	const digest::DigestType type_;
+	const std::vector<digest::Digests>* digests_;
+
+	void do_create(TableComposer* c, const int record_idx) const final;
+
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] field   The attribute of the column
+	 * \param[in] type    The digest type of the column
+	 * \param[in] digests Digests of each track
+	 */
+	DigestField(const ATTR field, const digest::DigestType type,
+			const std::vector<digest::Digests>* digests);
 };
 
+#pragma GCC diagnostic pop
+
 
 /**
  * \brief Abstract base class for an Application to perform calculations.
@@ -293,6 +435,46 @@ protected:
 	std::unique_ptr<arcsdec::FileReaderSelection> create_selection(
 			const OptionCode& request,
 			const Configuration& options) const;
+
+	/**
+	 * \brief Open the checksum cache if requested.
+	 *
+	 * If no cache is requested, no cache will be returned.
+	 *
+	 * \param[in] config Current configuration
+	 *
+	 * \throws std::runtime_error If the requested cache cannot be opened
+	 */
+	std::unique_ptr<cache::ChecksumCache> create_cache(
+			const Configuration& config) const;
+
+	/**
+	 * \brief Report the lookups in the checksum cache.
+	 *
+	 * \param[in] cache The checksum cache or \c nullptr
+	 */
+	void report_cache(const cache::ChecksumCache* cache) const;
+
+	/**
+	 * \brief Options for reading audio files as requested.
+	 *
+	 * \param[in] config Current configuration
+	 *
+	 * \return Options for reading audio files
+	 */
+	io::InputOptions create_input_options(const Configuration& config) const;
+
+	/**
+	 * \brief Start reporting the progress if requested.
+	 *
+	 * If no progress is requested, no reporter will be returned.
+	 *
+	 * \param[in] config Current configuration
+	 *
+	 * \return Progress reporter writing to stderr or \c nullptr
+	 */
+	std::unique_ptr<progress::Reporter> create_progress(
+			const Configuration& config) const;
 };
 
 
@@ -313,6 +495,20 @@ public:
 	 * \param[in] types           The checksum types requested
 	 * \param[in] audio_selection The selection for audio readers
 	 * \param[in] toc_selection   The selection for ToC parsers
+	 * \param[in] threads         Number of threads, 0 for one per CPU
+	 * \param[in] cache           The checksum cache or \c nullptr
+	 * \param[in] input           Options for reading audio files
+	 * \param[in] digest_types    Digests to calculate along with the checksums
+	 * \param[in] digests         Receives the digests calculated or \c nullptr
+	 * \param[in] check_md5       Check the MD5 declared by the audio files
+	 * \param[in] md5_status      Receives the MD5 check results or \c nullptr
+	 * \param[in] window          Samples per window in the digests, 0 for none
+	 * \param[in] placement       Placement of the threads on the CPUs
+	 * \param[in] selections      Cache for reader selections or \c nullptr
+	 * \param[in] engine          Engine to update the sums
+	 * \param[in] deadline        Deadline of the whole calculation
+	 * \param[in] file_timeout    Timeout for each audio file, 0 for none
+	 * \param[in] progress        Progress reporter or \c nullptr
 	 *
 	 * \return Calculation result
 	 */
@@ -323,7 +519,22 @@ public:
 		const bool last_file_is_last_track,
 		const std::vector<arcstk::checksum::type>& types,
 		arcsdec::FileReaderSelection* audio_selection,
-		arcsdec::FileReaderSelection* toc_selection);
+		arcsdec::FileReaderSelection* toc_selection,
+		const std::size_t threads,
+		cache::ChecksumCache* cache,
+		const io::InputOptions& input,
+		const std::vector<digest::DigestType>& digest_types = {},
+		std::vector<digest::Digests>* digests = nullptr,
+		const bool check_md5 = false,
+		std::vector<calc::MD5Status>* md5_status = nullptr,
+		const std::size_t window = 0,
+		const affinity::Placement placement = affinity::Placement::NONE,
+		selection::SelectionCache* selections = nullptr,
+		const kernel::Engine engine = kernel::Engine::SCALAR,
+		const deadline::Deadline& deadline = deadline::Deadline {},
+		const std::chrono::milliseconds file_timeout =
+			std::chrono::milliseconds { 0 },
+		progress::Reporter* progress = nullptr);
 
 private:
 
@@ -337,9 +548,125 @@ private:
 	std::unique_ptr<CalcTableCreator> create_formatter(
 			const Configuration& config) const;
 
+	/**
+	 * \brief Format a calculation result.
+	 *
+	 * \param[in] formatter       The formatter to use
+	 * \param[in] requested_types The checksum types requested
+	 * \param[in] checksums       The checksums calculated
+	 * \param[in] arid            The ARId calculated
+	 * \param[in] toc             The ToC, if any
+	 * \param[in] audiofilenames  The audio files passed, if any
+	 * \param[in] digests         The digests calculated, if any
+	 * \param[in] md5_status      The results of the MD5 checks, if any
+	 *
+	 * \return Formatted result
+	 */
+	std::unique_ptr<Result> format_result(CalcTableCreator& formatter,
+			const std::vector<arcstk::checksum::type>& requested_types,
+			const Checksums& checksums, const ARId& arid, const ToC* toc,
+			const std::vector<std::string>& audiofilenames,
+			const std::vector<digest::Digests>& digests,
+			const std::vector<calc::MD5Status>& md5_status) const;
+
+	/**
+	 * \brief The digests requested to calculate along with the checksums.
+	 *
+	 * \param[in] config The configuration parsed from command line
+	 *
+	 * \return Digest types requested, empty if none
+	 */
+	std::vector<digest::DigestType> requested_digests(
+			const Configuration& config) const;
+
+	/**
+	 * \brief Number of frames per window requested.
+	 *
+	 * \param[in] config The configuration parsed from command line
+	 *
+	 * \return Frames per window, 0 if no windows are requested
+	 */
+	std::size_t requested_window(const Configuration& config) const;
+
+	/**
+	 * \brief Plan the calculation without decoding the audio files.
+	 *
+	 * Reads the metadata files and the headers of the audio files of the
+	 * album or of each album of a manifest file or a tree. Reports their
+	 * samples and sizes by reader type and predicts the wall time of the
+	 * calculation with the threads requested.
+	 *
+	 * The rates of the reader types are read from the calibration file if
+	 * one is specified. Each reader type without a rate is measured on its
+	 * smallest audio file and the calibration file is updated.
+	 *
+	 * \param[in] config          The configuration parsed from command line
+	 * \param[in] audio_selection The selection for audio readers
+	 * \param[in] toc_selection   The selection for ToC parsers
+	 *
+	 * \return Exit code: EXIT_FAILURE iff any album cannot be planned, and
+	 * the plan as table or as JSON
+	 */
+	std::pair<int, std::unique_ptr<Result>> run_plan(
+			const Configuration& config,
+			arcsdec::FileReaderSelection* audio_selection,
+			arcsdec::FileReaderSelection* toc_selection) const;
+
+	/**
+	 * \brief Calculate and output each album of a manifest file or a tree.
+	 *
+	 * The albums are calculated concurrently, but their results are output in
+	 * the order of the manifest. Thus, the output is identical to the output
+	 * of processing the albums one by one.
+	 *
+	 * The albums of a directory tree are calculated while the tree is still
+	 * walked and output in the order their calculations complete. Only if a
+	 * preflight is requested, the entire tree is walked first and the albums
+	 * are output in the order of their metafiles.
+	 *
+	 * A watched directory tree is processed until the process is terminated.
+	 * Each album is calculated as soon as it is completely written.
+	 *
+	 * If a journal is specified, the albums in the journal are skipped and
+	 * each album completed without failure is added to it.
+	 *
+	 * If a memory limit is specified, an album is only started while its
+	 * estimated memory fits under the limit along with the albums running.
+	 *
+	 * If a placement is specified, the threads are pinned to CPUs
+	 * accordingly.
+	 *
+	 * The albums are grouped by the storage device of their audio files and
+	 * each device is read by a limited number of threads at once, e.g. a
+	 * single thread for a hard disk. Threads not needed by a saturated device
+	 * process the albums on other devices.
+	 *
+	 * The albums share the readers selected for the signatures of their audio
+	 * files as well as the ARCSCalculator instances.
+	 *
+	 * If a timeout is specified, an album that exceeds it is cancelled and
+	 * reported as TIMEOUT while the other albums continue.
+	 *
+	 * \param[in] config          The configuration parsed from command line
+	 * \param[in] requested_types The checksum types requested
+	 * \param[in] audio_selection The selection for audio readers
+	 * \param[in] toc_selection   The selection for ToC parsers
+	 * \param[in] cache           The checksum cache or \c nullptr
+	 *
+	 * \return Exit code: EXIT_FAILURE iff any album failed, EXIT_TIMEOUT iff
+	 * any album timed out and none failed
+	 */
+	int run_batch(const Configuration& config,
+			const std::vector<arcstk::checksum::type>& requested_types,
+			arcsdec::FileReaderSelection* audio_selection,
+			arcsdec::FileReaderSelection* toc_selection,
+			cache::ChecksumCache* cache) const;
+
 
 	// ARCalcApplicationBase
 
+	bool do_calculation_requested(const Configuration& config) const final;
+
 	std::pair<int, std::unique_ptr<Result>> do_run_calculation(
 			const Configuration& config) const final;
 
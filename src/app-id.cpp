@@ -2,9 +2,15 @@
 #include "app-id.hpp"
 #endif
 
-#include <cstdlib>                  // for EXIT_SUCCESS
+#include <cstddef>                  // for size_t
+#include <cstdint>                  // for int32_t
+#include <cstdlib>                  // for EXIT_SUCCESS, EXIT_FAILURE
+#include <exception>                // for exception
+#include <iostream>                 // for cerr
 #include <iterator>                 // for end
 #include <memory>                   // for unique_ptr, make_unique
+#include <mutex>                    // for mutex, lock_guard
+#include <stdexcept>                // for invalid_argument, runtime_error
 #include <string>                   // for string
 #include <utility>                  // for make_pair, move, pair
 
@@ -29,14 +35,26 @@
 #include "config.hpp"                 // for Configurator, OptionCode
 #endif
 #ifndef __ARCSTOOLS_RESULT_HPP__
-#include "result.hpp"                 // for ResultObject
+#include "result.hpp"                 // for ResultObject, ResultList
 #endif
 #ifndef __ARCSTOOLS_TOOLS_ARID_HPP__
 #include "tools-arid.hpp"             // for ARIdLayout
 #endif
+#ifndef __ARCSTOOLS_TOOLS_BATCH_HPP__
+#include "tools-batch.hpp"            // for Album, find_albums
+#endif
 #ifndef __ARCSTOOLS_TOOLS_CALC_HPP__
 #include "tools-calc.hpp"             // for IdSelection
 #endif
+#ifndef __ARCSTOOLS_TOOLS_IO_HPP__
+#include "tools-io.hpp"               // for InputOptions, to_backend
+#endif
+#ifndef __ARCSTOOLS_TOOLS_PARALLEL_HPP__
+#include "tools-parallel.hpp"         // for TaskPool, worker_count
+#endif
+#ifndef __ARCSTOOLS_TOOLS_PCM_HPP__
+#include "tools-pcm.hpp"              // for open_sample_reader
+#endif
 
 namespace arcsapp
 {
@@ -116,7 +134,19 @@ void ARIdConfigurator::do_flush_local_options(OptionRegistry& r) const
 			"'http://accuraterip.com/accuraterip/'" }},
 
 		{ ARIdOptions::AUDIOFILE,
-		{ 'a', "audiofile", true, "none", "Specify input audio file" }}
+		{ 'a', "audiofile", true, "none", "Specify input audio file" }},
+
+		{ ARIdOptions::IO,
+		{ "io", true, "stdio",
+			"Read audio files by 'stdio', 'mmap' or 'io_uring'" }},
+
+		{ ARIdOptions::RECURSIVE,
+		{ "recursive", true, "none",
+			"Print the id of every cuesheet in the directory tree" }},
+
+		{ ARIdOptions::THREADS,
+		{ 'j', "threads", true, "0",
+			"Number of threads for --recursive, 0 for one per CPU" }}
 	});
 }
 
@@ -130,28 +160,75 @@ std::unique_ptr<Options> ARIdConfigurator::do_configure_options(
 		options->set(ARIdOptions::DBID);
 		options->unset(ARIdOptions::FILENAME);
 	}
+
+	// Recursive: each cuesheet in the tree is processed with its audio files
+	if (options->is_set(ARIdOptions::RECURSIVE))
+	{
+		if (options->is_set(ARIdOptions::AUDIOFILE)
+				|| not options->no_arguments())
+		{
+			throw ConfigurationException("Option --recursive cannot be "
+					"combined with --audiofile or a metafile");
+		}
+
+		if (options->value(ARIdOptions::RECURSIVE).empty())
+		{
+			throw ConfigurationException("Option --recursive requires a "
+					"directory");
+		}
+	}
+
+	// Threads: One Per CPU If Not Specified
+	if (not options->is_set(ARIdOptions::THREADS))
+	{
+		options->set(ARIdOptions::THREADS, "0");
+
+	} else if (not options->is_set(ARIdOptions::RECURSIVE))
+	{
+		ARCS_LOG_WARNING << "Option THREADS is ignored without RECURSIVE";
+	}
+
+	// Validate I/O backend
+	if (options->is_set(ARIdOptions::IO))
+	{
+		try
+		{
+			io::to_backend(options->value(ARIdOptions::IO));
+
+		} catch (const std::invalid_argument& e)
+		{
+			throw ConfigurationException(e.what());
+		}
+	}
+
 	return options;
 }
 
 
+OptionParsers ARIdConfigurator::do_parser_list() const
+{
+	return {
+		{ ARIdOptions::THREADS,
+			[]{ return std::make_unique<NumberParser>(); } }
+	};
+}
+
+
 // ARIdApplication
 
 
 bool ARIdApplication::do_calculation_requested(const Configuration& config)
 	const
 {
-	return config.is_set(ARIdOptions::AUDIOFILE) || not config.no_arguments();
+	return config.is_set(ARIdOptions::AUDIOFILE)
+		|| config.is_set(ARIdOptions::RECURSIVE) || not config.no_arguments();
 }
 
 
-auto ARIdApplication::do_run_calculation(const Configuration& config) const
-	-> std::pair<int, std::unique_ptr<Result>>
+std::unique_ptr<ARId> ARIdApplication::calculate_arid(
+		const std::string& metafilename, std::string audiofilename,
+		const Configuration& config) const
 {
-	// Compute requested values
-
-	const auto metafilename = config.argument(0);
-	auto audiofilename      = config.value(ARIdOptions::AUDIOFILE);
-
 	// Step 1: update selection and parse metafile
 
 	auto toc = std::unique_ptr<ToC>{};
@@ -201,9 +278,27 @@ auto ARIdApplication::do_run_calculation(const Configuration& config) const
 
 		auto audio_size = std::unique_ptr<AudioSize>{};
 
+		auto audio_sel { create_selection(ARIdOptions::READERID, config) };
+
+		// An I/O backend is respected unless a reader is requested explicitly
+
+		if (config.is_set(ARIdOptions::IO) && !audio_sel)
+		{
+			auto input = io::InputOptions {};
+			input.backend = io::to_backend(config.value(ARIdOptions::IO));
+
+			if (const auto reader {
+					pcm::open_sample_reader(audiofilename, input) })
+			{
+				audio_size = std::make_unique<AudioSize>(
+					static_cast<std::int32_t>(reader->total_samples()),
+					AudioSize::UNIT::SAMPLES);
+			}
+		}
+
+		if (!audio_size)
 		{
 			AudioInfo a;
-			auto audio_sel { create_selection(ARIdOptions::READERID, config) };
 			if (audio_sel)
 			{
 				a.set_selection(audio_sel.get());
@@ -215,10 +310,13 @@ auto ARIdApplication::do_run_calculation(const Configuration& config) const
 		arid = make_arid(*toc, *audio_size);
 	}
 
-	if (!arid) { this->fatal_error("Could not compute AccurateRip id."); }
+	return arid;
+}
 
-	// Build the result object
 
+std::unique_ptr<ARIdLayout> ARIdApplication::create_layout(
+		const Configuration& config) const
+{
 	std::unique_ptr<ARIdLayout> layout;
 
 	if (config.is_set(ARIdOptions::PROFILE))
@@ -247,7 +345,92 @@ auto ARIdApplication::do_run_calculation(const Configuration& config) const
 		);
 	}
 
-	auto id = RichARId{*arid, std::move(layout),
+	return layout;
+}
+
+
+int ARIdApplication::run_recursive(const Configuration& config) const
+{
+	const auto workers { parallel::worker_count(
+			config.object<std::size_t>(ARIdOptions::THREADS)) };
+
+	ARCS_LOG_INFO << "Process albums in "
+		<< config.value(ARIdOptions::RECURSIVE) << " with " << workers
+		<< " threads";
+
+	auto mutex     = std::mutex {};
+	auto exit_code = EXIT_SUCCESS;
+
+	// Each album is identified as soon as the walk finds it, thus the ids are
+	// output in the order their calculations complete.
+
+	parallel::TaskPool pool { workers };
+
+	batch::find_albums(config.value(ARIdOptions::RECURSIVE), workers,
+		[&](batch::Album&& found)
+		{
+			pool.submit([&,album = std::move(found)]
+				{
+					auto arid  = std::unique_ptr<ARId> {};
+					auto error = std::string {
+						"Could not compute AccurateRip id." };
+
+					try
+					{
+						arid = calculate_arid(album.metafile, {}, config);
+
+					} catch (const std::exception& e)
+					{
+						error = e.what();
+					}
+
+					const std::lock_guard<std::mutex> lock(mutex);
+
+					if (!arid)
+					{
+						std::cerr << "ERROR: " << album.metafile << ": "
+							<< error << '\n';
+
+						exit_code = EXIT_FAILURE;
+						return;
+					}
+
+					auto result { std::make_unique<ResultList>() };
+
+					result->append(std::make_unique<ResultObject<std::string>>(
+						album.metafile + '\n'));
+					result->append(std::make_unique<ResultObject<RichARId>>(
+						RichARId { *arid, create_layout(config),
+							config.value(ARIdOptions::URLPREFIX) }));
+
+					output(std::move(result));
+				});
+		});
+
+	pool.wait();
+
+	return exit_code;
+}
+
+
+auto ARIdApplication::do_run_calculation(const Configuration& config) const
+	-> std::pair<int, std::unique_ptr<Result>>
+{
+	if (config.is_set(ARIdOptions::RECURSIVE))
+	{
+		return std::make_pair(run_recursive(config), nullptr);
+	}
+
+	// Compute requested values
+
+	const auto arid { calculate_arid(config.argument(0),
+			config.value(ARIdOptions::AUDIOFILE), config) };
+
+	if (!arid) { this->fatal_error("Could not compute AccurateRip id."); }
+
+	// Build the result object
+
+	auto id = RichARId{*arid, create_layout(config),
 		config.value(ARIdOptions::URLPREFIX)};
 
 	return std::make_pair(EXIT_SUCCESS,
@@ -13,6 +13,10 @@
 #include <string>           // for string
 #include <utility>          // for pair
 
+#ifndef __LIBARCSTK_IDENTIFIER_HPP__
+#include <arcstk/identifier.hpp> // for ARId
+#endif
+
 #ifndef __ARCSTOOLS_APPLICATION_HPP__
 #include "application.hpp"  // for Application
 #endif
@@ -22,6 +26,9 @@
 #ifndef __ARCSTOOLS_APPCALC_HPP__
 #include "app-calc.hpp"     // for ARCalcApplicationBase
 #endif
+#ifndef __ARCSTOOLS_TOOLS_ARID_HPP__
+#include "tools-arid.hpp"   // for ARIdLayout
+#endif
 
 
 namespace arcsapp
@@ -48,7 +55,10 @@ public:
 	static constexpr OptionCode URLPREFIX = BASE +  5;
 	static constexpr OptionCode ID        = BASE +  6;
 	static constexpr OptionCode AUDIOFILE = BASE +  7;
-	static constexpr OptionCode NOLABELS  = BASE +  8; // 18
+	static constexpr OptionCode NOLABELS  = BASE +  8;
+	static constexpr OptionCode IO        = BASE +  9;
+	static constexpr OptionCode RECURSIVE = BASE + 10; // 20
+	static constexpr OptionCode THREADS   = BASE + 11; // 21
 };
 
 
@@ -70,7 +80,7 @@ private:
 
 	// void do_validate(const Options& options) const;
 
-	// OptionParsers do_parser_list() const;
+	OptionParsers do_parser_list() const final;
 
 	// void do_validate(const Configuration& configuration) const;
 };
@@ -81,6 +91,41 @@ private:
  */
 class ARIdApplication final : public ARCalcApplicationBase
 {
+	/**
+	 * \brief Calculate the ARId of an album.
+	 *
+	 * If the ToC is incomplete, the audio file is required to determine the
+	 * length of the last track. If no audio file is passed, it is taken from
+	 * the ToC.
+	 *
+	 * \param[in] metafilename  Name of the metadata file
+	 * \param[in] audiofilename Name of the audio file, may be empty
+	 * \param[in] config        The Application configuration
+	 *
+	 * \return The ARId of the album
+	 */
+	std::unique_ptr<arcstk::ARId> calculate_arid(const std::string& metafilename,
+			std::string audiofilename, const Configuration& config) const;
+
+	/**
+	 * \brief Create the layout for the ARId.
+	 *
+	 * \param[in] config The Application configuration
+	 *
+	 * \return Layout for the ARId
+	 */
+	std::unique_ptr<arid::ARIdLayout> create_layout(const Configuration& config)
+		const;
+
+	/**
+	 * \brief Calculate and output the ARId of each album of a directory tree.
+	 *
+	 * \param[in] config The Application configuration
+	 *
+	 * \return Exit code: EXIT_FAILURE iff any album failed
+	 */
+	int run_recursive(const Configuration& config) const;
+
 	// ARCalcApplicationBase
 
 	bool do_calculation_requested(const Configuration& config) const final;
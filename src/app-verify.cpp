@@ -4,7 +4,9 @@
 #endif
 
 #include <algorithm>       // for replace, max, transform
+#include <any>             // for any_cast
 #include <cctype>          // for toupper
+#include <chrono>          // for milliseconds
 #include <cmath>           // for ceil
 #include <cstddef>         // for size_t
 #include <cstdint>         // for uint32_t
@@ -12,9 +14,11 @@
 #include <exception>       // for exception
 #include <iterator>        // for begin, end
 #include <memory>          // for unique_ptr, make_unique
+#include <optional>        // for optional, nullopt
 #include <sstream>         // for istringstream, ostringstream
 #include <stdexcept>       // for invalid_argument, runtime_error
 #include <string>          // for stoul, string, to_string
+#include <vector>          // for vector
 #include <tuple>           // for get, make_tuple, tuple
 #include <utility>         // for move, pair
 
@@ -37,6 +41,9 @@
 #ifndef __ARCSTOOLS_CONFIG_HPP__
 #include "config.hpp"               // for Configurator, OptionCode
 #endif
+#ifndef __ARCSTOOLS_TOOLS_ARCS_HPP__
+#include "tools-arcs.hpp"           // for calculate_shifted, find_shift
+#endif
 #ifndef __ARCSTOOLS_TOOLS_ARID_HPP__
 #include "tools-arid.hpp"           // for ARIdLayout
 #endif
@@ -46,6 +53,12 @@
 #ifndef __ARCSTOOLS_TOOLS_DBAR_HPP__
 #include "tools-dbar.hpp"           // for ContentHandler
 #endif
+#ifndef __ARCSTOOLS_TOOLS_PARALLEL_HPP__
+#include "tools-parallel.hpp"       // for worker_count
+#endif
+#ifndef __ARCSTOOLS_TOOLS_PCM_HPP__
+#include "tools-pcm.hpp"            // for open_sample_reader
+#endif
 #ifndef __ARCSTOOLS_TOOLS_TABLE_HPP__
 #include "tools-table.hpp"          // for StringTableLayout, CellDecorator
 									// TableComposer
@@ -295,6 +308,43 @@ RefValuesType ChecksumListParser::do_parse_nonempty(
 }
 
 
+// OffsetRangeParser
+
+
+std::string OffsetRangeParser::start_message() const
+{
+	return "Range of the offset search in samples";
+}
+
+
+std::size_t OffsetRangeParser::do_parse_nonempty(const std::string& s) const
+{
+	// One second of audio is far beyond any drive's read offset
+	static constexpr std::size_t MAX_RANGE = 44100;
+
+	auto number { s };
+
+	for (const auto& prefix : { std::string { "\u00B1" }, std::string { "+-" } })
+	{
+		if (0 == number.compare(0, prefix.size(), prefix))
+		{
+			number.erase(0, prefix.size());
+			break;
+		}
+	}
+
+	const auto range { std::any_cast<std::size_t>(NumberParser{}.parse(number)) };
+
+	if (range > MAX_RANGE)
+	{
+		throw ConfigurationException("Offset range must not exceed "
+				+ std::to_string(MAX_RANGE) + " samples");
+	}
+
+	return range;
+}
+
+
 // ColorSpecParser
 
 
@@ -463,6 +513,38 @@ void ARVerifyConfigurator::do_flush_local_options(OptionRegistry& r) const
 		{  "print-url", false, OP_VALUE::FALSE,
 			"Print the AccurateRip URL of the album" }},
 
+		{ VERIFY::THREADS ,
+		{  'j', "threads", true, "1",
+			"Number of threads for calculation, 0 for one per CPU" }},
+
+		{ VERIFY::CACHE ,
+		{  "cache", true, "none",
+			"Reuse checksums from cache directory, add new ones" }},
+
+		{ VERIFY::CACHEKEY ,
+		{  "cache-key", true, "file",
+			"Identify cached files by 'file' system or by 'content'" }},
+
+		{ VERIFY::READAHEAD ,
+		{  "read-ahead", true, "0",
+			"Number of buffers to read ahead, 0 for none" }},
+
+		{ VERIFY::BUFFERSIZE ,
+		{  "buffer-size", true, "1024",
+			"Size of each read-ahead buffer in KiB" }},
+
+		{ VERIFY::IO ,
+		{  "io", true, "stdio",
+			"Read audio files by 'stdio', 'mmap' or 'io_uring'" }},
+
+		{ VERIFY::CHECKMD5 ,
+		{  "check-md5", false, "FALSE",
+			"Check the MD5 declared by FLAC files while calculating" }},
+
+		{ VERIFY::PROGRESS ,
+		{  "progress", true, "none",
+			"Report progress and throughput to stderr every N seconds" }},
+
 		// from VERIFY
 
 		{ VERIFY::NOFIRST ,
@@ -503,7 +585,11 @@ void ARVerifyConfigurator::do_flush_local_options(OptionRegistry& r) const
 
 		{ VERIFY::CONFIDENCE ,
 		{  "confidence", false, OP_VALUE::FALSE,
-			"Print confidence values if available" }}
+			"Print confidence values if available" }},
+
+		{ VERIFY::OFFSETRANGE ,
+		{  "offset-range", true, OP_VALUE::NONE,
+			"Search the shift of mismatching tracks within +-N samples" }}
 	});
 }
 
@@ -634,14 +720,21 @@ void ARVerifyConfigurator::do_validate(const Options& options) const
 
 OptionParsers ARVerifyConfigurator::do_parser_list() const
 {
-	return {
+	auto parsers { calcbase_parser_list() };
+
+	parsers.insert(parsers.end(),
+	{
 		{ VERIFY::RESPONSEFILE,
 			[]{ return std::make_unique<DBARParser>(); } },
 		{ VERIFY::REFVALUES,
 			[]{ return std::make_unique<ChecksumListParser>(); } },
 		{ VERIFY::COLORED,
-			[]{ return std::make_unique<ColorSpecParser>(); } }
-	};
+			[]{ return std::make_unique<ColorSpecParser>(); } },
+		{ VERIFY::OFFSETRANGE,
+			[]{ return std::make_unique<OffsetRangeParser>(); } }
+	});
+
+	return parsers;
 }
 
 
@@ -663,6 +756,7 @@ void ARVerifyConfigurator::do_validate(const Configuration& c) const
 
 VerifyTableCreator::VerifyTableCreator()
 	: match_symbol_ {}
+	, shifts_       {}
 {
 	// empty
 }
@@ -680,6 +774,19 @@ const std::string& VerifyTableCreator::match_symbol() const
 }
 
 
+void VerifyTableCreator::set_shifts(
+		const std::vector<std::optional<long>>& shifts)
+{
+	shifts_ = shifts;
+}
+
+
+const std::vector<std::optional<long>>& VerifyTableCreator::shifts() const
+{
+	return shifts_;
+}
+
+
 void VerifyTableCreator::update_field_labels(TableComposer& c) const
 {
 	const auto label_for_mine = std::string { "Mine" };
@@ -726,6 +833,16 @@ void VerifyTableCreator::add_result_fields(std::vector<ATTR>& field_list,
 			}
 		}
 	}
+
+	if (!shifts_.empty())
+	{
+		field_list.emplace_back(ATTR::SHIFT);
+	}
+
+	if (!md5_status().empty())
+	{
+		field_list.emplace_back(ATTR::MD5_CHECK);
+	}
 }
 
 
@@ -778,6 +895,18 @@ void VerifyTableCreator::populate_result_creators(
 
 		populate_theirs();
 	}
+
+	if (required(field_list, ATTR::SHIFT))
+	{
+		creators.emplace_back(
+			std::make_unique<AddField<ATTR::SHIFT>>(&shifts_));
+	}
+
+	if (required(field_list, ATTR::MD5_CHECK))
+	{
+		creators.emplace_back(
+			std::make_unique<AddField<ATTR::MD5_CHECK>>(&md5_status()));
+	}
 }
 
 
@@ -1357,6 +1486,30 @@ AddField<ATTR::THEIRS>::AddField(
 }
 
 
+void AddField<ATTR::SHIFT>::do_create(TableComposer* c, const int record_idx)
+	const
+{
+	const auto track { static_cast<std::size_t>(record_idx) };
+
+	auto value = std::string { "-" };
+
+	if (track < shifts_->size() && shifts_->at(track))
+	{
+		const auto shift { *shifts_->at(track) };
+		value = (shift > 0 ? "+" : "") + std::to_string(shift);
+	}
+
+	table::add_field(c, record_idx, ATTR::SHIFT, value);
+}
+
+
+AddField<ATTR::SHIFT>::AddField(const std::vector<std::optional<long>>* shifts)
+	: shifts_ { shifts }
+{
+	/* empty */
+}
+
+
 // validate
 
 
@@ -1519,6 +1672,140 @@ void ARVerifyApplication::log_matching_files(const Checksums& checksums,
 }
 
 
+std::vector<std::optional<long>> ARVerifyApplication::search_offsets(
+		const Configuration& config, const ToC& toc,
+		const ChecksumSource& reference, const VerificationResult& vresult)
+	const
+{
+	const auto max_shift { config.object<std::size_t>(VERIFY::OFFSETRANGE) };
+
+	// The search requires random access to the album in a single audio file
+
+	auto audiofilename = std::string {};
+
+	if (config.no_arguments())
+	{
+		const auto& [ single_audio_file, pairwise_distinct_files, files ] =
+			calc::ToCFiles::get(toc);
+
+		if (single_audio_file && !files.empty())
+		{
+			audiofilename = calc::ToCFiles::expand_path(
+					config.value(VERIFY::METAFILE), files.front());
+		}
+	} else if (config.arguments()->size() == 1)
+	{
+		audiofilename = config.arguments()->front();
+	}
+
+	if (audiofilename.empty() || calc::STDIN_FILENAME == audiofilename)
+	{
+		ARCS_LOG_WARNING << "Skip offset search since it requires the album as"
+			" a single audio file";
+		return {};
+	}
+
+	const auto options { create_input_options(config) };
+
+	auto tracks = std::vector<arcs::TrackRange> {};
+
+	try
+	{
+		const auto reader { pcm::open_sample_reader(audiofilename, options) };
+
+		if (!reader)
+		{
+			ARCS_LOG_WARNING << "Skip offset search since the format of "
+				<< audiofilename << " is not supported";
+			return {};
+		}
+
+		tracks = arcs::track_ranges(calc::sample_offsets(toc),
+				reader->total_samples());
+
+	} catch (const std::exception& e)
+	{
+		ARCS_LOG_WARNING << "Skip offset search: " << e.what();
+		return {};
+	}
+
+	if (config.is_set(VERIFY::NOFIRST))
+	{
+		tracks.front().check_from = 1;
+	}
+
+	if (config.is_set(VERIFY::NOLAST))
+	{
+		tracks.back().check_to = tracks.back().length;
+	}
+
+	ARCS_LOG_INFO << "Search shifts of up to " << max_shift << " samples in "
+		<< audiofilename;
+
+	const auto sums { arcs::calculate_shifted(
+			[&audiofilename,&options]{
+				return pcm::open_sample_reader(audiofilename, options); },
+			tracks, max_shift,
+			parallel::worker_count(config.object<std::size_t>(VERIFY::THREADS)))
+	};
+
+	// Tracks that match in any block are not shifted
+
+	const auto matches = [&vresult](const int track)
+	{
+		if (track >= vresult.tracks_per_block())
+		{
+			return false;
+		}
+
+		for (auto b = int { 0 }; b < vresult.total_blocks(); ++b)
+		{
+			if (vresult.track(b, track, true) || vresult.track(b, track, false))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	};
+
+	auto shifts = std::vector<std::optional<long>>(tracks.size());
+
+	for (std::size_t t = 0; t < tracks.size(); ++t)
+	{
+		if (matches(static_cast<int>(t)))
+		{
+			shifts[t] = 0;
+			continue;
+		}
+
+		auto references = std::vector<std::uint32_t> {};
+
+		for (std::size_t b = 0; b < reference.size(); ++b)
+		{
+			if (t < reference.size(b))
+			{
+				references.push_back(reference.arcs_value(b, t));
+			}
+		}
+
+		shifts[t] = arcs::find_shift(sums[t], references);
+
+		if (shifts[t])
+		{
+			ARCS_LOG_INFO << "Track " << (t + 1) << " matches when shifted by "
+				<< *shifts[t] << " samples";
+		} else
+		{
+			ARCS_LOG_INFO << "Track " << (t + 1) << " does not match within +-"
+				<< max_shift << " samples";
+		}
+	}
+
+	return shifts;
+}
+
+
 std::string ARVerifyApplication::do_name() const
 {
 	return "verify";
@@ -1579,6 +1866,11 @@ auto ARVerifyApplication::do_run_calculation(const Configuration& config) const
 	// If no selections are assigned, the libarcsdec default selections
 	// will be used.
 
+	const auto cache { create_cache(config) };
+
+	auto md5_status = std::vector<calc::MD5Status> {};
+	auto progress   = create_progress(config);
+
 	// Calculate the actual ARCSs from input files
 
 	auto [ checksums, mine_arid, toc ] = ARCalcApplication::calculate(
@@ -1588,9 +1880,27 @@ auto ARVerifyApplication::do_run_calculation(const Configuration& config) const
 			!config.is_set(VERIFY::NOLAST),
 			{ arcstk::checksum::type::ARCS2 }, /* force ARCSv1 + ARCSv2 */
 			audio_selection.get(),
-			toc_selection.get()
+			toc_selection.get(),
+			config.object<std::size_t>(VERIFY::THREADS),
+			cache.get(),
+			create_input_options(config),
+			{},
+			nullptr,
+			config.is_set(VERIFY::CHECKMD5),
+			&md5_status,
+			0,
+			affinity::Placement::NONE,
+			nullptr,
+			kernel::Engine::SCALAR,
+			{},
+			std::chrono::milliseconds { 0 },
+			progress.get()
 	);
 
+	progress.reset();
+
+	report_cache(cache.get());
+
 	if (checksums.size() == 0)
 	{
 		this->fatal_error("Calculation returned no checksums.");
@@ -1691,6 +2001,21 @@ auto ARVerifyApplication::do_run_calculation(const Configuration& config) const
 			<< " in response, having difference " << std::get<2>(best_b);
 	}
 
+	// Search the shifts of mismatching tracks
+
+	auto shifts = std::vector<std::optional<long>> {};
+
+	if (config.is_set(VERIFY::OFFSETRANGE))
+	{
+		if (toc)
+		{
+			shifts = search_offsets(config, *toc, *ref_source, *vresult);
+		} else
+		{
+			ARCS_LOG_WARNING << "Skip offset search since it requires a ToC";
+		}
+	}
+
 	if (config.is_set(VERIFY::NOOUTPUT)) // implies BOOLEAN
 	{
 		// 0 on accurate match, else > 0
@@ -1743,7 +2068,12 @@ auto ARVerifyApplication::do_run_calculation(const Configuration& config) const
 
 	// TODO Create formatter, then add types_to_print as print flags,
 	// remove the dedicated vector
-	auto result { create_formatter(config)->format(
+	auto formatter { create_formatter(config) };
+
+	formatter->set_shifts(shifts);
+	formatter->set_md5_status(md5_status);
+
+	auto result { formatter->format(
 		/* types to print */           types_to_print,
 		/* verification results */     vresult.get(),
 		/* optional best match */      best_block,
@@ -1759,6 +2089,12 @@ auto ARVerifyApplication::do_run_calculation(const Configuration& config) const
 		? std::get<2>(best_b) // best difference
 		: EXIT_SUCCESS;
 
+	// A corrupt audio file fails the verification in any case
+	if (EXIT_SUCCESS == exit_code && calc::has_mismatch(md5_status))
+	{
+		exit_code = EXIT_FAILURE;
+	}
+
 	return { exit_code, std::move(result) };
 }
 
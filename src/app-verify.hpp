@@ -12,6 +12,7 @@
 #include <cstddef>       // for size_t
 #include <cstdint>       // for uint16_t, uint32_t
 #include <memory>        // for unique_ptr
+#include <optional>      // for optional
 #include <string>        // for string
 #include <unordered_map> // for unordered_map
 #include <utility>       // for pair
@@ -159,6 +160,20 @@ class ChecksumListParser final : public InputStringParser<RefValuesType>
 };
 
 
+/**
+ * \brief Parser for the range of the offset search.
+ *
+ * Accepts a non-negative number of samples, optionally prefixed by '±' or
+ * '+-', as input for option VERIFY::OFFSETRANGE.
+ */
+class OffsetRangeParser final : public InputStringParser<std::size_t>
+{
+	std::string start_message() const final;
+
+	std::size_t do_parse_nonempty(const std::string& s) const final;
+};
+
+
 class ColorRegistry;
 
 /**
@@ -187,7 +202,7 @@ class VERIFY : public CALCBASE
 
 public:
 
-	static constexpr OptionCode NOFIRST      = BASE +  0; // 20
+	static constexpr OptionCode NOFIRST      = BASE +  0; // 28
 	static constexpr OptionCode NOLAST       = BASE +  1;
 	static constexpr OptionCode NOALBUM      = BASE +  2;
 	static constexpr OptionCode RESPONSEFILE = BASE +  3;
@@ -196,7 +211,8 @@ public:
 	static constexpr OptionCode BOOLEAN      = BASE +  6;
 	static constexpr OptionCode NOOUTPUT     = BASE +  7;
 	static constexpr OptionCode COLORED      = BASE +  8;
-	static constexpr OptionCode CONFIDENCE   = BASE +  9; // 29
+	static constexpr OptionCode CONFIDENCE   = BASE +  9;
+	static constexpr OptionCode OFFSETRANGE  = BASE + 10; // 38
 };
 
 
@@ -274,6 +290,23 @@ public:
 	 */
 	const std::string& match_symbol() const;
 
+	/**
+	 * \brief Set the shifts found by the offset search.
+	 *
+	 * If the list is not empty, a column with the shift of each track is
+	 * printed.
+	 *
+	 * \param[in] shifts Matching shift for each track, if any
+	 */
+	void set_shifts(const std::vector<std::optional<long>>& shifts);
+
+	/**
+	 * \brief The shifts found by the offset search.
+	 *
+	 * \return Matching shift for each track, if any
+	 */
+	const std::vector<std::optional<long>>& shifts() const;
+
 	/**
 	 * \brief Callback worker: add formatted THEIR checksum to result table.
 	 *
@@ -371,6 +404,11 @@ private:
 	 * \brief The symbol to be printed on identity of two checksum values.
 	 */
 	std::string match_symbol_;
+
+	/**
+	 * \brief Matching shift for each track, if any.
+	 */
+	std::vector<std::optional<long>> shifts_;
 };
 
 
@@ -808,6 +846,22 @@ public:
 			const bool print_confidence);
 };
 
+
+/**
+ * \brief Creates the column with the shift at which a track matches.
+ */
+template <>
+class table::AddField<ATTR::SHIFT> final : public FieldCreator
+{
+	const std::vector<std::optional<long>>* shifts_;
+
+	void do_create(TableComposer* c, const int record_idx) const final;
+
+public:
+
+	AddField(const std::vector<std::optional<long>>* shifts);
+};
+
 #pragma GCC diagnostic pop
 
 
@@ -857,6 +911,25 @@ class ARVerifyApplication final : public ARCalcApplicationBase
 		const VerificationResult& vresult, const int block,
 		const bool version = true) const;
 
+	/**
+	 * \brief Worker: Search the shift at which each track matches.
+	 *
+	 * Tracks that already match are reported with shift 0, all other tracks
+	 * are searched for a matching ARCSv1 within the range of shifts passed by
+	 * VERIFY::OFFSETRANGE. Searching requires the album as a single audio
+	 * file that can be read by a pcm::SampleReader.
+	 *
+	 * \param[in] config     The Application configuration
+	 * \param[in] toc        ToC of the album
+	 * \param[in] reference  Reference checksums
+	 * \param[in] vresult    Result of the verification
+	 *
+	 * \return Matching shift for each track, empty if the search failed
+	 */
+	std::vector<std::optional<long>> search_offsets(const Configuration& config,
+		const ToC& toc, const ChecksumSource& reference,
+		const VerificationResult& vresult) const;
+
 
 	// ARCalcApplicationBase
 
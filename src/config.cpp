@@ -2,13 +2,13 @@
 #include "config.hpp"
 #endif
 
-#include <algorithm>     // for find_if, replace
+#include <algorithm>     // for all_of, find_if, replace
 #include <cstddef>       // for size_t
 #include <iomanip>       // for setw
 #include <memory>        // for unique_ptr, make_unique
 #include <ostream>       // for ostream, endl, operator<<
 #include <sstream>       // for istringstream
-#include <stdexcept>     // for runtime_error
+#include <stdexcept>     // for out_of_range, runtime_error
 #include <string>        // for string
 #include <utility>       // for make_pair, move
 #include <vector>        // for vector
@@ -182,6 +182,35 @@ std::any StringParser::parse(const std::string& s) const
 }
 
 
+// NumberParser
+
+
+std::string NumberParser::start_message() const
+{
+	return "Non-negative number";
+}
+
+
+std::size_t NumberParser::do_parse_nonempty(const std::string& s) const
+{
+	const auto is_digit = [](const char c) { return c >= '0' && c <= '9'; };
+
+	if (!std::all_of(s.begin(), s.end(), is_digit))
+	{
+		throw ConfigurationException("Not a non-negative number: '" + s + "'");
+	}
+
+	try
+	{
+		return std::stoul(s);
+
+	} catch (const std::out_of_range&)
+	{
+		throw ConfigurationException("Number out of range: '" + s + "'");
+	}
+}
+
+
 // contains()
 
 
@@ -217,10 +246,15 @@ std::unique_ptr<Options> Configurator::read_options(const int argc,
 		const auto add_option =
 			[&options](const OptionCode c, const std::string& v)
 			{
-				// Discard dashes
-				if (input::DASH == c || input::DDASH == c) { return; }
+				// Discard double dashes
+				if (input::DDASH == c) { return; }
+
+				// A single dash is an argument denoting stdin
+				if (input::DASH == c)
+				{
+					options->put_argument("-");
 
-				if (input::ARGUMENT == c)
+				} else if (input::ARGUMENT == c)
 				{
 					options->put_argument(v);
 				} else
@@ -298,6 +298,20 @@ class InputStringParser : public StringParser
 };
 
 
+/**
+ * \brief Parser for a non-negative decimal number.
+ *
+ * Accepts the decimal representation of a non-negative integer as input. An
+ * empty input is parsed to 0.
+ */
+class NumberParser final : public InputStringParser<std::size_t>
+{
+	std::string start_message() const final;
+
+	std::size_t do_parse_nonempty(const std::string& s) const final;
+};
+
+
 using OptionRegistry = std::vector<std::pair<OptionCode, Option>>;
 //FIXME This definition is repeated from clitokens.hpp
 
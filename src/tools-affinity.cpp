@@ -0,0 +1,288 @@
+/**
+ * \file tools-affinity.cpp Placement of worker threads on CPUs and NUMA nodes
+ */
+
+#ifndef __ARCSTOOLS_TOOLS_AFFINITY_HPP__
+#include "tools-affinity.hpp"
+#endif
+
+#include <algorithm>   // for binary_search, max, sort, unique
+#include <cstring>     // for strerror
+#include <filesystem>  // for directory_iterator
+#include <fstream>     // for ifstream
+#include <sstream>     // for istringstream
+#include <stdexcept>   // for invalid_argument, runtime_error
+#include <string>      // for string, stoul, getline
+#include <system_error> // for error_code
+
+#include <pthread.h>   // for pthread_self, pthread_setaffinity_np
+#include <sched.h>     // for cpu_set_t, CPU_SET, CPU_ZERO, sched_getaffinity
+
+#ifndef __LIBARCSTK_LOGGING_HPP__
+#include <arcstk/logging.hpp>
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+namespace affinity
+{
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+/**
+ * \brief Sysfs directory of the NUMA nodes.
+ */
+const auto NODE_DIR = std::string { "/sys/devices/system/node" };
+
+
+/**
+ * \brief CPUs this process may run on, in ascending order.
+ */
+std::vector<Cpu> allowed_cpus()
+{
+	auto cpus = std::vector<Cpu> {};
+	auto set = cpu_set_t {};
+
+	CPU_ZERO(&set);
+
+	if (::sched_getaffinity(0, sizeof set, &set) != 0)
+	{
+		return cpus;
+	}
+
+	for (auto cpu = Cpu { 0 }; cpu < static_cast<Cpu>(CPU_SETSIZE); ++cpu)
+	{
+		if (CPU_ISSET(cpu, &set))
+		{
+			cpus.push_back(cpu);
+		}
+	}
+
+	return cpus;
+}
+
+} // namespace
+
+
+Placement to_placement(const std::string& name)
+{
+	if ("none" == name)
+	{
+		return Placement::NONE;
+	}
+
+	if ("compact" == name)
+	{
+		return Placement::COMPACT;
+	}
+
+	if ("spread" == name)
+	{
+		return Placement::SPREAD;
+	}
+
+	throw std::invalid_argument("Unknown placement '" + name
+			+ "', expected 'none', 'compact' or 'spread'");
+}
+
+
+std::string name(const Placement placement)
+{
+	switch (placement)
+	{
+		case Placement::COMPACT: return "compact";
+		case Placement::SPREAD:  return "spread";
+		default:                 return "none";
+	}
+}
+
+
+std::vector<Cpu> parse_cpu_list(const std::string& list)
+{
+	auto cpus = std::vector<Cpu> {};
+	auto in = std::istringstream { list };
+
+	for (std::string range; std::getline(in, range, ',');)
+	{
+		if (range.empty() || "\n" == range)
+		{
+			continue;
+		}
+
+		try
+		{
+			auto end = std::size_t { 0 };
+			const auto first { std::stoul(range, &end) };
+			auto last { first };
+
+			if (end < range.size() && '-' == range[end])
+			{
+				last = std::stoul(range.substr(end + 1));
+			}
+
+			for (auto cpu = first; cpu <= last; ++cpu)
+			{
+				cpus.push_back(static_cast<Cpu>(cpu));
+			}
+		} catch (const std::logic_error&)
+		{
+			throw std::invalid_argument("Malformed list of CPUs: " + list);
+		}
+	}
+
+	std::sort(cpus.begin(), cpus.end());
+	cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+
+	return cpus;
+}
+
+
+Topology topology()
+{
+	const auto allowed { allowed_cpus() };
+
+	auto nodes = Topology {};
+	auto ec = std::error_code {};
+
+	for (auto entry = fs::directory_iterator { NODE_DIR, ec };
+			!ec && entry != fs::directory_iterator {}; entry.increment(ec))
+	{
+		const auto dirname { entry->path().filename().string() };
+
+		if (dirname.rfind("node", 0) != 0 || dirname.size() == 4
+				|| dirname.find_first_not_of("0123456789", 4)
+					!= std::string::npos)
+		{
+			continue;
+		}
+
+		auto in = std::ifstream { entry->path() / "cpulist" };
+		auto list = std::string {};
+		std::getline(in, list);
+
+		auto cpus = std::vector<Cpu> {};
+
+		try
+		{
+			for (const auto cpu : parse_cpu_list(list))
+			{
+				if (std::binary_search(allowed.begin(), allowed.end(), cpu))
+				{
+					cpus.push_back(cpu);
+				}
+			}
+		} catch (const std::invalid_argument& e)
+		{
+			ARCS_LOG_WARNING << e.what();
+		}
+
+		if (!cpus.empty())
+		{
+			nodes.push_back(cpus);
+		}
+	}
+
+	// Nodes ordered by their first CPU, which is the order of their indices
+
+	std::sort(nodes.begin(), nodes.end());
+
+	if (nodes.empty() && !allowed.empty())
+	{
+		nodes.push_back(allowed);
+	}
+
+	return nodes;
+}
+
+
+std::vector<Cpu> cpu_order(const Placement placement, const Topology& nodes)
+{
+	auto order = std::vector<Cpu> {};
+
+	if (Placement::COMPACT == placement)
+	{
+		for (const auto& node : nodes)
+		{
+			order.insert(order.end(), node.begin(), node.end());
+		}
+	} else if (Placement::SPREAD == placement)
+	{
+		auto max_cpus = std::size_t { 0 };
+
+		for (const auto& node : nodes)
+		{
+			max_cpus = std::max(max_cpus, node.size());
+		}
+
+		for (std::size_t i = 0; i < max_cpus; ++i)
+		{
+			for (const auto& node : nodes)
+			{
+				if (i < node.size())
+				{
+					order.push_back(node[i]);
+				}
+			}
+		}
+	}
+
+	return order;
+}
+
+
+void pin_current_thread(const Cpu cpu)
+{
+	auto set = cpu_set_t {};
+
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+
+	const auto error {
+		::pthread_setaffinity_np(::pthread_self(), sizeof set, &set) };
+
+	if (error != 0)
+	{
+		throw std::runtime_error("Could not pin thread to CPU "
+				+ std::to_string(cpu) + ": " + std::strerror(error));
+	}
+}
+
+
+parallel::WorkerInit pinning(const Placement placement)
+{
+	if (Placement::NONE == placement)
+	{
+		return nullptr;
+	}
+
+	const auto nodes { topology() };
+	const auto order { cpu_order(placement, nodes) };
+
+	if (order.empty())
+	{
+		ARCS_LOG_WARNING << "No CPUs to pin workers to";
+		return nullptr;
+	}
+
+	ARCS_LOG_INFO << "Pin workers " << name(placement) << " to "
+		<< order.size() << " CPUs on " << nodes.size() << " NUMA nodes";
+
+	return [order](const std::size_t index)
+		{
+			const auto cpu { order[index % order.size()] };
+
+			ARCS_LOG_DEBUG << "Pin worker " << index << " to CPU " << cpu;
+
+			pin_current_thread(cpu);
+		};
+}
+
+} // namespace affinity
+} // namespace v_1_0_0
+} // namespace arcsapp
+
@@ -0,0 +1,142 @@
+#ifndef __ARCSTOOLS_TOOLS_AFFINITY_HPP__
+#define __ARCSTOOLS_TOOLS_AFFINITY_HPP__
+
+/**
+ * \file
+ *
+ * \brief Placement of worker threads on CPUs and NUMA nodes.
+ */
+
+#include <cstddef>     // for size_t
+#include <string>      // for string
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_PARALLEL_HPP__
+#include "tools-parallel.hpp" // for WorkerInit
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+
+/**
+ * \brief Tools and helpers for pinning worker threads to CPUs.
+ *
+ * A worker that is pinned to a CPU stays on its NUMA node. Since Linux places
+ * a page on the node of the thread that touches it first, the buffers a
+ * worker allocates and fills are local to its node. Threads started by a
+ * pinned worker, e.g. for reading ahead, inherit its CPU.
+ */
+namespace affinity
+{
+
+/**
+ * \brief Index of a CPU as used by the kernel.
+ */
+using Cpu = unsigned;
+
+
+/**
+ * \brief CPUs of each NUMA node.
+ */
+using Topology = std::vector<std::vector<Cpu>>;
+
+
+/**
+ * \brief Strategies to place worker threads.
+ */
+enum class Placement
+{
+	NONE,    //!< Workers are not pinned and scheduled by the kernel
+	COMPACT, //!< Workers fill the CPUs of a node before the next node
+	SPREAD   //!< Workers are distributed over the nodes in turn
+};
+
+
+/**
+ * \brief Placement for the specified name.
+ *
+ * Valid names are 'none', 'compact' and 'spread'.
+ *
+ * \param[in] name Name of the placement
+ *
+ * \return Placement for \c name
+ *
+ * \throws std::invalid_argument If \c name is not the name of a placement
+ */
+Placement to_placement(const std::string& name);
+
+
+/**
+ * \brief Name of a placement.
+ *
+ * \param[in] placement The placement to get the name for
+ *
+ * \return Name of \c placement
+ */
+std::string name(const Placement placement);
+
+
+/**
+ * \brief Parse a list of CPUs in the format of sysfs, e.g. '0-3,8'.
+ *
+ * \param[in] list List of CPUs
+ *
+ * \return CPUs in the list in ascending order
+ *
+ * \throws std::invalid_argument If \c list is malformed
+ */
+std::vector<Cpu> parse_cpu_list(const std::string& list);
+
+
+/**
+ * \brief CPUs of each NUMA node that this process may run on.
+ *
+ * The nodes are read from /sys/devices/system/node. If they are not
+ * available, all CPUs of the process form a single node.
+ *
+ * \return CPUs of each node, nodes without CPUs are omitted
+ */
+Topology topology();
+
+
+/**
+ * \brief CPU of each worker in the order of the worker indices.
+ *
+ * For Placement::NONE the result is empty. Otherwise, worker \c i is to be
+ * pinned to the CPU at index \c i modulo the size of the result.
+ *
+ * \param[in] placement Strategy to place the workers
+ * \param[in] nodes     CPUs of each NUMA node
+ *
+ * \return CPUs in the order they are assigned to workers
+ */
+std::vector<Cpu> cpu_order(const Placement placement, const Topology& nodes);
+
+
+/**
+ * \brief Pin the calling thread to a CPU.
+ *
+ * \param[in] cpu The CPU to run on
+ *
+ * \throws std::runtime_error If the thread cannot be pinned
+ */
+void pin_current_thread(const Cpu cpu);
+
+
+/**
+ * \brief Worker initialization that pins each worker to its CPU.
+ *
+ * \param[in] placement Strategy to place the workers
+ *
+ * \return Initialization for a pool, empty for Placement::NONE
+ */
+parallel::WorkerInit pinning(const Placement placement);
+
+} // namespace affinity
+} // namespace v_1_0_0
+} // namespace arcsapp
+
+#endif
+
@@ -0,0 +1,665 @@
+/**
+ * \file tools-arcs.cpp Calculation of AccurateRip checksums on sample ranges
+ */
+
+#ifndef __ARCSTOOLS_TOOLS_ARCS_HPP__
+#include "tools-arcs.hpp"
+#endif
+
+#include <algorithm>   // for fill_n, find, max, min
+#include <cstddef>     // for ptrdiff_t, size_t
+#include <cstdint>     // for int64_t, uint32_t, uint64_t
+#include <iterator>    // for next
+#include <limits>      // for numeric_limits
+#include <optional>    // for optional, nullopt
+#include <stdexcept>   // for invalid_argument, runtime_error
+#include <string>      // for to_string
+#include <tuple>       // for tuple
+#include <vector>      // for vector
+
+#ifndef __LIBARCSTK_LOGGING_HPP__
+#include <arcstk/logging.hpp>
+#endif
+
+#ifndef __ARCSTOOLS_TOOLS_PARALLEL_HPP__
+#include "tools-parallel.hpp"   // for TaskPool
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+namespace arcs
+{
+
+namespace
+{
+
+/**
+ * \brief Number of samples to read at once.
+ */
+constexpr std::size_t READ_CHUNK_SAMPLES = 65536;
+
+/**
+ * \brief Minimal number of samples in a range (10 seconds of audio).
+ */
+constexpr std::size_t MIN_RANGE_SAMPLES = 441000;
+
+
+/**
+ * \brief A part of a track to be processed as a single task.
+ */
+struct Part final
+{
+	/**
+	 * \brief Index of the track in the list of tracks.
+	 */
+	std::size_t track;
+
+	/**
+	 * \brief Index of the first sample within the audio file.
+	 */
+	std::size_t first;
+
+	/**
+	 * \brief Number of samples.
+	 */
+	std::size_t length;
+
+	/**
+	 * \brief Multiplier of the first sample.
+	 */
+	std::size_t multiplier;
+};
+
+
+/**
+ * \brief Split the tracks in parts of roughly equal size.
+ *
+ * \param[in] tracks  Tracks to split
+ * \param[in] workers Number of threads to feed
+ *
+ * \return Parts of the tracks
+ */
+std::vector<Part> split_tracks(const std::vector<TrackRange>& tracks,
+		const std::size_t workers)
+{
+	auto total = std::size_t { 0 };
+	for (const auto& t : tracks)
+	{
+		total += t.length;
+	}
+
+	// Create some more parts than workers to balance the load
+
+	const auto max_length = workers < 2
+		? total
+		: std::max(MIN_RANGE_SAMPLES, total / (workers * 4) + 1);
+
+	auto parts = std::vector<Part> {};
+
+	for (std::size_t i = 0; i < tracks.size(); ++i)
+	{
+		auto offset = std::size_t { 0 };
+
+		do
+		{
+			const auto length =
+				std::min(max_length, tracks[i].length - offset);
+
+			parts.push_back({ i, tracks[i].first + offset, length, offset + 1 });
+			offset += length;
+
+		} while (offset < tracks[i].length);
+	}
+
+	return parts;
+}
+
+
+/**
+ * \brief Read samples from an index that may be outside the audio file.
+ *
+ * Samples before the start or after the end of the audio file are zero.
+ *
+ * \param[in] reader Reader on the audio file
+ * \param[in] first  Index of the first sample, may be negative
+ * \param[in] count  Number of samples
+ * \param[in] buffer Buffer for at least \c count samples
+ *
+ * \throws std::runtime_error If reading fails
+ */
+void read_padded(SampleReader& reader, const std::int64_t first,
+		const std::size_t count, Sample* buffer)
+{
+	std::fill_n(buffer, count, 0);
+
+	const auto total { static_cast<std::int64_t>(reader.total_samples()) };
+	const auto begin { std::max(first, std::int64_t { 0 }) };
+	const auto end   {
+		std::min(first + static_cast<std::int64_t>(count), total) };
+
+	if (begin >= end)
+	{
+		return;
+	}
+
+	const auto wanted { static_cast<std::size_t>(end - begin) };
+
+	if (reader.read(static_cast<std::size_t>(begin), wanted,
+				buffer + (begin - first)) < wanted)
+	{
+		throw std::runtime_error("Audio data ends before sample "
+				+ std::to_string(end));
+	}
+}
+
+/**
+ * \brief Calculate the ARCSs of the tracks of sequentially read samples.
+ *
+ * Implements calculate_stream() for any source of samples.
+ *
+ * \tparam Read Function that reads the next samples to a buffer
+ */
+template <typename Read>
+std::tuple<std::vector<ARCSAccumulator>, std::size_t> calculate_sequential(
+		const Read& read, const std::vector<std::size_t>& offsets,
+		const bool is_first, const bool is_last,
+		std::vector<digest::Digests>* digests, digest::Digests* file_digests,
+		const kernel::Engine engine)
+{
+	if (offsets.empty())
+	{
+		throw std::invalid_argument("No tracks specified");
+	}
+
+	const auto unlimited = std::numeric_limits<std::size_t>::max();
+
+	auto sums = std::vector<ARCSAccumulator> {};
+
+	for (std::size_t t = 0; t < offsets.size(); ++t)
+	{
+		if (t > 0 && offsets[t] < offsets[t - 1])
+		{
+			throw std::invalid_argument("Track offsets are not ascending");
+		}
+
+		const auto check_from { 0 == t && is_first ? SKIP_FRONT + 1 : 1 };
+		const auto check_to   { t + 1 < offsets.size()
+			? offsets[t + 1] - offsets[t] : unlimited };
+
+		sums.emplace_back(1, check_from, check_to, engine);
+	}
+
+	// Samples of the last track that may be among its last SKIP_BACK samples
+	auto delayed = std::vector<Sample> {};
+
+	auto buffer = std::vector<Sample>(READ_CHUNK_SAMPLES);
+	auto position = std::size_t { 0 };
+	auto track    = std::size_t { 0 };
+
+	for (auto n = read(buffer.size(), buffer.data()); n > 0;
+			n = read(buffer.size(), buffer.data()))
+	{
+		if (file_digests)
+		{
+			file_digests->update(buffer.data(), n);
+		}
+
+		auto done = std::size_t { 0 };
+
+		while (done < n)
+		{
+			// Skip tracks that end before the current position
+			while (track + 1 < offsets.size() && offsets[track + 1] <= position)
+			{
+				++track;
+			}
+
+			const auto end { track + 1 < offsets.size()
+				? std::min(n, done + (offsets[track + 1] - position))
+				: n };
+
+			const auto count { end - done };
+
+			if (position < offsets.front())
+			{
+				// Before the first track
+				const auto skip { std::min(count, offsets.front() - position) };
+
+				done     += skip;
+				position += skip;
+				continue;
+			}
+
+			// Digests cover all samples of the track without delay
+
+			if (digests)
+			{
+				digests->at(track).update(buffer.data() + done, count);
+			}
+
+			if (track + 1 == offsets.size() && is_last)
+			{
+				delayed.insert(delayed.end(), buffer.data() + done,
+						buffer.data() + end);
+
+				if (delayed.size() > SKIP_BACK)
+				{
+					const auto ready { delayed.size() - SKIP_BACK };
+
+					sums[track].update(delayed.data(), ready);
+					delayed.erase(delayed.begin(), std::next(delayed.begin(),
+								static_cast<std::ptrdiff_t>(ready)));
+				}
+			} else
+			{
+				sums[track].update(buffer.data() + done, count);
+			}
+
+			done     += count;
+			position += count;
+		}
+	}
+
+	if (position < offsets.back())
+	{
+		throw std::runtime_error("Audio data ends before sample "
+				+ std::to_string(offsets.back()));
+	}
+
+	return { sums, position };
+}
+
+} // namespace
+
+
+// ARCSAccumulator
+
+
+ARCSAccumulator::ARCSAccumulator(const std::size_t multiplier,
+		const std::size_t check_from, const std::size_t check_to,
+		const kernel::Engine engine)
+	: multiplier_ { multiplier }
+	, check_from_ { check_from }
+	, check_to_   { check_to }
+	, sum_lo_     { 0 }
+	, sum_hi_     { 0 }
+	, kernel_     { kernel::select(engine) }
+{
+	// empty
+}
+
+
+void ARCSAccumulator::update(const Sample* samples, const std::size_t count)
+{
+	// Restrict the loop to the samples with a multiplier to count
+
+	const auto first = multiplier_ < check_from_
+		? std::min(check_from_ - multiplier_, count)
+		: std::size_t { 0 };
+
+	const auto last = multiplier_ <= check_to_
+		? std::min(check_to_ - multiplier_ + 1, count)
+		: std::size_t { 0 };
+
+	if (first < last)
+	{
+		kernel_(samples + first, last - first, multiplier_ + first,
+				&sum_lo_, &sum_hi_);
+	}
+
+	multiplier_ += count;
+}
+
+
+void ARCSAccumulator::merge(const ARCSAccumulator& other)
+{
+	sum_lo_ += other.sum_lo_;
+	sum_hi_ += other.sum_hi_;
+}
+
+
+std::size_t ARCSAccumulator::multiplier() const
+{
+	return multiplier_;
+}
+
+
+std::uint32_t ARCSAccumulator::arcs1() const
+{
+	return sum_lo_;
+}
+
+
+std::uint32_t ARCSAccumulator::arcs2() const
+{
+	return sum_lo_ + sum_hi_;
+}
+
+
+// track_ranges
+
+
+std::vector<TrackRange> track_ranges(const std::vector<std::size_t>& offsets,
+		const std::size_t total_samples)
+{
+	auto ranges = std::vector<TrackRange> {};
+
+	if (offsets.empty())
+	{
+		return ranges;
+	}
+
+	ranges.reserve(offsets.size());
+
+	for (std::size_t i = 0; i < offsets.size(); ++i)
+	{
+		const auto next = i + 1 < offsets.size() ? offsets[i + 1] : total_samples;
+
+		if (next <= offsets[i])
+		{
+			throw std::invalid_argument("Track " + std::to_string(i + 1)
+					+ " does not end after its start");
+		}
+
+		const auto length = next - offsets[i];
+
+		ranges.push_back({ offsets[i], length, 1, length });
+	}
+
+	ranges.front().check_from = SKIP_FRONT + 1;
+	ranges.back().check_to =
+		ranges.back().length > SKIP_BACK ? ranges.back().length - SKIP_BACK : 0;
+
+	return ranges;
+}
+
+
+// accumulate
+
+
+void accumulate(SampleReader& reader, const std::size_t first,
+		const std::size_t length, ARCSAccumulator& sums,
+		digest::Digests* digests)
+{
+	auto buffer = std::vector<Sample>(std::min(READ_CHUNK_SAMPLES, length));
+	auto done = std::size_t { 0 };
+
+	while (done < length)
+	{
+		const auto wanted = std::min(buffer.size(), length - done);
+		const auto read = reader.read(first + done, wanted, buffer.data());
+
+		if (read < wanted)
+		{
+			throw std::runtime_error("Audio data ends before sample "
+					+ std::to_string(first + length));
+		}
+
+		sums.update(buffer.data(), read);
+
+		if (digests)
+		{
+			digests->update(buffer.data(), read);
+		}
+
+		done += read;
+	}
+}
+
+
+// calculate_tracks
+
+
+std::vector<ARCSAccumulator> calculate_tracks(const SampleReaderFactory& open,
+		const std::vector<TrackRange>& tracks, const std::size_t workers,
+		std::vector<digest::Digests>* digests,
+		const parallel::WorkerInit& init, const kernel::Engine engine)
+{
+	// Digests require each track to be processed as a whole
+	const auto parts { split_tracks(tracks, digests ? 1 : workers) };
+
+	ARCS_LOG_DEBUG << "Calculate " << tracks.size() << " tracks in "
+		<< parts.size() << " ranges with " << workers << " threads";
+
+	auto part_sums = std::vector<ARCSAccumulator> {};
+	part_sums.reserve(parts.size());
+
+	for (const auto& p : parts)
+	{
+		part_sums.emplace_back(p.multiplier,
+				tracks[p.track].check_from, tracks[p.track].check_to, engine);
+	}
+
+	{
+		parallel::TaskPool pool { std::min(workers, parts.size()), init };
+
+		for (std::size_t i = 0; i < parts.size(); ++i)
+		{
+			pool.submit([&open,&parts,&part_sums,digests,i]
+				{
+					auto reader { open() };
+
+					accumulate(*reader, parts[i].first, parts[i].length,
+							part_sums[i],
+							digests ? &digests->at(parts[i].track) : nullptr);
+				});
+		}
+
+		pool.wait();
+	}
+
+	// Combine the parts of each track
+
+	auto sums = std::vector<ARCSAccumulator> {};
+	sums.reserve(tracks.size());
+
+	for (const auto& t : tracks)
+	{
+		sums.emplace_back(1, t.check_from, t.check_to);
+	}
+
+	for (std::size_t i = 0; i < parts.size(); ++i)
+	{
+		sums[parts[i].track].merge(part_sums[i]);
+	}
+
+	return sums;
+}
+
+
+// calculate_stream
+
+
+std::tuple<std::vector<ARCSAccumulator>, std::size_t> calculate_stream(
+		SampleStream& stream, const std::vector<std::size_t>& offsets,
+		const bool is_first, const bool is_last,
+		std::vector<digest::Digests>* digests, digest::Digests* file_digests,
+		const kernel::Engine engine)
+{
+	return calculate_sequential(
+			[&stream](const std::size_t count, Sample* buffer)
+			{
+				return stream.read(count, buffer);
+			},
+			offsets, is_first, is_last, digests, file_digests, engine);
+}
+
+
+std::tuple<std::vector<ARCSAccumulator>, std::size_t> calculate_stream(
+		SampleReader& reader, const std::vector<std::size_t>& offsets,
+		const bool is_first, const bool is_last,
+		std::vector<digest::Digests>* digests, digest::Digests* file_digests,
+		const kernel::Engine engine)
+{
+	auto position = std::size_t { 0 };
+
+	return calculate_sequential(
+			[&reader,&position](const std::size_t count, Sample* buffer)
+			{
+				const auto n { reader.read(position, count, buffer) };
+				position += n;
+				return n;
+			},
+			offsets, is_first, is_last, digests, file_digests, engine);
+}
+
+
+// shifted_arcs1
+
+
+std::vector<std::uint32_t> shifted_arcs1(SampleReader& reader,
+		const TrackRange& track, const std::size_t max_shift)
+{
+	auto sums = std::vector<std::uint32_t>(2 * max_shift + 1, 0);
+
+	if (track.check_from > track.check_to || track.check_from < 1)
+	{
+		return sums; // No samples to count
+	}
+
+	// Indices of the first and last sample to count, relative to the track
+	const auto a { track.check_from - 1 };
+	const auto b { track.check_to   - 1 };
+
+	// Index of the first sample of the track for the smallest shift
+	const auto start { static_cast<std::int64_t>(track.first)
+		- static_cast<std::int64_t>(max_shift) };
+
+	// Sums of the weighted and the plain samples for the smallest shift
+
+	auto weighted = std::uint32_t { 0 };
+	auto plain    = std::uint32_t { 0 };
+
+	auto buffer = std::vector<Sample>(std::min(READ_CHUNK_SAMPLES, b - a + 1));
+	auto m = static_cast<std::uint32_t>(a + 1);
+
+	for (auto i = a; i <= b;)
+	{
+		const auto count { std::min(buffer.size(), b + 1 - i) };
+
+		read_padded(reader, start + static_cast<std::int64_t>(i), count,
+				buffer.data());
+
+		for (std::size_t j = 0; j < count; ++j, ++m)
+		{
+			weighted += m * buffer[j];
+			plain    += buffer[j];
+		}
+
+		i += count;
+	}
+
+	sums[0] = weighted;
+
+	// For each further shift, the window loses the sample at index a and
+	// gains the sample at index b + 1, all other samples get their multiplier
+	// decreased by 1.
+
+	auto leaving  = std::vector<Sample>(2 * max_shift);
+	auto entering = std::vector<Sample>(2 * max_shift);
+
+	read_padded(reader, start + static_cast<std::int64_t>(a), leaving.size(),
+			leaving.data());
+	read_padded(reader, start + static_cast<std::int64_t>(b + 1),
+			entering.size(), entering.data());
+
+	const auto m_leaving  { static_cast<std::uint32_t>(a) };
+	const auto m_entering { static_cast<std::uint32_t>(b + 1) };
+
+	for (std::size_t k = 0; k < leaving.size(); ++k)
+	{
+		weighted += m_entering * entering[k] - m_leaving * leaving[k] - plain;
+		plain    += entering[k] - leaving[k];
+
+		sums[k + 1] = weighted;
+	}
+
+	return sums;
+}
+
+
+// calculate_shifted
+
+
+std::vector<std::vector<std::uint32_t>> calculate_shifted(
+		const SampleReaderFactory& open, const std::vector<TrackRange>& tracks,
+		const std::size_t max_shift, const std::size_t workers)
+{
+	ARCS_LOG_DEBUG << "Calculate " << tracks.size() << " tracks with shifts"
+		<< " up to " << max_shift << " samples with " << workers << " threads";
+
+	auto sums = std::vector<std::vector<std::uint32_t>>(tracks.size());
+
+	if (tracks.empty())
+	{
+		return sums;
+	}
+
+	{
+		parallel::TaskPool pool { std::min(workers, tracks.size()) };
+
+		for (std::size_t i = 0; i < tracks.size(); ++i)
+		{
+			pool.submit([&open,&tracks,&sums,max_shift,i]
+				{
+					auto reader { open() };
+
+					sums[i] = shifted_arcs1(*reader, tracks[i], max_shift);
+				});
+		}
+
+		pool.wait();
+	}
+
+	return sums;
+}
+
+
+// find_shift
+
+
+std::optional<long> find_shift(const std::vector<std::uint32_t>& sums,
+		const std::vector<std::uint32_t>& references)
+{
+	const auto matches = [&references](const std::uint32_t sum)
+	{
+		return std::find(references.begin(), references.end(), sum)
+			!= references.end();
+	};
+
+	if (sums.empty())
+	{
+		return std::nullopt;
+	}
+
+	// The sum of shift 0 is in the middle. It is at most half the size of a
+	// vector and thus each distance from the middle fits into a long.
+
+	const auto center { sums.size() / 2 };
+
+	// Search outwards from shift 0, negative shift first
+
+	for (auto d = std::size_t { 0 }; d <= center; ++d)
+	{
+		const auto shift { static_cast<long>(d) };
+
+		if (matches(sums[center - d]))
+		{
+			return -shift;
+		}
+
+		if (center + d < sums.size() && matches(sums[center + d]))
+		{
+			return shift;
+		}
+	}
+
+	return std::nullopt;
+}
+
+} // namespace arcs
+} // namespace v_1_0_0
+} // namespace arcsapp
+
@@ -0,0 +1,371 @@
+#ifndef __ARCSTOOLS_TOOLS_ARCS_HPP__
+#define __ARCSTOOLS_TOOLS_ARCS_HPP__
+
+/**
+ * \file
+ *
+ * \brief Calculation of AccurateRip checksums on arbitrary sample ranges.
+ */
+
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint32_t
+#include <functional>  // for function
+#include <memory>      // for unique_ptr
+#include <optional>    // for optional
+#include <tuple>       // for tuple
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_DIGEST_HPP__
+#include "tools-digest.hpp"   // for Digests
+#endif
+#ifndef __ARCSTOOLS_TOOLS_KERNEL_HPP__
+#include "tools-kernel.hpp"   // for Engine, Kernel
+#endif
+#ifndef __ARCSTOOLS_TOOLS_PARALLEL_HPP__
+#include "tools-parallel.hpp" // for WorkerInit
+#endif
+#ifndef __ARCSTOOLS_TOOLS_PCM_HPP__
+#include "tools-pcm.hpp"      // for Sample, SampleReader
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+
+/**
+ * \brief Calculation of ARCSs independent from libarcstk.
+ *
+ * ARCS is a position-weighted sum: each sample of a track is multiplied by its
+ * 1-based position within the track. Thus, any range of samples can be summed
+ * up on its own as long as the position of its first sample is known, and the
+ * sums of the ranges of a track add up to the ARCS of the track.
+ */
+namespace arcs
+{
+
+using pcm::Sample;
+using pcm::SampleReader;
+using pcm::SampleStream;
+
+/**
+ * \brief Number of samples skipped at the start of the first track.
+ */
+constexpr std::size_t SKIP_FRONT = 2939;
+
+/**
+ * \brief Number of samples skipped at the end of the last track.
+ */
+constexpr std::size_t SKIP_BACK = 2940;
+
+
+/**
+ * \brief Accumulates ARCSv1 and ARCSv2 for a contiguous range of samples.
+ *
+ * Only samples whose multiplier is within the closed interval
+ * [check_from, check_to] contribute to the sums. The sums are updated by the
+ * kernel of the engine passed on construction.
+ */
+class ARCSAccumulator final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] multiplier Multiplier for the first sample to be updated
+	 * \param[in] check_from Smallest multiplier to count
+	 * \param[in] check_to   Greatest multiplier to count
+	 * \param[in] engine     Engine to update the sums
+	 */
+	ARCSAccumulator(const std::size_t multiplier,
+			const std::size_t check_from, const std::size_t check_to,
+			const kernel::Engine engine = kernel::Engine::SCALAR);
+
+	/**
+	 * \brief Update with a sequence of samples.
+	 *
+	 * \param[in] samples Pointer to the first sample
+	 * \param[in] count   Number of samples
+	 */
+	void update(const Sample* samples, const std::size_t count);
+
+	/**
+	 * \brief Add the sums of another accumulator.
+	 *
+	 * \param[in] other Accumulator for another range of the same track
+	 */
+	void merge(const ARCSAccumulator& other);
+
+	/**
+	 * \brief Multiplier for the next sample.
+	 *
+	 * \return Multiplier for the next sample
+	 */
+	std::size_t multiplier() const;
+
+	/**
+	 * \brief ARCSv1 of the samples updated so far.
+	 *
+	 * \return ARCSv1 value
+	 */
+	std::uint32_t arcs1() const;
+
+	/**
+	 * \brief ARCSv2 of the samples updated so far.
+	 *
+	 * \return ARCSv2 value
+	 */
+	std::uint32_t arcs2() const;
+
+private:
+
+	/**
+	 * \brief Multiplier for the next sample.
+	 */
+	std::size_t multiplier_;
+
+	/**
+	 * \brief Smallest multiplier to count.
+	 */
+	std::size_t check_from_;
+
+	/**
+	 * \brief Greatest multiplier to count.
+	 */
+	std::size_t check_to_;
+
+	/**
+	 * \brief Sum of the lower 32 bits of the products.
+	 */
+	std::uint32_t sum_lo_;
+
+	/**
+	 * \brief Sum of the higher 32 bits of the products.
+	 */
+	std::uint32_t sum_hi_;
+
+	/**
+	 * \brief Kernel to update the sums.
+	 */
+	kernel::Kernel kernel_;
+};
+
+
+/**
+ * \brief The samples of a track and the interval of multipliers to count.
+ */
+struct TrackRange final
+{
+	/**
+	 * \brief Index of the first sample of the track within the audio file.
+	 */
+	std::size_t first;
+
+	/**
+	 * \brief Number of samples in the track.
+	 */
+	std::size_t length;
+
+	/**
+	 * \brief Smallest multiplier to count.
+	 */
+	std::size_t check_from;
+
+	/**
+	 * \brief Greatest multiplier to count.
+	 */
+	std::size_t check_to;
+};
+
+
+/**
+ * \brief Create the track ranges for an audio file containing all tracks.
+ *
+ * The offsets are sample indices within the audio file. The last track ends
+ * with the last sample of the audio file. Samples before the first offset do
+ * not belong to any track.
+ *
+ * \param[in] offsets       Sample index of the first sample of each track
+ * \param[in] total_samples Total number of samples in the audio file
+ *
+ * \return Range for each track
+ *
+ * \throws std::invalid_argument If offsets are not ascending or out of range
+ */
+std::vector<TrackRange> track_ranges(const std::vector<std::size_t>& offsets,
+		const std::size_t total_samples);
+
+
+/**
+ * \brief Update an accumulator with a range of samples read from an audio file.
+ *
+ * \param[in] reader  Reader on the audio file
+ * \param[in] first   Index of the first sample within the audio file
+ * \param[in] length  Number of samples
+ * \param[in] sums    Accumulator to update
+ * \param[in] digests Digests to update with the same samples or \c nullptr
+ *
+ * \throws std::runtime_error If reading fails or the audio is too short
+ */
+void accumulate(SampleReader& reader, const std::size_t first,
+		const std::size_t length, ARCSAccumulator& sums,
+		digest::Digests* digests = nullptr);
+
+
+/**
+ * \brief Creates a SampleReader on the audio file.
+ */
+using SampleReaderFactory = std::function<std::unique_ptr<SampleReader>()>;
+
+
+/**
+ * \brief Calculate the ARCSs of the specified tracks in the same audio file.
+ *
+ * The tracks are split in ranges that are read and summed up on
+ * \c workers threads concurrently, each range by its own SampleReader. The
+ * partial sums are combined per track, hence the result is identical to the
+ * result of a sequential calculation.
+ *
+ * If digests are passed, they are updated with all samples of the respective
+ * track. Since digests cannot be combined from parts, each track is then
+ * processed as a whole and only different tracks are processed concurrently.
+ *
+ * \param[in] open    Create a reader on the audio file
+ * \param[in] tracks  Ranges of the tracks to calculate
+ * \param[in] workers Number of threads to use
+ * \param[in] digests Digests for each track or \c nullptr
+ * \param[in] init    Initialization of each thread, e.g. to pin it
+ * \param[in] engine  Engine to update the sums
+ *
+ * \return Accumulated sums for each track, in the order of \c tracks
+ *
+ * \throws std::runtime_error If reading fails or the audio is too short
+ */
+std::vector<ARCSAccumulator> calculate_tracks(const SampleReaderFactory& open,
+		const std::vector<TrackRange>& tracks, const std::size_t workers,
+		std::vector<digest::Digests>* digests = nullptr,
+		const parallel::WorkerInit& init = parallel::WorkerInit {},
+		const kernel::Engine engine = kernel::Engine::SCALAR);
+
+
+/**
+ * \brief Calculate the ARCSs of the tracks of an audio stream in one pass.
+ *
+ * The offsets are sample indices within the stream, the last track ends with
+ * the end of the stream. Samples before the first offset do not belong to any
+ * track. Since the end of the stream is not known in advance, the samples of
+ * the last track are summed up with a delay of SKIP_BACK samples.
+ *
+ * \param[in] stream       The audio stream
+ * \param[in] offsets      Sample index of the first sample of each track
+ * \param[in] is_first     Treat the first track as first track of the album
+ * \param[in] is_last      Treat the last track as last track of the album
+ * \param[in] digests      Digests for each track or \c nullptr
+ * \param[in] file_digests Digests of all samples read or \c nullptr
+ * \param[in] engine       Engine to update the sums
+ *
+ * \return Accumulated sums for each track and the total number of samples
+ *
+ * \throws std::runtime_error If reading fails or the stream ends before the
+ * last offset
+ */
+std::tuple<std::vector<ARCSAccumulator>, std::size_t> calculate_stream(
+		SampleStream& stream, const std::vector<std::size_t>& offsets,
+		const bool is_first, const bool is_last,
+		std::vector<digest::Digests>* digests = nullptr,
+		digest::Digests* file_digests = nullptr,
+		const kernel::Engine engine = kernel::Engine::SCALAR);
+
+
+/**
+ * \brief Calculate the ARCSs of the tracks of an audio file in one pass.
+ *
+ * Reads the audio file sequentially from its first to its last sample, which
+ * allows to update digests of the entire file along with the ARCSs.
+ *
+ * \param[in] reader       Reader on the audio file
+ * \param[in] offsets      Sample index of the first sample of each track
+ * \param[in] is_first     Treat the first track as first track of the album
+ * \param[in] is_last      Treat the last track as last track of the album
+ * \param[in] digests      Digests for each track or \c nullptr
+ * \param[in] file_digests Digests of all samples of the file or \c nullptr
+ * \param[in] engine       Engine to update the sums
+ *
+ * \return Accumulated sums for each track and the total number of samples
+ *
+ * \throws std::runtime_error If reading fails or the audio file ends before
+ * the last offset
+ */
+std::tuple<std::vector<ARCSAccumulator>, std::size_t> calculate_stream(
+		SampleReader& reader, const std::vector<std::size_t>& offsets,
+		const bool is_first, const bool is_last,
+		std::vector<digest::Digests>* digests = nullptr,
+		digest::Digests* file_digests = nullptr,
+		const kernel::Engine engine = kernel::Engine::SCALAR);
+
+
+/**
+ * \brief Calculate the ARCSv1 of a track for each shift within a window.
+ *
+ * For shift \c s, the samples of the track are taken from the audio file
+ * starting \c s samples after the first sample of the track. Samples before
+ * the start or after the end of the audio file are considered silence.
+ *
+ * After the sums for the smallest shift are calculated in one pass over the
+ * track, the sum for each following shift is derived from the sum for the
+ * previous shift by updating it with the sample leaving and the sample entering
+ * the window. Thus, the cost for each shift is constant.
+ *
+ * ARCSv2 cannot be updated this way since the sum of the higher 32 bits of the
+ * products does not depend linearly on the samples.
+ *
+ * \param[in] reader    Reader on the audio file
+ * \param[in] track     Range of the track
+ * \param[in] max_shift Greatest absolute shift
+ *
+ * \return ARCSv1 for each shift from -max_shift to +max_shift
+ *
+ * \throws std::runtime_error If reading fails
+ */
+std::vector<std::uint32_t> shifted_arcs1(SampleReader& reader,
+		const TrackRange& track, const std::size_t max_shift);
+
+
+/**
+ * \brief Calculate the shifted ARCSv1 of the specified tracks.
+ *
+ * The tracks are processed on \c workers threads concurrently, each track by
+ * its own SampleReader.
+ *
+ * \param[in] open      Create a reader on the audio file
+ * \param[in] tracks    Ranges of the tracks to calculate
+ * \param[in] max_shift Greatest absolute shift
+ * \param[in] workers   Number of threads to use
+ *
+ * \return Result of shifted_arcs1() for each track, in the order of \c tracks
+ *
+ * \throws std::runtime_error If reading fails
+ */
+std::vector<std::vector<std::uint32_t>> calculate_shifted(
+		const SampleReaderFactory& open, const std::vector<TrackRange>& tracks,
+		const std::size_t max_shift, const std::size_t workers);
+
+
+/**
+ * \brief Find the smallest shift at which a track matches a reference.
+ *
+ * \param[in] sums       Result of shifted_arcs1() for the track
+ * \param[in] references Reference values for the track
+ *
+ * \return Shift with the smallest absolute value that matches, if any
+ */
+std::optional<long> find_shift(const std::vector<std::uint32_t>& sums,
+		const std::vector<std::uint32_t>& references);
+
+} // namespace arcs
+} // namespace v_1_0_0
+} // namespace arcsapp
+
+#endif
+
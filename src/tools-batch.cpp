@@ -0,0 +1,174 @@
+/**
+ * \file tools-batch.cpp Processing multiple albums in a single run
+ */
+
+#ifndef __ARCSTOOLS_TOOLS_BATCH_HPP__
+#include "tools-batch.hpp"
+#endif
+
+#include <algorithm>   // for transform
+#include <cctype>      // for tolower
+#include <cstddef>     // for size_t
+#include <filesystem>  // for path, directory_iterator, is_directory
+#include <fstream>     // for ifstream
+#include <functional>  // for function
+#include <sstream>     // for ostringstream
+#include <stdexcept>   // for runtime_error
+#include <string>      // for string, getline
+#include <system_error> // for error_code
+#include <vector>      // for vector
+
+#ifndef __LIBARCSTK_LOGGING_HPP__
+#include <arcstk/logging.hpp>
+#endif
+
+#ifndef __ARCSTOOLS_TOOLS_PARALLEL_HPP__
+#include "tools-parallel.hpp" // for TaskPool
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+namespace batch
+{
+
+
+std::vector<Album> read_manifest(std::istream& in)
+{
+	auto albums  = std::vector<Album> {};
+	auto line    = std::string {};
+	auto line_no = std::size_t { 0 };
+
+	while (std::getline(in, line))
+	{
+		++line_no;
+
+		if (!line.empty() && '\r' == line.back())
+		{
+			line.pop_back();
+		}
+
+		if (line.empty() || '#' == line.front())
+		{
+			continue;
+		}
+
+		auto fields = std::vector<std::string> {};
+		auto start  = std::size_t { 0 };
+		auto tab    = line.find('\t');
+
+		while (tab != std::string::npos)
+		{
+			fields.push_back(line.substr(start, tab - start));
+			start = tab + 1;
+			tab   = line.find('\t', start);
+		}
+		fields.push_back(line.substr(start));
+
+		if (fields.front().empty())
+		{
+			std::ostringstream msg;
+			msg << "Manifest line " << line_no << " does not start with a "
+				<< "metafile";
+
+			throw std::runtime_error(msg.str());
+		}
+
+		auto album = Album { fields.front(), {} };
+
+		for (auto f = fields.begin() + 1; f != fields.end(); ++f)
+		{
+			if (!f->empty())
+			{
+				album.audiofiles.push_back(*f);
+			}
+		}
+
+		albums.push_back(album);
+	}
+
+	ARCS_LOG_DEBUG << "Read " << albums.size() << " albums from manifest";
+
+	return albums;
+}
+
+
+std::vector<Album> read_manifest(const std::string& filename)
+{
+	auto in = std::ifstream { filename };
+
+	if (!in)
+	{
+		throw std::runtime_error("Could not read manifest file: " + filename);
+	}
+
+	return read_manifest(in);
+}
+
+
+bool is_metafile(const std::string& filename)
+{
+	auto suffix { std::filesystem::path { filename }.extension().string() };
+
+	std::transform(suffix.begin(), suffix.end(), suffix.begin(),
+			[](unsigned char c) { return std::tolower(c); });
+
+	return ".cue" == suffix;
+}
+
+
+void find_albums(const std::string& root, const std::size_t workers,
+		const std::function<void(Album&&)>& found)
+{
+	namespace fs = std::filesystem;
+
+	auto error = std::error_code {};
+
+	if (!fs::is_directory(root, error))
+	{
+		throw std::runtime_error("Not a directory: " + root);
+	}
+
+	parallel::TaskPool pool { workers };
+
+	// Each directory is a task, its subdirectories are queued as new tasks
+
+	auto walk = std::function<void(const fs::path&)> {};
+
+	walk = [&pool,&walk,&found](const fs::path& dir)
+	{
+		auto ec = std::error_code {};
+		auto entry = fs::directory_iterator { dir,
+			fs::directory_options::skip_permission_denied, ec };
+
+		for (; !ec && entry != fs::directory_iterator {}; entry.increment(ec))
+		{
+			auto type_ec = std::error_code {};
+
+			if (entry->is_directory(type_ec) && !entry->is_symlink(type_ec))
+			{
+				pool.submit([&walk,subdir = entry->path()]{ walk(subdir); });
+
+			} else if (entry->is_regular_file(type_ec)
+					&& is_metafile(entry->path().string()))
+			{
+				found(Album { entry->path().generic_string(), {} });
+			}
+		}
+
+		if (ec)
+		{
+			ARCS_LOG_WARNING << "Skip unreadable directory " << dir.string()
+				<< ": " << ec.message();
+		}
+	};
+
+	pool.submit([&walk,&root]{ walk(fs::path { root }); });
+	pool.wait();
+}
+
+} // namespace batch
+} // namespace v_1_0_0
+} // namespace arcsapp
+
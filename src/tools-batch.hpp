@@ -0,0 +1,119 @@
+#ifndef __ARCSTOOLS_TOOLS_BATCH_HPP__
+#define __ARCSTOOLS_TOOLS_BATCH_HPP__
+
+/**
+ * \file
+ *
+ * \brief Helper tools for processing multiple albums in a single run.
+ */
+
+#include <cstddef>     // for size_t
+#include <functional>  // for function
+#include <istream>     // for istream
+#include <string>      // for string
+#include <vector>      // for vector
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+
+/**
+ * \brief Tools and helpers for batch processing.
+ */
+namespace batch
+{
+
+/**
+ * \brief An album to process: a metafile and optionally its audio files.
+ */
+struct Album final
+{
+	/**
+	 * \brief Name of the metafile.
+	 */
+	std::string metafile;
+
+	/**
+	 * \brief Names of the audio files, overriding the files in the metafile.
+	 */
+	std::vector<std::string> audiofiles;
+};
+
+
+/**
+ * \brief Read a manifest of albums.
+ *
+ * A manifest contains one album per line. A line consists of the name of the
+ * metafile, optionally followed by the names of the audio files. The names are
+ * separated by TAB characters. Empty lines and lines starting with '#' are
+ * ignored.
+ *
+ * \param[in] in Stream to read the manifest from
+ *
+ * \return List of albums in the order of the manifest
+ *
+ * \throws std::runtime_error If a line does not start with a metafile
+ */
+std::vector<Album> read_manifest(std::istream& in);
+
+/**
+ * \brief Read a manifest of albums from a file.
+ *
+ * \param[in] filename Name of the manifest file
+ *
+ * \return List of albums in the order of the manifest
+ *
+ * \throws std::runtime_error If the file cannot be read or is malformed
+ *
+ * \see read_manifest(std::istream&)
+ */
+std::vector<Album> read_manifest(const std::string& filename);
+
+/**
+ * \brief TRUE iff the file is a metafile to be processed as an album.
+ *
+ * Metafiles are recognized by the suffix ".cue" in any case.
+ *
+ * \param[in] filename Name of the file
+ *
+ * \return TRUE iff the file is a metafile
+ */
+bool is_metafile(const std::string& filename);
+
+/**
+ * \brief Find the albums in a directory tree.
+ *
+ * Walks the tree below \c root concurrently on \c workers threads, each
+ * directory is listed by a single thread. Every metafile is reported as an
+ * Album without audio files, thus the audio files are taken from the metafile
+ * when the album is processed.
+ *
+ * Each album is passed to \c found as soon as it is found while the walk is
+ * still going on. Since \c found is called concurrently by the threads of the
+ * walk, it is required to be thread-safe.
+ *
+ * Symbolic links to directories are not followed. Directories that cannot be
+ * read are skipped.
+ *
+ * The albums name no audio files. Since \c found is called on the threads of
+ * the walk, consumers that need the audio files take them from the metafile
+ * in \c found, e.g. by calc::ChecksumCalculator::audiofiles(), and thus
+ * parse each metafile concurrently and only once.
+ *
+ * \param[in] root    Root directory of the tree
+ * \param[in] workers Number of threads to walk the tree
+ * \param[in] found   Callback for each album found
+ *
+ * \throws std::runtime_error If \c root is not a directory
+ * \throws Any exception thrown by \c found
+ */
+void find_albums(const std::string& root, const std::size_t workers,
+		const std::function<void(Album&&)>& found);
+
+} // namespace batch
+} // namespace v_1_0_0
+} // namespace arcsapp
+
+#endif
+
@@ -0,0 +1,794 @@
+/**
+ * \file tools-cache.cpp Persistent on-disk cache for checksums
+ */
+
+#ifndef __ARCSTOOLS_TOOLS_CACHE_HPP__
+#include "tools-cache.hpp"
+#endif
+
+#include <algorithm>   // for max, nth_element
+#include <chrono>      // for system_clock, duration_cast, seconds
+#include <cerrno>      // for errno, EINTR
+#include <cstdio>      // for rename
+#include <cstring>     // for memcmp, memcpy, memset, strerror
+#include <filesystem>  // for create_directories, path
+#include <iterator>    // for next
+#include <fstream>     // for ifstream
+#include <stdexcept>   // for runtime_error
+#include <string>      // for string
+#include <system_error> // for error_code
+#include <vector>      // for vector
+
+#include <fcntl.h>     // for open, O_RDWR, O_CREAT, O_TRUNC
+#include <sys/file.h>  // for flock, LOCK_SH, LOCK_EX, LOCK_UN
+#include <sys/mman.h>  // for mmap, munmap, MAP_SHARED, MAP_FAILED
+#include <sys/stat.h>  // for stat, fstat
+#include <unistd.h>    // for close, ftruncate
+
+#ifndef __LIBARCSTK_LOGGING_HPP__
+#include <arcstk/logging.hpp>
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+namespace cache
+{
+
+namespace
+{
+
+/**
+ * \brief Magic bytes at the start of the cache file.
+ */
+constexpr char MAGIC[8] = { 'A', 'R', 'C', 'S', 'C', 'S', 'U', 'M' };
+
+/**
+ * \brief Version of the cache file layout.
+ */
+constexpr std::uint32_t VERSION = 1;
+
+/**
+ * \brief Number of slots of a new cache file.
+ */
+constexpr std::size_t INITIAL_CAPACITY = 1u << 12;
+
+/**
+ * \brief Name of the cache file in the cache directory.
+ */
+const std::string INDEX_FILE { "checksums.idx" };
+
+/**
+ * \brief Name of the lock file in the cache directory.
+ */
+const std::string LOCK_FILE { "checksums.lock" };
+
+/**
+ * \brief State of an empty slot.
+ */
+constexpr std::uint8_t SLOT_EMPTY = 0;
+
+/**
+ * \brief State of a slot holding an entry.
+ */
+constexpr std::uint8_t SLOT_USED = 1;
+
+
+/**
+ * \brief Build an error message containing the current errno.
+ */
+std::string system_error_message(const std::string& msg,
+		const std::string& filename)
+{
+	return msg + " " + filename + ": " + std::strerror(errno);
+}
+
+
+/**
+ * \brief Current time in seconds.
+ */
+std::uint32_t now()
+{
+	using std::chrono::duration_cast;
+	using std::chrono::seconds;
+	using std::chrono::system_clock;
+
+	return static_cast<std::uint32_t>(
+			duration_cast<seconds>(system_clock::now().time_since_epoch())
+			.count());
+}
+
+
+/**
+ * \brief Finalizer of splitmix64.
+ */
+std::uint64_t mix(std::uint64_t x)
+{
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9u;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebu;
+	x ^= x >> 31;
+	return x;
+}
+
+
+/**
+ * \brief Number of bytes at the start of a file to fingerprint.
+ */
+constexpr std::size_t HEADER_BYTES = 65536;
+
+/**
+ * \brief Number of blocks sampled from a file to fingerprint.
+ */
+constexpr std::size_t SAMPLED_BLOCKS = 16;
+
+/**
+ * \brief Size of a sampled block in bytes.
+ */
+constexpr std::size_t BLOCK_BYTES = 4096;
+
+
+/**
+ * \brief Smallest power of 2 not less than \c n.
+ */
+std::size_t power_of_2(const std::size_t n)
+{
+	auto p = std::size_t { 1 };
+
+	while (p < n)
+	{
+		p <<= 1;
+	}
+
+	return p;
+}
+
+} // namespace
+
+
+// file_identity
+
+
+FileIdentity file_identity(const std::string& filename)
+{
+	struct stat info;
+
+	if (::stat(filename.c_str(), &info) != 0)
+	{
+		throw std::runtime_error(
+				system_error_message("Could not access file", filename));
+	}
+
+	// The size is a signed off_t, the other fields convert implicitly
+
+	const std::uint64_t device = info.st_dev;
+	const std::uint64_t inode  = info.st_ino;
+	const std::int64_t seconds = info.st_mtim.tv_sec;
+
+	return {
+		device,
+		inode,
+		static_cast<std::uint64_t>(info.st_size),
+		seconds * 1000000000 + info.st_mtim.tv_nsec
+	};
+}
+
+
+// content_identity
+
+
+FileIdentity content_identity(const std::string& filename,
+		const std::uint64_t total_samples)
+{
+	std::ifstream in { filename, std::ios::binary | std::ios::ate };
+
+	if (!in)
+	{
+		throw std::runtime_error("Could not open file: " + filename);
+	}
+
+	const auto size { static_cast<std::uint64_t>(in.tellg()) };
+
+	// Two independent 64 bit hashes: FNV-1a and a multiplicative one
+
+	auto h1 = std::uint64_t { 0xcbf29ce484222325u };
+	auto h2 = mix(size ^ total_samples);
+
+	auto buffer = std::vector<char>(HEADER_BYTES);
+
+	const auto update = [&](const std::uint64_t pos, const std::size_t len)
+	{
+		in.seekg(static_cast<std::streamoff>(pos));
+		in.read(buffer.data(), static_cast<std::streamsize>(len));
+
+		if (in.gcount() != static_cast<std::streamsize>(len))
+		{
+			throw std::runtime_error("Could not read file: " + filename);
+		}
+
+		for (std::size_t i = 0; i < len; ++i)
+		{
+			const auto byte { static_cast<unsigned char>(buffer[i]) };
+
+			h1 = (h1 ^ byte) * 0x100000001b3u;
+			h2 = (h2 + byte) * 0x9e3779b97f4a7c15u;
+			h2 ^= h2 >> 29;
+		}
+	};
+
+	// Container header
+
+	update(0, static_cast<std::size_t>(std::min<std::uint64_t>(size,
+					HEADER_BYTES)));
+
+	// Blocks evenly spaced from the end of the header to the end of the file
+
+	if (size > HEADER_BYTES + BLOCK_BYTES)
+	{
+		const auto span { size - HEADER_BYTES - BLOCK_BYTES };
+
+		for (std::size_t i = 1; i <= SAMPLED_BLOCKS; ++i)
+		{
+			update(HEADER_BYTES + span * i / SAMPLED_BLOCKS, BLOCK_BYTES);
+		}
+	}
+
+	return { mix(h1), mix(h2), size, static_cast<std::int64_t>(total_samples) };
+}
+
+
+// ChecksumCache::Header
+
+
+struct ChecksumCache::Header final
+{
+	char          magic[8];
+	std::uint32_t version;
+	std::uint32_t record_size;
+	std::uint64_t capacity;
+	std::uint64_t count;
+	std::uint32_t obsolete;
+	std::uint8_t  reserved[28];
+};
+
+
+// ChecksumCache::Record
+
+
+struct ChecksumCache::Record final
+{
+	// Identity
+
+	std::uint64_t device;
+	std::uint64_t inode;
+	std::uint64_t size;
+	std::int64_t  mtime;
+	std::uint64_t toc;
+
+	// Value
+
+	std::uint32_t length;
+	std::uint32_t arcs1;
+	std::uint32_t arcs2;
+	std::uint32_t last_used;
+
+	// Identity
+
+	std::uint8_t  track;
+	std::uint8_t  key_types;
+	std::uint8_t  flags;
+
+	// Value
+
+	std::uint8_t  value_types;
+	std::uint8_t  state;
+	std::uint8_t  reserved[3];
+
+	/**
+	 * \brief Hash of the fields that identify the slot.
+	 *
+	 * Size and modification time are not part of the hash, hence an entry for
+	 * an outdated version of a file occupies the slot for the current version.
+	 */
+	std::uint64_t hash() const
+	{
+		auto h = mix(device ^ 0x9e3779b97f4a7c15u);
+		h = mix(h ^ inode);
+		h = mix(h ^ toc);
+		return mix(h ^ (std::uint64_t { track } << 16
+					| std::uint64_t { key_types } << 8 | flags));
+	}
+
+	/**
+	 * \brief TRUE iff this record occupies the same slot as \c rhs.
+	 */
+	bool same_slot(const Record& rhs) const
+	{
+		return device == rhs.device && inode == rhs.inode && toc == rhs.toc
+			&& track == rhs.track && key_types == rhs.key_types
+			&& flags == rhs.flags;
+	}
+
+	/**
+	 * \brief TRUE iff this record refers to the same version of the file.
+	 */
+	bool same_file(const Record& rhs) const
+	{
+		return same_slot(rhs) && size == rhs.size && mtime == rhs.mtime;
+	}
+};
+
+
+namespace
+{
+
+/**
+ * \brief Create a record from a key.
+ */
+template <typename R>
+R to_record(const CacheKey& key)
+{
+	R r;
+	std::memset(&r, 0, sizeof(r));
+
+	r.device    = key.file.device;
+	r.inode     = key.file.inode;
+	r.size      = key.file.size;
+	r.mtime     = key.file.mtime;
+	r.toc       = key.toc;
+	r.track     = key.track;
+	r.key_types = key.types;
+	r.flags     = key.flags;
+
+	return r;
+}
+
+
+/**
+ * \brief Slot for \c key in \c records, either matching or empty.
+ *
+ * The table is required to contain at least one empty slot.
+ */
+template <typename R>
+R* probe(R* records, const std::size_t capacity, const R& key)
+{
+	const auto mask = capacity - 1;
+
+	for (auto i = key.hash() & mask; ; i = (i + 1) & mask)
+	{
+		if (records[i].state == SLOT_EMPTY || records[i].same_slot(key))
+		{
+			return records + i;
+		}
+	}
+}
+
+} // namespace
+
+
+// ChecksumCache::FileLock
+
+
+class ChecksumCache::FileLock final
+{
+public:
+
+	FileLock(const int fd, const int operation)
+		: fd_ { fd }
+	{
+		while (::flock(fd_, operation) != 0)
+		{
+			if (errno != EINTR)
+			{
+				throw std::runtime_error(std::string { "Could not lock cache: " }
+						+ std::strerror(errno));
+			}
+		}
+	}
+
+	FileLock(const FileLock&) = delete;
+	FileLock& operator=(const FileLock&) = delete;
+
+	~FileLock() noexcept
+	{
+		::flock(fd_, LOCK_UN);
+	}
+
+private:
+
+	int fd_;
+};
+
+
+// ChecksumCache
+
+
+ChecksumCache::ChecksumCache(const std::string& directory,
+		const std::size_t max_entries)
+	: directory_   { directory }
+	, max_entries_ { std::max(max_entries, std::size_t { 2 }) }
+	, lock_fd_     { -1 }
+	, map_         { nullptr }
+	, map_size_    { 0 }
+	, key_mode_    { KeyMode::IDENTITY }
+	, hits_        { 0 }
+	, misses_      { 0 }
+	, mutex_       { /* default */ }
+{
+	auto error = std::error_code {};
+	std::filesystem::create_directories(directory_, error);
+
+	if (error)
+	{
+		throw std::runtime_error("Could not create cache directory "
+				+ directory_ + ": " + error.message());
+	}
+
+	const auto lockfile {
+		(std::filesystem::path(directory_) / LOCK_FILE).string() };
+
+	lock_fd_ = ::open(lockfile.c_str(), O_RDWR | O_CREAT, 0644);
+
+	if (lock_fd_ < 0)
+	{
+		throw std::runtime_error(
+				system_error_message("Could not open lock file", lockfile));
+	}
+
+	try
+	{
+		FileLock lock { lock_fd_, LOCK_EX };
+		open_index();
+
+	} catch (...)
+	{
+		::close(lock_fd_);
+		throw;
+	}
+
+	ARCS_LOG_DEBUG << "Opened checksum cache in " << directory_ << " with "
+		<< header()->count << " entries";
+}
+
+
+ChecksumCache::~ChecksumCache() noexcept
+{
+	close_index();
+	::close(lock_fd_);
+}
+
+
+std::optional<CacheValue> ChecksumCache::find(const CacheKey& key)
+{
+	std::lock_guard<std::mutex> guard { mutex_ };
+	FileLock lock { lock_fd_, LOCK_SH };
+	reopen_if_replaced();
+
+	const auto wanted { to_record<Record>(key) };
+	auto* r = slot(key);
+
+	if (r->state != SLOT_USED || !r->same_file(wanted))
+	{
+		++misses_;
+		return std::nullopt;
+	}
+
+	++hits_;
+
+	// Concurrent readers may store the same timestamp, which is harmless
+
+	r->last_used = now();
+
+	return CacheValue { r->length, r->value_types, r->arcs1, r->arcs2 };
+}
+
+
+void ChecksumCache::insert(const CacheKey& key, const CacheValue& value)
+{
+	std::lock_guard<std::mutex> guard { mutex_ };
+	FileLock lock { lock_fd_, LOCK_EX };
+	reopen_if_replaced();
+
+	// Keep the load factor at most 1/2 for short probe sequences
+
+	const auto capacity = header()->capacity;
+	const auto count    = header()->count;
+
+	if (count >= max_entries_)
+	{
+		rebuild(capacity);
+
+	} else if ((count + 1) * 2 > capacity)
+	{
+		rebuild(capacity * 2);
+	}
+
+	auto* r = slot(key);
+
+	if (r->state != SLOT_USED)
+	{
+		++header()->count;
+	}
+
+	*r = to_record<Record>(key);
+	r->length      = value.length;
+	r->value_types = value.types;
+	r->arcs1       = value.arcs1;
+	r->arcs2       = value.arcs2;
+	r->last_used   = now();
+	r->state       = SLOT_USED;
+}
+
+
+std::size_t ChecksumCache::size()
+{
+	std::lock_guard<std::mutex> guard { mutex_ };
+	FileLock lock { lock_fd_, LOCK_SH };
+	reopen_if_replaced();
+
+	return header()->count;
+}
+
+
+const std::string& ChecksumCache::directory() const
+{
+	return directory_;
+}
+
+
+void ChecksumCache::set_key_mode(const KeyMode mode)
+{
+	key_mode_ = mode;
+}
+
+
+KeyMode ChecksumCache::key_mode() const
+{
+	return key_mode_;
+}
+
+
+std::size_t ChecksumCache::hits() const
+{
+	return hits_;
+}
+
+
+std::size_t ChecksumCache::misses() const
+{
+	return misses_;
+}
+
+
+void ChecksumCache::open_index()
+{
+	static_assert(sizeof(Header) == 64, "Cache file header must have 64 bytes");
+	static_assert(sizeof(Record) == 64, "Cache file record must have 64 bytes");
+
+	const auto filename {
+		(std::filesystem::path(directory_) / INDEX_FILE).string() };
+
+	const auto fd = ::open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+
+	if (fd < 0)
+	{
+		throw std::runtime_error(
+				system_error_message("Could not open cache file", filename));
+	}
+
+	struct stat info;
+
+	if (::fstat(fd, &info) != 0)
+	{
+		::close(fd);
+		throw std::runtime_error(
+				system_error_message("Could not access cache file", filename));
+	}
+
+	auto size = static_cast<std::size_t>(info.st_size);
+
+	// A new cache file is only created while holding the exclusive lock
+
+	const bool created = size == 0;
+
+	if (created)
+	{
+		size = sizeof(Header) + INITIAL_CAPACITY * sizeof(Record);
+
+		if (::ftruncate(fd, static_cast<off_t>(size)) != 0)
+		{
+			::close(fd);
+			throw std::runtime_error(
+				system_error_message("Could not resize cache file", filename));
+		}
+	}
+
+	if (size < sizeof(Header))
+	{
+		::close(fd);
+		throw std::runtime_error("Not a checksum cache file: " + filename);
+	}
+
+	auto* map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if (map == MAP_FAILED)
+	{
+		throw std::runtime_error(
+				system_error_message("Could not map cache file", filename));
+	}
+
+	map_      = map;
+	map_size_ = size;
+
+	if (created)
+	{
+		std::memcpy(header()->magic, MAGIC, sizeof(MAGIC));
+		header()->version     = VERSION;
+		header()->record_size = sizeof(Record);
+		header()->capacity    = INITIAL_CAPACITY;
+		header()->count       = 0;
+		header()->obsolete    = 0;
+	}
+
+	const auto* h = header();
+
+	if (std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0
+		|| h->version != VERSION || h->record_size != sizeof(Record)
+		|| h->capacity == 0 || (h->capacity & (h->capacity - 1)) != 0
+		|| sizeof(Header) + h->capacity * sizeof(Record) > map_size_)
+	{
+		close_index();
+		throw std::runtime_error("Not a compatible checksum cache file: "
+				+ filename);
+	}
+}
+
+
+void ChecksumCache::close_index()
+{
+	if (map_)
+	{
+		::munmap(map_, map_size_);
+		map_      = nullptr;
+		map_size_ = 0;
+	}
+}
+
+
+void ChecksumCache::reopen_if_replaced()
+{
+	if (header()->obsolete)
+	{
+		close_index();
+		open_index();
+	}
+}
+
+
+void ChecksumCache::rebuild(const std::size_t capacity)
+{
+	// Collect the entries to keep
+
+	auto entries = std::vector<Record> {};
+	entries.reserve(header()->count);
+
+	for (std::size_t i = 0; i < header()->capacity; ++i)
+	{
+		if (records()[i].state == SLOT_USED)
+		{
+			entries.push_back(records()[i]);
+		}
+	}
+
+	if (entries.size() >= max_entries_)
+	{
+		const auto keep = max_entries_ / 2;
+
+		const auto middle { std::next(entries.begin(),
+				static_cast<std::vector<Record>::difference_type>(keep)) };
+
+		std::nth_element(entries.begin(), middle, entries.end(),
+			[](const Record& lhs, const Record& rhs)
+			{
+				return lhs.last_used > rhs.last_used;
+			});
+
+		ARCS_LOG_INFO << "Evict " << (entries.size() - keep)
+			<< " entries from checksum cache";
+
+		entries.resize(keep);
+	}
+
+	const auto new_capacity =
+		std::max(power_of_2(capacity), power_of_2(entries.size() * 2 + 2));
+
+	// Write the new cache file beside the current one
+
+	const auto dir { std::filesystem::path(directory_) };
+	const auto filename { (dir / INDEX_FILE).string() };
+	const auto tmpname  { (dir / (INDEX_FILE + ".tmp")).string() };
+
+	const auto fd = ::open(tmpname.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+	if (fd < 0)
+	{
+		throw std::runtime_error(
+				system_error_message("Could not create cache file", tmpname));
+	}
+
+	const auto size = sizeof(Header) + new_capacity * sizeof(Record);
+
+	if (::ftruncate(fd, static_cast<off_t>(size)) != 0)
+	{
+		::close(fd);
+		throw std::runtime_error(
+				system_error_message("Could not resize cache file", tmpname));
+	}
+
+	auto* map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if (map == MAP_FAILED)
+	{
+		throw std::runtime_error(
+				system_error_message("Could not map cache file", tmpname));
+	}
+
+	auto* h = static_cast<Header*>(map);
+	auto* slots = reinterpret_cast<Record*>(h + 1);
+
+	std::memcpy(h->magic, MAGIC, sizeof(MAGIC));
+	h->version     = VERSION;
+	h->record_size = sizeof(Record);
+	h->capacity    = new_capacity;
+	h->count       = entries.size();
+	h->obsolete    = 0;
+
+	for (const auto& e : entries)
+	{
+		*probe(slots, new_capacity, e) = e;
+	}
+
+	::munmap(map, size);
+
+	if (std::rename(tmpname.c_str(), filename.c_str()) != 0)
+	{
+		throw std::runtime_error(
+				system_error_message("Could not replace cache file", filename));
+	}
+
+	// Processes that still map the replaced file will reopen the cache file
+
+	header()->obsolete = 1;
+
+	close_index();
+	open_index();
+
+	ARCS_LOG_DEBUG << "Rebuilt checksum cache with capacity " << new_capacity;
+}
+
+
+ChecksumCache::Header* ChecksumCache::header() const
+{
+	return static_cast<Header*>(map_);
+}
+
+
+ChecksumCache::Record* ChecksumCache::records() const
+{
+	return reinterpret_cast<Record*>(header() + 1);
+}
+
+
+ChecksumCache::Record* ChecksumCache::slot(const CacheKey& key) const
+{
+	return probe(records(), header()->capacity, to_record<Record>(key));
+}
+
+} // namespace cache
+} // namespace v_1_0_0
+} // namespace arcsapp
+
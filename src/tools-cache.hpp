@@ -0,0 +1,396 @@
+#ifndef __ARCSTOOLS_TOOLS_CACHE_HPP__
+#define __ARCSTOOLS_TOOLS_CACHE_HPP__
+
+/**
+ * \file
+ *
+ * \brief Persistent on-disk cache for checksums.
+ */
+
+#include <atomic>      // for atomic
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint8_t, uint32_t, uint64_t, int64_t
+#include <mutex>       // for mutex
+#include <optional>    // for optional
+#include <string>      // for string
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+
+/**
+ * \brief Tools and helpers for caching checksums across runs.
+ */
+namespace cache
+{
+
+/**
+ * \brief Identity of a file as provided by the file system.
+ *
+ * If any of the fields changes, the content of the file is considered to have
+ * changed.
+ */
+struct FileIdentity final
+{
+	/**
+	 * \brief Device the file resides on.
+	 */
+	std::uint64_t device;
+
+	/**
+	 * \brief Inode of the file.
+	 */
+	std::uint64_t inode;
+
+	/**
+	 * \brief Size of the file in bytes.
+	 */
+	std::uint64_t size;
+
+	/**
+	 * \brief Modification time of the file in nanoseconds.
+	 */
+	std::int64_t mtime;
+};
+
+
+/**
+ * \brief Determine the identity of a file.
+ *
+ * \param[in] filename Name of the file
+ *
+ * \return Identity of the file
+ *
+ * \throws std::runtime_error If the file cannot be accessed
+ */
+FileIdentity file_identity(const std::string& filename);
+
+
+/**
+ * \brief Determine the identity of a file by its content.
+ *
+ * The identity is derived from a fingerprint of the container header and some
+ * blocks sampled from the entire file, together with the size of the file and
+ * the number of samples as reported by the audio reader. Thus, a file keeps
+ * its identity when it is moved, renamed or copied to another file system.
+ *
+ * For the identity returned, \c device and \c inode hold the fingerprint and
+ * \c mtime holds the number of samples.
+ *
+ * \param[in] filename      Name of the file
+ * \param[in] total_samples Number of samples, 0 if unknown
+ *
+ * \return Identity of the file content
+ *
+ * \throws std::runtime_error If the file cannot be read
+ */
+FileIdentity content_identity(const std::string& filename,
+		const std::uint64_t total_samples);
+
+
+/**
+ * \brief How to identify audio files in the cache.
+ */
+enum class KeyMode
+{
+	IDENTITY, ///< Identify by file_identity()
+	CONTENT   ///< Identify by content_identity()
+};
+
+
+/**
+ * \brief Flags for the calculation context of a CacheKey.
+ */
+enum CacheFlag : std::uint8_t
+{
+	FIRST_TRACK = 1, ///< File is the first track of the album
+	LAST_TRACK  = 2, ///< File is the last track of the album
+	IMAGE       = 4, ///< File contains all tracks, key refers to a track
+	CONTENT     = 8  ///< File is identified by its content
+};
+
+
+/**
+ * \brief Key of a cache entry.
+ *
+ * An entry represents the checksums of either a file containing a single
+ * track or of a single track in a file containing all tracks.
+ */
+struct CacheKey final
+{
+	/**
+	 * \brief Identity of the audio file.
+	 */
+	FileIdentity file;
+
+	/**
+	 * \brief Hash of the ToC for an image, 0 if not an image.
+	 */
+	std::uint64_t toc;
+
+	/**
+	 * \brief 1-based track number in an image, 0 if not an image.
+	 */
+	std::uint8_t track;
+
+	/**
+	 * \brief Requested checksum types as bit mask.
+	 */
+	std::uint8_t types;
+
+	/**
+	 * \brief Calculation context as combination of CacheFlag values.
+	 */
+	std::uint8_t flags;
+};
+
+
+/**
+ * \brief Value of a cache entry.
+ */
+struct CacheValue final
+{
+	/**
+	 * \brief Length of the track in frames.
+	 */
+	std::uint32_t length;
+
+	/**
+	 * \brief Checksum types present as bit mask.
+	 */
+	std::uint8_t types;
+
+	/**
+	 * \brief ARCSv1 value.
+	 */
+	std::uint32_t arcs1;
+
+	/**
+	 * \brief ARCSv2 value.
+	 */
+	std::uint32_t arcs2;
+};
+
+
+/**
+ * \brief Persistent cache for checksums, shared between processes.
+ *
+ * The cache is a single file in the cache directory that is memory mapped. It
+ * is a hash table with fixed-size records and open addressing, so a lookup
+ * touches only a few pages of the file.
+ *
+ * Entries for an outdated version of a file are replaced when the checksums of
+ * the current version are inserted. If the number of entries exceeds the
+ * maximum, the least recently used half of the entries is evicted.
+ *
+ * Access is synchronized between threads of the same process as well as
+ * between processes by a lock file in the cache directory.
+ */
+class ChecksumCache final
+{
+public:
+
+	/**
+	 * \brief Default maximum number of entries.
+	 */
+	static constexpr std::size_t DEFAULT_MAX_ENTRIES = 1u << 22;
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * Creates the cache directory and the cache file if they do not exist.
+	 *
+	 * \param[in] directory   Directory of the cache
+	 * \param[in] max_entries Maximum number of entries before eviction
+	 *
+	 * \throws std::runtime_error If the cache cannot be opened or created
+	 */
+	ChecksumCache(const std::string& directory,
+			const std::size_t max_entries = DEFAULT_MAX_ENTRIES);
+
+	ChecksumCache(const ChecksumCache&) = delete;
+	ChecksumCache& operator=(const ChecksumCache&) = delete;
+
+	/**
+	 * \brief Destructor.
+	 */
+	~ChecksumCache() noexcept;
+
+	/**
+	 * \brief Look up the value for a key.
+	 *
+	 * \param[in] key The key to look up
+	 *
+	 * \return The value for \c key if present
+	 */
+	std::optional<CacheValue> find(const CacheKey& key);
+
+	/**
+	 * \brief Insert or update the value for a key.
+	 *
+	 * \param[in] key   The key to insert
+	 * \param[in] value The value for \c key
+	 *
+	 * \throws std::runtime_error If the cache file cannot be resized
+	 */
+	void insert(const CacheKey& key, const CacheValue& value);
+
+	/**
+	 * \brief Number of entries in the cache.
+	 *
+	 * \return Number of entries
+	 */
+	std::size_t size();
+
+	/**
+	 * \brief Directory of this cache.
+	 *
+	 * \return Directory of this cache
+	 */
+	const std::string& directory() const;
+
+	/**
+	 * \brief Set how audio files are to be identified.
+	 *
+	 * The key mode is not stored in the cache, it is a hint for the users of
+	 * this instance. The default is KeyMode::IDENTITY.
+	 *
+	 * \param[in] mode How to identify audio files
+	 */
+	void set_key_mode(const KeyMode mode);
+
+	/**
+	 * \brief How audio files are to be identified.
+	 *
+	 * \return How to identify audio files
+	 */
+	KeyMode key_mode() const;
+
+	/**
+	 * \brief Number of successful lookups by this instance.
+	 *
+	 * \return Number of lookups that found a value
+	 */
+	std::size_t hits() const;
+
+	/**
+	 * \brief Number of failed lookups by this instance.
+	 *
+	 * \return Number of lookups that found no value
+	 */
+	std::size_t misses() const;
+
+private:
+
+	/**
+	 * \brief On-disk layout of the cache file header.
+	 */
+	struct Header;
+
+	/**
+	 * \brief On-disk layout of a cache entry.
+	 */
+	struct Record;
+
+	/**
+	 * \brief Lock the cache for the current process.
+	 */
+	class FileLock;
+
+	/**
+	 * \brief Map the current cache file, create it if it does not exist.
+	 */
+	void open_index();
+
+	/**
+	 * \brief Unmap the current cache file.
+	 */
+	void close_index();
+
+	/**
+	 * \brief Map the current cache file again iff it was replaced.
+	 */
+	void reopen_if_replaced();
+
+	/**
+	 * \brief Replace the cache file by one with the specified capacity.
+	 *
+	 * If the current number of entries exceeds the maximum, the most recently
+	 * used entries are kept.
+	 *
+	 * \param[in] capacity Number of slots in the new file
+	 */
+	void rebuild(const std::size_t capacity);
+
+	/**
+	 * \brief Header of the mapped cache file.
+	 */
+	Header* header() const;
+
+	/**
+	 * \brief Slots of the mapped cache file.
+	 */
+	Record* records() const;
+
+	/**
+	 * \brief Slot that holds \c key or the empty slot to insert it.
+	 *
+	 * \param[in] key The key to find the slot for
+	 *
+	 * \return Slot for \c key
+	 */
+	Record* slot(const CacheKey& key) const;
+
+	/**
+	 * \brief Cache directory.
+	 */
+	std::string directory_;
+
+	/**
+	 * \brief Maximum number of entries.
+	 */
+	std::size_t max_entries_;
+
+	/**
+	 * \brief Descriptor of the lock file.
+	 */
+	int lock_fd_;
+
+	/**
+	 * \brief Start address of the mapped cache file.
+	 */
+	void* map_;
+
+	/**
+	 * \brief Size of the mapped cache file in bytes.
+	 */
+	std::size_t map_size_;
+
+	/**
+	 * \brief How audio files are to be identified.
+	 */
+	KeyMode key_mode_;
+
+	/**
+	 * \brief Number of successful lookups.
+	 */
+	std::atomic<std::size_t> hits_;
+
+	/**
+	 * \brief Number of failed lookups.
+	 */
+	std::atomic<std::size_t> misses_;
+
+	/**
+	 * \brief Synchronizes threads of this process.
+	 */
+	std::mutex mutex_;
+};
+
+} // namespace cache
+} // namespace v_1_0_0
+} // namespace arcsapp
+
+#endif
+
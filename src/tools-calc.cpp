@@ -6,12 +6,19 @@
 #include "tools-calc.hpp"
 #endif
 
-#include <cstdint>                  // for uint16_t
+#include <algorithm>                // for count_if, find, min, none_of, sort
+#include <cstddef>                  // for ptrdiff_t, size_t
+#include <cstdint>                  // for int32_t, uint8_t, uint64_t
+#include <functional>               // for greater
 #include <iomanip>                  // for setw, setfill
+#include <iostream>                 // for cin
+#include <iterator>                 // for next
 #include <memory>                   // for unique_ptr, make_unique
+#include <numeric>                  // for accumulate
 #include <sstream>                  // for ostringstream
-#include <stdexcept>                // for invalid_argument
+#include <stdexcept>                // for invalid_argument, runtime_error
 #include <string>                   // for string
+#include <system_error>             // for error_code
 #include <tuple>                    // for make_tuple, tuple
 #include <unordered_set>            // for unordered_set
 #include <utility>                  // for move
@@ -32,14 +39,29 @@
 #endif
 
 #ifndef __LIBARCSDEC_CALCULATORS_HPP__
-#include <arcsdec/calculators.hpp>  // for ToCParser, ARCSCalculator
+#include <arcsdec/calculators.hpp>  // for ToCParser, ARCSCalculator, AudioInfo
 #endif
 #ifndef __LIBARCSDEC_SELECTION_HPP__
 #include <arcsdec/selection.hpp>    // for FileReaderPreferenceSelection
 #endif
 
+#ifndef __ARCSTOOLS_TOOLS_ARCS_HPP__
+#include "tools-arcs.hpp"           // for calculate_tracks, track_ranges
+#endif
+#ifndef __ARCSTOOLS_TOOLS_CACHE_HPP__
+#include "tools-cache.hpp"          // for ChecksumCache, CacheKey
+#endif
 #ifndef __ARCSTOOLS_TOOLS_FS_HPP__
-#include "tools-fs.hpp"             // for path, prepend_path
+#include "tools-fs.hpp"             // for path, file_is_readable
+#endif
+#ifndef __ARCSTOOLS_TOOLS_PARALLEL_HPP__
+#include "tools-parallel.hpp"       // for TaskPool, worker_count
+#endif
+#ifndef __ARCSTOOLS_TOOLS_PCM_HPP__
+#include "tools-pcm.hpp"            // for open_sample_reader, reader_memory
+#endif
+#ifndef __ARCSTOOLS_TOOLS_SELECTION_HPP__
+#include "tools-selection.hpp"      // for signature_of, SelectionCache
 #endif
 
 namespace arcsapp
@@ -54,6 +76,302 @@ using arcsdec::FileReaderSelection;
 using arcsdec::ToCParser;
 
 
+namespace
+{
+
+/**
+ * \brief Number of samples per frame.
+ */
+constexpr std::size_t SAMPLES_PER_FRAME = 588;
+
+/**
+ * \brief Estimated memory of a calculation besides reading its audio files.
+ *
+ * Covers the ToC, the checksums and the digests of an album.
+ */
+constexpr std::size_t JOB_MEMORY = 4 * 1024 * 1024;
+
+/**
+ * \brief Estimated maximal memory for the samples libarcsdec reads at once.
+ */
+constexpr std::size_t ARCSDEC_BLOCK_MEMORY = 16 * 1024 * 1024;
+
+/**
+ * \brief Estimated memory of a decoder used by libarcsdec.
+ */
+constexpr std::size_t ARCSDEC_DECODER_MEMORY = 4 * 1024 * 1024;
+
+
+/**
+ * \brief Bit of a checksum type in the type mask of a cache entry.
+ */
+std::uint8_t type_bit(const arcstk::checksum::type t)
+{
+	using arcstk::checksum::type;
+
+	switch (t)
+	{
+		case type::ARCS1: return 1;
+		case type::ARCS2: return 2;
+		default:          return 0;
+	}
+}
+
+
+/**
+ * \brief Type mask of a cache entry for a set of checksum types.
+ */
+std::uint8_t type_mask(const ChecksumTypeset& types)
+{
+	auto mask = std::uint8_t { 0 };
+
+	for (const auto& t : types)
+	{
+		mask |= type_bit(t);
+	}
+
+	return mask;
+}
+
+
+/**
+ * \brief Convert the sums of a track to a ChecksumSet.
+ *
+ * The sums are collected as libarcstk would: ARCSv1 is a byproduct of ARCSv2.
+ */
+arcstk::ChecksumSet to_checksum_set(const arcs::ARCSAccumulator& sums,
+		const std::size_t samples, const ChecksumTypeset& types)
+{
+	using arcstk::checksum::type;
+
+	const auto with_v2 { types.count(type::ARCS2) > 0 };
+	const auto with_v1 { with_v2 || types.count(type::ARCS1) > 0 };
+
+	auto set { arcstk::ChecksumSet {
+		static_cast<std::int32_t>(samples / SAMPLES_PER_FRAME) } };
+
+	if (with_v1)
+	{
+		set.insert(type::ARCS1, arcstk::Checksum { sums.arcs1() });
+	}
+
+	if (with_v2)
+	{
+		set.insert(type::ARCS2, arcstk::Checksum { sums.arcs2() });
+	}
+
+	return set;
+}
+
+
+/**
+ * \brief Convert the sums of each track to Checksums.
+ */
+Checksums to_checksums(const std::vector<arcs::ARCSAccumulator>& sums,
+		const std::vector<arcs::TrackRange>& tracks,
+		const ChecksumTypeset& types)
+{
+	auto checksums { Checksums { tracks.size() } };
+
+	for (std::size_t i = 0; i < tracks.size(); ++i)
+	{
+		checksums.append(to_checksum_set(sums[i], tracks[i].length, types));
+	}
+
+	return checksums;
+}
+
+
+/**
+ * \brief Convert a ChecksumSet to a cache value.
+ */
+cache::CacheValue to_cache_value(const arcstk::ChecksumSet& set)
+{
+	using arcstk::checksum::type;
+
+	auto value = cache::CacheValue {
+		static_cast<std::uint32_t>(set.length()), 0, 0, 0 };
+
+	if (set.contains(type::ARCS1))
+	{
+		value.types |= type_bit(type::ARCS1);
+		value.arcs1  = set.get(type::ARCS1).value();
+	}
+
+	if (set.contains(type::ARCS2))
+	{
+		value.types |= type_bit(type::ARCS2);
+		value.arcs2  = set.get(type::ARCS2).value();
+	}
+
+	return value;
+}
+
+
+/**
+ * \brief Convert a cache value to a ChecksumSet.
+ */
+arcstk::ChecksumSet to_checksum_set(const cache::CacheValue& value)
+{
+	using arcstk::checksum::type;
+
+	auto set { arcstk::ChecksumSet { value.length } };
+
+	if (value.types & type_bit(type::ARCS1))
+	{
+		set.insert(type::ARCS1, arcstk::Checksum { value.arcs1 });
+	}
+
+	if (value.types & type_bit(type::ARCS2))
+	{
+		set.insert(type::ARCS2, arcstk::Checksum { value.arcs2 });
+	}
+
+	return set;
+}
+
+
+/**
+ * \brief Identity of an audio file for a cache key.
+ */
+cache::FileIdentity identify(const cache::ChecksumCache& c,
+		const std::string& audiofilename)
+{
+	if (cache::KeyMode::CONTENT != c.key_mode())
+	{
+		return cache::file_identity(audiofilename);
+	}
+
+	// Readers with random access provide the number of samples without
+	// decoding, for any other format the fingerprint has to suffice
+
+	const auto reader { pcm::open_sample_reader(audiofilename) };
+
+	return cache::content_identity(audiofilename,
+			reader ? reader->total_samples() : 0);
+}
+
+
+/**
+ * \brief Flags for a cache key.
+ */
+std::uint8_t key_flags(const cache::ChecksumCache& c, const int flags)
+{
+	return static_cast<std::uint8_t>(cache::KeyMode::CONTENT == c.key_mode()
+			? flags | cache::CONTENT
+			: flags);
+}
+
+
+/**
+ * \brief Hash of the track layout of a ToC (FNV-1a).
+ *
+ * Never 0, since 0 marks entries for files that are not images.
+ */
+std::uint64_t toc_hash(const ToC& toc)
+{
+	auto h = std::uint64_t { 0xcbf29ce484222325u };
+
+	const auto add = [&h](const std::uint64_t v)
+	{
+		for (auto i = 0; i < 8; ++i)
+		{
+			h ^= (v >> (i * 8)) & 0xFF;
+			h *= 0x100000001b3u;
+		}
+	};
+
+	for (const auto& offset : toc.offsets())
+	{
+		add(static_cast<std::uint64_t>(offset.frames()));
+	}
+
+	add(toc.complete() ? static_cast<std::uint64_t>(toc.leadout().frames()) : 0);
+
+	return h ? h : 1;
+}
+
+
+/**
+ * \brief ARId of an album in a single audio file.
+ *
+ * The audio size is only required if the ToC has no leadout.
+ */
+ARId image_arid(const ToC& toc, const std::size_t total_samples)
+{
+	const auto arid { toc.complete()
+		? make_arid(toc)
+		: make_arid(toc, arcstk::AudioSize { static_cast<std::int32_t>(
+				total_samples), arcstk::AudioSize::UNIT::SAMPLES }) };
+
+	return *arid;
+}
+
+
+/**
+ * \brief TRUE iff the audio file name denotes standard input.
+ */
+bool is_stdin(const std::string& audiofilename)
+{
+	return STDIN_FILENAME == audiofilename;
+}
+
+
+/**
+ * \brief Digests to calculate for each of the specified number of tracks.
+ *
+ * If neither digest types nor windows are specified, the result is empty.
+ */
+std::vector<digest::Digests> make_digests(
+		const std::vector<digest::DigestType>& types, const std::size_t window,
+		const std::size_t total)
+{
+	if (types.empty() && 0 == window)
+	{
+		return {};
+	}
+
+	return std::vector<digest::Digests>(total,
+			digest::Digests { types, window });
+}
+
+
+/**
+ * \brief Compare the MD5 declared by an audio file with the MD5 calculated.
+ */
+MD5Status check_md5(const std::string& audiofilename,
+		const std::string& declared, const digest::Digests& calculated)
+{
+	if (declared == calculated.value(digest::DigestType::MD5))
+	{
+		ARCS_LOG_INFO << "MD5 of " << audiofilename << " matches";
+		return MD5Status::MATCH;
+	}
+
+	ARCS_LOG_WARNING << "MD5 of the samples of " << audiofilename
+		<< " does not match the declared MD5 " << declared;
+
+	return MD5Status::MISMATCH;
+}
+
+
+/**
+ * \brief Throw if digests or windows are requested but cannot be calculated.
+ */
+void require_no_digests(const std::vector<digest::DigestType>& types,
+		const std::size_t window, const std::string& audiofilename)
+{
+	if (!types.empty() || window > 0)
+	{
+		throw std::runtime_error("Cannot calculate digests for "
+				+ audiofilename + ", digests require a RIFF/WAV or FLAC file"
+				" read without an explicitly requested reader");
+	}
+}
+
+} // namespace
+
+
 std::tuple<bool,bool,std::vector<std::string>> ToCFiles::get(const ToC& toc)
 {
 	const auto toc_list { toc.filenames() };
@@ -114,6 +432,23 @@ std::string ToCFiles::expand_path(const std::string& metafilename,
 }
 
 
+// sample_offsets
+
+
+std::vector<std::size_t> sample_offsets(const ToC& toc)
+{
+	auto offsets = std::vector<std::size_t> {};
+
+	for (const auto& offset : toc.offsets())
+	{
+		offsets.push_back(
+				static_cast<std::size_t>(offset.frames()) * SAMPLES_PER_FRAME);
+	}
+
+	return offsets;
+}
+
+
 // IdSelection
 
 
@@ -127,6 +462,16 @@ std::unique_ptr<arcsdec::FileReaderSelection> IdSelection::operator()(
 }
 
 
+// has_mismatch
+
+
+bool has_mismatch(const std::vector<MD5Status>& md5_status)
+{
+	return std::find(md5_status.begin(), md5_status.end(),
+			MD5Status::MISMATCH) != md5_status.end();
+}
+
+
 // ChecksumCalculator
 
 
@@ -141,8 +486,24 @@ ChecksumCalculator::ChecksumCalculator()
 ChecksumCalculator::ChecksumCalculator(
 		const ChecksumTypeset& types)
 	: types_           { types }
+	, threads_         { 1 }
+	, placement_       { affinity::Placement::NONE }
+	, engine_          { kernel::Engine::SCALAR }
+	, deadline_        { /* never */ }
+	, file_timeout_    { 0 }
+	, progress_        { nullptr }
+	, cache_           { nullptr }
+	, input_options_   { /* default */ }
+	, stall_counters_  { std::make_unique<io::StallCounters>() }
+	, digest_types_    { /* empty */ }
+	, digests_         { std::make_unique<std::vector<digest::Digests>>() }
+	, window_          { 0 }
+	, check_md5_       { false }
+	, md5_status_      { std::make_unique<std::vector<MD5Status>>() }
 	, audio_selection_ { nullptr }
 	, toc_selection_   { nullptr }
+	, own_selections_  { std::make_unique<selection::SelectionCache>() }
+	, selections_      { own_selections_.get() }
 {
 	// empty
 }
@@ -193,13 +554,11 @@ std::tuple<Checksums, ARId, std::unique_ptr<ToC>>
 
 	// Run
 
-	auto calculator { setup_calculator() };
-
 	// case: single-file album w ToC
 	if (1 == filecount)
 	{
 		const auto [ checksums, arid ] =
-			calculator.calculate(audiofilenames.front(), *toc);
+			calculate_image(audiofilenames.front(), *toc);
 
 		return { checksums, arid, std::move(toc) };
 	}
@@ -207,7 +566,7 @@ std::tuple<Checksums, ARId, std::unique_ptr<ToC>>
 	// case: multi-file album w ToC (== "EAC-styled layout")
 	if (toc->total_tracks() == filecount)
 	{
-		const auto chksums { calculator.calculate(audiofilenames, true, true) };
+		const auto chksums { calculate_files(audiofilenames, true, true) };
 		const auto arid    { make_arid(*toc) };
 
 		return { chksums, *arid, std::move(toc) };
@@ -222,92 +581,485 @@ std::tuple<Checksums, ARId, std::unique_ptr<ToC>>
 		const std::vector<std::string>& audiofilenames,
 		const bool first_is_first_track, const bool last_is_last_track) const
 {
-	auto calculator { setup_calculator() };
-
-	const auto checksums { calculator.calculate(audiofilenames,
+	const auto checksums { calculate_files(audiofilenames,
 			first_is_first_track, last_is_last_track) };
 
 	return { checksums, arcstk::EmptyARId, nullptr };
 }
 
 
-void ChecksumCalculator::set_types(const ChecksumTypeset& types)
-{
-	types_ = types;
-}
-
-
-ChecksumTypeset ChecksumCalculator::types() const
+std::vector<std::string> ChecksumCalculator::probe(
+		const std::vector<std::string>& audiofilenames,
+		const std::string& metafilename) const
 {
-	return types_;
-}
+	auto problems = std::vector<std::string> {};
 
+	if (metafilename.empty())
+	{
+		problems.push_back("No ToC file specified");
+		return problems;
+	}
 
-void ChecksumCalculator::set_toc_selection(FileReaderSelection* selection)
-{
-	toc_selection_ = selection;
-}
+	auto toc = std::unique_ptr<ToC> {};
 
+	try
+	{
+		toc = setup_parser().parse(metafilename);
 
-FileReaderSelection* ChecksumCalculator::toc_selection() const
-{
-	return toc_selection_;
-}
+	} catch (const std::exception& e)
+	{
+		problems.push_back("Cannot parse " + metafilename + ": " + e.what());
+		return problems;
+	}
 
+	auto audiofiles { audiofilenames };
 
-void ChecksumCalculator::set_audio_selection(FileReaderSelection* selection)
-{
-	audio_selection_ = selection;
-}
+	if (audiofiles.empty())
+	{
+		auto [ is_single_file, pairwise_dist, files ] = ToCFiles::get(*toc);
 
+		if (!is_single_file && !pairwise_dist)
+		{
+			problems.push_back("Metafile " + metafilename + " references "
+					"multiple audio files that are not pairwise distinct");
+			return problems;
+		}
 
-FileReaderSelection* ChecksumCalculator::audio_selection() const
-{
-	return audio_selection_;
-}
+		if (files.empty())
+		{
+			problems.push_back("Metafile " + metafilename + " references "
+					"no audio files");
+			return problems;
+		}
 
+		for (auto& audiofile : files)
+		{
+			audiofiles.push_back(
+					ToCFiles::expand_path(metafilename, audiofile));
+		}
+	} else if (audiofiles.size() != 1
+			&& static_cast<int>(audiofiles.size()) != toc->total_tracks())
+	{
+		std::ostringstream msg;
+		msg << "Metafile " << metafilename << " specifies "
+			<< toc->total_tracks() << " tracks but " << audiofiles.size()
+			<< " audio files were passed";
 
-std::tuple<Checksums, ARId, std::unique_ptr<ToC>>
-	ChecksumCalculator::calculate(
-		std::unique_ptr<ToC> toc, const std::string& filepath) const
-{
-	ARCS_LOG_DEBUG << "Calculate result from ToC"
-			" and searchpath for audiofiles";
+		problems.push_back(msg.str());
+		return problems;
+	}
 
-	// Validate audio file set in ToC
+	// Only the headers are read to determine the sizes
 
-	auto [ is_single_file, pairwise_dist, audiofiles ] = ToCFiles::get(*toc);
+	auto info { arcsdec::AudioInfo{} };
 
-	if (!is_single_file && !pairwise_dist)
+	if (audio_selection())
 	{
-		throw std::invalid_argument(
-			"ToC references a set of multiple audio files, but they are not "
-			"pairwise distinct. This usecase is unsupported in the current "
-			"version.");
+		info.set_selection(audio_selection());
 	}
 
-	// Calculate ARCSs
-
-	auto calculator { setup_calculator() };
-
-	if (is_single_file)
+	for (const auto& audiofile : audiofiles)
 	{
-		const auto audiofile =
-			ToCFiles::expand_path(filepath, audiofiles.front());
-
-		// case: single-file album w ToC
-		const auto [ checksums, arid ] = calculator.calculate(audiofile, *toc);
+		if (STDIN_FILENAME == audiofile)
+		{
+			continue;
+		}
 
-		return { checksums, arid, std::move(toc) };
-	} else
-	{
-		for (auto& audiofile : audiofiles)
+		if (!file::file_is_readable(audiofile))
 		{
-			audiofile = ToCFiles::expand_path(filepath, audiofile);
+			problems.push_back("Cannot read audio file " + audiofile);
+			continue;
+		}
+
+		try
+		{
+			const auto size { info.size(audiofile) };
+
+			if (!size || size->zero())
+			{
+				problems.push_back("Audio file " + audiofile
+						+ " contains no samples");
+				continue;
+			}
+
+			if (1 == audiofiles.size() && !toc->offsets().empty())
+			{
+				const auto last_track { static_cast<std::size_t>(
+						toc->offsets().back().frames()) * SAMPLES_PER_FRAME };
+				const auto samples { static_cast<std::size_t>(
+						size->total_samples()) };
+
+				if (samples <= last_track)
+				{
+					std::ostringstream msg;
+					msg << "Audio file " << audiofile << " has " << samples
+						<< " samples but the last track starts at sample "
+						<< last_track;
+
+					problems.push_back(msg.str());
+				}
+			}
+		} catch (const std::exception& e)
+		{
+			problems.push_back("Audio file " + audiofile + ": " + e.what());
+		}
+	}
+
+	return problems;
+}
+
+
+std::size_t ChecksumCalculator::estimate_memory(
+		const std::vector<std::string>& audiofilenames,
+		const std::string& metafilename) const
+{
+	auto audiofiles { audiofilenames };
+
+	try
+	{
+		audiofiles = this->audiofiles(audiofilenames, metafilename);
+
+	} catch (const std::exception& e)
+	{
+		ARCS_LOG_DEBUG << "Cannot estimate memory for " << metafilename
+			<< ": " << e.what();
+	}
+
+	const auto workers { parallel::worker_count(threads()) };
+
+	// A single file is read by each worker, multiple files are read
+	// concurrently by one worker each
+
+	const auto readers { 1 == audiofiles.size() ? workers : 1 };
+	const auto concurrent { std::min(workers, audiofiles.size()) };
+
+	auto per_file = std::vector<std::size_t> {};
+	per_file.reserve(audiofiles.size());
+
+	for (const auto& audiofile : audiofiles)
+	{
+		if (is_stdin(audiofile))
+		{
+			per_file.push_back(pcm::reader_memory(pcm::Format::WAV,
+						io::InputOptions {}, 0));
+			continue;
+		}
+
+		auto ec = std::error_code {};
+		const auto size { std::filesystem::file_size(audiofile, ec) };
+		const auto file_size { ec ? 0 : static_cast<std::size_t>(size) };
+
+		const auto format { pcm::detect_format(audiofile) };
+
+		if (selection::Decoder::SAMPLE_READER
+				== decoder(format, audiofiles.size()))
+		{
+			per_file.push_back(readers
+				* pcm::reader_memory(format, input_options_, file_size));
+		} else
+		{
+			per_file.push_back(ARCSDEC_DECODER_MEMORY
+				+ std::min(file_size, ARCSDEC_BLOCK_MEMORY));
+		}
+	}
+
+	// Account for the largest files that may be read at the same time
+
+	std::sort(per_file.begin(), per_file.end(), std::greater<std::size_t>{});
+
+	return std::accumulate(per_file.begin(), std::next(per_file.begin(),
+				static_cast<std::ptrdiff_t>(concurrent)), JOB_MEMORY);
+}
+
+
+std::vector<std::string> ChecksumCalculator::audiofiles(
+		const std::vector<std::string>& audiofilenames,
+		const std::string& metafilename) const
+{
+	auto audiofiles { audiofilenames };
+
+	if (audiofiles.empty() && !metafilename.empty())
+	{
+		const auto toc { setup_parser().parse(metafilename) };
+		const auto [ single, distinct, files ] = ToCFiles::get(*toc);
+
+		if (!single && !distinct)
+		{
+			throw std::invalid_argument("Metafile " + metafilename
+					+ " references multiple audio files that are not "
+					"pairwise distinct");
+		}
+
+		for (const auto& audiofile : files)
+		{
+			audiofiles.push_back(
+					ToCFiles::expand_path(metafilename, audiofile));
+		}
+	}
+
+	return audiofiles;
+}
+
+
+selection::Decoder ChecksumCalculator::decoder(const pcm::Format format,
+		const std::size_t files) const
+{
+	// A single file is split among the workers, multiple files are read by
+	// one worker each (see calculate_image_uncached() and calculate_file())
+
+	const auto workers { parallel::worker_count(threads()) };
+
+	const auto reads_samples { !audio_selection()
+		&& (prefers_samples() || (1 == files && workers > 1)) };
+
+	return reads_samples && pcm::Format::OTHER != format
+		? selection::Decoder::SAMPLE_READER
+		: selection::Decoder::LIBARCSDEC;
+}
+
+
+void ChecksumCalculator::set_types(const ChecksumTypeset& types)
+{
+	types_ = types;
+}
+
+
+ChecksumTypeset ChecksumCalculator::types() const
+{
+	return types_;
+}
+
+
+void ChecksumCalculator::set_threads(const std::size_t threads)
+{
+	threads_ = threads;
+}
+
+
+std::size_t ChecksumCalculator::threads() const
+{
+	return threads_;
+}
+
+
+void ChecksumCalculator::set_placement(const affinity::Placement placement)
+{
+	placement_ = placement;
+}
+
+
+affinity::Placement ChecksumCalculator::placement() const
+{
+	return placement_;
+}
+
+
+void ChecksumCalculator::set_engine(const kernel::Engine engine)
+{
+	engine_ = engine;
+}
+
+
+kernel::Engine ChecksumCalculator::engine() const
+{
+	return engine_;
+}
+
+
+void ChecksumCalculator::set_deadline(const deadline::Deadline& deadline)
+{
+	deadline_ = deadline;
+}
+
+
+const deadline::Deadline& ChecksumCalculator::deadline() const
+{
+	return deadline_;
+}
+
+
+void ChecksumCalculator::set_file_timeout(
+		const std::chrono::milliseconds timeout)
+{
+	file_timeout_ = timeout;
+}
+
+
+std::chrono::milliseconds ChecksumCalculator::file_timeout() const
+{
+	return file_timeout_;
+}
+
+
+void ChecksumCalculator::set_progress(progress::Reporter* progress)
+{
+	progress_ = progress;
+}
+
+
+progress::Reporter* ChecksumCalculator::progress() const
+{
+	return progress_;
+}
+
+
+void ChecksumCalculator::set_cache(cache::ChecksumCache* cache)
+{
+	cache_ = cache;
+}
+
+
+cache::ChecksumCache* ChecksumCalculator::cache() const
+{
+	return cache_;
+}
+
+
+void ChecksumCalculator::set_input_options(const io::InputOptions& options)
+{
+	input_options_ = options;
+}
+
+
+io::InputOptions ChecksumCalculator::input_options() const
+{
+	auto options { input_options_ };
+	options.counters = stall_counters_.get();
+
+	return options;
+}
+
+
+const io::StallCounters& ChecksumCalculator::stall_counters() const
+{
+	return *stall_counters_;
+}
+
+
+void ChecksumCalculator::set_digests(
+		const std::vector<digest::DigestType>& types)
+{
+	digest_types_ = types;
+}
+
+
+const std::vector<digest::DigestType>& ChecksumCalculator::digest_types() const
+{
+	return digest_types_;
+}
+
+
+const std::vector<digest::Digests>& ChecksumCalculator::digests() const
+{
+	return *digests_;
+}
+
+
+void ChecksumCalculator::set_window(const std::size_t samples)
+{
+	window_ = samples;
+}
+
+
+std::size_t ChecksumCalculator::window() const
+{
+	return window_;
+}
+
+
+void ChecksumCalculator::set_check_md5(const bool check)
+{
+	check_md5_ = check;
+}
+
+
+bool ChecksumCalculator::checks_md5() const
+{
+	return check_md5_;
+}
+
+
+const std::vector<MD5Status>& ChecksumCalculator::md5_status() const
+{
+	return *md5_status_;
+}
+
+
+void ChecksumCalculator::set_toc_selection(FileReaderSelection* selection)
+{
+	toc_selection_ = selection;
+}
+
+
+FileReaderSelection* ChecksumCalculator::toc_selection() const
+{
+	return toc_selection_;
+}
+
+
+void ChecksumCalculator::set_audio_selection(FileReaderSelection* selection)
+{
+	audio_selection_ = selection;
+}
+
+
+FileReaderSelection* ChecksumCalculator::audio_selection() const
+{
+	return audio_selection_;
+}
+
+
+void ChecksumCalculator::set_selection_cache(selection::SelectionCache* cache)
+{
+	selections_ = cache ? cache : own_selections_.get();
+}
+
+
+selection::SelectionCache& ChecksumCalculator::selection_cache() const
+{
+	return *selections_;
+}
+
+
+std::tuple<Checksums, ARId, std::unique_ptr<ToC>>
+	ChecksumCalculator::calculate(
+		std::unique_ptr<ToC> toc, const std::string& filepath) const
+{
+	ARCS_LOG_DEBUG << "Calculate result from ToC"
+			" and searchpath for audiofiles";
+
+	// Validate audio file set in ToC
+
+	auto [ is_single_file, pairwise_dist, audiofiles ] = ToCFiles::get(*toc);
+
+	if (!is_single_file && !pairwise_dist)
+	{
+		throw std::invalid_argument(
+			"ToC references a set of multiple audio files, but they are not "
+			"pairwise distinct. This usecase is unsupported in the current "
+			"version.");
+	}
+
+	// Calculate ARCSs
+
+	if (is_single_file)
+	{
+		const auto audiofile =
+			ToCFiles::expand_path(filepath, audiofiles.front());
+
+		// case: single-file album w ToC
+		const auto [ checksums, arid ] = calculate_image(audiofile, *toc);
+
+		return { checksums, arid, std::move(toc) };
+	} else
+	{
+		for (auto& audiofile : audiofiles)
+		{
+			audiofile = ToCFiles::expand_path(filepath, audiofile);
 		}
 
 		// case: multi-file album w toc (== "EAC-styled layout")
-		const auto checksums { calculator.calculate(audiofiles, true, true) };
+		const auto checksums { calculate_files(audiofiles, true, true) };
 		const auto arid      { make_arid(*toc) };
 
 		return { checksums, *arid, std::move(toc) };
@@ -315,16 +1067,481 @@ std::tuple<Checksums, ARId, std::unique_ptr<ToC>>
 }
 
 
-ARCSCalculator ChecksumCalculator::setup_calculator() const
+Checksums ChecksumCalculator::calculate_files(
+		const std::vector<std::string>& audiofilenames,
+		const bool first_is_first_track, const bool last_is_last_track) const
 {
-	auto calculator { ARCSCalculator { types() } };
+	const auto total_files { audiofilenames.size() };
 
-	if (audio_selection())
+	const auto is_first = [first_is_first_track](const std::size_t i)
+	{
+		return first_is_first_track && 0 == i;
+	};
+
+	const auto is_last = [last_is_last_track,total_files](const std::size_t i)
+	{
+		return last_is_last_track && total_files - 1 == i;
+	};
+
+	if (std::count_if(audiofilenames.begin(), audiofilenames.end(), is_stdin)
+			> 1)
+	{
+		throw std::invalid_argument("Standard input can only be read once");
+	}
+
+	auto results {
+		std::vector<std::unique_ptr<arcstk::ChecksumSet>>(total_files) };
+
+	*digests_ = make_digests(digest_types_, window_, total_files);
+	md5_status_->assign(checks_md5() ? total_files : 0, MD5Status::UNCHECKED);
+
+	// Look up the files in the cache
+
+	auto keys = std::vector<cache::CacheKey> {};
+
+	if (cache())
+	{
+		keys.reserve(total_files);
+
+		for (std::size_t i = 0; i < total_files; ++i)
+		{
+			if (is_stdin(audiofilenames[i]))
+			{
+				keys.emplace_back();
+				continue;
+			}
+
+			keys.push_back({ identify(*cache(), audiofilenames[i]), 0, 0,
+				type_mask(types()), key_flags(*cache(),
+					(is_first(i) ? cache::FIRST_TRACK : 0)
+					| (is_last(i) ? cache::LAST_TRACK : 0)) });
+
+			// Cached checksums have no digests and no MD5 checks
+
+			if (requires_samples())
+			{
+				continue;
+			}
+
+			if (const auto value { cache()->find(keys.back()) })
+			{
+				results[i] = std::make_unique<arcstk::ChecksumSet>(
+						to_checksum_set(*value));
+			}
+		}
+	}
+
+	auto missing = std::vector<std::size_t> {};
+
+	for (std::size_t i = 0; i < total_files; ++i)
+	{
+		if (!results[i])
+		{
+			missing.push_back(i);
+		}
+	}
+
+	if (cache())
+	{
+		ARCS_LOG_INFO << "Found " << (total_files - missing.size()) << " of "
+			<< total_files << " audio files in cache";
+	}
+
+	const auto workers {
+		std::min(parallel::worker_count(threads()), missing.size()) };
+
+	if (workers < 2 && missing.size() == total_files
+			&& !prefers_samples()
+			&& std::none_of(audiofilenames.begin(), audiofilenames.end(),
+				is_stdin))
+	{
+		const auto calculator { setup_calculator() };
+
+		const auto checksums { calculator->calculate(audiofilenames,
+				first_is_first_track, last_is_last_track) };
+
+		for (std::size_t i = 0; i < total_files; ++i)
+		{
+			results[i] = std::make_unique<arcstk::ChecksumSet>(checksums.at(i));
+		}
+	} else if (!missing.empty())
+	{
+		ARCS_LOG_DEBUG << "Calculate " << missing.size()
+			<< " audio files with " << workers << " threads";
+
+		// Each file is processed on its own, only the first and the last file
+		// may be treated as first or last track, respectively.
+
+		parallel::TaskPool pool { workers, affinity::pinning(placement()) };
+
+		for (const auto i : missing)
+		{
+			pool.submit([this,&audiofilenames,&results,i,
+					first = is_first(i),last = is_last(i)]
+				{
+					results[i] = std::make_unique<arcstk::ChecksumSet>(
+						calculate_file(audiofilenames[i], first, last,
+							digests_->empty() ? nullptr : &digests_->at(i),
+							md5_status_->empty()
+								? nullptr : &md5_status_->at(i)));
+				});
+		}
+
+		pool.wait();
+	}
+
+	if (cache())
+	{
+		for (const auto i : missing)
+		{
+			if (!is_stdin(audiofilenames[i]))
+			{
+				cache()->insert(keys[i], to_cache_value(*results[i]));
+			}
+		}
+	}
+
+	// Collect results in order of the input
+
+	auto checksums { Checksums { total_files } };
+
+	for (const auto& result : results)
+	{
+		checksums.append(*result);
+	}
+
+	return checksums;
+}
+
+
+arcstk::ChecksumSet ChecksumCalculator::calculate_file(
+		const std::string& audiofilename,
+		const bool is_first, const bool is_last,
+		digest::Digests* digests, MD5Status* md5) const
+{
+	if (is_stdin(audiofilename))
+	{
+		auto stream { pcm::open_sample_stream(std::cin) };
+
+		auto stream_digests {
+			make_digests(digest_types_, window_, digests ? 1 : 0) };
+
+		const auto [ sums, total_samples ] =
+			arcs::calculate_stream(*stream, { 0 }, is_first, is_last,
+					digests ? &stream_digests : nullptr, nullptr, engine());
+
+		if (digests)
+		{
+			*digests = stream_digests.front();
+		}
+
+		return to_checksum_set(sums.front(), total_samples, types());
+	}
+
+	const auto expiry { file_deadline(audiofilename) };
+	expiry.check();
+
+	// A reader explicitly requested by the user is always respected
+
+	auto reader { prefers_samples() && !audio_selection()
+		? deadline::guard(open_reader(audiofilename), expiry)
+		: nullptr };
+
+	if (!reader)
+	{
+		require_no_digests(digest_types_, window_, audiofilename);
+
+		const auto calculator { setup_calculator() };
+
+		return calculator->calculate(
+				std::vector<std::string>{ audiofilename }, is_first, is_last)
+			.at(0);
+	}
+
+	const auto counter {
+		file_progress(audiofilename, reader->total_samples()) };
+	reader = progress::track(std::move(reader), counter);
+
+	const auto declared_md5 { md5 ? reader->embedded_md5() : std::string{} };
+
+	if (!declared_md5.empty())
+	{
+		// Read the file in a single pass to update the MD5 along with the sums
+
+		auto track_digests {
+			make_digests(digest_types_, window_, digests ? 1 : 0) };
+		auto file_digests { digest::Digests { { digest::DigestType::MD5 } } };
+
+		const auto [ sums, total_samples ] =
+			arcs::calculate_stream(*reader, { 0 }, is_first, is_last,
+					digests ? &track_digests : nullptr, &file_digests,
+					engine());
+
+		if (digests)
+		{
+			*digests = track_digests.front();
+		}
+
+		*md5 = check_md5(audiofilename, declared_md5, file_digests);
+
+		return to_checksum_set(sums.front(), total_samples, types());
+	}
+
+	const auto total_samples { reader->total_samples() };
+
+	const auto check_from { is_first ? arcs::SKIP_FRONT + 1 : 1 };
+	const auto check_to   { !is_last ? total_samples
+		: (total_samples > arcs::SKIP_BACK
+			? total_samples - arcs::SKIP_BACK : 0) };
+
+	auto sums { arcs::ARCSAccumulator { 1, check_from, check_to, engine() } };
+
+	arcs::accumulate(*reader, 0, total_samples, sums, digests);
+
+	return to_checksum_set(sums, total_samples, types());
+}
+
+
+std::tuple<Checksums, ARId> ChecksumCalculator::calculate_image(
+		const std::string& audiofilename, const ToC& toc) const
+{
+	const auto total_tracks { static_cast<std::size_t>(toc.total_tracks()) };
+
+	*digests_ = make_digests(digest_types_, window_, total_tracks);
+	md5_status_->assign(checks_md5() ? total_tracks : 0,
+			MD5Status::UNCHECKED);
+
+	if (is_stdin(audiofilename))
+	{
+		return calculate_image_stream(toc);
+	}
+
+	if (!cache())
 	{
-		calculator.set_selection(audio_selection());
+		return calculate_image_uncached(audiofilename, toc);
 	}
 
-	return calculator;
+	// Look up the tracks in the cache
+
+	const auto file  { identify(*cache(), audiofilename) };
+	const auto hash  { toc_hash(toc) };
+	const auto mask  { type_mask(types()) };
+	const auto total { static_cast<std::size_t>(toc.total_tracks()) };
+
+	auto keys = std::vector<cache::CacheKey> {};
+	keys.reserve(total);
+
+	auto cached { Checksums { total } };
+
+	for (std::size_t t = 1; t <= total; ++t)
+	{
+		keys.push_back({ file, hash, static_cast<std::uint8_t>(t), mask,
+			key_flags(*cache(), cache::IMAGE
+				| (1 == t ? cache::FIRST_TRACK : 0)
+				| (total == t ? cache::LAST_TRACK : 0)) });
+
+		// Stop looking up at the first track not in cache, cached checksums
+		// have no digests and no MD5 checks
+
+		if (cached.size() + 1 == t && !requires_samples())
+		{
+			if (const auto value { cache()->find(keys.back()) })
+			{
+				cached.append(to_checksum_set(*value));
+			}
+		}
+	}
+
+	if (total > 0 && cached.size() == total)
+	{
+		ARCS_LOG_INFO << "Found all tracks of " << audiofilename << " in cache";
+
+		// Leadout of an incomplete ToC follows from the length of the last track
+
+		const auto arid { toc.complete()
+			? make_arid(toc)
+			: make_arid(toc, arcstk::AudioSize {
+					toc.offsets().back().frames()
+						+ static_cast<std::int32_t>(cached.at(total - 1).length()),
+					arcstk::AudioSize::UNIT::FRAMES }) };
+
+		return { cached, *arid };
+	}
+
+	const auto [ checksums, arid ] =
+		calculate_image_uncached(audiofilename, toc);
+
+	if (checksums.size() == total)
+	{
+		for (std::size_t i = 0; i < total; ++i)
+		{
+			cache()->insert(keys[i], to_cache_value(checksums.at(i)));
+		}
+	}
+
+	return { checksums, arid };
+}
+
+
+std::tuple<Checksums, ARId> ChecksumCalculator::calculate_image_uncached(
+		const std::string& audiofilename, const ToC& toc) const
+{
+	const auto workers { parallel::worker_count(threads()) };
+
+	const auto expiry { file_deadline(audiofilename) };
+	expiry.check();
+
+	// A reader explicitly requested by the user is always respected
+
+	auto reader { (workers > 1 || prefers_samples()) && !audio_selection()
+		? deadline::guard(open_reader(audiofilename), expiry)
+		: nullptr };
+
+	if (!reader)
+	{
+		require_no_digests(digest_types_, window_, audiofilename);
+
+		const auto calculator { setup_calculator() };
+
+		const auto [ checksums, arid ] =
+			calculator->calculate(audiofilename, toc);
+
+		return { checksums, arid };
+	}
+
+	// All readers of the file share its counter
+
+	const auto counter {
+		file_progress(audiofilename, reader->total_samples()) };
+	reader = progress::track(std::move(reader), counter);
+
+	const auto declared_md5 {
+		checks_md5() ? reader->embedded_md5() : std::string{} };
+
+	if (!declared_md5.empty())
+	{
+		ARCS_LOG_INFO << "Read " << audiofilename
+			<< " in a single pass to check its MD5";
+
+		auto file_digests { digest::Digests { { digest::DigestType::MD5 } } };
+
+		const auto offsets { sample_offsets(toc) };
+
+		const auto [ sums, total_samples ] =
+			arcs::calculate_stream(*reader, offsets, true, true,
+					digests_->empty() ? nullptr : digests_.get(),
+					&file_digests, engine());
+
+		md5_status_->assign(md5_status_->size(),
+				check_md5(audiofilename, declared_md5, file_digests));
+
+		const auto tracks { arcs::track_ranges(offsets, total_samples) };
+
+		return { to_checksums(sums, tracks, types()),
+			image_arid(toc, total_samples) };
+	}
+
+	ARCS_LOG_INFO << "Calculate tracks of " << audiofilename
+		<< " with " << workers << " threads";
+
+	// Track ranges from ToC
+
+	const auto total_samples { reader->total_samples() };
+	reader.reset();
+
+	const auto tracks { arcs::track_ranges(sample_offsets(toc), total_samples) };
+
+	const auto options { input_options() };
+
+	const auto sums { arcs::calculate_tracks(
+			[&audiofilename,&options,&expiry,&counter]{
+				return progress::track(deadline::guard(
+					pcm::open_sample_reader(audiofilename, options), expiry),
+					counter); },
+			tracks, workers, digests_->empty() ? nullptr : digests_.get(),
+			affinity::pinning(placement()), engine()) };
+
+	return { to_checksums(sums, tracks, types()),
+		image_arid(toc, total_samples) };
+}
+
+
+std::tuple<Checksums, ARId> ChecksumCalculator::calculate_image_stream(
+		const ToC& toc) const
+{
+	ARCS_LOG_INFO << "Calculate tracks from standard input in one pass";
+
+	const auto offsets { sample_offsets(toc) };
+
+	auto stream { pcm::open_sample_stream(std::cin) };
+
+	const auto [ sums, total_samples ] =
+		arcs::calculate_stream(*stream, offsets, true, true,
+				digests_->empty() ? nullptr : digests_.get(), nullptr,
+				engine());
+
+	const auto tracks { arcs::track_ranges(offsets, total_samples) };
+
+	return { to_checksums(sums, tracks, types()),
+		image_arid(toc, total_samples) };
+}
+
+
+bool ChecksumCalculator::requires_samples() const
+{
+	return !digest_types_.empty() || window_ > 0 || checks_md5();
+}
+
+
+bool ChecksumCalculator::prefers_samples() const
+{
+	return requires_samples() || !io::is_default(input_options_)
+		|| kernel::Engine::SCALAR != engine()
+		|| deadline_.is_set() || file_timeout_.count() > 0
+		|| nullptr != progress_;
+}
+
+
+deadline::Deadline ChecksumCalculator::file_deadline(
+		const std::string& audiofilename) const
+{
+	return deadline_.earliest(
+			deadline::Deadline { file_timeout_, audiofilename });
+}
+
+
+std::shared_ptr<progress::FileProgress> ChecksumCalculator::file_progress(
+		const std::string& audiofilename, const std::size_t total) const
+{
+	return progress_ ? progress_->start_file(audiofilename, total) : nullptr;
+}
+
+
+std::unique_ptr<pcm::SampleReader> ChecksumCalculator::open_reader(
+		const std::string& audiofilename) const
+{
+	const auto signature { selection::signature_of(audiofilename) };
+
+	if (selection_cache().find(signature) == selection::Decoder::LIBARCSDEC)
+	{
+		ARCS_LOG_DEBUG << "Read " << audiofilename << " by libarcsdec as "
+			"selected for " << signature;
+		return nullptr;
+	}
+
+	auto reader { pcm::open_sample_reader(audiofilename, input_options()) };
+
+	selection_cache().insert(signature, reader
+			? selection::Decoder::SAMPLE_READER
+			: selection::Decoder::LIBARCSDEC);
+
+	return reader;
+}
+
+
+selection::CalculatorLease ChecksumCalculator::setup_calculator() const
+{
+	return selection_cache().acquire(types(), audio_selection());
 }
 
 
@@ -10,6 +10,30 @@
 #ifndef __ARCSTOOLS_LAYOUTS_HPP__
 #include "layouts.hpp"                 // for Layout
 #endif
+#ifndef __ARCSTOOLS_TOOLS_AFFINITY_HPP__
+#include "tools-affinity.hpp"          // for Placement
+#endif
+#ifndef __ARCSTOOLS_TOOLS_DEADLINE_HPP__
+#include "tools-deadline.hpp"          // for Deadline
+#endif
+#ifndef __ARCSTOOLS_TOOLS_DIGEST_HPP__
+#include "tools-digest.hpp"            // for Digests, DigestType
+#endif
+#ifndef __ARCSTOOLS_TOOLS_IO_HPP__
+#include "tools-io.hpp"                // for InputOptions, StallCounters
+#endif
+#ifndef __ARCSTOOLS_TOOLS_KERNEL_HPP__
+#include "tools-kernel.hpp"            // for Engine
+#endif
+#ifndef __ARCSTOOLS_TOOLS_PCM_HPP__
+#include "tools-pcm.hpp"               // for Format
+#endif
+#ifndef __ARCSTOOLS_TOOLS_PROGRESS_HPP__
+#include "tools-progress.hpp"          // for Reporter, FileProgress
+#endif
+#ifndef __ARCSTOOLS_TOOLS_SELECTION_HPP__
+#include "tools-selection.hpp"         // for SelectionCache, CalculatorLease
+#endif
 
 #ifndef __LIBARCSDEC_SELECTION_HPP__
 #include <arcsdec/selection.hpp>       // FileReaderSelection
@@ -22,9 +46,12 @@
 #include <arcstk/calculate.hpp>        // for Checksums, checksum::type
 #endif
 
-#include <memory>      // for unique_ptr
+#include <chrono>      // for milliseconds
+#include <cstddef>     // for size_t
+#include <memory>      // for shared_ptr, unique_ptr
 #include <string>      // for string
 #include <tuple>       // for tuple
+#include <unordered_set> // for unordered_set
 #include <vector>      // for vector
 
 
@@ -43,6 +70,14 @@ namespace arcsapp
 {
 inline namespace v_1_0_0
 {
+namespace cache
+{
+class ChecksumCache;
+} // namespace cache
+namespace pcm
+{
+class SampleReader;
+} // namespace pcm
 
 /**
  * \brief Tools and helpers for managing AccurateRip checksums.
@@ -62,6 +97,12 @@ using arcsdec::ToCParser;
 using ChecksumTypeset = std::unordered_set<arcstk::checksum::type>;
 
 
+/**
+ * \brief Audio file name that denotes standard input.
+ */
+constexpr auto STDIN_FILENAME = "-";
+
+
 /**
  * \brief Analyze ToC for filenames and adjust file paths.
  */
@@ -123,6 +164,16 @@ struct ToCFiles final
 };
 
 
+/**
+ * \brief Offsets of the tracks of a ToC as sample indices.
+ *
+ * \param[in] toc The ToC to get the offsets from
+ *
+ * \return Index of the first sample of each track
+ */
+std::vector<std::size_t> sample_offsets(const ToC& toc);
+
+
 /**
  * \brief Create a selection for a specific FileReader Id.
  */
@@ -136,11 +187,35 @@ struct IdSelection final
 };
 
 
+/**
+ * \brief Result of checking the MD5 declared by an audio file.
+ */
+enum class MD5Status
+{
+	UNCHECKED, //!< The audio file declares no MD5 or was not read
+	MATCH,     //!< The MD5 of the samples matches the declared MD5
+	MISMATCH   //!< The MD5 of the samples differs from the declared MD5
+};
+
+
+/**
+ * \brief TRUE iff any MD5 check resulted in a mismatch.
+ *
+ * \param[in] md5_status Results of MD5 checks
+ *
+ * \return TRUE iff \c md5_status contains MD5Status::MISMATCH
+ */
+bool has_mismatch(const std::vector<MD5Status>& md5_status);
+
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Weffc++"
 
 /**
  * \brief Wrapper for ARCSCalculator to handle input with multiple audio files.
+ *
+ * An audio file named STDIN_FILENAME is read from standard input in a single
+ * pass. It may contain RIFF/WAV or raw CDDA samples and is never cached.
  */
 class ChecksumCalculator final
 {
@@ -209,6 +284,81 @@ public:
 			const bool first_is_first_track, const bool last_is_last_track)
 		const;
 
+	/**
+	 * \brief Check whether an album can be calculated without decoding it.
+	 *
+	 * Parses the metadata file and reads only the headers of the audio files.
+	 * Checks that every audio file is readable and its format is supported,
+	 * that the number of audio files matches the number of tracks and that a
+	 * single audio file is long enough to contain every track.
+	 *
+	 * The audio files are determined as in
+	 * calculate(const std::vector<std::string>&, const std::string&).
+	 *
+	 * \param[in] audiofilenames Name of the audio files
+	 * \param[in] metafilename   Name of the metadata file
+	 *
+	 * \return Description of each problem found, empty if none was found
+	 */
+	std::vector<std::string> probe(
+			const std::vector<std::string>& audiofilenames,
+			const std::string& metafilename) const;
+
+	/**
+	 * \brief Estimate the memory required to calculate an album.
+	 *
+	 * The estimate accounts for the reader of each audio file, as it follows
+	 * from the format and the size of the file and the input options, and for
+	 * the number of files or tracks calculated concurrently. The audio files
+	 * are not decoded.
+	 *
+	 * The audio files are determined as by audiofiles(), thus the metadata
+	 * file is only parsed if no audio files are passed. Callers that already
+	 * took them from the metadata file pass them to avoid parsing it again.
+	 * If they cannot be determined, a minimal estimate is returned and the
+	 * calculation is expected to report the problem.
+	 *
+	 * \param[in] audiofilenames Name of the audio files
+	 * \param[in] metafilename   Name of the metadata file
+	 *
+	 * \return Estimated memory in bytes
+	 */
+	std::size_t estimate_memory(
+			const std::vector<std::string>& audiofilenames,
+			const std::string& metafilename) const;
+
+	/**
+	 * \brief The audio files of an album.
+	 *
+	 * If no audio files are passed, they are the audio files referenced by
+	 * the metadata file, expanded relative to its location. Passing them to
+	 * calculate(const std::vector<std::string>&, const std::string&) yields
+	 * the same result as passing none.
+	 *
+	 * \param[in] audiofilenames Name of the audio files
+	 * \param[in] metafilename   Name of the metadata file
+	 *
+	 * \return The audio files calculated for the album
+	 *
+	 * \throws std::invalid_argument If the metadata file references multiple
+	 *                               audio files that are not pairwise distinct
+	 * \throws std::exception If the metadata file cannot be parsed
+	 */
+	std::vector<std::string> audiofiles(
+			const std::vector<std::string>& audiofilenames,
+			const std::string& metafilename) const;
+
+	/**
+	 * \brief The decoder that reads an audio file of an album.
+	 *
+	 * \param[in] format Format of the audio file
+	 * \param[in] files  Number of audio files of the album
+	 *
+	 * \return Decoder of the audio file with the current settings
+	 */
+	selection::Decoder decoder(const pcm::Format format,
+			const std::size_t files) const;
+
 	/**
 	 * \brief Set the checksum type to be calculated.
 	 *
@@ -223,6 +373,248 @@ public:
 	 */
 	ChecksumTypeset types() const;
 
+	/**
+	 * \brief Set the number of threads for calculation.
+	 *
+	 * If the input consists of multiple audio files, up to \c threads files
+	 * are decoded and checksummed concurrently. A value of 0 requests one
+	 * thread per hardware thread. The default is 1, which processes the
+	 * files sequentially.
+	 *
+	 * \param[in] threads Number of threads for calculation
+	 */
+	void set_threads(const std::size_t threads);
+
+	/**
+	 * \brief Number of threads for calculation.
+	 *
+	 * \return Number of threads for calculation
+	 */
+	std::size_t threads() const;
+
+	/**
+	 * \brief Set the placement of the threads for calculation.
+	 *
+	 * Unless the placement is affinity::Placement::NONE, each thread is
+	 * pinned to a CPU before it reads any samples. The default is
+	 * affinity::Placement::NONE.
+	 *
+	 * \param[in] placement Placement of the threads for calculation
+	 */
+	void set_placement(const affinity::Placement placement);
+
+	/**
+	 * \brief Placement of the threads for calculation.
+	 *
+	 * \return Placement of the threads for calculation
+	 */
+	affinity::Placement placement() const;
+
+	/**
+	 * \brief Set the engine for the samples read by this instance.
+	 *
+	 * An engine other than kernel::Engine::SCALAR reads the audio files
+	 * without libarcsdec where possible. Audio files that require libarcsdec
+	 * are still calculated by libarcstk. The default is
+	 * kernel::Engine::SCALAR.
+	 *
+	 * \param[in] engine Engine to update the sums
+	 */
+	void set_engine(const kernel::Engine engine);
+
+	/**
+	 * \brief Engine for the samples read by this instance.
+	 *
+	 * \return Engine to update the sums
+	 */
+	kernel::Engine engine() const;
+
+	/**
+	 * \brief Set the deadline for the calculations of this instance.
+	 *
+	 * The deadline is checked before each audio file and before each block
+	 * of samples. If it has passed, the calculation throws a
+	 * deadline::TimeoutException. Unless the deadline is not set, the audio
+	 * files are read without libarcsdec where possible since libarcsdec
+	 * cannot be interrupted within an audio file.
+	 *
+	 * \param[in] deadline Deadline for the calculations
+	 */
+	void set_deadline(const deadline::Deadline& deadline);
+
+	/**
+	 * \brief Deadline for the calculations of this instance.
+	 *
+	 * \return Deadline for the calculations
+	 */
+	const deadline::Deadline& deadline() const;
+
+	/**
+	 * \brief Set the timeout for each audio file.
+	 *
+	 * The timeout starts when the audio file is opened and is checked like
+	 * the deadline.
+	 *
+	 * \param[in] timeout Timeout for each audio file, 0 for none
+	 */
+	void set_file_timeout(const std::chrono::milliseconds timeout);
+
+	/**
+	 * \brief Timeout for each audio file.
+	 *
+	 * \return Timeout for each audio file, 0 for none
+	 */
+	std::chrono::milliseconds file_timeout() const;
+
+	/**
+	 * \brief Set the progress reporter for this instance.
+	 *
+	 * The samples read from each audio file are counted by the reporter.
+	 * Unless no reporter is set, the audio files are read without libarcsdec
+	 * where possible since libarcsdec does not report its progress within an
+	 * audio file.
+	 *
+	 * \param[in] progress Progress reporter, not owned, or \c nullptr
+	 */
+	void set_progress(progress::Reporter* progress);
+
+	/**
+	 * \brief Progress reporter of this instance.
+	 *
+	 * \return Progress reporter or \c nullptr
+	 */
+	progress::Reporter* progress() const;
+
+	/**
+	 * \brief Set the checksum cache for this instance.
+	 *
+	 * If a cache is set, the checksums of each track are looked up in the
+	 * cache before any audio file is read and the checksums calculated are
+	 * inserted. The cache is not owned by this instance.
+	 *
+	 * \param[in] cache The cache to use or \c nullptr for no cache
+	 */
+	void set_cache(cache::ChecksumCache* cache);
+
+	/**
+	 * \brief Get the checksum cache used by this instance.
+	 *
+	 * \return The cache used by this instance or \c nullptr
+	 */
+	cache::ChecksumCache* cache() const;
+
+	/**
+	 * \brief Set the options for reading audio files.
+	 *
+	 * If read-ahead or an I/O backend is requested, audio files that support
+	 * random access are read accordingly, e.g. by an I/O thread into a ring of
+	 * buffers while the calculation consumes the buffers already read. Other
+	 * audio files are processed by libarcsdec as usual.
+	 *
+	 * The counters of the options are ignored, the counters of this instance
+	 * are used instead.
+	 *
+	 * \param[in] options Options for reading audio files
+	 */
+	void set_input_options(const io::InputOptions& options);
+
+	/**
+	 * \brief Options for reading audio files.
+	 *
+	 * \return Options for reading audio files
+	 */
+	io::InputOptions input_options() const;
+
+	/**
+	 * \brief Stall counters of the read-ahead pipeline.
+	 *
+	 * The counters accumulate over all calculations of this instance.
+	 *
+	 * \return Stall counters of this instance
+	 */
+	const io::StallCounters& stall_counters() const;
+
+	/**
+	 * \brief Set the digests to calculate along with the checksums.
+	 *
+	 * Digests are calculated from the samples read for the checksums, thus
+	 * they require an audio file that can be read without libarcsdec, i.e.
+	 * RIFF/WAV or FLAC. If digests are requested, the cache is not looked up
+	 * since it does not contain any digests.
+	 *
+	 * \param[in] types The digest types to calculate
+	 */
+	void set_digests(const std::vector<digest::DigestType>& types);
+
+	/**
+	 * \brief The digests to calculate along with the checksums.
+	 *
+	 * \return The digest types to calculate
+	 */
+	const std::vector<digest::DigestType>& digest_types() const;
+
+	/**
+	 * \brief Digests of the last calculation.
+	 *
+	 * The digests have the same order as the checksums of the last
+	 * calculation. If neither digests nor windows are requested, the result
+	 * is empty.
+	 *
+	 * \return Digests of the last calculation
+	 */
+	const std::vector<digest::Digests>& digests() const;
+
+	/**
+	 * \brief Set the number of samples per window.
+	 *
+	 * If set, the CRC32 of each window of each track is calculated along with
+	 * the checksums and provided by the digests(). Windows have the same
+	 * requirements as digests.
+	 *
+	 * \param[in] samples Number of samples per window, 0 for no windows
+	 */
+	void set_window(const std::size_t samples);
+
+	/**
+	 * \brief Number of samples per window.
+	 *
+	 * \return Number of samples per window, 0 if no windows are calculated
+	 */
+	std::size_t window() const;
+
+	/**
+	 * \brief Set whether to check the MD5 declared by the audio files.
+	 *
+	 * If activated, the MD5 of all samples of each audio file that declares
+	 * an MD5, e.g. a FLAC file, is calculated along with the checksums and
+	 * compared to the declared value. Since the MD5 requires the samples in
+	 * order, an audio file containing multiple tracks is then processed in a
+	 * single sequential pass. The cache is not looked up since it contains no
+	 * results of the check.
+	 *
+	 * \param[in] check TRUE to check the declared MD5s
+	 */
+	void set_check_md5(const bool check);
+
+	/**
+	 * \brief TRUE iff the MD5 declared by the audio files is checked.
+	 *
+	 * \return TRUE iff the declared MD5s are checked
+	 */
+	bool checks_md5() const;
+
+	/**
+	 * \brief Results of the MD5 checks of the last calculation.
+	 *
+	 * The results have the same order as the checksums of the last
+	 * calculation, thus each track of an audio file with multiple tracks has
+	 * the result of its audio file. If the MD5s are not checked, the result is
+	 * empty.
+	 *
+	 * \return Result of the MD5 check for each track
+	 */
+	const std::vector<MD5Status>& md5_status() const;
+
 	/**
 	 * \brief Get the FileReaderSelection used by this instance.
 	 *
@@ -251,6 +643,25 @@ public:
 	 */
 	void set_toc_selection(FileReaderSelection* selection);
 
+	/**
+	 * \brief Set the cache for reader selections and calculators.
+	 *
+	 * Audio files with the same signature are read by the reader that was
+	 * selected for the first of them and ARCSCalculators are reused. Without
+	 * a cache set, this instance uses a cache of its own, which applies only
+	 * to its own calculations.
+	 *
+	 * \param[in] cache Cache to share, \c nullptr for a cache of its own
+	 */
+	void set_selection_cache(selection::SelectionCache* cache);
+
+	/**
+	 * \brief The cache for reader selections and calculators.
+	 *
+	 * \return The cache used by this instance
+	 */
+	selection::SelectionCache& selection_cache() const;
+
 private:
 
 	/**
@@ -267,11 +678,136 @@ private:
 			std::unique_ptr<ToC> toc, const std::string& searchpath) const;
 
 	/**
-	 * \brief Setup internal ARCSCalculator instance.
+	 * \brief Calculate ARCSs for a sequence of audio files, one per track.
+	 *
+	 * If more than one thread is configured, the files are processed
+	 * concurrently. If a cache is set, only the files not in the cache are
+	 * processed. The result is in the order of \c audiofilenames in any case.
+	 *
+	 * \param[in] audiofilenames       Names of the audiofiles
+	 * \param[in] first_is_first_track Declare first file as first track
+	 * \param[in] last_is_last_track   Declare last file as last track
+	 *
+	 * \return The AccurateRip checksums of these tracks
+	 */
+	Checksums calculate_files(const std::vector<std::string>& audiofilenames,
+			const bool first_is_first_track, const bool last_is_last_track)
+		const;
+
+	/**
+	 * \brief Calculate ARCSs for a single audio file containing one track.
+	 *
+	 * \param[in] audiofilename Name of the audio file
+	 * \param[in] is_first      Declare file as first track
+	 * \param[in] is_last       Declare file as last track
+	 * \param[in] digests       Digests to update or \c nullptr
+	 * \param[in] md5           Result of the MD5 check or \c nullptr
+	 *
+	 * \return The AccurateRip checksums of the track
+	 */
+	arcstk::ChecksumSet calculate_file(const std::string& audiofilename,
+			const bool is_first, const bool is_last,
+			digest::Digests* digests, MD5Status* md5) const;
+
+	/**
+	 * \brief Calculate ARCSs for a single audio file containing all tracks.
+	 *
+	 * If a cache is set and contains all tracks, the audio file is not read.
+	 *
+	 * \param[in] audiofilename Name of the audio file
+	 * \param[in] toc           ToC of the album
+	 *
+	 * \return The AccurateRip checksums and the ARId of the album
+	 */
+	std::tuple<Checksums, ARId> calculate_image(
+			const std::string& audiofilename, const ToC& toc) const;
+
+	/**
+	 * \brief Calculate ARCSs for a single audio file by reading it.
+	 *
+	 * If more than one thread is configured and the audio file supports random
+	 * access, the tracks are split in ranges that are processed concurrently.
+	 * Otherwise, the audio file is processed sequentially by libarcsdec.
+	 *
+	 * \param[in] audiofilename Name of the audio file
+	 * \param[in] toc           ToC of the album
+	 *
+	 * \return The AccurateRip checksums and the ARId of the album
+	 */
+	std::tuple<Checksums, ARId> calculate_image_uncached(
+			const std::string& audiofilename, const ToC& toc) const;
+
+	/**
+	 * \brief Calculate ARCSs for an album streamed on standard input.
+	 *
+	 * \param[in] toc ToC of the album
+	 *
+	 * \return The AccurateRip checksums and the ARId of the album
+	 */
+	std::tuple<Checksums, ARId> calculate_image_stream(const ToC& toc) const;
+
+	/**
+	 * \brief TRUE iff the samples must be read by this instance.
+	 *
+	 * Digests, windows and MD5 checks require the samples, which are not
+	 * accessible when an audio file is read by libarcsdec.
+	 *
+	 * \return TRUE iff digests, windows or MD5 checks are requested
+	 */
+	bool requires_samples() const;
+
+	/**
+	 * \brief TRUE iff the samples are to be read by this instance.
+	 *
+	 * Besides the requirements of requires_samples(), non-default input
+	 * options, an engine other than kernel::Engine::SCALAR, deadlines and
+	 * progress reporting require to read the samples without libarcsdec if
+	 * possible.
+	 *
+	 * \return TRUE iff audio files are preferably read by a SampleReader
+	 */
+	bool prefers_samples() const;
+
+	/**
+	 * \brief Deadline for an audio file.
+	 *
+	 * \param[in] audiofilename Name of the audio file
+	 *
+	 * \return The earlier of the deadline and the timeout for the file
+	 */
+	deadline::Deadline file_deadline(const std::string& audiofilename) const;
+
+	/**
+	 * \brief Start to count the samples of an audio file.
+	 *
+	 * \param[in] audiofilename Name of the audio file
+	 * \param[in] total         Total number of samples of the audio file
+	 *
+	 * \return Counter of the samples or \c nullptr if no reporter is set
+	 */
+	std::shared_ptr<progress::FileProgress> file_progress(
+			const std::string& audiofilename, const std::size_t total) const;
+
+	/**
+	 * \brief Open a SampleReader unless libarcsdec was selected before.
+	 *
+	 * If a file with the same signature was not readable by a SampleReader,
+	 * no SampleReader is opened. Otherwise, the outcome is remembered for
+	 * the signature.
+	 *
+	 * \param[in] audiofilename Name of the audio file
+	 *
+	 * \return SampleReader for the file or \c nullptr
+	 */
+	std::unique_ptr<pcm::SampleReader> open_reader(
+			const std::string& audiofilename) const;
+
+	/**
+	 * \brief Borrow an ARCSCalculator from the selection cache.
 	 *
 	 * \return ARCSCalculator to perform the calculations
 	 */
-	ARCSCalculator setup_calculator() const;
+	selection::CalculatorLease setup_calculator() const;
 
 	/**
 	 * \brief Setup internal ToCParser instance.
@@ -285,6 +821,76 @@ private:
 	 */
 	ChecksumTypeset types_;
 
+	/**
+	 * \brief Number of threads for calculation.
+	 */
+	std::size_t threads_;
+
+	/**
+	 * \brief Placement of the threads for calculation.
+	 */
+	affinity::Placement placement_;
+
+	/**
+	 * \brief Engine to update the sums.
+	 */
+	kernel::Engine engine_;
+
+	/**
+	 * \brief Deadline for the calculations.
+	 */
+	deadline::Deadline deadline_;
+
+	/**
+	 * \brief Timeout for each audio file.
+	 */
+	std::chrono::milliseconds file_timeout_;
+
+	/**
+	 * \brief Progress reporter, not owned.
+	 */
+	progress::Reporter* progress_;
+
+	/**
+	 * \brief Checksum cache, not owned.
+	 */
+	cache::ChecksumCache* cache_;
+
+	/**
+	 * \brief Options for reading audio files.
+	 */
+	io::InputOptions input_options_;
+
+	/**
+	 * \brief Stall counters of the read-ahead pipeline.
+	 */
+	std::unique_ptr<io::StallCounters> stall_counters_;
+
+	/**
+	 * \brief Digest types to calculate.
+	 */
+	std::vector<digest::DigestType> digest_types_;
+
+	/**
+	 * \brief Digests of the last calculation.
+	 */
+	std::unique_ptr<std::vector<digest::Digests>> digests_;
+
+	/**
+	 * \brief Number of samples per window.
+	 */
+	std::size_t window_;
+
+	/**
+	 * \brief TRUE iff the declared MD5s are checked.
+	 */
+	bool check_md5_;
+
+	/**
+	 * \brief Results of the MD5 checks of the last calculation.
+	 */
+	std::unique_ptr<std::vector<MD5Status>> md5_status_;
+
 	/**
 	 * \brief Internal Audio reader selection.
 	 */
@@ -294,6 +900,16 @@ private:
 	 * \brief Internal ToC parser selection.
 	 */
 	FileReaderSelection* toc_selection_;
+
+	/**
+	 * \brief Selection cache of this instance.
+	 */
+	std::unique_ptr<selection::SelectionCache> own_selections_;
+
+	/**
+	 * \brief Selection cache in use, not owned.
+	 */
+	selection::SelectionCache* selections_;
 };
 
 #pragma GCC diagnostic pop
@@ -0,0 +1,168 @@
+/**
+ * \file tools-deadline.cpp Deadlines for calculations
+ */
+
+#ifndef __ARCSTOOLS_TOOLS_DEADLINE_HPP__
+#include "tools-deadline.hpp"
+#endif
+
+#include <utility>     // for move
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+namespace deadline
+{
+
+namespace
+{
+
+/**
+ * \brief SampleReader that checks a deadline before each read.
+ */
+class DeadlineReader final : public pcm::SampleReader
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] reader   The reader to wrap
+	 * \param[in] deadline The deadline to check
+	 */
+	DeadlineReader(std::unique_ptr<pcm::SampleReader> reader,
+			const Deadline& deadline);
+
+private:
+
+	std::size_t do_total_samples() const final;
+
+	std::size_t do_read(const std::size_t first, const std::size_t count,
+			pcm::Sample* buffer) final;
+
+	std::string do_embedded_md5() const final;
+
+	/**
+	 * \brief The wrapped reader.
+	 */
+	std::unique_ptr<pcm::SampleReader> reader_;
+
+	/**
+	 * \brief The deadline to check.
+	 */
+	Deadline deadline_;
+};
+
+
+DeadlineReader::DeadlineReader(std::unique_ptr<pcm::SampleReader> reader,
+		const Deadline& deadline)
+	: reader_   { std::move(reader) }
+	, deadline_ { deadline }
+{
+	// empty
+}
+
+
+std::size_t DeadlineReader::do_total_samples() const
+{
+	return reader_->total_samples();
+}
+
+
+std::size_t DeadlineReader::do_read(const std::size_t first,
+		const std::size_t count, pcm::Sample* buffer)
+{
+	deadline_.check();
+
+	return reader_->read(first, count, buffer);
+}
+
+
+std::string DeadlineReader::do_embedded_md5() const
+{
+	return reader_->embedded_md5();
+}
+
+} // namespace
+
+
+// TimeoutException
+
+
+TimeoutException::TimeoutException(const std::string& what_arg)
+	: std::runtime_error { what_arg }
+{
+	// empty
+}
+
+
+// Deadline
+
+
+Deadline::Deadline()
+	: timeout_ { 0 }
+	, expiry_  { Clock::time_point::max() }
+	, subject_ { /* empty */ }
+{
+	// empty
+}
+
+
+Deadline::Deadline(const std::chrono::milliseconds timeout,
+		const std::string& subject)
+	: timeout_ { timeout }
+	, expiry_  { timeout.count() > 0
+		? Clock::now() + timeout : Clock::time_point::max() }
+	, subject_ { subject }
+{
+	// empty
+}
+
+
+bool Deadline::is_set() const
+{
+	return expiry_ != Clock::time_point::max();
+}
+
+
+bool Deadline::expired() const
+{
+	return is_set() && Clock::now() >= expiry_;
+}
+
+
+void Deadline::check() const
+{
+	if (expired())
+	{
+		throw TimeoutException("Timeout after "
+				+ std::to_string(timeout_.count()) + " ms: " + subject_);
+	}
+}
+
+
+const Deadline& Deadline::earliest(const Deadline& other) const
+{
+	return other.expiry_ < expiry_ ? other : *this;
+}
+
+
+// guard
+
+
+std::unique_ptr<pcm::SampleReader> guard(
+		std::unique_ptr<pcm::SampleReader> reader, const Deadline& deadline)
+{
+	if (!reader || !deadline.is_set())
+	{
+		return reader;
+	}
+
+	return std::make_unique<DeadlineReader>(std::move(reader), deadline);
+}
+
+} // namespace deadline
+} // namespace v_1_0_0
+} // namespace arcsapp
+
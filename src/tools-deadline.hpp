@@ -0,0 +1,145 @@
+#ifndef __ARCSTOOLS_TOOLS_DEADLINE_HPP__
+#define __ARCSTOOLS_TOOLS_DEADLINE_HPP__
+
+/**
+ * \file
+ *
+ * \brief Deadlines for calculations, checked between blocks of samples.
+ */
+
+#include <chrono>      // for milliseconds, steady_clock
+#include <cstddef>     // for size_t
+#include <memory>      // for unique_ptr
+#include <stdexcept>   // for runtime_error
+#include <string>      // for string
+
+#ifndef __ARCSTOOLS_TOOLS_PCM_HPP__
+#include "tools-pcm.hpp"      // for Sample, SampleReader
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+
+/**
+ * \brief Tools and helpers for cancelling calculations that take too long.
+ *
+ * Cancellation is cooperative: a calculation checks its deadline before it
+ * reads the next block of samples and stops with a TimeoutException once the
+ * deadline has passed. A read that blocks, e.g. on a stalled network mount,
+ * is not interrupted, the deadline takes effect when the read returns.
+ */
+namespace deadline
+{
+
+/**
+ * \brief Clock of the deadlines.
+ */
+using Clock = std::chrono::steady_clock;
+
+
+/**
+ * \brief Reports a calculation that passed its deadline.
+ */
+class TimeoutException final : public std::runtime_error
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] what_arg What message
+	 */
+	explicit TimeoutException(const std::string& what_arg);
+};
+
+
+/**
+ * \brief Point in time after which a calculation is cancelled.
+ */
+class Deadline final
+{
+public:
+
+	/**
+	 * \brief Constructor for a deadline that never passes.
+	 */
+	Deadline();
+
+	/**
+	 * \brief Constructor for a deadline after a timeout from now.
+	 *
+	 * \param[in] timeout Time from now, 0 for a deadline that never passes
+	 * \param[in] subject What is cancelled, used in the message
+	 */
+	Deadline(const std::chrono::milliseconds timeout,
+			const std::string& subject);
+
+	/**
+	 * \brief TRUE iff this deadline can pass.
+	 *
+	 * \return TRUE iff a timeout is set
+	 */
+	bool is_set() const;
+
+	/**
+	 * \brief TRUE iff this deadline has passed.
+	 *
+	 * \return TRUE iff the timeout is set and expired
+	 */
+	bool expired() const;
+
+	/**
+	 * \brief Throw if this deadline has passed.
+	 *
+	 * \throws TimeoutException If the deadline has passed
+	 */
+	void check() const;
+
+	/**
+	 * \brief The earlier of this and another deadline.
+	 *
+	 * \param[in] other Another deadline
+	 *
+	 * \return The deadline that passes first
+	 */
+	const Deadline& earliest(const Deadline& other) const;
+
+private:
+
+	/**
+	 * \brief Timeout the deadline was created with.
+	 */
+	std::chrono::milliseconds timeout_;
+
+	/**
+	 * \brief Point in time the deadline passes.
+	 */
+	Clock::time_point expiry_;
+
+	/**
+	 * \brief What is cancelled.
+	 */
+	std::string subject_;
+};
+
+
+/**
+ * \brief Wrap a SampleReader to check a deadline before each read.
+ *
+ * \param[in] reader   The reader to wrap, may be \c nullptr
+ * \param[in] deadline The deadline to check
+ *
+ * \return Wrapped reader, \c reader itself if it is \c nullptr or the
+ * deadline is not set
+ */
+std::unique_ptr<pcm::SampleReader> guard(
+		std::unique_ptr<pcm::SampleReader> reader, const Deadline& deadline);
+
+} // namespace deadline
+} // namespace v_1_0_0
+} // namespace arcsapp
+
+#endif
+
@@ -0,0 +1,154 @@
+/**
+ * \file tools-device.cpp Storage devices of input files
+ */
+
+#ifndef __ARCSTOOLS_TOOLS_DEVICE_HPP__
+#include "tools-device.hpp"
+#endif
+
+#include <fstream>     // for ifstream
+#include <mutex>       // for lock_guard
+#include <string>      // for string, to_string
+
+#include <sys/stat.h>       // for stat
+#include <sys/sysmacros.h>  // for major, minor
+
+#ifndef __LIBARCSTK_LOGGING_HPP__
+#include <arcstk/logging.hpp>
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+namespace device
+{
+
+namespace
+{
+
+/**
+ * \brief Read the rotational attribute of a block device in sysfs.
+ *
+ * \return Medium as declared by the attribute, Medium::UNKNOWN if missing
+ */
+Medium read_rotational(const std::string& filename)
+{
+	auto in = std::ifstream { filename };
+	auto value = char { 0 };
+
+	if (!(in >> value))
+	{
+		return Medium::UNKNOWN;
+	}
+
+	return '0' == value ? Medium::SOLID_STATE : Medium::ROTATIONAL;
+}
+
+} // namespace
+
+
+std::string name(const Medium medium)
+{
+	switch (medium)
+	{
+		case Medium::ROTATIONAL:  return "rotational";
+		case Medium::SOLID_STATE: return "solid state";
+		default:                  return "unknown";
+	}
+}
+
+
+DeviceId device_of(const std::string& filename)
+{
+	struct stat status {};
+
+	if (::stat(filename.c_str(), &status) != 0)
+	{
+		return UNKNOWN_DEVICE;
+	}
+
+	return status.st_dev;
+}
+
+
+Medium medium_of(const DeviceId device)
+{
+	if (UNKNOWN_DEVICE == device)
+	{
+		return Medium::UNKNOWN;
+	}
+
+	const auto dev { static_cast<dev_t>(device) };
+	const auto sysfs { "/sys/dev/block/" + std::to_string(major(dev)) + ":"
+		+ std::to_string(minor(dev)) };
+
+	// A partition has no queue of its own, its disk has
+
+	const auto medium { read_rotational(sysfs + "/queue/rotational") };
+
+	return Medium::UNKNOWN != medium
+		? medium
+		: read_rotational(sysfs + "/../queue/rotational");
+}
+
+
+// ReaderLimits
+
+
+ReaderLimits::ReaderLimits()
+	: fixed_    { 0 }
+	, is_fixed_ { false }
+	, limits_   { /* empty */ }
+	, mutex_    { /* default */ }
+{
+	// empty
+}
+
+
+ReaderLimits::ReaderLimits(const std::size_t readers)
+	: fixed_    { readers }
+	, is_fixed_ { true }
+	, limits_   { /* empty */ }
+	, mutex_    { /* default */ }
+{
+	// empty
+}
+
+
+std::size_t ReaderLimits::readers(const DeviceId device)
+{
+	if (is_fixed_)
+	{
+		return fixed_;
+	}
+
+	const std::lock_guard<std::mutex> lock(mutex_);
+
+	const auto limit { limits_.find(device) };
+
+	if (limit != limits_.end())
+	{
+		return limit->second;
+	}
+
+	const auto medium { medium_of(device) };
+	const auto readers {
+		Medium::ROTATIONAL  == medium ? ROTATIONAL_READERS  :
+		Medium::SOLID_STATE == medium ? SOLID_STATE_READERS : 0 };
+
+	ARCS_LOG_INFO << "Device " << major(static_cast<dev_t>(device)) << ":"
+		<< minor(static_cast<dev_t>(device)) << " is " << name(medium)
+		<< ", read "
+		<< (readers > 0 ? std::to_string(readers) : "any number of")
+		<< " albums at once";
+
+	limits_.emplace(device, readers);
+
+	return readers;
+}
+
+} // namespace device
+} // namespace v_1_0_0
+} // namespace arcsapp
+
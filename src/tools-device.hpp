@@ -0,0 +1,164 @@
+#ifndef __ARCSTOOLS_TOOLS_DEVICE_HPP__
+#define __ARCSTOOLS_TOOLS_DEVICE_HPP__
+
+/**
+ * \file
+ *
+ * \brief Storage devices of input files.
+ */
+
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint64_t
+#include <map>         // for map
+#include <mutex>       // for mutex
+#include <string>      // for string
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+
+/**
+ * \brief Tools and helpers for scheduling reads by storage device.
+ */
+namespace device
+{
+
+/**
+ * \brief Identifier of a storage device as reported by stat() in st_dev.
+ */
+using DeviceId = std::uint64_t;
+
+
+/**
+ * \brief Device of files that cannot be accessed.
+ */
+constexpr DeviceId UNKNOWN_DEVICE = 0;
+
+
+/**
+ * \brief Default number of readers at once on a rotational device.
+ *
+ * Concurrent sequential readers make the heads of a disk seek between the
+ * files, thus a single reader yields the highest throughput.
+ */
+constexpr std::size_t ROTATIONAL_READERS = 1;
+
+
+/**
+ * \brief Default number of readers at once on a solid state device.
+ */
+constexpr std::size_t SOLID_STATE_READERS = 4;
+
+
+/**
+ * \brief Kinds of storage media.
+ */
+enum class Medium
+{
+	ROTATIONAL,  //!< Hard disk or a device containing one
+	SOLID_STATE, //!< SSD, NVMe or another device without seek time
+	UNKNOWN      //!< No block device, e.g. a network share or tmpfs
+};
+
+
+/**
+ * \brief Name of a medium.
+ *
+ * \param[in] medium The medium to get the name for
+ *
+ * \return Name of \c medium
+ */
+std::string name(const Medium medium);
+
+
+/**
+ * \brief Device of the file system containing the specified file.
+ *
+ * \param[in] filename Name of the file
+ *
+ * \return Device of \c filename, UNKNOWN_DEVICE if it cannot be accessed
+ */
+DeviceId device_of(const std::string& filename);
+
+
+/**
+ * \brief Medium of a device as reported by the kernel.
+ *
+ * The medium is read from the 'queue/rotational' attribute of the device in
+ * /sys/dev/block. For a partition, the attribute of its disk is read.
+ *
+ * \param[in] device The device
+ *
+ * \return Medium of \c device, Medium::UNKNOWN if it is not a block device
+ * or not on Linux
+ */
+Medium medium_of(const DeviceId device);
+
+
+/**
+ * \brief Number of readers at once on each device.
+ *
+ * Each limit is determined from the medium of the device and cached. The
+ * limits can be requested from multiple threads.
+ */
+class ReaderLimits final
+{
+public:
+
+	/**
+	 * \brief Constructor for the default limits.
+	 *
+	 * Rotational devices are limited to ROTATIONAL_READERS, solid state
+	 * devices to SOLID_STATE_READERS, other devices are not limited.
+	 */
+	ReaderLimits();
+
+	/**
+	 * \brief Constructor for the same limit on every device.
+	 *
+	 * \param[in] readers Number of readers per device, 0 for no limit
+	 */
+	explicit ReaderLimits(const std::size_t readers);
+
+	ReaderLimits(const ReaderLimits&) = delete;
+	ReaderLimits& operator=(const ReaderLimits&) = delete;
+
+	/**
+	 * \brief Number of readers at once on the specified device.
+	 *
+	 * \param[in] device The device
+	 *
+	 * \return Number of readers, 0 for no limit
+	 */
+	std::size_t readers(const DeviceId device);
+
+private:
+
+	/**
+	 * \brief Same limit for every device, if set.
+	 */
+	const std::size_t fixed_;
+
+	/**
+	 * \brief TRUE iff the same limit applies to every device.
+	 */
+	const bool is_fixed_;
+
+	/**
+	 * \brief Limits determined so far.
+	 */
+	std::map<DeviceId, std::size_t> limits_;
+
+	/**
+	 * \brief Guard for the limits.
+	 */
+	std::mutex mutex_;
+};
+
+} // namespace device
+} // namespace v_1_0_0
+} // namespace arcsapp
+
+#endif
+
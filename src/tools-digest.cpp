@@ -0,0 +1,581 @@
+/**
+ * \file tools-digest.cpp Digests of tracks calculated along with the ARCSs
+ */
+
+#ifndef __ARCSTOOLS_TOOLS_DIGEST_HPP__
+#include "tools-digest.hpp"
+#endif
+
+#include <algorithm>   // for find, min
+#include <cstring>     // for memcpy
+#include <iomanip>     // for setfill, setw
+#include <sstream>     // for ostringstream, istringstream
+#include <stdexcept>   // for invalid_argument
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+namespace digest
+{
+
+namespace
+{
+
+/**
+ * \brief Number of samples to convert to bytes at once.
+ */
+constexpr std::size_t CONVERT_SAMPLES = 1024;
+
+
+/**
+ * \brief Create the lookup table for the reflected CRC32 polynomial.
+ */
+constexpr std::array<std::uint32_t, 256> make_crc32_table()
+{
+	auto table = std::array<std::uint32_t, 256> {};
+
+	for (std::uint32_t i = 0; i < 256; ++i)
+	{
+		auto c = i;
+
+		for (int k = 0; k < 8; ++k)
+		{
+			c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+		}
+
+		table[i] = c;
+	}
+
+	return table;
+}
+
+
+/**
+ * \brief Lookup table for CRC32.
+ */
+constexpr auto CRC32_TABLE { make_crc32_table() };
+
+
+/**
+ * \brief Per-round shift amounts of MD5.
+ */
+constexpr std::array<std::uint32_t, 64> MD5_SHIFTS {
+	7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+	5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20,
+	4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+	6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+};
+
+
+/**
+ * \brief Per-round constants of MD5.
+ */
+constexpr std::array<std::uint32_t, 64> MD5_CONSTANTS {
+	0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee,
+	0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+	0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be,
+	0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+	0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa,
+	0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+	0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed,
+	0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+	0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c,
+	0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+	0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05,
+	0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+	0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039,
+	0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+	0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
+	0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+};
+
+
+/**
+ * \brief Rotate left.
+ */
+std::uint32_t rotate_left(const std::uint32_t x, const std::uint32_t n)
+{
+	return (x << n) | (x >> (32 - n));
+}
+
+} // namespace
+
+
+// to_type
+
+
+DigestType to_type(const std::string& name)
+{
+	if ("crc32" == name)
+	{
+		return DigestType::CRC32;
+	}
+
+	if ("crc32-nosilence" == name)
+	{
+		return DigestType::CRC32_NOSILENCE;
+	}
+
+	if ("ctdb" == name)
+	{
+		return DigestType::CTDB;
+	}
+
+	if ("md5" == name)
+	{
+		return DigestType::MD5;
+	}
+
+	throw std::invalid_argument("Unknown digest '" + name
+			+ "', expected 'crc32', 'crc32-nosilence', 'ctdb' or 'md5'");
+}
+
+
+// name
+
+
+std::string name(const DigestType type)
+{
+	switch (type)
+	{
+		case DigestType::CRC32_NOSILENCE: return "crc32-nosilence";
+		case DigestType::CTDB:            return "ctdb";
+		case DigestType::MD5:             return "md5";
+		default:                          return "crc32";
+	}
+}
+
+
+// to_types
+
+
+std::vector<DigestType> to_types(const std::string& names)
+{
+	auto types = std::vector<DigestType> {};
+
+	auto in = std::istringstream { names };
+	auto token = std::string {};
+
+	while (std::getline(in, token, ','))
+	{
+		const auto type { to_type(token) };
+
+		if (std::find(types.begin(), types.end(), type) == types.end())
+		{
+			types.push_back(type);
+		}
+	}
+
+	return types;
+}
+
+
+// to_hex
+
+
+std::string to_hex(const std::array<std::uint8_t, 16>& md5)
+{
+	auto out = std::ostringstream {};
+
+	for (const auto byte : md5)
+	{
+		out << std::hex << std::nouppercase << std::setw(2)
+			<< std::setfill('0') << static_cast<unsigned>(byte);
+	}
+
+	return out.str();
+}
+
+
+// CRC32
+
+
+CRC32::CRC32()
+	: crc_ { 0xFFFFFFFF }
+{
+	// empty
+}
+
+
+void CRC32::update(const std::uint8_t* bytes, const std::size_t count)
+{
+	auto crc { crc_ };
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		crc = CRC32_TABLE[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+	}
+
+	crc_ = crc;
+}
+
+
+std::uint32_t CRC32::value() const
+{
+	return crc_ ^ 0xFFFFFFFF;
+}
+
+
+// MD5
+
+
+MD5::MD5()
+	: state_ { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 }
+	, block_ {}
+	, total_bytes_ { 0 }
+{
+	// empty
+}
+
+
+void MD5::update(const std::uint8_t* bytes, const std::size_t count)
+{
+	auto done = std::size_t { 0 };
+	auto used { total_bytes_ % 64 };
+
+	total_bytes_ += count;
+
+	// Complete a pending block
+
+	if (used > 0)
+	{
+		const auto n { std::min(count, 64 - used) };
+
+		std::memcpy(block_.data() + used, bytes, n);
+		done += n;
+		used += n;
+
+		if (used < 64)
+		{
+			return;
+		}
+
+		process(block_.data());
+	}
+
+	for (; done + 64 <= count; done += 64)
+	{
+		process(bytes + done);
+	}
+
+	std::memcpy(block_.data(), bytes + done, count - done);
+}
+
+
+std::array<std::uint8_t, 16> MD5::value() const
+{
+	auto final_md5 { *this };
+
+	// Padding: a single 1 bit, zeros up to 56 bytes modulo 64, bit length
+
+	const auto bits { total_bytes_ * 8 };
+	const auto used { total_bytes_ % 64 };
+
+	auto padding = std::array<std::uint8_t, 72> {};
+	padding[0] = 0x80;
+
+	const auto padding_size { used < 56 ? 56 - used : 120 - used };
+
+	for (std::size_t i = 0; i < 8; ++i)
+	{
+		padding[padding_size + i] = static_cast<std::uint8_t>(bits >> (8 * i));
+	}
+
+	final_md5.update(padding.data(), padding_size + 8);
+
+	auto result = std::array<std::uint8_t, 16> {};
+
+	for (std::size_t i = 0; i < 16; ++i)
+	{
+		result[i] = static_cast<std::uint8_t>(
+				final_md5.state_[i / 4] >> (8 * (i % 4)));
+	}
+
+	return result;
+}
+
+
+void MD5::process(const std::uint8_t* block)
+{
+	auto m = std::array<std::uint32_t, 16> {};
+
+	for (std::size_t i = 0; i < 16; ++i)
+	{
+		m[i] = std::uint32_t { block[4 * i] }
+			| std::uint32_t { block[4 * i + 1] } << 8
+			| std::uint32_t { block[4 * i + 2] } << 16
+			| std::uint32_t { block[4 * i + 3] } << 24;
+	}
+
+	auto a { state_[0] };
+	auto b { state_[1] };
+	auto c { state_[2] };
+	auto d { state_[3] };
+
+	for (std::uint32_t i = 0; i < 64; ++i)
+	{
+		auto f = std::uint32_t { 0 };
+		auto g = std::uint32_t { 0 };
+
+		if (i < 16)
+		{
+			f = (b & c) | (~b & d);
+			g = i;
+		} else if (i < 32)
+		{
+			f = (d & b) | (~d & c);
+			g = (5 * i + 1) % 16;
+		} else if (i < 48)
+		{
+			f = b ^ c ^ d;
+			g = (3 * i + 5) % 16;
+		} else
+		{
+			f = c ^ (b | ~d);
+			g = (7 * i) % 16;
+		}
+
+		const auto next { d };
+		d = c;
+		c = b;
+		b = b + rotate_left(a + f + MD5_CONSTANTS[i] + m[g], MD5_SHIFTS[i]);
+		a = next;
+	}
+
+	state_[0] += a;
+	state_[1] += b;
+	state_[2] += c;
+	state_[3] += d;
+}
+
+
+// Digests
+
+
+Digests::Digests(const std::vector<DigestType>& types,
+		const std::size_t window)
+	: types_           { types }
+	, crc32_           {}
+	, crc32_nosilence_ {}
+	, ctdb_            {}
+	, ctdb_skipped_    { 0 }
+	, ctdb_tail_       ( has(DigestType::CTDB) ? 4 * CTDB_SKIP_SAMPLES : 0 )
+	, ctdb_tail_first_ { 0 }
+	, ctdb_tail_size_  { 0 }
+	, md5_             {}
+	, window_          { window }
+	, windows_         { /* empty */ }
+	, window_crc_      {}
+	, window_samples_  { 0 }
+{
+	// empty
+}
+
+
+void Digests::update(const Sample* samples, const std::size_t count)
+{
+	const auto crc32     { has(DigestType::CRC32) };
+	const auto nosilence { has(DigestType::CRC32_NOSILENCE) };
+	const auto ctdb      { has(DigestType::CTDB) };
+	const auto md5       { has(DigestType::MD5) };
+
+	// Little endian PCM bytes of all samples and of the non-zero values
+	auto bytes         = std::array<std::uint8_t, 4 * CONVERT_SAMPLES> {};
+	auto nonzero_bytes = std::array<std::uint8_t, 4 * CONVERT_SAMPLES> {};
+
+	for (std::size_t done = 0; done < count; done += CONVERT_SAMPLES)
+	{
+		const auto n { std::min(CONVERT_SAMPLES, count - done) };
+		auto nonzero = std::size_t { 0 };
+
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			const auto s { samples[done + i] };
+
+			bytes[4 * i]     = static_cast<std::uint8_t>(s);
+			bytes[4 * i + 1] = static_cast<std::uint8_t>(s >> 8);
+			bytes[4 * i + 2] = static_cast<std::uint8_t>(s >> 16);
+			bytes[4 * i + 3] = static_cast<std::uint8_t>(s >> 24);
+
+			if (nosilence)
+			{
+				// Left and right channel are skipped independently
+
+				if (s & 0x0000FFFF)
+				{
+					nonzero_bytes[nonzero++] = bytes[4 * i];
+					nonzero_bytes[nonzero++] = bytes[4 * i + 1];
+				}
+
+				if (s & 0xFFFF0000)
+				{
+					nonzero_bytes[nonzero++] = bytes[4 * i + 2];
+					nonzero_bytes[nonzero++] = bytes[4 * i + 3];
+				}
+			}
+		}
+
+		if (crc32)
+		{
+			crc32_.update(bytes.data(), 4 * n);
+		}
+
+		if (nosilence)
+		{
+			crc32_nosilence_.update(nonzero_bytes.data(), nonzero);
+		}
+
+		if (ctdb)
+		{
+			update_ctdb(bytes.data(), n);
+		}
+
+		if (md5)
+		{
+			md5_.update(bytes.data(), 4 * n);
+		}
+
+		if (window_ > 0)
+		{
+			update_windows(bytes.data(), n);
+		}
+	}
+}
+
+
+const std::vector<DigestType>& Digests::types() const
+{
+	return types_;
+}
+
+
+std::string Digests::value(const DigestType type) const
+{
+	if (!has(type))
+	{
+		throw std::invalid_argument("Digest " + name(type)
+				+ " is not calculated");
+	}
+
+	if (DigestType::MD5 == type)
+	{
+		return to_hex(md5_.value());
+	}
+
+	auto out = std::ostringstream {};
+
+	// The samples held back by the CTDB digest are the last of the track
+
+	const auto& crc { DigestType::CRC32 == type ? crc32_
+		: (DigestType::CTDB == type ? ctdb_ : crc32_nosilence_) };
+
+	out << std::hex << std::uppercase << std::setw(8) << std::setfill('0')
+		<< crc.value();
+
+	return out.str();
+}
+
+
+std::size_t Digests::window() const
+{
+	return window_;
+}
+
+
+std::vector<std::uint32_t> Digests::windows() const
+{
+	auto windows { windows_ };
+
+	if (window_samples_ > 0)
+	{
+		windows.push_back(window_crc_.value());
+	}
+
+	return windows;
+}
+
+
+bool Digests::has(const DigestType type) const
+{
+	return std::find(types_.begin(), types_.end(), type) != types_.end();
+}
+
+
+void Digests::update_windows(const std::uint8_t* bytes,
+		const std::size_t count)
+{
+	auto done = std::size_t { 0 };
+
+	while (done < count)
+	{
+		const auto n { std::min(count - done, window_ - window_samples_) };
+
+		window_crc_.update(bytes + 4 * done, 4 * n);
+		window_samples_ += n;
+		done            += n;
+
+		if (window_samples_ == window_)
+		{
+			windows_.push_back(window_crc_.value());
+			window_crc_     = CRC32 {};
+			window_samples_ = 0;
+		}
+	}
+}
+
+
+void Digests::update_ctdb(const std::uint8_t* bytes, const std::size_t count)
+{
+	// Skip the first samples of the track
+
+	const auto skip { std::min(count, CTDB_SKIP_SAMPLES - ctdb_skipped_) };
+	ctdb_skipped_ += skip;
+
+	auto next { bytes + 4 * skip };
+	auto left { count - skip };
+
+	// Samples that no longer fit into the ring buffer are not among the last
+	// samples, the oldest are taken first
+
+	const auto excess { ctdb_tail_size_ + left > CTDB_SKIP_SAMPLES
+		? ctdb_tail_size_ + left - CTDB_SKIP_SAMPLES : 0 };
+	const auto from_tail { std::min(excess, ctdb_tail_size_) };
+
+	for (auto done = std::size_t { 0 }; done < from_tail; )
+	{
+		const auto n { std::min(from_tail - done,
+				CTDB_SKIP_SAMPLES - ctdb_tail_first_) };
+
+		ctdb_.update(ctdb_tail_.data() + 4 * ctdb_tail_first_, 4 * n);
+		ctdb_tail_first_ = (ctdb_tail_first_ + n) % CTDB_SKIP_SAMPLES;
+		done += n;
+	}
+
+	ctdb_tail_size_ -= from_tail;
+
+	const auto from_input { excess - from_tail };
+
+	ctdb_.update(next, 4 * from_input);
+	next += 4 * from_input;
+	left -= from_input;
+
+	// Hold back the remaining samples
+
+	while (left > 0)
+	{
+		const auto last {
+			(ctdb_tail_first_ + ctdb_tail_size_) % CTDB_SKIP_SAMPLES };
+		const auto n { std::min(left, CTDB_SKIP_SAMPLES - last) };
+
+		std::memcpy(ctdb_tail_.data() + 4 * last, next, 4 * n);
+		ctdb_tail_size_ += n;
+		next += 4 * n;
+		left -= n;
+	}
+}
+
+} // namespace digest
+} // namespace v_1_0_0
+} // namespace arcsapp
+
@@ -0,0 +1,362 @@
+#ifndef __ARCSTOOLS_TOOLS_DIGEST_HPP__
+#define __ARCSTOOLS_TOOLS_DIGEST_HPP__
+
+/**
+ * \file
+ *
+ * \brief Digests of tracks that are calculated along with the ARCSs.
+ */
+
+#include <array>       // for array
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint8_t, uint32_t, uint64_t
+#include <string>      // for string
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_PCM_HPP__
+#include "tools-pcm.hpp"      // for Sample
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+
+/**
+ * \brief Digests of the samples of a track.
+ *
+ * The digests are updated with the same samples as the ARCSs, thus they are
+ * calculated without decoding the audio a second time. Each digest covers all
+ * samples of the track as 16 bit little endian stereo PCM.
+ */
+namespace digest
+{
+
+using pcm::Sample;
+
+
+/**
+ * \brief Types of digests.
+ */
+enum class DigestType
+{
+	CRC32,           //!< CRC32 of the track, like the copy CRC of EAC
+	CRC32_NOSILENCE, //!< CRC32 of the non-zero 16 bit values of the track
+	CTDB,            //!< CRC32 of the track without its first and last frames
+	MD5              //!< MD5 of the track
+};
+
+
+/**
+ * \brief Digest type for the specified name.
+ *
+ * Valid names are 'crc32', 'crc32-nosilence', 'ctdb' and 'md5'.
+ *
+ * \param[in] name Name of the digest type
+ *
+ * \return The digest type with the specified name
+ *
+ * \throws std::invalid_argument If the name is unknown
+ */
+DigestType to_type(const std::string& name);
+
+
+/**
+ * \brief Name of the digest type.
+ *
+ * \param[in] type The digest type
+ *
+ * \return Name of the digest type
+ */
+std::string name(const DigestType type);
+
+
+/**
+ * \brief Digest types for a comma-separated list of names.
+ *
+ * Types occurring more than once are only contained once in the result.
+ *
+ * \param[in] names Comma-separated list of digest type names
+ *
+ * \return Digest types in the order of their first occurrence
+ *
+ * \throws std::invalid_argument If any name is unknown
+ */
+std::vector<DigestType> to_types(const std::string& names);
+
+
+/**
+ * \brief Hexadecimal representation of an MD5 value.
+ *
+ * \param[in] md5 The MD5 value
+ *
+ * \return MD5 value as 32 lowercase hexadecimal digits
+ */
+std::string to_hex(const std::array<std::uint8_t, 16>& md5);
+
+
+/**
+ * \brief CRC32 as specified by IEEE 802.3.
+ */
+class CRC32 final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 */
+	CRC32();
+
+	/**
+	 * \brief Update with a sequence of bytes.
+	 *
+	 * \param[in] bytes Pointer to the first byte
+	 * \param[in] count Number of bytes
+	 */
+	void update(const std::uint8_t* bytes, const std::size_t count);
+
+	/**
+	 * \brief CRC32 of the bytes updated so far.
+	 *
+	 * \return CRC32 value
+	 */
+	std::uint32_t value() const;
+
+private:
+
+	/**
+	 * \brief Current remainder, not yet inverted.
+	 */
+	std::uint32_t crc_;
+};
+
+
+/**
+ * \brief MD5 as specified by RFC 1321.
+ */
+class MD5 final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 */
+	MD5();
+
+	/**
+	 * \brief Update with a sequence of bytes.
+	 *
+	 * \param[in] bytes Pointer to the first byte
+	 * \param[in] count Number of bytes
+	 */
+	void update(const std::uint8_t* bytes, const std::size_t count);
+
+	/**
+	 * \brief MD5 of the bytes updated so far.
+	 *
+	 * The instance may be updated further after calling this function.
+	 *
+	 * \return MD5 value
+	 */
+	std::array<std::uint8_t, 16> value() const;
+
+private:
+
+	/**
+	 * \brief Process a complete block of 64 bytes.
+	 *
+	 * \param[in] block Pointer to the first byte of the block
+	 */
+	void process(const std::uint8_t* block);
+
+	/**
+	 * \brief Current state.
+	 */
+	std::array<std::uint32_t, 4> state_;
+
+	/**
+	 * \brief Bytes of the current incomplete block.
+	 */
+	std::array<std::uint8_t, 64> block_;
+
+	/**
+	 * \brief Total number of bytes updated so far.
+	 */
+	std::uint64_t total_bytes_;
+};
+
+
+/**
+ * \brief Samples skipped at the start and at the end by DigestType::CTDB.
+ *
+ * The CUETools database skips 10 frames of 588 samples at each end, since they
+ * are not read reliably by every drive.
+ */
+constexpr std::size_t CTDB_SKIP_SAMPLES = 10 * 588;
+
+
+/**
+ * \brief Calculates the requested digests of a track in one pass.
+ *
+ * The digest DigestType::CTDB skips the first and the last
+ * CTDB_SKIP_SAMPLES of the track. Since the end of the track is not known in
+ * advance, the last CTDB_SKIP_SAMPLES updated are held back until further
+ * samples are updated.
+ *
+ * Optionally, the CRC32 of each window of a fixed number of samples is
+ * calculated along with the digests. The windows start with the first sample
+ * updated, the last window may be shorter than the others.
+ */
+class Digests final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] types  The digest types to calculate
+	 * \param[in] window Number of samples per window, 0 for no windows
+	 */
+	explicit Digests(const std::vector<DigestType>& types,
+			const std::size_t window = 0);
+
+	/**
+	 * \brief Update with a sequence of samples.
+	 *
+	 * \param[in] samples Pointer to the first sample
+	 * \param[in] count   Number of samples
+	 */
+	void update(const Sample* samples, const std::size_t count);
+
+	/**
+	 * \brief The digest types calculated.
+	 *
+	 * \return The digest types calculated
+	 */
+	const std::vector<DigestType>& types() const;
+
+	/**
+	 * \brief Hexadecimal value of a digest of the samples updated so far.
+	 *
+	 * CRC32 values are printed as 8 uppercase digits, MD5 values as 32
+	 * lowercase digits, as common for the respective digest.
+	 *
+	 * \param[in] type The digest type
+	 *
+	 * \return Value of the digest
+	 *
+	 * \throws std::invalid_argument If the digest type is not calculated
+	 */
+	std::string value(const DigestType type) const;
+
+	/**
+	 * \brief Number of samples per window.
+	 *
+	 * \return Number of samples per window, 0 if no windows are calculated
+	 */
+	std::size_t window() const;
+
+	/**
+	 * \brief CRC32 of each window of the samples updated so far.
+	 *
+	 * \return CRC32 of each window, including an incomplete last window
+	 */
+	std::vector<std::uint32_t> windows() const;
+
+private:
+
+	/**
+	 * \brief TRUE iff the digest type is calculated.
+	 *
+	 * \param[in] type The digest type
+	 */
+	bool has(const DigestType type) const;
+
+	/**
+	 * \brief Update the windows with a sequence of samples as bytes.
+	 *
+	 * \param[in] bytes Pointer to the first byte of the first sample
+	 * \param[in] count Number of samples
+	 */
+	void update_windows(const std::uint8_t* bytes, const std::size_t count);
+
+	/**
+	 * \brief Update the CTDB digest with a sequence of samples as bytes.
+	 *
+	 * \param[in] bytes Pointer to the first byte of the first sample
+	 * \param[in] count Number of samples
+	 */
+	void update_ctdb(const std::uint8_t* bytes, const std::size_t count);
+
+	/**
+	 * \brief The digest types calculated.
+	 */
+	std::vector<DigestType> types_;
+
+	/**
+	 * \brief CRC32 of all samples.
+	 */
+	CRC32 crc32_;
+
+	/**
+	 * \brief CRC32 of the non-zero 16 bit values.
+	 */
+	CRC32 crc32_nosilence_;
+
+	/**
+	 * \brief CRC32 of the samples without the first and the last samples.
+	 */
+	CRC32 ctdb_;
+
+	/**
+	 * \brief Number of samples skipped at the start so far.
+	 */
+	std::size_t ctdb_skipped_;
+
+	/**
+	 * \brief Bytes of the last samples, held back as a ring buffer.
+	 */
+	std::vector<std::uint8_t> ctdb_tail_;
+
+	/**
+	 * \brief Index of the oldest sample in the ring buffer.
+	 */
+	std::size_t ctdb_tail_first_;
+
+	/**
+	 * \brief Number of samples in the ring buffer.
+	 */
+	std::size_t ctdb_tail_size_;
+
+	/**
+	 * \brief MD5 of all samples.
+	 */
+	MD5 md5_;
+
+	/**
+	 * \brief Number of samples per window.
+	 */
+	std::size_t window_;
+
+	/**
+	 * \brief CRC32 of each complete window.
+	 */
+	std::vector<std::uint32_t> windows_;
+
+	/**
+	 * \brief CRC32 of the current window.
+	 */
+	CRC32 window_crc_;
+
+	/**
+	 * \brief Number of samples in the current window.
+	 */
+	std::size_t window_samples_;
+};
+
+} // namespace digest
+} // namespace v_1_0_0
+} // namespace arcsapp
+
+#endif
+
@@ -0,0 +1,1239 @@
+/**
+ * \file tools-io.cpp Input of audio file bytes
+ */
+
+#ifndef __ARCSTOOLS_TOOLS_IO_HPP__
+#include "tools-io.hpp"
+#endif
+
+#include <algorithm>   // for any_of, max, min
+#include <cerrno>      // for errno, EINTR, EAGAIN
+#include <cstdio>      // for BUFSIZ
+#include <cstring>     // for memset, strerror
+#include <fstream>     // for filebuf
+#include <mutex>       // for call_once, once_flag
+#include <stdexcept>   // for invalid_argument, runtime_error
+#include <utility>     // for move
+
+#include <fcntl.h>     // for open, O_RDONLY, posix_fadvise
+#include <sys/mman.h>  // for mmap, munmap, madvise
+#include <sys/stat.h>  // for fstat
+#include <unistd.h>    // for close, pread
+
+#ifdef ARCSTOOLS_WITH_IO_URING
+#include <linux/io_uring.h>  // for io_uring_params, io_uring_sqe, ...
+#include <sys/syscall.h>     // for __NR_io_uring_setup, __NR_io_uring_enter
+#endif
+
+#ifndef __LIBARCSTK_LOGGING_HPP__
+#include <arcstk/logging.hpp>
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+namespace io
+{
+
+namespace
+{
+
+/**
+ * \brief Minimal number of buffers of a read-ahead ring.
+ *
+ * One buffer is consumed while the other one is filled.
+ */
+constexpr std::size_t MIN_DEPTH = 2;
+
+/**
+ * \brief Minimal size of a read-ahead buffer in bytes.
+ */
+constexpr std::size_t MIN_BUFFER_SIZE = 4096;
+
+
+/**
+ * \brief Read up to \c size bytes from position \c offset.
+ *
+ * Reads less than \c size bytes only at the end of the file.
+ *
+ * \return Number of bytes read
+ *
+ * \throws std::runtime_error If reading fails
+ */
+std::size_t read_at(const int fd, const std::uint64_t offset, char* buffer,
+		const std::size_t size)
+{
+	auto done = std::size_t { 0 };
+
+	while (done < size)
+	{
+		const auto n = ::pread(fd, buffer + done, size - done,
+				static_cast<off_t>(offset + done));
+
+		if (n < 0)
+		{
+			if (EINTR == errno)
+			{
+				continue;
+			}
+
+			throw std::runtime_error(std::string { "Failed to read file: " }
+					+ std::strerror(errno));
+		}
+
+		if (0 == n)
+		{
+			break;
+		}
+
+		done += static_cast<std::size_t>(n);
+	}
+
+	return done;
+}
+
+
+#ifdef ARCSTOOLS_WITH_IO_URING
+
+/**
+ * \brief Create an io_uring instance.
+ *
+ * \return File descriptor of the instance or -1 with errno set
+ */
+int setup_ring(const unsigned entries, io_uring_params& params)
+{
+	return static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+}
+
+#endif
+
+} // namespace
+
+
+// Backend
+
+
+Backend to_backend(const std::string& name)
+{
+	if ("stdio" == name)
+	{
+		return Backend::STDIO;
+	}
+
+	if ("mmap" == name)
+	{
+		return Backend::MMAP;
+	}
+
+	if ("io_uring" == name)
+	{
+		return Backend::URING;
+	}
+
+	throw std::invalid_argument("Unknown I/O backend '" + name
+			+ "', expected 'stdio', 'mmap' or 'io_uring'");
+}
+
+
+std::string name(const Backend backend)
+{
+	switch (backend)
+	{
+		case Backend::MMAP:  return "mmap";
+		case Backend::URING: return "io_uring";
+		default:             return "stdio";
+	}
+}
+
+
+bool uring_available()
+{
+#ifdef ARCSTOOLS_WITH_IO_URING
+	static const bool available = []
+	{
+		auto params = io_uring_params {};
+		const auto fd = setup_ring(MIN_DEPTH, params);
+
+		if (fd < 0)
+		{
+			ARCS_LOG_DEBUG << "Could not set up io_uring: "
+				<< std::strerror(errno);
+			return false;
+		}
+
+		::close(fd);
+
+		// IORING_OP_READ was introduced together with this feature
+
+		return (params.features & IORING_FEAT_RW_CUR_POS) != 0;
+	}();
+
+	return available;
+#else
+	return false;
+#endif
+}
+
+
+// InputOptions
+
+
+bool is_default(const InputOptions& options)
+{
+	return Backend::STDIO == options.backend && 0 == options.read_ahead;
+}
+
+
+std::size_t input_memory(const InputOptions& options,
+		const std::size_t file_size)
+{
+	switch (options.backend)
+	{
+		case Backend::MMAP:
+			return file_size;
+
+		case Backend::URING:
+			return (options.read_ahead > 0
+					? options.read_ahead : DEFAULT_URING_DEPTH)
+				* options.buffer_size;
+
+		default:
+			break;
+	}
+
+	// ReadAheadBuffer uses at least 2 buffers
+
+	return options.read_ahead > 0
+		? std::max(options.read_ahead, std::size_t { 2 }) * options.buffer_size
+		: static_cast<std::size_t>(BUFSIZ);
+}
+
+
+// ReadAheadBuffer
+
+
+ReadAheadBuffer::ReadAheadBuffer(const std::string& filename,
+		const std::size_t depth, const std::size_t buffer_size,
+		StallCounters* counters)
+	: fd_               { ::open(filename.c_str(), O_RDONLY) }
+	, file_size_        { 0 }
+	, counters_         { counters }
+	, blocks_           ( std::max(depth, MIN_DEPTH) )
+	, free_             { /* empty */ }
+	, filled_           { /* empty */ }
+	, current_          { 0 }
+	, has_current_      { false }
+	, position_         { 0 }
+	, stop_             { false }
+	, error_            { nullptr }
+	, mutex_            { /* default */ }
+	, free_available_   { /* default */ }
+	, filled_available_ { /* default */ }
+	, thread_           { /* default */ }
+{
+	if (fd_ < 0)
+	{
+		throw std::runtime_error("Could not open audio file: " + filename);
+	}
+
+	struct stat info;
+
+	if (::fstat(fd_, &info) != 0)
+	{
+		::close(fd_);
+		throw std::runtime_error("Could not access audio file: " + filename);
+	}
+
+	file_size_ = static_cast<std::uint64_t>(info.st_size);
+
+	::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+	for (auto& block : blocks_)
+	{
+		block.data.resize(std::max(buffer_size, MIN_BUFFER_SIZE));
+	}
+
+	start(0);
+}
+
+
+ReadAheadBuffer::~ReadAheadBuffer() noexcept
+{
+	stop();
+	::close(fd_);
+}
+
+
+ReadAheadBuffer::int_type ReadAheadBuffer::underflow()
+{
+	if (gptr() < egptr())
+	{
+		return traits_type::to_int_type(*gptr());
+	}
+
+	std::unique_lock<std::mutex> lock { mutex_ };
+
+	// Return the consumed buffer to the I/O thread
+
+	if (has_current_)
+	{
+		const auto& block = blocks_[current_];
+		position_ = block.offset + block.size;
+
+		free_.push_back(current_);
+		has_current_ = false;
+		setg(nullptr, nullptr, nullptr);
+
+		free_available_.notify_one();
+	}
+
+	if (filled_.empty() && !error_)
+	{
+		if (counters_)
+		{
+			++counters_->decode_waits;
+		}
+
+		filled_available_.wait(lock,
+				[this]{ return !filled_.empty() || error_; });
+	}
+
+	if (filled_.empty())
+	{
+		std::rethrow_exception(error_);
+	}
+
+	auto& block = blocks_[filled_.front()];
+
+	if (0 == block.size)
+	{
+		// Keep the end marker for subsequent calls
+
+		return traits_type::eof();
+	}
+
+	current_ = filled_.front();
+	has_current_ = true;
+	filled_.pop_front();
+
+	position_ = block.offset;
+	setg(block.data.data(), block.data.data(), block.data.data() + block.size);
+
+	return traits_type::to_int_type(*gptr());
+}
+
+
+ReadAheadBuffer::pos_type ReadAheadBuffer::seekoff(off_type off,
+		std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+	auto base = off_type { 0 };
+
+	if (std::ios_base::cur == dir)
+	{
+		base = static_cast<off_type>(has_current_
+			? blocks_[current_].offset + static_cast<std::uint64_t>(
+					gptr() - eback())
+			: position_);
+
+	} else if (std::ios_base::end == dir)
+	{
+		base = static_cast<off_type>(file_size_);
+	}
+
+	if (base + off < 0)
+	{
+		return pos_type(off_type(-1));
+	}
+
+	return seekpos(pos_type(base + off), which);
+}
+
+
+ReadAheadBuffer::pos_type ReadAheadBuffer::seekpos(pos_type pos,
+		std::ios_base::openmode which)
+{
+	if (!(which & std::ios_base::in) || off_type(pos) < 0)
+	{
+		return pos_type(off_type(-1));
+	}
+
+	const auto target = static_cast<std::uint64_t>(off_type(pos));
+
+	// Seek within the current buffer
+
+	if (has_current_)
+	{
+		const auto& block = blocks_[current_];
+
+		if (block.offset <= target && target <= block.offset + block.size)
+		{
+			setg(eback(), eback() + (target - block.offset), egptr());
+			return pos;
+		}
+	} else if (target == position_)
+	{
+		return pos;
+	}
+
+	// Discard the buffers read ahead
+
+	ARCS_LOG(DEBUG2) << "Restart read-ahead at byte " << target;
+
+	stop();
+	start(target);
+
+	return pos;
+}
+
+
+void ReadAheadBuffer::start(const std::uint64_t offset)
+{
+	free_.clear();
+	filled_.clear();
+
+	for (std::size_t i = 0; i < blocks_.size(); ++i)
+	{
+		free_.push_back(i);
+	}
+
+	has_current_ = false;
+	position_    = offset;
+	stop_        = false;
+	error_       = nullptr;
+
+	setg(nullptr, nullptr, nullptr);
+
+	thread_ = std::thread { &ReadAheadBuffer::run, this, offset };
+}
+
+
+void ReadAheadBuffer::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock { mutex_ };
+		stop_ = true;
+	}
+
+	free_available_.notify_all();
+
+	if (thread_.joinable())
+	{
+		thread_.join();
+	}
+}
+
+
+void ReadAheadBuffer::run(std::uint64_t offset)
+{
+	while (true)
+	{
+		auto index = std::size_t { 0 };
+
+		{
+			std::unique_lock<std::mutex> lock { mutex_ };
+
+			if (free_.empty() && !stop_)
+			{
+				if (counters_)
+				{
+					++counters_->io_waits;
+				}
+
+				free_available_.wait(lock,
+						[this]{ return stop_ || !free_.empty(); });
+			}
+
+			if (stop_)
+			{
+				return;
+			}
+
+			index = free_.front();
+			free_.pop_front();
+		}
+
+		// The buffer is owned by this thread until it is queued as filled
+
+		auto& block = blocks_[index];
+
+		try
+		{
+			block.offset = offset;
+			block.size   = read_at(fd_, offset, block.data.data(),
+					block.data.size());
+
+		} catch (...)
+		{
+			std::lock_guard<std::mutex> lock { mutex_ };
+			error_ = std::current_exception();
+			filled_available_.notify_one();
+			return;
+		}
+
+		if (counters_ && block.size > 0)
+		{
+			++counters_->buffers;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock { mutex_ };
+			filled_.push_back(index);
+		}
+
+		filled_available_.notify_one();
+
+		if (0 == block.size)
+		{
+			return;
+		}
+
+		offset += block.size;
+	}
+}
+
+
+// MappedBuffer
+
+
+MappedBuffer::MappedBuffer(const std::string& filename)
+	: data_ { nullptr }
+	, size_ { 0 }
+{
+	const auto fd = ::open(filename.c_str(), O_RDONLY);
+
+	if (fd < 0)
+	{
+		throw std::runtime_error("Could not open audio file: " + filename);
+	}
+
+	struct stat info;
+
+	if (::fstat(fd, &info) != 0)
+	{
+		::close(fd);
+		throw std::runtime_error("Could not access audio file: " + filename);
+	}
+
+	size_ = static_cast<std::size_t>(info.st_size);
+
+	if (size_ > 0)
+	{
+		const auto data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		::close(fd);
+
+		if (MAP_FAILED == data)
+		{
+			throw std::runtime_error("Could not map audio file: " + filename);
+		}
+
+		::madvise(data, size_, MADV_SEQUENTIAL);
+
+		data_ = static_cast<char*>(data);
+	} else
+	{
+		::close(fd);
+	}
+
+	setg(data_, data_, data_ + size_);
+}
+
+
+MappedBuffer::~MappedBuffer() noexcept
+{
+	if (data_)
+	{
+		::munmap(data_, size_);
+	}
+}
+
+
+MappedBuffer::pos_type MappedBuffer::seekoff(off_type off,
+		std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+	auto base = off_type { 0 };
+
+	if (std::ios_base::cur == dir)
+	{
+		base = gptr() - eback();
+
+	} else if (std::ios_base::end == dir)
+	{
+		base = static_cast<off_type>(size_);
+	}
+
+	if (base + off < 0)
+	{
+		return pos_type(off_type(-1));
+	}
+
+	return seekpos(pos_type(base + off), which);
+}
+
+
+MappedBuffer::pos_type MappedBuffer::seekpos(pos_type pos,
+		std::ios_base::openmode which)
+{
+	if (!(which & std::ios_base::in) || off_type(pos) < 0
+			|| static_cast<std::size_t>(off_type(pos)) > size_)
+	{
+		return pos_type(off_type(-1));
+	}
+
+	setg(data_, data_ + off_type(pos), data_ + size_);
+
+	return pos;
+}
+
+
+// UringBuffer::Ring
+
+
+#ifdef ARCSTOOLS_WITH_IO_URING
+
+/**
+ * \brief Submission and completion queues of an io_uring instance.
+ *
+ * Uses the raw system calls, hence liburing is not required.
+ */
+class UringBuffer::Ring final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] entries Number of submission queue entries
+	 *
+	 * \throws std::runtime_error If the instance cannot be created
+	 */
+	explicit Ring(const unsigned entries);
+
+	Ring(const Ring&) = delete;
+	Ring& operator=(const Ring&) = delete;
+
+	~Ring() noexcept;
+
+	/**
+	 * \brief Queue a read for submission.
+	 */
+	void queue_read(const int fd, char* buffer, const std::size_t size,
+			const std::uint64_t offset, const std::uint64_t user_data);
+
+	/**
+	 * \brief Submit all queued reads.
+	 */
+	void submit();
+
+	/**
+	 * \brief Submit all queued reads and wait for at least one completion.
+	 */
+	void wait();
+
+	/**
+	 * \brief Pass each completion to \c f as user data and result.
+	 */
+	template <typename F>
+	void reap(F&& f);
+
+private:
+
+	void release() noexcept;
+
+	int fd_;
+
+	void* sq_ring_;
+	std::size_t sq_ring_size_;
+	void* cq_ring_;
+	std::size_t cq_ring_size_;
+	io_uring_sqe* sqes_;
+	std::size_t sqes_size_;
+
+	unsigned* sq_tail_;
+	unsigned* sq_mask_;
+	unsigned* sq_array_;
+
+	unsigned* cq_head_;
+	unsigned* cq_tail_;
+	unsigned* cq_mask_;
+	io_uring_cqe* cqes_;
+
+	/**
+	 * \brief Number of entries queued but not yet submitted.
+	 */
+	unsigned queued_;
+};
+
+
+UringBuffer::Ring::Ring(const unsigned entries)
+	: fd_           { -1 }
+	, sq_ring_      { MAP_FAILED }
+	, sq_ring_size_ { 0 }
+	, cq_ring_      { MAP_FAILED }
+	, cq_ring_size_ { 0 }
+	, sqes_         { nullptr }
+	, sqes_size_    { 0 }
+	, sq_tail_      { nullptr }
+	, sq_mask_      { nullptr }
+	, sq_array_     { nullptr }
+	, cq_head_      { nullptr }
+	, cq_tail_      { nullptr }
+	, cq_mask_      { nullptr }
+	, cqes_         { nullptr }
+	, queued_       { 0 }
+{
+	auto params = io_uring_params {};
+
+	fd_ = setup_ring(entries, params);
+
+	if (fd_ < 0)
+	{
+		throw std::runtime_error(std::string { "Could not set up io_uring: " }
+				+ std::strerror(errno));
+	}
+
+	sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	cq_ring_size_ = params.cq_off.cqes
+		+ params.cq_entries * sizeof(io_uring_cqe);
+	sqes_size_    = params.sq_entries * sizeof(io_uring_sqe);
+
+	const bool single_mmap { (params.features & IORING_FEAT_SINGLE_MMAP) != 0 };
+
+	if (single_mmap)
+	{
+		sq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+	}
+
+	sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+
+	if (!single_mmap && sq_ring_ != MAP_FAILED)
+	{
+		cq_ring_ = ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+	}
+
+	const auto sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+
+	if (sqes != MAP_FAILED)
+	{
+		sqes_ = static_cast<io_uring_sqe*>(sqes);
+	}
+
+	if (MAP_FAILED == sq_ring_ || (!single_mmap && MAP_FAILED == cq_ring_)
+			|| !sqes_)
+	{
+		release();
+		throw std::runtime_error("Could not map io_uring queues");
+	}
+
+	auto* sq { static_cast<char*>(sq_ring_) };
+	auto* cq { static_cast<char*>(single_mmap ? sq_ring_ : cq_ring_) };
+
+	sq_tail_  = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+	sq_mask_  = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+	sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+	cq_head_  = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+	cq_tail_  = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+	cq_mask_  = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+	cqes_     = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+}
+
+
+UringBuffer::Ring::~Ring() noexcept
+{
+	release();
+}
+
+
+void UringBuffer::Ring::queue_read(const int fd, char* buffer,
+		const std::size_t size, const std::uint64_t offset,
+		const std::uint64_t user_data)
+{
+	// Only this thread writes the tail of the submission queue
+
+	const auto tail  { *sq_tail_ };
+	const auto index { tail & *sq_mask_ };
+
+	auto& sqe = sqes_[index];
+	std::memset(&sqe, 0, sizeof(sqe));
+
+	sqe.opcode    = IORING_OP_READ;
+	sqe.fd        = fd;
+	sqe.addr      = reinterpret_cast<std::uint64_t>(buffer);
+	sqe.len       = static_cast<std::uint32_t>(size);
+	sqe.off       = offset;
+	sqe.user_data = user_data;
+
+	sq_array_[index] = index;
+
+	__atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+	++queued_;
+}
+
+
+void UringBuffer::Ring::submit()
+{
+	while (queued_ > 0)
+	{
+		const auto n = ::syscall(__NR_io_uring_enter, fd_, queued_, 0, 0,
+				nullptr, 0);
+
+		if (n < 0)
+		{
+			if (EINTR == errno)
+			{
+				continue;
+			}
+
+			throw std::runtime_error(std::string { "Failed to submit reads: " }
+					+ std::strerror(errno));
+		}
+
+		queued_ -= static_cast<unsigned>(n);
+	}
+}
+
+
+void UringBuffer::Ring::wait()
+{
+	submit();
+
+	while (::syscall(__NR_io_uring_enter, fd_, 0, 1, IORING_ENTER_GETEVENTS,
+				nullptr, 0) < 0)
+	{
+		if (EINTR != errno)
+		{
+			throw std::runtime_error(std::string { "Failed to wait for reads: " }
+					+ std::strerror(errno));
+		}
+	}
+}
+
+
+template <typename F>
+void UringBuffer::Ring::reap(F&& f)
+{
+	auto head { *cq_head_ };
+
+	while (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE))
+	{
+		const auto cqe { cqes_[head & *cq_mask_] };
+
+		// Release the entry before processing, processing may throw
+
+		++head;
+		__atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+		f(cqe.user_data, cqe.res);
+	}
+}
+
+
+void UringBuffer::Ring::release() noexcept
+{
+	if (sqes_)
+	{
+		::munmap(sqes_, sqes_size_);
+	}
+
+	if (cq_ring_ != MAP_FAILED)
+	{
+		::munmap(cq_ring_, cq_ring_size_);
+	}
+
+	if (sq_ring_ != MAP_FAILED)
+	{
+		::munmap(sq_ring_, sq_ring_size_);
+	}
+
+	if (fd_ >= 0)
+	{
+		::close(fd_);
+	}
+}
+
+#else
+
+/**
+ * \brief Placeholder for builds without io_uring.
+ */
+class UringBuffer::Ring final
+{
+public:
+
+	explicit Ring(const unsigned /* entries */)
+	{
+		throw std::runtime_error("io_uring is not supported by this build");
+	}
+
+	void queue_read(const int, char*, const std::size_t, const std::uint64_t,
+			const std::uint64_t)
+	{
+		// empty
+	}
+
+	void submit()
+	{
+		// empty
+	}
+
+	void wait()
+	{
+		// empty
+	}
+
+	template <typename F>
+	void reap(F&& /* f */)
+	{
+		// empty
+	}
+};
+
+#endif
+
+
+// UringBuffer
+
+
+UringBuffer::UringBuffer(const std::string& filename, const std::size_t depth,
+		const std::size_t buffer_size, StallCounters* counters)
+	: fd_          { ::open(filename.c_str(), O_RDONLY) }
+	, file_size_   { 0 }
+	, counters_    { counters }
+	, blocks_      ( std::max(depth, MIN_DEPTH) )
+	, requested_   { /* empty */ }
+	, current_     { 0 }
+	, has_current_ { false }
+	, position_    { 0 }
+	, next_offset_ { 0 }
+	, ring_        { nullptr }
+{
+	if (fd_ < 0)
+	{
+		throw std::runtime_error("Could not open audio file: " + filename);
+	}
+
+	struct stat info;
+
+	if (::fstat(fd_, &info) != 0)
+	{
+		::close(fd_);
+		throw std::runtime_error("Could not access audio file: " + filename);
+	}
+
+	file_size_ = static_cast<std::uint64_t>(info.st_size);
+
+	try
+	{
+		ring_ = std::make_unique<Ring>(static_cast<unsigned>(blocks_.size()));
+
+	} catch (...)
+	{
+		::close(fd_);
+		throw;
+	}
+
+	for (auto& block : blocks_)
+	{
+		block.data.resize(std::max(buffer_size, MIN_BUFFER_SIZE));
+		block.pending = false;
+	}
+
+	restart(0);
+}
+
+
+UringBuffer::~UringBuffer() noexcept
+{
+	// The kernel must not write to the buffers after they are released
+
+	try
+	{
+		while (std::any_of(blocks_.begin(), blocks_.end(),
+					[](const Block& b){ return b.pending; }))
+		{
+			complete(true);
+		}
+	} catch (...)
+	{
+		ARCS_LOG_WARNING << "Failed to finish reads in flight";
+	}
+
+	ring_.reset();
+	::close(fd_);
+}
+
+
+UringBuffer::int_type UringBuffer::underflow()
+{
+	if (gptr() < egptr())
+	{
+		return traits_type::to_int_type(*gptr());
+	}
+
+	// Reuse the consumed buffer for the next block
+
+	if (has_current_)
+	{
+		const auto& block = blocks_[current_];
+		position_ = block.offset + block.filled;
+
+		has_current_ = false;
+		setg(nullptr, nullptr, nullptr);
+
+		request(current_);
+		ring_->submit();
+	}
+
+	if (requested_.empty())
+	{
+		return traits_type::eof();
+	}
+
+	const auto index { requested_.front() };
+	auto& block = blocks_[index];
+
+	if (block.pending)
+	{
+		complete(false);
+	}
+
+	if (block.pending)
+	{
+		if (counters_)
+		{
+			++counters_->decode_waits;
+		}
+
+		while (block.pending)
+		{
+			complete(true);
+		}
+	}
+
+	if (0 == block.filled)
+	{
+		// File was truncated while reading
+
+		return traits_type::eof();
+	}
+
+	current_ = index;
+	has_current_ = true;
+	requested_.pop_front();
+
+	position_ = block.offset;
+	setg(block.data.data(), block.data.data(),
+			block.data.data() + block.filled);
+
+	return traits_type::to_int_type(*gptr());
+}
+
+
+UringBuffer::pos_type UringBuffer::seekoff(off_type off,
+		std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+	auto base = off_type { 0 };
+
+	if (std::ios_base::cur == dir)
+	{
+		base = static_cast<off_type>(has_current_
+			? blocks_[current_].offset + static_cast<std::uint64_t>(
+					gptr() - eback())
+			: position_);
+
+	} else if (std::ios_base::end == dir)
+	{
+		base = static_cast<off_type>(file_size_);
+	}
+
+	if (base + off < 0)
+	{
+		return pos_type(off_type(-1));
+	}
+
+	return seekpos(pos_type(base + off), which);
+}
+
+
+UringBuffer::pos_type UringBuffer::seekpos(pos_type pos,
+		std::ios_base::openmode which)
+{
+	if (!(which & std::ios_base::in) || off_type(pos) < 0)
+	{
+		return pos_type(off_type(-1));
+	}
+
+	const auto target = static_cast<std::uint64_t>(off_type(pos));
+
+	// Seek within the current buffer
+
+	if (has_current_)
+	{
+		const auto& block = blocks_[current_];
+
+		if (block.offset <= target && target <= block.offset + block.filled)
+		{
+			setg(eback(), eback() + (target - block.offset), egptr());
+			return pos;
+		}
+	} else if (target == position_)
+	{
+		return pos;
+	}
+
+	ARCS_LOG(DEBUG2) << "Restart io_uring reads at byte " << target;
+
+	restart(target);
+
+	return pos;
+}
+
+
+void UringBuffer::request(const std::size_t index)
+{
+	if (next_offset_ >= file_size_)
+	{
+		return;
+	}
+
+	auto& block = blocks_[index];
+
+	block.offset  = next_offset_;
+	block.size    = static_cast<std::size_t>(std::min<std::uint64_t>(
+				block.data.size(), file_size_ - next_offset_));
+	block.filled  = 0;
+	block.pending = true;
+
+	next_offset_ += block.size;
+	requested_.push_back(index);
+
+	ring_->queue_read(fd_, block.data.data(), block.size, block.offset, index);
+}
+
+
+void UringBuffer::complete(const bool wait)
+{
+	if (wait)
+	{
+		ring_->wait();
+	}
+
+	ring_->reap([this](const std::uint64_t index, const int result)
+	{
+		auto& block = blocks_[index];
+
+		const bool retry { -EINTR == result || -EAGAIN == result };
+
+		if (result < 0 && !retry)
+		{
+			block.pending = false;
+
+			throw std::runtime_error(std::string { "Failed to read file: " }
+					+ std::strerror(-result));
+		}
+
+		if (!retry)
+		{
+			block.filled += static_cast<std::size_t>(result);
+
+			if (0 == result || block.filled == block.size)
+			{
+				block.pending = false;
+
+				if (counters_ && block.filled > 0)
+				{
+					++counters_->buffers;
+				}
+
+				return;
+			}
+		}
+
+		// Short or interrupted read, request the rest of the block
+
+		ring_->queue_read(fd_, block.data.data() + block.filled,
+				block.size - block.filled, block.offset + block.filled, index);
+	});
+
+	ring_->submit();
+}
+
+
+void UringBuffer::restart(const std::uint64_t offset)
+{
+	while (std::any_of(blocks_.begin(), blocks_.end(),
+				[](const Block& b){ return b.pending; }))
+	{
+		complete(true);
+	}
+
+	requested_.clear();
+
+	has_current_ = false;
+	position_    = offset;
+	next_offset_ = offset;
+
+	setg(nullptr, nullptr, nullptr);
+
+	for (std::size_t i = 0; i < blocks_.size(); ++i)
+	{
+		request(i);
+	}
+
+	ring_->submit();
+}
+
+
+// open_input
+
+
+std::unique_ptr<std::streambuf> open_input(const std::string& filename,
+		const InputOptions& options)
+{
+	if (Backend::MMAP == options.backend)
+	{
+		return std::make_unique<MappedBuffer>(filename);
+	}
+
+	if (Backend::URING == options.backend)
+	{
+		if (uring_available())
+		{
+			return std::make_unique<UringBuffer>(filename,
+				options.read_ahead > 0 ? options.read_ahead
+					: DEFAULT_URING_DEPTH,
+				options.buffer_size, options.counters);
+		}
+
+		static std::once_flag warned;
+		std::call_once(warned, []{
+			ARCS_LOG_WARNING << "io_uring is not available, use stdio";
+		});
+	}
+
+	if (options.read_ahead > 0)
+	{
+		return std::make_unique<ReadAheadBuffer>(filename, options.read_ahead,
+				options.buffer_size, options.counters);
+	}
+
+	auto buffer { std::make_unique<std::filebuf>() };
+
+	if (!buffer->open(filename, std::ios_base::in | std::ios_base::binary))
+	{
+		throw std::runtime_error("Could not open audio file: " + filename);
+	}
+
+	return buffer;
+}
+
+} // namespace io
+} // namespace v_1_0_0
+} // namespace arcsapp
+
@@ -0,0 +1,575 @@
+#ifndef __ARCSTOOLS_TOOLS_IO_HPP__
+#define __ARCSTOOLS_TOOLS_IO_HPP__
+
+/**
+ * \file
+ *
+ * \brief Input of audio file bytes.
+ */
+
+#include <atomic>             // for atomic
+#include <condition_variable> // for condition_variable
+#include <cstddef>            // for size_t
+#include <cstdint>            // for uint64_t
+#include <deque>              // for deque
+#include <exception>          // for exception_ptr
+#include <ios>                // for streamsize, streamoff, ios_base
+#include <memory>             // for unique_ptr
+#include <mutex>              // for mutex
+#include <streambuf>          // for streambuf
+#include <string>             // for string
+#include <thread>             // for thread
+#include <vector>             // for vector
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+
+/**
+ * \brief Tools and helpers for reading the bytes of audio files.
+ *
+ * The readers of namespace pcm read their input through a std::streambuf
+ * provided by open_input(). Thus, the strategy for reading bytes from the file
+ * is independent from the parsing and decoding of the audio format.
+ */
+namespace io
+{
+
+/**
+ * \brief Default size of a read-ahead buffer in bytes.
+ */
+constexpr std::size_t DEFAULT_BUFFER_SIZE = 1024 * 1024;
+
+/**
+ * \brief Default number of reads in flight for Backend::URING.
+ */
+constexpr std::size_t DEFAULT_URING_DEPTH = 8;
+
+
+/**
+ * \brief Strategies for reading the bytes of a file.
+ */
+enum class Backend
+{
+	STDIO, //!< Buffered reading by the standard library
+	MMAP,  //!< Memory mapping with sequential access advice
+	URING  //!< Asynchronous reads by Linux io_uring with several reads in flight
+};
+
+
+/**
+ * \brief Backend for the specified name.
+ *
+ * Valid names are 'stdio', 'mmap' and 'io_uring'.
+ *
+ * \param[in] name Name of the backend
+ *
+ * \return Backend for \c name
+ *
+ * \throws std::invalid_argument If \c name is not the name of a backend
+ */
+Backend to_backend(const std::string& name);
+
+
+/**
+ * \brief Name of the specified backend.
+ *
+ * \param[in] backend Backend to name
+ *
+ * \return Name of \c backend as accepted by to_backend()
+ */
+std::string name(const Backend backend);
+
+
+/**
+ * \brief TRUE iff io_uring is supported by this build and the running kernel.
+ *
+ * \return TRUE iff Backend::URING can be used
+ */
+bool uring_available();
+
+
+/**
+ * \brief Counts how often each stage of a read-ahead pipeline waited.
+ *
+ * If the I/O stage waits more often, decoding and checksumming is the
+ * bottleneck. If the decoding stage waits more often, I/O is the bottleneck.
+ */
+struct StallCounters final
+{
+	/**
+	 * \brief Number of buffers read by the I/O stage.
+	 */
+	std::atomic<std::size_t> buffers { 0 };
+
+	/**
+	 * \brief Number of times the I/O stage waited for a free buffer.
+	 */
+	std::atomic<std::size_t> io_waits { 0 };
+
+	/**
+	 * \brief Number of times the decoding stage waited for a filled buffer.
+	 */
+	std::atomic<std::size_t> decode_waits { 0 };
+};
+
+
+/**
+ * \brief Options for reading the bytes of an audio file.
+ */
+struct InputOptions final
+{
+	/**
+	 * \brief Strategy for reading the bytes of a file.
+	 */
+	Backend backend = Backend::STDIO;
+
+	/**
+	 * \brief Number of buffers to read ahead, 0 for no read-ahead.
+	 *
+	 * For Backend::URING this is the number of reads in flight, 0 for
+	 * DEFAULT_URING_DEPTH. It is ignored by Backend::MMAP.
+	 */
+	std::size_t read_ahead = 0;
+
+	/**
+	 * \brief Size of a read-ahead buffer in bytes.
+	 */
+	std::size_t buffer_size = DEFAULT_BUFFER_SIZE;
+
+	/**
+	 * \brief Counters to update, may be \c nullptr.
+	 */
+	StallCounters* counters = nullptr;
+};
+
+
+/**
+ * \brief TRUE iff the options request plain buffered reading.
+ *
+ * \param[in] options Options for reading
+ *
+ * \return TRUE iff neither read-ahead nor a specific backend is requested
+ */
+bool is_default(const InputOptions& options);
+
+
+/**
+ * \brief Estimated memory for reading a file with the specified options.
+ *
+ * Accounts for the buffers of the backend. The pages of a file mapped by
+ * Backend::MMAP count towards the resident memory as soon as they are read,
+ * hence the entire file is accounted for.
+ *
+ * \param[in] options   Options for reading
+ * \param[in] file_size Size of the file in bytes
+ *
+ * \return Estimated memory in bytes
+ */
+std::size_t input_memory(const InputOptions& options,
+		const std::size_t file_size);
+
+
+/**
+ * \brief Stream buffer that reads a file ahead on its own thread.
+ *
+ * The file is read sequentially in blocks into a ring of buffers by an I/O
+ * thread while the consumer processes the buffers already filled. Thus, I/O
+ * and decoding overlap.
+ *
+ * Seeking within the current buffer is cheap. Seeking elsewhere discards the
+ * buffers read ahead and restarts reading at the new position.
+ */
+class ReadAheadBuffer final : public std::streambuf
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] filename    Name of the file to read
+	 * \param[in] depth       Number of buffers, at least 2 are used
+	 * \param[in] buffer_size Size of each buffer in bytes
+	 * \param[in] counters    Counters to update, may be \c nullptr
+	 *
+	 * \throws std::runtime_error If the file cannot be opened
+	 */
+	ReadAheadBuffer(const std::string& filename, const std::size_t depth,
+			const std::size_t buffer_size, StallCounters* counters);
+
+	ReadAheadBuffer(const ReadAheadBuffer&) = delete;
+	ReadAheadBuffer& operator=(const ReadAheadBuffer&) = delete;
+
+	/**
+	 * \brief Destructor.
+	 *
+	 * Stops the I/O thread and closes the file.
+	 */
+	~ReadAheadBuffer() noexcept final;
+
+protected:
+
+	int_type underflow() final;
+
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+			std::ios_base::openmode which) final;
+
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which) final;
+
+private:
+
+	/**
+	 * \brief A buffer of the ring.
+	 */
+	struct Block final
+	{
+		/**
+		 * \brief Bytes of the block.
+		 */
+		std::vector<char> data { /* empty */ };
+
+		/**
+		 * \brief Position of the first byte within the file.
+		 */
+		std::uint64_t offset { 0 };
+
+		/**
+		 * \brief Number of valid bytes, 0 marks the end of the file.
+		 */
+		std::size_t size { 0 };
+	};
+
+	/**
+	 * \brief Start the I/O thread at the specified position.
+	 *
+	 * \param[in] offset Position to start reading
+	 */
+	void start(const std::uint64_t offset);
+
+	/**
+	 * \brief Stop the I/O thread and discard all buffers.
+	 */
+	void stop();
+
+	/**
+	 * \brief Main loop of the I/O thread.
+	 *
+	 * \param[in] offset Position to start reading
+	 */
+	void run(std::uint64_t offset);
+
+	/**
+	 * \brief Descriptor of the file.
+	 */
+	int fd_;
+
+	/**
+	 * \brief Size of the file in bytes.
+	 */
+	std::uint64_t file_size_;
+
+	/**
+	 * \brief Counters to update, may be \c nullptr.
+	 */
+	StallCounters* counters_;
+
+	/**
+	 * \brief The ring of buffers.
+	 */
+	std::vector<Block> blocks_;
+
+	/**
+	 * \brief Indices of the buffers free for reading.
+	 */
+	std::deque<std::size_t> free_;
+
+	/**
+	 * \brief Indices of the buffers filled, in file order.
+	 */
+	std::deque<std::size_t> filled_;
+
+	/**
+	 * \brief Index of the buffer of the get area, if any.
+	 */
+	std::size_t current_;
+
+	/**
+	 * \brief TRUE iff the get area is a buffer of the ring.
+	 */
+	bool has_current_;
+
+	/**
+	 * \brief Position of the get area within the file.
+	 */
+	std::uint64_t position_;
+
+	/**
+	 * \brief TRUE iff the I/O thread is requested to stop.
+	 */
+	bool stop_;
+
+	/**
+	 * \brief Error that occurred in the I/O thread.
+	 */
+	std::exception_ptr error_;
+
+	/**
+	 * \brief Guards the queues and the flags.
+	 */
+	std::mutex mutex_;
+
+	/**
+	 * \brief Signals a free buffer or a stop request.
+	 */
+	std::condition_variable free_available_;
+
+	/**
+	 * \brief Signals a filled buffer.
+	 */
+	std::condition_variable filled_available_;
+
+	/**
+	 * \brief The I/O thread.
+	 */
+	std::thread thread_;
+};
+
+
+/**
+ * \brief Stream buffer on a memory mapped file.
+ *
+ * The whole file is the get area, the kernel is advised to expect sequential
+ * access and thus reads ahead.
+ */
+class MappedBuffer final : public std::streambuf
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] filename Name of the file to map
+	 *
+	 * \throws std::runtime_error If the file cannot be mapped
+	 */
+	explicit MappedBuffer(const std::string& filename);
+
+	MappedBuffer(const MappedBuffer&) = delete;
+	MappedBuffer& operator=(const MappedBuffer&) = delete;
+
+	/**
+	 * \brief Destructor.
+	 *
+	 * Unmaps the file.
+	 */
+	~MappedBuffer() noexcept final;
+
+protected:
+
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+			std::ios_base::openmode which) final;
+
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which) final;
+
+private:
+
+	/**
+	 * \brief Start of the mapping, \c nullptr for an empty file.
+	 */
+	char* data_;
+
+	/**
+	 * \brief Size of the file in bytes.
+	 */
+	std::size_t size_;
+};
+
+
+/**
+ * \brief Stream buffer that reads a file by Linux io_uring.
+ *
+ * A ring of buffers is kept in flight as asynchronous reads of consecutive
+ * blocks. When a buffer is consumed, it is immediately submitted again for
+ * the next block not yet requested. No additional thread is involved.
+ *
+ * Seeking within the current buffer is cheap. Seeking elsewhere waits for the
+ * reads in flight and restarts reading at the new position.
+ *
+ * Only the StallCounters::buffers and StallCounters::decode_waits are updated
+ * since the kernel never waits for a free buffer.
+ */
+class UringBuffer final : public std::streambuf
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] filename    Name of the file to read
+	 * \param[in] depth       Number of reads in flight, at least 2 are used
+	 * \param[in] buffer_size Size of each buffer in bytes
+	 * \param[in] counters    Counters to update, may be \c nullptr
+	 *
+	 * \throws std::runtime_error If the file cannot be opened or io_uring is
+	 * not available
+	 */
+	UringBuffer(const std::string& filename, const std::size_t depth,
+			const std::size_t buffer_size, StallCounters* counters);
+
+	UringBuffer(const UringBuffer&) = delete;
+	UringBuffer& operator=(const UringBuffer&) = delete;
+
+	/**
+	 * \brief Destructor.
+	 *
+	 * Waits for the reads in flight and closes the file.
+	 */
+	~UringBuffer() noexcept final;
+
+protected:
+
+	int_type underflow() final;
+
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+			std::ios_base::openmode which) final;
+
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which) final;
+
+private:
+
+	/**
+	 * \brief A buffer of the ring.
+	 */
+	struct Block final
+	{
+		/**
+		 * \brief Bytes of the block.
+		 */
+		std::vector<char> data { /* empty */ };
+
+		/**
+		 * \brief Position of the first byte within the file.
+		 */
+		std::uint64_t offset { 0 };
+
+		/**
+		 * \brief Number of bytes requested.
+		 */
+		std::size_t size { 0 };
+
+		/**
+		 * \brief Number of bytes read so far.
+		 */
+		std::size_t filled { 0 };
+
+		/**
+		 * \brief TRUE iff a read for this block is in flight.
+		 */
+		bool pending { false };
+	};
+
+	/**
+	 * \brief The io_uring instance.
+	 */
+	class Ring;
+
+	/**
+	 * \brief Request the next block not yet requested into a buffer.
+	 *
+	 * Does nothing at the end of the file.
+	 *
+	 * \param[in] index Index of the buffer
+	 */
+	void request(const std::size_t index);
+
+	/**
+	 * \brief Process the completed reads.
+	 *
+	 * \param[in] wait TRUE iff at least one completion is to be waited for
+	 */
+	void complete(const bool wait);
+
+	/**
+	 * \brief Wait for all reads in flight and restart at the specified
+	 * position.
+	 *
+	 * \param[in] offset Position to start reading
+	 */
+	void restart(const std::uint64_t offset);
+
+	/**
+	 * \brief Descriptor of the file.
+	 */
+	int fd_;
+
+	/**
+	 * \brief Size of the file in bytes.
+	 */
+	std::uint64_t file_size_;
+
+	/**
+	 * \brief Counters to update, may be \c nullptr.
+	 */
+	StallCounters* counters_;
+
+	/**
+	 * \brief The ring of buffers.
+	 */
+	std::vector<Block> blocks_;
+
+	/**
+	 * \brief Indices of the buffers requested, in file order.
+	 */
+	std::deque<std::size_t> requested_;
+
+	/**
+	 * \brief Index of the buffer of the get area, if any.
+	 */
+	std::size_t current_;
+
+	/**
+	 * \brief TRUE iff the get area is a buffer of the ring.
+	 */
+	bool has_current_;
+
+	/**
+	 * \brief Position of the get area within the file.
+	 */
+	std::uint64_t position_;
+
+	/**
+	 * \brief Position of the next block to request.
+	 */
+	std::uint64_t next_offset_;
+
+	/**
+	 * \brief The io_uring instance.
+	 */
+	std::unique_ptr<Ring> ring_;
+};
+
+
+/**
+ * \brief Open a file for reading its bytes.
+ *
+ * With Backend::STDIO and without read-ahead, a buffered std::filebuf is
+ * returned. If Backend::URING is requested but not available, a warning is
+ * logged and Backend::STDIO is used instead.
+ *
+ * \param[in] filename Name of the file
+ * \param[in] options  Options for reading
+ *
+ * \return Stream buffer on the file
+ *
+ * \throws std::runtime_error If the file cannot be opened
+ */
+std::unique_ptr<std::streambuf> open_input(const std::string& filename,
+		const InputOptions& options);
+
+} // namespace io
+} // namespace v_1_0_0
+} // namespace arcsapp
+
+#endif
+
@@ -0,0 +1,409 @@
+/**
+ * \file tools-journal.cpp Journal of completed albums for resuming batch runs
+ */
+
+#ifndef __ARCSTOOLS_TOOLS_JOURNAL_HPP__
+#include "tools-journal.hpp"
+#endif
+
+#include <cerrno>      // for errno, EINTR
+#include <cstdlib>     // for strtoull
+#include <cstring>     // for strerror
+#include <fstream>     // for ifstream
+#include <iomanip>     // for setfill, setw
+#include <sstream>     // for ostringstream
+#include <stdexcept>   // for runtime_error
+
+#include <fcntl.h>     // for open, O_WRONLY, O_APPEND, O_CREAT, O_CLOEXEC
+#include <unistd.h>    // for close, fsync, write
+
+#ifndef __LIBARCSTK_LOGGING_HPP__
+#include <arcstk/logging.hpp>
+#endif
+
+#ifndef __ARCSTOOLS_TOOLS_CACHE_HPP__
+#include "tools-cache.hpp"    // for file_identity
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+namespace journal
+{
+
+namespace
+{
+
+/**
+ * \brief FNV-1a offset basis for 64 bit.
+ */
+constexpr std::uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325;
+
+/**
+ * \brief FNV-1a prime for 64 bit.
+ */
+constexpr std::uint64_t FNV_PRIME = 0x100000001b3;
+
+/**
+ * \brief Number of hexadecimal digits of key and digest.
+ */
+constexpr std::size_t HEX_DIGITS = 16;
+
+
+/**
+ * \brief Add name, size and modification time of a file to a hash.
+ */
+void add_file(Fnv1a& hash, const std::string& filename)
+{
+	const auto identity { cache::file_identity(filename) };
+
+	hash.add(filename)
+		.add(identity.size)
+		.add(static_cast<std::uint64_t>(identity.mtime));
+}
+
+} // namespace
+
+
+// Fnv1a
+
+
+Fnv1a::Fnv1a()
+	: value_ { FNV_OFFSET_BASIS }
+{
+	// empty
+}
+
+
+Fnv1a& Fnv1a::add(const std::string& s)
+{
+	for (const auto c : s)
+	{
+		add_byte(static_cast<unsigned char>(c));
+	}
+
+	add_byte(0);
+
+	return *this;
+}
+
+
+Fnv1a& Fnv1a::add(const std::uint64_t v)
+{
+	for (auto i = 0; i < 8; ++i)
+	{
+		add_byte(static_cast<unsigned char>(v >> (8 * i)));
+	}
+
+	return *this;
+}
+
+
+std::uint64_t Fnv1a::value() const
+{
+	return value_;
+}
+
+
+void Fnv1a::add_byte(const unsigned char b)
+{
+	value_ = (value_ ^ b) * FNV_PRIME;
+}
+
+
+// album_key
+
+
+std::uint64_t album_key(const batch::Album& album,
+		const std::vector<std::string>& audiofiles)
+{
+	auto hash = Fnv1a {};
+
+	add_file(hash, album.metafile);
+
+	for (const auto& audiofile : audiofiles)
+	{
+		add_file(hash, audiofile);
+	}
+
+	return hash.value();
+}
+
+
+// Journal
+
+
+Journal::Journal(const std::string& filename, const std::size_t group,
+		const std::chrono::milliseconds interval)
+	: filename_        { filename }
+	, group_           { group > 0 ? group : 1 }
+	, interval_        { interval }
+	, keys_            { /* empty */ }
+	, pending_         { /* empty */ }
+	, pending_entries_ { 0 }
+	, oldest_          { /* epoch */ }
+	, fd_              { -1 }
+	, mutex_           { /* default */ }
+	, signal_          { /* default */ }
+	, stop_            { false }
+	, thread_          { /* empty */ }
+{
+	const auto incomplete { load() };
+
+	fd_ = ::open(filename_.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC,
+			0644);
+
+	if (fd_ < 0)
+	{
+		throw std::runtime_error("Could not open journal " + filename_ + ": "
+				+ std::strerror(errno));
+	}
+
+	// An incomplete line is left by an interrupted write, start a new line
+	// to keep the next entry intact
+
+	if (incomplete)
+	{
+		try
+		{
+			pending_ = "\n";
+			flush_locked();
+
+		} catch (...)
+		{
+			::close(fd_);
+			throw;
+		}
+	}
+
+	if (interval_.count() > 0)
+	{
+		thread_ = std::thread { &Journal::run, this };
+	}
+
+	ARCS_LOG_INFO << "Journal " << filename_ << " contains " << keys_.size()
+		<< " completed albums";
+}
+
+
+Journal::Journal(const std::string& filename, const std::size_t group)
+	: Journal(filename, group, FLUSH_INTERVAL)
+{
+	// empty
+}
+
+
+Journal::Journal(const std::string& filename)
+	: Journal(filename, GROUP_SIZE, FLUSH_INTERVAL)
+{
+	// empty
+}
+
+
+Journal::~Journal() noexcept
+{
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	signal_.notify_all();
+
+	if (thread_.joinable())
+	{
+		thread_.join();
+	}
+
+	try
+	{
+		flush();
+
+	} catch (const std::exception& e)
+	{
+		ARCS_LOG_ERROR << e.what();
+	}
+
+	::close(fd_);
+}
+
+
+bool Journal::contains(const std::uint64_t key) const
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+
+	return keys_.find(key) != keys_.end();
+}
+
+
+void Journal::append(const std::uint64_t key, const std::uint64_t digest,
+		const std::string& name)
+{
+	auto line = std::ostringstream {};
+
+	line << std::hex << std::setfill('0')
+		<< std::setw(HEX_DIGITS) << key << ' '
+		<< std::setw(HEX_DIGITS) << digest << ' ' << name << '\n';
+
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+
+		if (pending_.empty())
+		{
+			oldest_ = std::chrono::steady_clock::now();
+		}
+
+		keys_.insert(key);
+		pending_ += line.str();
+
+		if (++pending_entries_ >= group_)
+		{
+			flush_locked();
+			return;
+		}
+	}
+
+	// The background thread writes the entry if the group is not full in time
+
+	signal_.notify_all();
+}
+
+
+void Journal::flush()
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+
+	flush_locked();
+}
+
+
+std::size_t Journal::size() const
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+
+	return keys_.size();
+}
+
+
+bool Journal::load()
+{
+	auto in = std::ifstream { filename_, std::ios::binary };
+
+	if (!in)
+	{
+		return false; // Not yet existing
+	}
+
+	auto line = std::string {};
+	auto incomplete = false;
+
+	while (std::getline(in, line))
+	{
+		incomplete = in.eof(); // Last line without newline
+
+		if (line.size() < 2 * HEX_DIGITS + 2 || ' ' != line[HEX_DIGITS])
+		{
+			continue;
+		}
+
+		auto end = static_cast<char*>(nullptr);
+		const auto key { std::strtoull(line.c_str(), &end, 16) };
+
+		if (end == line.c_str() + HEX_DIGITS)
+		{
+			keys_.insert(key);
+		}
+	}
+
+	return incomplete;
+}
+
+
+void Journal::flush_locked()
+{
+	if (pending_.empty())
+	{
+		return;
+	}
+
+	auto written = std::size_t { 0 };
+
+	while (written < pending_.size())
+	{
+		const auto n { ::write(fd_, pending_.data() + written,
+				pending_.size() - written) };
+
+		if (n < 0)
+		{
+			if (EINTR == errno)
+			{
+				continue;
+			}
+
+			// Keep the entries not written for the next attempt
+
+			const auto error { std::strerror(errno) };
+			pending_.erase(0, written);
+
+			throw std::runtime_error("Could not write journal " + filename_
+					+ ": " + error);
+		}
+
+		written += static_cast<std::size_t>(n);
+	}
+
+	pending_.clear();
+	pending_entries_ = 0;
+
+	// The entries are only durable when they are on the disk
+
+	if (::fsync(fd_) != 0)
+	{
+		throw std::runtime_error("Could not sync journal " + filename_ + ": "
+				+ std::strerror(errno));
+	}
+}
+
+
+void Journal::run()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+
+	while (!stop_)
+	{
+		if (pending_.empty())
+		{
+			signal_.wait(lock, [this]{ return stop_ || !pending_.empty(); });
+			continue;
+		}
+
+		const auto due { oldest_ + interval_ };
+
+		if (signal_.wait_until(lock, due, [this]{ return stop_; }))
+		{
+			break;
+		}
+
+		// Entries appended after a group was written are due later
+
+		if (!pending_.empty()
+				&& std::chrono::steady_clock::now() >= oldest_ + interval_)
+		{
+			try
+			{
+				flush_locked();
+
+			} catch (const std::exception& e)
+			{
+				ARCS_LOG_ERROR << e.what();
+
+				// Retry after the next interval
+				oldest_ = std::chrono::steady_clock::now();
+			}
+		}
+	}
+}
+
+} // namespace journal
+} // namespace v_1_0_0
+} // namespace arcsapp
+
@@ -0,0 +1,304 @@
+#ifndef __ARCSTOOLS_TOOLS_JOURNAL_HPP__
+#define __ARCSTOOLS_TOOLS_JOURNAL_HPP__
+
+/**
+ * \file
+ *
+ * \brief Journal of completed albums for resuming batch runs.
+ */
+
+#include <chrono>              // for milliseconds, steady_clock
+#include <condition_variable>  // for condition_variable
+#include <cstddef>             // for size_t
+#include <cstdint>             // for uint64_t
+#include <mutex>               // for mutex
+#include <string>              // for string
+#include <thread>              // for thread
+#include <unordered_set>       // for unordered_set
+#include <vector>              // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_BATCH_HPP__
+#include "tools-batch.hpp"    // for Album
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+
+/**
+ * \brief Tools and helpers for resuming interrupted runs.
+ */
+namespace journal
+{
+
+/**
+ * \brief 64 bit FNV-1a hash for journal keys and result digests.
+ */
+class Fnv1a final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 */
+	Fnv1a();
+
+	/**
+	 * \brief Add the characters of a string to the hash.
+	 *
+	 * The string is terminated by a 0 byte in the hash, hence consecutive
+	 * strings cannot be confused.
+	 *
+	 * \param[in] s String to add
+	 *
+	 * \return This hash
+	 */
+	Fnv1a& add(const std::string& s);
+
+	/**
+	 * \brief Add the bytes of a value to the hash.
+	 *
+	 * \param[in] v Value to add
+	 *
+	 * \return This hash
+	 */
+	Fnv1a& add(const std::uint64_t v);
+
+	/**
+	 * \brief Current hash value.
+	 *
+	 * \return Current hash value
+	 */
+	std::uint64_t value() const;
+
+private:
+
+	void add_byte(const unsigned char b);
+
+	/**
+	 * \brief Current hash value.
+	 */
+	std::uint64_t value_;
+};
+
+
+/**
+ * \brief Key of an album in the journal.
+ *
+ * The key is derived from the name, the size and the modification time of the
+ * metafile and of each audio file of the album. If the album names no audio
+ * files, they are taken from its metafile by the caller, e.g. by
+ * calc::ChecksumCalculator::audiofiles(). Thus, a changed audio file is
+ * detected even if its metafile is unchanged.
+ *
+ * \param[in] album      The album to identify
+ * \param[in] audiofiles The audio files of the album, resolved from the
+ *                       metafile if the album names none
+ *
+ * \return Key of the album
+ *
+ * \throws std::runtime_error If a file of the album cannot be accessed
+ */
+std::uint64_t album_key(const batch::Album& album,
+		const std::vector<std::string>& audiofiles);
+
+
+/**
+ * \brief Append-only journal of the albums completed.
+ *
+ * The journal file contains a line for each completed album, consisting of
+ * the key of the album, the digest of its result and the name of its metafile.
+ * Key and digest are 16 hexadecimal digits each, the fields are separated by
+ * a single blank. Only the keys are loaded, lines that are incomplete are
+ * ignored.
+ *
+ * Entries are written in groups to keep appending cheap. A group is written
+ * as soon as it is full or its oldest entry is pending for the flush
+ * interval, and each group written is synced to the disk. If the process
+ * dies, at most the last group is lost, thus only its albums are processed
+ * again when resuming.
+ *
+ * The journal can be used from multiple threads.
+ */
+class Journal final
+{
+public:
+
+	/**
+	 * \brief Default number of entries written as a group.
+	 */
+	static constexpr std::size_t GROUP_SIZE = 64;
+
+	/**
+	 * \brief Default time an entry is pending at most.
+	 */
+	static constexpr std::chrono::milliseconds FLUSH_INTERVAL { 5000 };
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * Loads the keys from the journal file and opens it for appending. If the
+	 * file does not exist, it is created. An interval of 0 starts no
+	 * background thread, the entries are then only written in full groups
+	 * and by flush().
+	 *
+	 * \param[in] filename Name of the journal file
+	 * \param[in] group    Number of entries written as a group
+	 * \param[in] interval Time an entry is pending at most
+	 *
+	 * \throws std::runtime_error If the journal file cannot be opened
+	 */
+	Journal(const std::string& filename, const std::size_t group,
+			const std::chrono::milliseconds interval);
+
+	/**
+	 * \brief Constructor for FLUSH_INTERVAL.
+	 *
+	 * \param[in] filename Name of the journal file
+	 * \param[in] group    Number of entries written as a group
+	 *
+	 * \throws std::runtime_error If the journal file cannot be opened
+	 */
+	Journal(const std::string& filename, const std::size_t group);
+
+	/**
+	 * \brief Constructor for GROUP_SIZE and FLUSH_INTERVAL.
+	 *
+	 * \param[in] filename Name of the journal file
+	 *
+	 * \throws std::runtime_error If the journal file cannot be opened
+	 */
+	explicit Journal(const std::string& filename);
+
+	Journal(const Journal&) = delete;
+	Journal& operator=(const Journal&) = delete;
+
+	/**
+	 * \brief Destructor.
+	 *
+	 * Stops the background thread and writes the pending entries.
+	 */
+	~Journal() noexcept;
+
+	/**
+	 * \brief TRUE iff the album with the specified key is completed.
+	 *
+	 * \param[in] key Key of the album
+	 *
+	 * \return TRUE iff the album is in the journal
+	 */
+	bool contains(const std::uint64_t key) const;
+
+	/**
+	 * \brief Add a completed album.
+	 *
+	 * \param[in] key    Key of the album
+	 * \param[in] digest Digest of the result of the album
+	 * \param[in] name   Name of the metafile of the album
+	 */
+	void append(const std::uint64_t key, const std::uint64_t digest,
+			const std::string& name);
+
+	/**
+	 * \brief Write the pending entries to the journal file and sync it.
+	 *
+	 * \throws std::runtime_error If the entries cannot be written
+	 */
+	void flush();
+
+	/**
+	 * \brief Number of albums in the journal.
+	 *
+	 * \return Number of albums in the journal
+	 */
+	std::size_t size() const;
+
+private:
+
+	/**
+	 * \brief Load the keys of the journal file.
+	 *
+	 * \return TRUE iff the file ends with an incomplete line
+	 */
+	bool load();
+
+	/**
+	 * \brief Write the pending entries, requires the lock to be held.
+	 *
+	 * \throws std::runtime_error If the entries cannot be written
+	 */
+	void flush_locked();
+
+	/**
+	 * \brief Write the entries pending for the interval until stopped.
+	 */
+	void run();
+
+	/**
+	 * \brief Name of the journal file.
+	 */
+	std::string filename_;
+
+	/**
+	 * \brief Number of entries written as a group.
+	 */
+	std::size_t group_;
+
+	/**
+	 * \brief Time an entry is pending at most.
+	 */
+	std::chrono::milliseconds interval_;
+
+	/**
+	 * \brief Keys of the albums completed.
+	 */
+	std::unordered_set<std::uint64_t> keys_;
+
+	/**
+	 * \brief Entries not yet written.
+	 */
+	std::string pending_;
+
+	/**
+	 * \brief Number of entries not yet written.
+	 */
+	std::size_t pending_entries_;
+
+	/**
+	 * \brief Time the oldest pending entry was appended.
+	 */
+	std::chrono::steady_clock::time_point oldest_;
+
+	/**
+	 * \brief Descriptor of the journal file opened for appending.
+	 */
+	int fd_;
+
+	/**
+	 * \brief Guard for keys and pending entries.
+	 */
+	mutable std::mutex mutex_;
+
+	/**
+	 * \brief Signals the background thread an entry or to stop.
+	 */
+	std::condition_variable signal_;
+
+	/**
+	 * \brief TRUE iff the background thread is to stop.
+	 */
+	bool stop_;
+
+	/**
+	 * \brief The background thread.
+	 */
+	std::thread thread_;
+};
+
+} // namespace journal
+} // namespace v_1_0_0
+} // namespace arcsapp
+
+#endif
+
@@ -0,0 +1,407 @@
+/**
+ * \file tools-kernel.cpp Kernels of the ARCS calculation
+ */
+
+#ifndef __ARCSTOOLS_TOOLS_KERNEL_HPP__
+#include "tools-kernel.hpp"
+#endif
+
+#include <cstdint>     // for uint32_t, uint64_t, UINT32_MAX
+#include <stdexcept>   // for invalid_argument, logic_error
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ARCSTOOLS_KERNEL_X86
+#include <immintrin.h> // for __m128i, __m256i, __m512i, _mm*_mul_epu32
+#endif
+
+#ifndef __LIBARCSTK_LOGGING_HPP__
+#include <arcstk/logging.hpp>
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+namespace kernel
+{
+
+namespace
+{
+
+/**
+ * \brief TRUE iff the multipliers of the samples fit in 32 bits.
+ */
+bool fits_vector(const std::size_t count, const std::uint64_t multiplier)
+{
+	return multiplier + count <= UINT32_MAX;
+}
+
+
+#ifdef ARCSTOOLS_KERNEL_X86
+
+// Each 64 bit lane holds two samples. The even samples are multiplied in
+// place, the odd samples after shifting them to the lower half of the lane.
+// The lower and higher halves of the 64 bit products are summed up in
+// separate lanes, only the lower 32 bits of the lane sums are used.
+
+
+/**
+ * \brief Vector kernel for SSE2.
+ */
+__attribute__((target("sse2")))
+void sse2(const Sample* samples, const std::size_t count,
+		const std::uint64_t multiplier, std::uint32_t* sum_lo,
+		std::uint32_t* sum_hi)
+{
+	if (!fits_vector(count, multiplier))
+	{
+		scalar(samples, count, multiplier, sum_lo, sum_hi);
+		return;
+	}
+
+	const auto lo_mask { _mm_set1_epi64x(0xFFFFFFFF) };
+	const auto step    { _mm_set1_epi64x(4) };
+
+	auto m_even { _mm_set_epi64x(static_cast<long long>(multiplier + 2),
+			static_cast<long long>(multiplier)) };
+	auto m_odd  { _mm_add_epi64(m_even, _mm_set1_epi64x(1)) };
+
+	auto lo { _mm_setzero_si128() };
+	auto hi { _mm_setzero_si128() };
+
+	auto i = std::size_t { 0 };
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const auto v { _mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(samples + i)) };
+
+		const auto even { _mm_mul_epu32(v, m_even) };
+		const auto odd  { _mm_mul_epu32(_mm_srli_epi64(v, 32), m_odd) };
+
+		lo = _mm_add_epi64(lo, _mm_and_si128(even, lo_mask));
+		lo = _mm_add_epi64(lo, _mm_and_si128(odd,  lo_mask));
+		hi = _mm_add_epi64(hi, _mm_srli_epi64(even, 32));
+		hi = _mm_add_epi64(hi, _mm_srli_epi64(odd,  32));
+
+		m_even = _mm_add_epi64(m_even, step);
+		m_odd  = _mm_add_epi64(m_odd,  step);
+	}
+
+	alignas(16) std::uint64_t lanes_lo[2];
+	alignas(16) std::uint64_t lanes_hi[2];
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes_lo), lo);
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes_hi), hi);
+
+	for (auto k = 0; k < 2; ++k)
+	{
+		*sum_lo += static_cast<std::uint32_t>(lanes_lo[k]);
+		*sum_hi += static_cast<std::uint32_t>(lanes_hi[k]);
+	}
+
+	scalar(samples + i, count - i, multiplier + i, sum_lo, sum_hi);
+}
+
+
+/**
+ * \brief Vector kernel for AVX2.
+ */
+__attribute__((target("avx2")))
+void avx2(const Sample* samples, const std::size_t count,
+		const std::uint64_t multiplier, std::uint32_t* sum_lo,
+		std::uint32_t* sum_hi)
+{
+	if (!fits_vector(count, multiplier))
+	{
+		scalar(samples, count, multiplier, sum_lo, sum_hi);
+		return;
+	}
+
+	const auto m { static_cast<long long>(multiplier) };
+
+	const auto lo_mask { _mm256_set1_epi64x(0xFFFFFFFF) };
+	const auto step    { _mm256_set1_epi64x(8) };
+
+	auto m_even { _mm256_set_epi64x(m + 6, m + 4, m + 2, m) };
+	auto m_odd  { _mm256_add_epi64(m_even, _mm256_set1_epi64x(1)) };
+
+	auto lo { _mm256_setzero_si256() };
+	auto hi { _mm256_setzero_si256() };
+
+	auto i = std::size_t { 0 };
+
+	for (; i + 8 <= count; i += 8)
+	{
+		const auto v { _mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(samples + i)) };
+
+		const auto even { _mm256_mul_epu32(v, m_even) };
+		const auto odd  { _mm256_mul_epu32(_mm256_srli_epi64(v, 32), m_odd) };
+
+		lo = _mm256_add_epi64(lo, _mm256_and_si256(even, lo_mask));
+		lo = _mm256_add_epi64(lo, _mm256_and_si256(odd,  lo_mask));
+		hi = _mm256_add_epi64(hi, _mm256_srli_epi64(even, 32));
+		hi = _mm256_add_epi64(hi, _mm256_srli_epi64(odd,  32));
+
+		m_even = _mm256_add_epi64(m_even, step);
+		m_odd  = _mm256_add_epi64(m_odd,  step);
+	}
+
+	alignas(32) std::uint64_t lanes_lo[4];
+	alignas(32) std::uint64_t lanes_hi[4];
+	_mm256_store_si256(reinterpret_cast<__m256i*>(lanes_lo), lo);
+	_mm256_store_si256(reinterpret_cast<__m256i*>(lanes_hi), hi);
+
+	for (auto k = 0; k < 4; ++k)
+	{
+		*sum_lo += static_cast<std::uint32_t>(lanes_lo[k]);
+		*sum_hi += static_cast<std::uint32_t>(lanes_hi[k]);
+	}
+
+	scalar(samples + i, count - i, multiplier + i, sum_lo, sum_hi);
+}
+
+
+// The intrinsics of GCC pass undefined vectors as masked-off sources
+
+#if !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+/**
+ * \brief Vector kernel for AVX-512.
+ */
+__attribute__((target("avx512f")))
+void avx512(const Sample* samples, const std::size_t count,
+		const std::uint64_t multiplier, std::uint32_t* sum_lo,
+		std::uint32_t* sum_hi)
+{
+	if (!fits_vector(count, multiplier))
+	{
+		scalar(samples, count, multiplier, sum_lo, sum_hi);
+		return;
+	}
+
+	const auto m { static_cast<long long>(multiplier) };
+
+	const auto lo_mask { _mm512_set1_epi64(0xFFFFFFFF) };
+	const auto step    { _mm512_set1_epi64(16) };
+
+	auto m_even { _mm512_set_epi64(m + 14, m + 12, m + 10, m + 8,
+			m + 6, m + 4, m + 2, m) };
+	auto m_odd  { _mm512_add_epi64(m_even, _mm512_set1_epi64(1)) };
+
+	auto lo { _mm512_setzero_si512() };
+	auto hi { _mm512_setzero_si512() };
+
+	auto i = std::size_t { 0 };
+
+	for (; i + 16 <= count; i += 16)
+	{
+		const auto v { _mm512_loadu_si512(samples + i) };
+
+		const auto even { _mm512_mul_epu32(v, m_even) };
+		const auto odd  { _mm512_mul_epu32(_mm512_srli_epi64(v, 32), m_odd) };
+
+		lo = _mm512_add_epi64(lo, _mm512_and_si512(even, lo_mask));
+		lo = _mm512_add_epi64(lo, _mm512_and_si512(odd,  lo_mask));
+		hi = _mm512_add_epi64(hi, _mm512_srli_epi64(even, 32));
+		hi = _mm512_add_epi64(hi, _mm512_srli_epi64(odd,  32));
+
+		m_even = _mm512_add_epi64(m_even, step);
+		m_odd  = _mm512_add_epi64(m_odd,  step);
+	}
+
+	alignas(64) std::uint64_t lanes_lo[8];
+	alignas(64) std::uint64_t lanes_hi[8];
+	_mm512_store_si512(lanes_lo, lo);
+	_mm512_store_si512(lanes_hi, hi);
+
+	for (auto k = 0; k < 8; ++k)
+	{
+		*sum_lo += static_cast<std::uint32_t>(lanes_lo[k]);
+		*sum_hi += static_cast<std::uint32_t>(lanes_hi[k]);
+	}
+
+	scalar(samples + i, count - i, multiplier + i, sum_lo, sum_hi);
+}
+
+#if !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // ARCSTOOLS_KERNEL_X86
+
+
+/**
+ * \brief Kernel of Engine::CHECKED.
+ */
+void checked(const Sample* samples, const std::size_t count,
+		const std::uint64_t multiplier, std::uint32_t* sum_lo,
+		std::uint32_t* sum_hi)
+{
+	static const auto vector { vector_kernel(detect_isa()) };
+
+	auto expected_lo { *sum_lo };
+	auto expected_hi { *sum_hi };
+
+	scalar(samples, count, multiplier, &expected_lo, &expected_hi);
+	vector(samples, count, multiplier, sum_lo, sum_hi);
+
+	if (*sum_lo != expected_lo || *sum_hi != expected_hi)
+	{
+		throw std::logic_error("Kernel " + name(detect_isa())
+				+ " differs from scalar kernel for " + std::to_string(count)
+				+ " samples from multiplier " + std::to_string(multiplier));
+	}
+}
+
+} // namespace
+
+
+Engine to_engine(const std::string& name)
+{
+	if ("scalar" == name)
+	{
+		return Engine::SCALAR;
+	}
+
+	if ("simd" == name)
+	{
+		return Engine::SIMD;
+	}
+
+	if ("checked" == name)
+	{
+		return Engine::CHECKED;
+	}
+
+	throw std::invalid_argument("Unknown engine '" + name
+			+ "', expected 'scalar', 'simd' or 'checked'");
+}
+
+
+std::string name(const Engine engine)
+{
+	switch (engine)
+	{
+		case Engine::SIMD:    return "simd";
+		case Engine::CHECKED: return "checked";
+		default:              return "scalar";
+	}
+}
+
+
+std::string name(const Isa isa)
+{
+	switch (isa)
+	{
+		case Isa::SSE2:   return "sse2";
+		case Isa::AVX2:   return "avx2";
+		case Isa::AVX512: return "avx512";
+		default:          return "none";
+	}
+}
+
+
+Isa detect_isa()
+{
+	const auto isas { supported_isas() };
+
+	return isas.empty() ? Isa::NONE : isas.back();
+}
+
+
+std::vector<Isa> supported_isas()
+{
+	auto isas = std::vector<Isa> {};
+
+#ifdef ARCSTOOLS_KERNEL_X86
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("sse2"))
+	{
+		isas.push_back(Isa::SSE2);
+	}
+
+	if (__builtin_cpu_supports("avx2"))
+	{
+		isas.push_back(Isa::AVX2);
+	}
+
+	if (__builtin_cpu_supports("avx512f"))
+	{
+		isas.push_back(Isa::AVX512);
+	}
+#endif
+
+	return isas;
+}
+
+
+void scalar(const Sample* samples, const std::size_t count,
+		const std::uint64_t multiplier, std::uint32_t* sum_lo,
+		std::uint32_t* sum_hi)
+{
+	auto lo { *sum_lo };
+	auto hi { *sum_hi };
+	auto m  { multiplier };
+
+	for (std::size_t i = 0; i < count; ++i, ++m)
+	{
+		const auto product = m * samples[i];
+
+		lo += static_cast<std::uint32_t>(product);
+		hi += static_cast<std::uint32_t>(product >> 32);
+	}
+
+	*sum_lo = lo;
+	*sum_hi = hi;
+}
+
+
+Kernel vector_kernel(const Isa isa)
+{
+	switch (isa)
+	{
+#ifdef ARCSTOOLS_KERNEL_X86
+		case Isa::SSE2:   return sse2;
+		case Isa::AVX2:   return avx2;
+		case Isa::AVX512: return avx512;
+#endif
+		default:          return scalar;
+	}
+}
+
+
+Kernel select(const Engine engine)
+{
+	if (Engine::SCALAR == engine)
+	{
+		return scalar;
+	}
+
+	static const auto isa = []
+	{
+		const auto detected { detect_isa() };
+
+		if (Isa::NONE == detected)
+		{
+			ARCS_LOG_WARNING << "No vector kernel for this CPU, "
+				"use scalar kernel";
+		} else
+		{
+			ARCS_LOG_INFO << "Use vector kernel " << name(detected);
+		}
+
+		return detected;
+	}();
+
+	return Engine::CHECKED == engine ? checked : vector_kernel(isa);
+}
+
+} // namespace kernel
+} // namespace v_1_0_0
+} // namespace arcsapp
+
@@ -0,0 +1,166 @@
+#ifndef __ARCSTOOLS_TOOLS_KERNEL_HPP__
+#define __ARCSTOOLS_TOOLS_KERNEL_HPP__
+
+/**
+ * \file
+ *
+ * \brief Kernels summing up the products of samples and their multipliers.
+ */
+
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint32_t, uint64_t
+#include <string>      // for string
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_PCM_HPP__
+#include "tools-pcm.hpp"      // for Sample
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+
+/**
+ * \brief Tools and helpers for the inner loop of the ARCS calculation.
+ *
+ * A kernel updates the sums of the lower and of the higher 32 bits of the
+ * products of each sample with its multiplier. The scalar kernel processes
+ * one sample at a time. The vector kernels multiply several samples with a
+ * single instruction and are selected at runtime for the instruction set of
+ * the CPU.
+ */
+namespace kernel
+{
+
+using pcm::Sample;
+
+/**
+ * \brief Update the sums with a sequence of samples.
+ *
+ * The first sample is multiplied by \c multiplier, each following sample by
+ * the multiplier of its predecessor plus 1.
+ *
+ * \param[in]     samples    Pointer to the first sample
+ * \param[in]     count      Number of samples
+ * \param[in]     multiplier Multiplier of the first sample
+ * \param[in,out] sum_lo     Sum of the lower 32 bits of the products
+ * \param[in,out] sum_hi     Sum of the higher 32 bits of the products
+ */
+using Kernel = void (*)(const Sample* samples, const std::size_t count,
+		const std::uint64_t multiplier, std::uint32_t* sum_lo,
+		std::uint32_t* sum_hi);
+
+
+/**
+ * \brief Engines to calculate the ARCSs of the samples read by arcs-tools.
+ */
+enum class Engine
+{
+	SCALAR, //!< The scalar kernel
+	SIMD,   //!< The widest vector kernel the CPU supports
+	CHECKED //!< The vector kernel, verified by the scalar kernel
+};
+
+
+/**
+ * \brief Instruction sets of the vector kernels.
+ */
+enum class Isa
+{
+	NONE,   //!< No vector kernel, e.g. on a CPU other than x86
+	SSE2,   //!< 2 products per instruction
+	AVX2,   //!< 4 products per instruction
+	AVX512  //!< 8 products per instruction
+};
+
+
+/**
+ * \brief Engine for the specified name.
+ *
+ * Valid names are 'scalar', 'simd' and 'checked'.
+ *
+ * \param[in] name Name of the engine
+ *
+ * \return Engine for \c name
+ *
+ * \throws std::invalid_argument If \c name is not the name of an engine
+ */
+Engine to_engine(const std::string& name);
+
+
+/**
+ * \brief Name of an engine.
+ *
+ * \param[in] engine The engine to get the name for
+ *
+ * \return Name of \c engine
+ */
+std::string name(const Engine engine);
+
+
+/**
+ * \brief Name of an instruction set.
+ *
+ * \param[in] isa The instruction set to get the name for
+ *
+ * \return Name of \c isa
+ */
+std::string name(const Isa isa);
+
+
+/**
+ * \brief Widest instruction set with a vector kernel the CPU supports.
+ *
+ * \return Instruction set of the CPU, Isa::NONE if no vector kernel applies
+ */
+Isa detect_isa();
+
+
+/**
+ * \brief Instruction sets with a vector kernel the CPU supports.
+ *
+ * \return Supported instruction sets, from the narrowest to the widest
+ */
+std::vector<Isa> supported_isas();
+
+
+/**
+ * \brief The scalar kernel.
+ */
+void scalar(const Sample* samples, const std::size_t count,
+		const std::uint64_t multiplier, std::uint32_t* sum_lo,
+		std::uint32_t* sum_hi);
+
+
+/**
+ * \brief Vector kernel for an instruction set.
+ *
+ * The vector kernels require multipliers below 2^32, which is the case for
+ * any track on a CD. Otherwise, they fall back on the scalar kernel.
+ *
+ * \param[in] isa The instruction set to use
+ *
+ * \return Kernel for \c isa, the scalar kernel for Isa::NONE
+ */
+Kernel vector_kernel(const Isa isa);
+
+
+/**
+ * \brief Kernel for an engine.
+ *
+ * The kernel of Engine::CHECKED throws a std::logic_error if the vector
+ * kernel and the scalar kernel differ in their sums.
+ *
+ * \param[in] engine The engine
+ *
+ * \return Kernel for \c engine on this CPU
+ */
+Kernel select(const Engine engine);
+
+} // namespace kernel
+} // namespace v_1_0_0
+} // namespace arcsapp
+
+#endif
+
@@ -0,0 +1,484 @@
+/**
+ * \file tools-parallel.cpp Run tasks concurrently
+ */
+
+#ifndef __ARCSTOOLS_TOOLS_PARALLEL_HPP__
+#include "tools-parallel.hpp"
+#endif
+
+#include <algorithm>   // for max, min
+#include <cstddef>     // for size_t
+#include <exception>   // for current_exception, rethrow_exception
+#include <mutex>       // for lock_guard, unique_lock
+#include <string>      // for to_string
+#include <thread>      // for thread
+#include <utility>     // for move
+
+#ifndef __LIBARCSTK_LOGGING_HPP__
+#include <arcstk/logging.hpp>
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+namespace parallel
+{
+
+namespace
+{
+
+/**
+ * \brief Initialize a worker thread, a failure only affects performance.
+ */
+void init_worker(const WorkerInit& init, const std::size_t index)
+{
+	if (!init)
+	{
+		return;
+	}
+
+	try
+	{
+		init(index);
+
+	} catch (const std::exception& e)
+	{
+		ARCS_LOG_WARNING << "Could not initialize worker " << index << ": "
+			<< e.what();
+	}
+}
+
+} // namespace
+
+
+std::size_t worker_count(const std::size_t requested)
+{
+	if (requested > 0)
+	{
+		return requested;
+	}
+
+	const auto hw_threads = std::thread::hardware_concurrency();
+
+	return hw_threads > 0 ? hw_threads : 1;
+}
+
+
+// TaskPool
+
+
+TaskPool::TaskPool(const std::size_t workers)
+	: TaskPool(workers, nullptr)
+{
+	// empty
+}
+
+
+TaskPool::TaskPool(const std::size_t workers, WorkerInit init)
+	: workers_        { /* empty */ }
+	, init_           { std::move(init) }
+	, tasks_          { /* empty */ }
+	, mutex_          { /* default */ }
+	, task_available_ { /* default */ }
+	, all_done_       { /* default */ }
+	, running_        { 0 }
+	, stop_           { false }
+	, error_          { nullptr }
+{
+	const auto total = std::max(workers, std::size_t { 1 });
+
+	ARCS_LOG(DEBUG1) << "Start " << total << " worker threads";
+
+	workers_.reserve(total);
+	for (std::size_t i = 0; i < total; ++i)
+	{
+		workers_.emplace_back(&TaskPool::work, this, i);
+	}
+}
+
+
+TaskPool::~TaskPool() noexcept
+{
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		all_done_.wait(lock, [this]{ return tasks_.empty() && !running_; });
+		stop_ = true;
+	}
+
+	task_available_.notify_all();
+
+	for (auto& w : workers_)
+	{
+		w.join();
+	}
+}
+
+
+void TaskPool::submit(Task task)
+{
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		tasks_.push(std::move(task));
+	}
+
+	task_available_.notify_one();
+}
+
+
+void TaskPool::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	all_done_.wait(lock, [this]{ return tasks_.empty() && !running_; });
+
+	if (error_)
+	{
+		auto error = error_;
+		error_ = nullptr;
+		std::rethrow_exception(error);
+	}
+}
+
+
+std::size_t TaskPool::size() const
+{
+	return workers_.size();
+}
+
+
+void TaskPool::work(const std::size_t index)
+{
+	init_worker(init_, index);
+
+	while (true)
+	{
+		auto task = Task {};
+
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			task_available_.wait(lock,
+					[this]{ return stop_ || !tasks_.empty(); });
+
+			if (stop_ && tasks_.empty())
+			{
+				return;
+			}
+
+			task = std::move(tasks_.front());
+			tasks_.pop();
+			++running_;
+		}
+
+		try
+		{
+			task();
+
+		} catch (...)
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+
+			if (!error_)
+			{
+				error_ = std::current_exception();
+			}
+		}
+
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			--running_;
+		}
+
+		all_done_.notify_all();
+	}
+}
+
+
+// GroupedTaskPool
+
+
+GroupedTaskPool::GroupedTaskPool(const std::size_t workers, GroupLimit limit)
+	: GroupedTaskPool(workers, std::move(limit), nullptr)
+{
+	// empty
+}
+
+
+GroupedTaskPool::GroupedTaskPool(const std::size_t workers, GroupLimit limit,
+		WorkerInit init)
+	: workers_        { /* empty */ }
+	, limit_          { std::move(limit) }
+	, init_           { std::move(init) }
+	, groups_         { /* empty */ }
+	, submitted_      { 0 }
+	, queued_         { 0 }
+	, mutex_          { /* default */ }
+	, task_available_ { /* default */ }
+	, all_done_       { /* default */ }
+	, running_        { 0 }
+	, stop_           { false }
+	, error_          { nullptr }
+{
+	const auto total = std::max(workers, std::size_t { 1 });
+
+	ARCS_LOG(DEBUG1) << "Start " << total << " worker threads for groups";
+
+	workers_.reserve(total);
+	for (std::size_t i = 0; i < total; ++i)
+	{
+		workers_.emplace_back(&GroupedTaskPool::work, this, i);
+	}
+}
+
+
+GroupedTaskPool::~GroupedTaskPool() noexcept
+{
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		all_done_.wait(lock, [this]{ return !queued_ && !running_; });
+		stop_ = true;
+	}
+
+	task_available_.notify_all();
+
+	for (auto& w : workers_)
+	{
+		w.join();
+	}
+}
+
+
+void GroupedTaskPool::submit(const Group group, Task task)
+{
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+
+		auto state { groups_.find(group) };
+
+		if (state == groups_.end())
+		{
+			const auto limit { limit_(group) };
+
+			ARCS_LOG_DEBUG << "Group " << group << " runs "
+				<< (limit > 0 ? std::to_string(limit) : "any number of")
+				<< " tasks at once";
+
+			state = groups_.emplace(group, GroupState { {}, 0, limit }).first;
+		}
+
+		state->second.queued.push_back({ submitted_++, std::move(task) });
+		++queued_;
+	}
+
+	task_available_.notify_one();
+}
+
+
+void GroupedTaskPool::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	all_done_.wait(lock, [this]{ return !queued_ && !running_; });
+
+	if (error_)
+	{
+		auto error = error_;
+		error_ = nullptr;
+		std::rethrow_exception(error);
+	}
+}
+
+
+std::size_t GroupedTaskPool::size() const
+{
+	return workers_.size();
+}
+
+
+void GroupedTaskPool::work(const std::size_t index)
+{
+	init_worker(init_, index);
+
+	while (true)
+	{
+		auto task  = Task {};
+		auto state = static_cast<GroupState*>(nullptr);
+
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			task_available_.wait(lock, [this,&state]
+				{
+					state = next_group();
+					return stop_ || state;
+				});
+
+			if (!state)
+			{
+				return; // Stopped and nothing queued
+			}
+
+			task = std::move(state->queued.front().task);
+			state->queued.pop_front();
+			--queued_;
+			++state->running;
+			++running_;
+		}
+
+		try
+		{
+			task();
+
+		} catch (...)
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+
+			if (!error_)
+			{
+				error_ = std::current_exception();
+			}
+		}
+
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			--state->running;
+			--running_;
+		}
+
+		// A task of the same group may start now
+
+		task_available_.notify_all();
+		all_done_.notify_all();
+	}
+}
+
+
+GroupedTaskPool::GroupState* GroupedTaskPool::next_group()
+{
+	auto next = static_cast<GroupState*>(nullptr);
+
+	for (auto& [ group, state ] : groups_)
+	{
+		if (state.queued.empty()
+				|| (state.limit > 0 && state.running >= state.limit))
+		{
+			continue;
+		}
+
+		if (!next || state.queued.front().sequence
+				< next->queued.front().sequence)
+		{
+			next = &state;
+		}
+	}
+
+	return next;
+}
+
+
+// MemoryGovernor
+
+
+MemoryGovernor::MemoryGovernor(const std::size_t limit)
+	: limit_    { limit }
+	, in_use_   { 0 }
+	, running_  { 0 }
+	, admitted_ { 0 }
+	, deferred_ { 0 }
+	, peak_     { 0 }
+	, mutex_    { /* default */ }
+	, released_ { /* default */ }
+{
+	// empty
+}
+
+
+void MemoryGovernor::acquire(const std::size_t bytes)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+
+	const auto fits = [this,bytes]
+	{
+		return 0 == limit_ || 0 == running_ || in_use_ + bytes <= limit_;
+	};
+
+	if (!fits())
+	{
+		++deferred_;
+
+		ARCS_LOG_DEBUG << "Defer job of " << bytes << " bytes, "
+			<< in_use_ << " of " << limit_ << " bytes in use";
+
+		released_.wait(lock, fits);
+	}
+
+	if (limit_ > 0 && bytes > limit_)
+	{
+		ARCS_LOG_WARNING << "Job of " << bytes << " bytes exceeds the "
+			"memory limit of " << limit_ << " bytes, run it alone";
+	}
+
+	in_use_ += bytes;
+	++running_;
+	++admitted_;
+	peak_ = std::max(peak_, in_use_);
+}
+
+
+void MemoryGovernor::release(const std::size_t bytes)
+{
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+
+		in_use_ -= std::min(bytes, in_use_);
+		--running_;
+	}
+
+	released_.notify_all();
+}
+
+
+std::size_t MemoryGovernor::limit() const
+{
+	return limit_;
+}
+
+
+std::size_t MemoryGovernor::admitted() const
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+	return admitted_;
+}
+
+
+std::size_t MemoryGovernor::deferred() const
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+	return deferred_;
+}
+
+
+std::size_t MemoryGovernor::peak() const
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+	return peak_;
+}
+
+
+// Admission
+
+
+Admission::Admission(MemoryGovernor& governor, const std::size_t bytes)
+	: governor_ { governor }
+	, bytes_    { bytes }
+{
+	governor_.acquire(bytes_);
+}
+
+
+Admission::~Admission() noexcept
+{
+	governor_.release(bytes_);
+}
+
+} // namespace parallel
+} // namespace v_1_0_0
+} // namespace arcsapp
+
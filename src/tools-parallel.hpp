@@ -0,0 +1,718 @@
+#ifndef __ARCSTOOLS_TOOLS_PARALLEL_HPP__
+#define __ARCSTOOLS_TOOLS_PARALLEL_HPP__
+
+/**
+ * \file
+ *
+ * \brief Helper tools for running tasks concurrently.
+ */
+
+#include <condition_variable> // for condition_variable
+#include <cstddef>            // for size_t
+#include <cstdint>            // for uint64_t
+#include <deque>              // for deque
+#include <exception>          // for exception_ptr
+#include <functional>         // for function
+#include <map>                // for map
+#include <mutex>              // for mutex, lock_guard, unique_lock
+#include <optional>           // for optional
+#include <queue>              // for queue
+#include <thread>             // for thread
+#include <utility>            // for move
+#include <vector>             // for vector
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+
+/**
+ * \brief Tools and helpers for concurrent processing.
+ */
+namespace parallel
+{
+
+/**
+ * \brief A unit of work to be run by a TaskPool.
+ */
+using Task = std::function<void()>;
+
+
+/**
+ * \brief Called on each worker thread before it runs any task.
+ *
+ * The argument is the 0-based index of the worker in its pool. An empty
+ * function is not called.
+ */
+using WorkerInit = std::function<void(const std::size_t)>;
+
+
+/**
+ * \brief Number of worker threads to use for the requested number.
+ *
+ * A request of 0 is interpreted as "one worker per hardware thread". If the
+ * hardware concurrency cannot be determined, a single worker is used.
+ *
+ * \param[in] requested Requested number of workers
+ *
+ * \return Actual number of workers to use
+ */
+std::size_t worker_count(const std::size_t requested);
+
+
+/**
+ * \brief Fixed-size pool of worker threads processing a queue of tasks.
+ *
+ * Tasks are started in the order they are submitted. The first exception that
+ * escapes from a task is stored and rethrown by wait(), every subsequent
+ * exception is discarded. Tasks that are still queued when an exception occurs
+ * are run nonetheless.
+ *
+ * The destructor waits for all queued tasks to complete.
+ */
+class TaskPool final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] workers Number of worker threads, at least 1 will be used
+	 */
+	explicit TaskPool(const std::size_t workers);
+
+	/**
+	 * \brief Constructor for workers that are initialized.
+	 *
+	 * \param[in] workers Number of worker threads, at least 1 will be used
+	 * \param[in] init    Called on each worker thread before its first task
+	 */
+	TaskPool(const std::size_t workers, WorkerInit init);
+
+	TaskPool(const TaskPool&) = delete;
+	TaskPool& operator=(const TaskPool&) = delete;
+
+	/**
+	 * \brief Destructor.
+	 *
+	 * Waits for all tasks to complete and joins the workers.
+	 */
+	~TaskPool() noexcept;
+
+	/**
+	 * \brief Queue a task for processing.
+	 *
+	 * \param[in] task The task to queue
+	 */
+	void submit(Task task);
+
+	/**
+	 * \brief Block until every queued task is completed.
+	 *
+	 * \throws Any exception that escaped from a task
+	 */
+	void wait();
+
+	/**
+	 * \brief Number of worker threads in this pool.
+	 *
+	 * \return Number of worker threads
+	 */
+	std::size_t size() const;
+
+private:
+
+	/**
+	 * \brief Worker loop: fetch and run tasks until stopped.
+	 *
+	 * \param[in] index Index of the worker
+	 */
+	void work(const std::size_t index);
+
+	/**
+	 * \brief Worker threads.
+	 */
+	std::vector<std::thread> workers_;
+
+	/**
+	 * \brief Initialization of each worker thread.
+	 */
+	WorkerInit init_;
+
+	/**
+	 * \brief Tasks not yet started.
+	 */
+	std::queue<Task> tasks_;
+
+	/**
+	 * \brief Guard for the queue and the counters.
+	 */
+	std::mutex mutex_;
+
+	/**
+	 * \brief Signals that a task was queued or the pool is stopped.
+	 */
+	std::condition_variable task_available_;
+
+	/**
+	 * \brief Signals that the queue is empty and no task is running.
+	 */
+	std::condition_variable all_done_;
+
+	/**
+	 * \brief Number of tasks currently running.
+	 */
+	std::size_t running_;
+
+	/**
+	 * \brief Flag to stop the workers.
+	 */
+	bool stop_;
+
+	/**
+	 * \brief First exception that escaped from a task.
+	 */
+	std::exception_ptr error_;
+};
+
+
+
+/**
+ * \brief Group of tasks that share a limit of tasks running at once.
+ */
+using Group = std::uint64_t;
+
+
+/**
+ * \brief Limit of tasks running at once for each group, 0 for no limit.
+ */
+using GroupLimit = std::function<std::size_t(const Group)>;
+
+
+/**
+ * \brief Pool of worker threads that limits the running tasks per group.
+ *
+ * Each task belongs to a group, e.g. the storage device of its input. At
+ * most the limit of its group of tasks run at once. A free worker starts the
+ * task that was submitted first among all tasks whose group is below its
+ * limit. Thus, tasks of a group are started in the order they are submitted,
+ * and as long as any group has capacity, no worker idles because another
+ * group is saturated.
+ *
+ * The limit of each group is determined once, when its first task is
+ * submitted. Exceptions are handled as by TaskPool.
+ */
+class GroupedTaskPool final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] workers Number of worker threads, at least 1 will be used
+	 * \param[in] limit   Limit of running tasks for each group
+	 */
+	GroupedTaskPool(const std::size_t workers, GroupLimit limit);
+
+	/**
+	 * \brief Constructor for workers that are initialized.
+	 *
+	 * \param[in] workers Number of worker threads, at least 1 will be used
+	 * \param[in] limit   Limit of running tasks for each group
+	 * \param[in] init    Called on each worker thread before its first task
+	 */
+	GroupedTaskPool(const std::size_t workers, GroupLimit limit,
+			WorkerInit init);
+
+	GroupedTaskPool(const GroupedTaskPool&) = delete;
+	GroupedTaskPool& operator=(const GroupedTaskPool&) = delete;
+
+	/**
+	 * \brief Destructor.
+	 *
+	 * Waits for all tasks to complete and joins the workers.
+	 */
+	~GroupedTaskPool() noexcept;
+
+	/**
+	 * \brief Queue a task of a group for processing.
+	 *
+	 * \param[in] group The group of the task
+	 * \param[in] task  The task to queue
+	 */
+	void submit(const Group group, Task task);
+
+	/**
+	 * \brief Block until every queued task is completed.
+	 *
+	 * \throws Any exception that escaped from a task
+	 */
+	void wait();
+
+	/**
+	 * \brief Number of worker threads in this pool.
+	 *
+	 * \return Number of worker threads
+	 */
+	std::size_t size() const;
+
+private:
+
+	/**
+	 * \brief A queued task with the position of its submission.
+	 */
+	struct Queued final
+	{
+		std::size_t sequence;
+		Task task;
+	};
+
+	/**
+	 * \brief Queue and counters of a group.
+	 */
+	struct GroupState final
+	{
+		std::deque<Queued> queued;
+		std::size_t running;
+		std::size_t limit;
+	};
+
+	/**
+	 * \brief Worker loop: fetch and run tasks until stopped.
+	 *
+	 * \param[in] index Index of the worker
+	 */
+	void work(const std::size_t index);
+
+	/**
+	 * \brief Group of the first submitted task that may start, if any.
+	 *
+	 * Requires the lock to be held.
+	 */
+	GroupState* next_group();
+
+	/**
+	 * \brief Worker threads.
+	 */
+	std::vector<std::thread> workers_;
+
+	/**
+	 * \brief Limit of running tasks for each group.
+	 */
+	GroupLimit limit_;
+
+	/**
+	 * \brief Initialization of each worker thread.
+	 */
+	WorkerInit init_;
+
+	/**
+	 * \brief Queues and counters of each group.
+	 */
+	std::map<Group, GroupState> groups_;
+
+	/**
+	 * \brief Number of tasks submitted so far.
+	 */
+	std::size_t submitted_;
+
+	/**
+	 * \brief Number of tasks queued in all groups.
+	 */
+	std::size_t queued_;
+
+	/**
+	 * \brief Guard for the queues and the counters.
+	 */
+	std::mutex mutex_;
+
+	/**
+	 * \brief Signals that a task was queued or completed or the pool is
+	 * stopped.
+	 */
+	std::condition_variable task_available_;
+
+	/**
+	 * \brief Signals that no task is queued and no task is running.
+	 */
+	std::condition_variable all_done_;
+
+	/**
+	 * \brief Number of tasks currently running.
+	 */
+	std::size_t running_;
+
+	/**
+	 * \brief Flag to stop the workers.
+	 */
+	bool stop_;
+
+	/**
+	 * \brief First exception that escaped from a task.
+	 */
+	std::exception_ptr error_;
+};
+
+
+/**
+ * \brief Admits jobs only while their estimated memory fits under a limit.
+ *
+ * Each job acquires its estimated memory before it starts and releases it
+ * when it is completed. A job that does not fit is deferred, i.e. its thread
+ * blocks until enough memory is released by other jobs. A job is always
+ * admitted if no other job is running, even if it exceeds the limit on its
+ * own, thus every job is eventually admitted.
+ *
+ * A limit of 0 admits every job immediately.
+ */
+class MemoryGovernor final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] limit Maximal memory of the running jobs in bytes, 0 for none
+	 */
+	explicit MemoryGovernor(const std::size_t limit);
+
+	MemoryGovernor(const MemoryGovernor&) = delete;
+	MemoryGovernor& operator=(const MemoryGovernor&) = delete;
+
+	/**
+	 * \brief Block until the memory of a job fits and account for it.
+	 *
+	 * \param[in] bytes Estimated memory of the job
+	 */
+	void acquire(const std::size_t bytes);
+
+	/**
+	 * \brief Release the memory of a completed job.
+	 *
+	 * \param[in] bytes Estimated memory of the job as acquired
+	 */
+	void release(const std::size_t bytes);
+
+	/**
+	 * \brief Maximal memory of the running jobs.
+	 *
+	 * \return Limit in bytes, 0 for none
+	 */
+	std::size_t limit() const;
+
+	/**
+	 * \brief Number of jobs admitted so far.
+	 *
+	 * \return Number of jobs admitted
+	 */
+	std::size_t admitted() const;
+
+	/**
+	 * \brief Number of jobs that had to wait before they were admitted.
+	 *
+	 * \return Number of jobs deferred
+	 */
+	std::size_t deferred() const;
+
+	/**
+	 * \brief Maximal memory of the jobs that were running at the same time.
+	 *
+	 * \return Peak of the estimated memory in bytes
+	 */
+	std::size_t peak() const;
+
+private:
+
+	/**
+	 * \brief Maximal memory of the running jobs.
+	 */
+	const std::size_t limit_;
+
+	/**
+	 * \brief Memory of the running jobs.
+	 */
+	std::size_t in_use_;
+
+	/**
+	 * \brief Number of running jobs.
+	 */
+	std::size_t running_;
+
+	/**
+	 * \brief Number of jobs admitted.
+	 */
+	std::size_t admitted_;
+
+	/**
+	 * \brief Number of jobs deferred.
+	 */
+	std::size_t deferred_;
+
+	/**
+	 * \brief Peak of the memory of the running jobs.
+	 */
+	std::size_t peak_;
+
+	/**
+	 * \brief Guard for the counters.
+	 */
+	mutable std::mutex mutex_;
+
+	/**
+	 * \brief Signals that memory was released.
+	 */
+	std::condition_variable released_;
+};
+
+
+/**
+ * \brief Holds the memory of a job acquired from a MemoryGovernor.
+ *
+ * The memory is acquired by the constructor and released by the destructor.
+ */
+class Admission final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * Blocks until the job is admitted.
+	 *
+	 * \param[in] governor Governor to acquire the memory from
+	 * \param[in] bytes    Estimated memory of the job
+	 */
+	Admission(MemoryGovernor& governor, const std::size_t bytes);
+
+	Admission(const Admission&) = delete;
+	Admission& operator=(const Admission&) = delete;
+
+	/**
+	 * \brief Destructor.
+	 *
+	 * Releases the memory of the job.
+	 */
+	~Admission() noexcept;
+
+private:
+
+	/**
+	 * \brief Governor the memory was acquired from.
+	 */
+	MemoryGovernor& governor_;
+
+	/**
+	 * \brief Memory acquired.
+	 */
+	const std::size_t bytes_;
+};
+
+
+namespace details
+{
+
+/**
+ * \brief Results produced concurrently to be consumed in order.
+ *
+ * \tparam T Result type
+ */
+template <typename T>
+class OrderedResults final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] total Number of results
+	 */
+	explicit OrderedResults(const std::size_t total)
+		: results_   (total)
+		, errors_    (total)
+		, done_      (total, false)
+		, mutex_     { /* default */ }
+		, available_ { /* default */ }
+	{
+		// empty
+	}
+
+	/**
+	 * \brief Task that produces the result for an index.
+	 *
+	 * \param[in] i       Index of the result
+	 * \param[in] produce Produce the result for an index
+	 *
+	 * \return Task to produce the result
+	 */
+	Task producer(const std::size_t i,
+			const std::function<T(const std::size_t)>& produce)
+	{
+		return [this,i,&produce]
+			{
+				auto result = std::optional<T> {};
+				auto error  = std::exception_ptr {};
+
+				try
+				{
+					result.emplace(produce(i));
+
+				} catch (...)
+				{
+					error = std::current_exception();
+				}
+
+				{
+					const std::lock_guard<std::mutex> lock(mutex_);
+					results_[i] = std::move(result);
+					errors_[i]  = error;
+					done_[i]    = true;
+				}
+
+				available_.notify_all();
+			};
+	}
+
+	/**
+	 * \brief Wait for the result for an index and consume it.
+	 *
+	 * \param[in] i       Index of the result
+	 * \param[in] consume Consume the result for an index
+	 *
+	 * \throws Any exception thrown by the producer of the result
+	 */
+	void consume(const std::size_t i,
+			const std::function<void(const std::size_t, T&&)>& consume)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			available_.wait(lock, [this,i]{ return done_[i]; });
+		}
+
+		if (errors_[i])
+		{
+			std::rethrow_exception(errors_[i]);
+		}
+
+		consume(i, std::move(*results_[i]));
+		results_[i].reset();
+	}
+
+private:
+
+	std::vector<std::optional<T>> results_;
+	std::vector<std::exception_ptr> errors_;
+	std::vector<bool> done_;
+	std::mutex mutex_;
+	std::condition_variable available_;
+};
+
+} // namespace details
+
+
+/**
+ * \brief Produce results concurrently and consume them in order.
+ *
+ * Calls \c produce for each index in [0, total) on \c workers threads and
+ * calls \c consume for each result in the order of the indices. Each result
+ * is consumed as soon as it and all its predecessors are available.
+ *
+ * At most \c window results are produced ahead of the next result to be
+ * consumed, which bounds the memory used by pending results. The consumer is
+ * called on the calling thread.
+ *
+ * \param[in] total   Number of results
+ * \param[in] workers Number of threads to produce results
+ * \param[in] window  Maximal number of pending results, at least \c workers
+ * \param[in] produce Produce the result for an index
+ * \param[in] consume Consume the result for an index
+ *
+ * \throws Any exception thrown by \c produce at the position of its result
+ *
+ * \tparam T Result type
+ */
+template <typename T>
+void run_ordered(const std::size_t total, const std::size_t workers,
+		const std::size_t window,
+		const std::function<T(const std::size_t)>& produce,
+		const std::function<void(const std::size_t, T&&)>& consume)
+{
+	auto results = details::OrderedResults<T> { total };
+
+	TaskPool pool { workers };
+
+	const auto max_pending = window < pool.size() ? pool.size() : window;
+	auto next_submit = std::size_t { 0 };
+
+	for (std::size_t next = 0; next < total; ++next)
+	{
+		// Keep the pool busy, but do not run too far ahead
+
+		for (; next_submit < total && next_submit < next + max_pending;
+				++next_submit)
+		{
+			pool.submit(results.producer(next_submit, produce));
+		}
+
+		results.consume(next, consume);
+	}
+}
+
+
+/**
+ * \brief Produce results concurrently by groups and consume them in order.
+ *
+ * Like run_ordered() with a window, but the results are produced by a
+ * GroupedTaskPool. Thus, at most the limit of a group of its results are
+ * produced at once, while the workers not needed by saturated groups produce
+ * the results of other groups within the window.
+ *
+ * \param[in] total   Number of results
+ * \param[in] workers Number of threads to produce results
+ * \param[in] window  Maximal number of pending results, at least \c workers
+ * \param[in] group   Group of the result for an index
+ * \param[in] limit   Limit of results produced at once for each group
+ * \param[in] produce Produce the result for an index
+ * \param[in] consume Consume the result for an index
+ * \param[in] init    Called on each worker thread before its first result
+ *
+ * \throws Any exception thrown by \c produce at the position of its result
+ *
+ * \tparam T Result type
+ */
+template <typename T>
+void run_ordered(const std::size_t total, const std::size_t workers,
+		const std::size_t window,
+		const std::function<Group(const std::size_t)>& group,
+		const GroupLimit& limit,
+		const std::function<T(const std::size_t)>& produce,
+		const std::function<void(const std::size_t, T&&)>& consume,
+		const WorkerInit& init = WorkerInit {})
+{
+	auto results = details::OrderedResults<T> { total };
+
+	GroupedTaskPool pool { workers, limit, init };
+
+	const auto max_pending = window < pool.size() ? pool.size() : window;
+	auto next_submit = std::size_t { 0 };
+
+	for (std::size_t next = 0; next < total; ++next)
+	{
+		// Keep the pool busy, but do not run too far ahead
+
+		for (; next_submit < total && next_submit < next + max_pending;
+				++next_submit)
+		{
+			pool.submit(group(next_submit),
+					results.producer(next_submit, produce));
+		}
+
+		results.consume(next, consume);
+	}
+}
+
+} // namespace parallel
+} // namespace v_1_0_0
+} // namespace arcsapp
+
+#endif
+
@@ -0,0 +1,925 @@
+/**
+ * \file tools-pcm.cpp Access to the CDDA samples of audio files
+ */
+
+#ifndef __ARCSTOOLS_TOOLS_PCM_HPP__
+#include "tools-pcm.hpp"
+#endif
+
+#include <algorithm>   // for any_of, copy, copy_n, min
+#include <array>       // for array
+#include <cstddef>     // for ptrdiff_t, size_t
+#include <cstdint>     // for uint8_t, uint16_t, uint32_t
+#include <fstream>     // for ifstream
+#include <iterator>    // for begin, end, next
+#include <istream>     // for istream
+#include <limits>      // for numeric_limits
+#include <memory>      // for unique_ptr, make_unique
+#include <stdexcept>   // for runtime_error
+#include <streambuf>   // for streambuf
+#include <string>      // for string
+#include <utility>     // for move
+#include <vector>      // for vector
+
+#ifdef ARCSTOOLS_WITH_FLAC
+#include <FLAC++/decoder.h>
+#endif
+
+#ifndef __LIBARCSTK_LOGGING_HPP__
+#include <arcstk/logging.hpp>
+#endif
+
+#ifndef __ARCSTOOLS_TOOLS_DIGEST_HPP__
+#include "tools-digest.hpp"   // for to_hex
+#endif
+#ifndef __ARCSTOOLS_TOOLS_IO_HPP__
+#include "tools-io.hpp"       // for open_input, input_memory
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+namespace pcm
+{
+
+namespace
+{
+
+/**
+ * \brief Channels of CDDA.
+ */
+constexpr unsigned CDDA_CHANNELS = 2;
+
+/**
+ * \brief Bits per sample and channel of CDDA.
+ */
+constexpr unsigned CDDA_BITS_PER_SAMPLE = 16;
+
+/**
+ * \brief Samples per second of CDDA.
+ */
+constexpr unsigned CDDA_SAMPLE_RATE = 44100;
+
+/**
+ * \brief Bytes per stereo sample of CDDA.
+ */
+constexpr std::size_t CDDA_BYTES_PER_SAMPLE = 4;
+
+/**
+ * \brief Estimated memory of the sample buffer of a calculation.
+ */
+constexpr std::size_t SAMPLE_BUFFER_MEMORY = 65536 * CDDA_BYTES_PER_SAMPLE;
+
+/**
+ * \brief Estimated memory of a FLAC decoder.
+ *
+ * Covers the decoder state and a decoded frame of the maximal block size.
+ */
+constexpr std::size_t FLAC_DECODER_MEMORY = 1024 * 1024;
+
+
+/**
+ * \brief Read an unsigned 16 bit little endian integer.
+ */
+std::uint16_t le16(const unsigned char* b)
+{
+	return static_cast<std::uint16_t>(b[0] | b[1] << 8);
+}
+
+
+/**
+ * \brief Read an unsigned 32 bit little endian integer.
+ */
+std::uint32_t le32(const unsigned char* b)
+{
+	return  static_cast<std::uint32_t>(b[0])
+		| static_cast<std::uint32_t>(b[1]) <<  8
+		| static_cast<std::uint32_t>(b[2]) << 16
+		| static_cast<std::uint32_t>(b[3]) << 24;
+}
+
+
+/**
+ * \brief TRUE iff the content of a RIFF/WAV fmt chunk specifies CDDA.
+ *
+ * \param[in] fmt  Content of the fmt chunk
+ * \param[in] size Number of bytes in \c fmt, at least 16
+ */
+bool is_cdda_format(const unsigned char* fmt, const std::size_t size)
+{
+	const auto tag = le16(fmt);
+
+	// WAVE_FORMAT_PCM or WAVE_FORMAT_EXTENSIBLE with PCM subformat
+	const auto is_pcm = tag == 0x0001
+		|| (tag == 0xFFFE && size >= 26 && le16(fmt + 24) == 1);
+
+	return is_pcm
+		&& le16(fmt +  2) == CDDA_CHANNELS
+		&& le32(fmt +  4) == CDDA_SAMPLE_RATE
+		&& le16(fmt + 12) == CDDA_BYTES_PER_SAMPLE
+		&& le16(fmt + 14) == CDDA_BITS_PER_SAMPLE;
+}
+
+
+/**
+ * \brief SampleReader for RIFF/WAV files with PCM encoded CDDA.
+ */
+class WavSampleReader final : public SampleReader
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] input Bytes of the audio file
+	 */
+	explicit WavSampleReader(std::unique_ptr<std::streambuf> input);
+
+	/**
+	 * \brief TRUE iff the file is a RIFF/WAV file containing CDDA.
+	 *
+	 * \return TRUE iff the file can be read by this instance
+	 */
+	bool is_cdda() const;
+
+private:
+
+	/**
+	 * \brief Parse the RIFF header and locate the data chunk.
+	 */
+	void parse_header();
+
+	std::size_t do_total_samples() const final;
+
+	std::size_t do_read(const std::size_t first, const std::size_t count,
+			Sample* buffer) final;
+
+	/**
+	 * \brief Bytes of the audio file.
+	 */
+	std::unique_ptr<std::streambuf> input_;
+
+	/**
+	 * \brief Input stream of the audio file.
+	 */
+	std::istream in_;
+
+	/**
+	 * \brief Byte position of the first sample.
+	 */
+	std::size_t data_offset_;
+
+	/**
+	 * \brief Total number of samples.
+	 */
+	std::size_t total_samples_;
+
+	/**
+	 * \brief TRUE iff the format is CDDA compliant.
+	 */
+	bool is_cdda_;
+
+	/**
+	 * \brief Buffer for raw bytes.
+	 */
+	std::vector<unsigned char> bytes_;
+};
+
+
+WavSampleReader::WavSampleReader(std::unique_ptr<std::streambuf> input)
+	: input_         { std::move(input) }
+	, in_            { input_.get() }
+	, data_offset_   { 0 }
+	, total_samples_ { 0 }
+	, is_cdda_       { false }
+	, bytes_         { /* empty */ }
+{
+	parse_header();
+}
+
+
+bool WavSampleReader::is_cdda() const
+{
+	return is_cdda_;
+}
+
+
+void WavSampleReader::parse_header()
+{
+	auto header = std::array<unsigned char, 12> {};
+
+	if (!in_.read(reinterpret_cast<char*>(header.data()), header.size())
+		|| std::string(reinterpret_cast<char*>(header.data()), 4) != "RIFF"
+		|| std::string(reinterpret_cast<char*>(header.data()) + 8, 4) != "WAVE")
+	{
+		ARCS_LOG_DEBUG << "Not a RIFF/WAV file";
+		return;
+	}
+
+	auto chunk       = std::array<unsigned char, 8> {};
+	auto fmt         = std::array<unsigned char, 26> {};
+	auto has_fmt     = false;
+	auto position    = std::size_t { header.size() };
+
+	while (in_.read(reinterpret_cast<char*>(chunk.data()), chunk.size()))
+	{
+		const auto id   = std::string(reinterpret_cast<char*>(chunk.data()), 4);
+		const auto size = std::size_t { le32(chunk.data() + 4) };
+
+		position += chunk.size();
+
+		if (id == "fmt ")
+		{
+			const auto fmt_size = std::min(size, fmt.size());
+			in_.read(reinterpret_cast<char*>(fmt.data()),
+					static_cast<std::streamsize>(fmt_size));
+
+			if (!in_ || fmt_size < 16)
+			{
+				ARCS_LOG_WARNING << "Malformed fmt chunk in RIFF/WAV file";
+				return;
+			}
+
+			is_cdda_ = is_cdda_format(fmt.data(), fmt_size);
+
+			has_fmt = true;
+
+		} else if (id == "data")
+		{
+			if (!has_fmt)
+			{
+				ARCS_LOG_WARNING << "RIFF/WAV file has data before format";
+				is_cdda_ = false;
+				return;
+			}
+
+			data_offset_   = position;
+			total_samples_ = size / CDDA_BYTES_PER_SAMPLE;
+
+			// Tolerate a data size exceeding the actual file size
+
+			in_.seekg(0, std::ios::end);
+			const auto file_size = static_cast<std::size_t>(in_.tellg());
+
+			if (data_offset_ + size > file_size)
+			{
+				ARCS_LOG_WARNING << "RIFF/WAV data chunk exceeds file size";
+				total_samples_ =
+					(file_size - data_offset_) / CDDA_BYTES_PER_SAMPLE;
+			}
+
+			in_.clear();
+			return;
+		}
+
+		// Chunks are padded to an even size
+		position += size + (size % 2);
+		in_.seekg(static_cast<std::streamoff>(position));
+	}
+
+	ARCS_LOG_WARNING << "RIFF/WAV file has no data chunk";
+	is_cdda_ = false;
+}
+
+
+std::size_t WavSampleReader::do_total_samples() const
+{
+	return total_samples_;
+}
+
+
+std::size_t WavSampleReader::do_read(const std::size_t first,
+		const std::size_t count, Sample* buffer)
+{
+	if (first >= total_samples_)
+	{
+		return 0;
+	}
+
+	const auto total = std::min(count, total_samples_ - first);
+
+	bytes_.resize(total * CDDA_BYTES_PER_SAMPLE);
+
+	in_.seekg(static_cast<std::streamoff>(
+				data_offset_ + first * CDDA_BYTES_PER_SAMPLE));
+	in_.read(reinterpret_cast<char*>(bytes_.data()),
+			static_cast<std::streamsize>(bytes_.size()));
+
+	if (!in_)
+	{
+		throw std::runtime_error("Failed to read samples from RIFF/WAV file");
+	}
+
+	for (std::size_t i = 0; i < total; ++i)
+	{
+		buffer[i] = le32(bytes_.data() + i * CDDA_BYTES_PER_SAMPLE);
+	}
+
+	return total;
+}
+
+
+#ifdef ARCSTOOLS_WITH_FLAC
+
+/**
+ * \brief SampleReader for FLAC files with CDDA, based on libFLAC++.
+ */
+class FlacSampleReader final : public SampleReader
+                             , private FLAC::Decoder::Stream
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] input    Bytes of the audio file
+	 * \param[in] filename Name of the audio file
+	 */
+	FlacSampleReader(std::unique_ptr<std::streambuf> input,
+			const std::string& filename);
+
+	/**
+	 * \brief TRUE iff the file is a FLAC file containing CDDA.
+	 *
+	 * \return TRUE iff the file can be read by this instance
+	 */
+	bool is_cdda() const;
+
+private:
+
+	std::size_t do_total_samples() const final;
+
+	std::size_t do_read(const std::size_t first, const std::size_t count,
+			Sample* buffer) final;
+
+	std::string do_embedded_md5() const final;
+
+	::FLAC__StreamDecoderReadStatus read_callback(FLAC__byte buffer[],
+			std::size_t* bytes) final;
+
+	::FLAC__StreamDecoderSeekStatus seek_callback(FLAC__uint64 offset) final;
+
+	::FLAC__StreamDecoderTellStatus tell_callback(FLAC__uint64* offset) final;
+
+	::FLAC__StreamDecoderLengthStatus length_callback(FLAC__uint64* length)
+		final;
+
+	bool eof_callback() final;
+
+	::FLAC__StreamDecoderWriteStatus write_callback(const ::FLAC__Frame* frame,
+			const FLAC__int32* const buffer[]) final;
+
+	void metadata_callback(const ::FLAC__StreamMetadata* metadata) final;
+
+	void error_callback(::FLAC__StreamDecoderErrorStatus status) final;
+
+	/**
+	 * \brief Bytes of the audio file.
+	 */
+	std::unique_ptr<std::streambuf> input_;
+
+	/**
+	 * \brief Total number of samples.
+	 */
+	std::size_t total_samples_;
+
+	/**
+	 * \brief TRUE iff the format is CDDA compliant.
+	 */
+	bool is_cdda_;
+
+	/**
+	 * \brief Index of the first sample in the last decoded frame.
+	 */
+	std::size_t frame_first_;
+
+	/**
+	 * \brief Samples of the last decoded frame.
+	 */
+	std::vector<Sample> frame_;
+
+	/**
+	 * \brief MD5 declared in STREAMINFO, empty if not set.
+	 */
+	std::string md5_;
+};
+
+
+FlacSampleReader::FlacSampleReader(std::unique_ptr<std::streambuf> input,
+		const std::string& filename)
+	: FLAC::Decoder::Stream {}
+	, input_         { std::move(input) }
+	, total_samples_ { 0 }
+	, is_cdda_       { false }
+	, frame_first_   { 0 }
+	, frame_         { /* empty */ }
+	, md5_           { /* empty */ }
+{
+	if (FLAC__STREAM_DECODER_INIT_STATUS_OK != init())
+	{
+		throw std::runtime_error("Could not open FLAC file: " + filename);
+	}
+
+	if (!process_until_end_of_metadata())
+	{
+		throw std::runtime_error("Could not read FLAC metadata: " + filename);
+	}
+}
+
+
+bool FlacSampleReader::is_cdda() const
+{
+	return is_cdda_;
+}
+
+
+std::size_t FlacSampleReader::do_total_samples() const
+{
+	return total_samples_;
+}
+
+
+std::string FlacSampleReader::do_embedded_md5() const
+{
+	return md5_;
+}
+
+
+std::size_t FlacSampleReader::do_read(const std::size_t first,
+		const std::size_t count, Sample* buffer)
+{
+	const auto last = std::min(first + count, total_samples_);
+	auto pos = first;
+
+	while (pos < last)
+	{
+		const auto frame_last = frame_first_ + frame_.size();
+
+		if (frame_first_ <= pos && pos < frame_last)
+		{
+			// Copy the requested part of the current frame
+
+			const auto n = std::min(frame_last, last) - pos;
+			std::copy_n(frame_.begin()
+					+ static_cast<std::ptrdiff_t>(pos - frame_first_),
+					n, buffer + (pos - first));
+			pos += n;
+
+			continue;
+		}
+
+		if (pos == frame_last)
+		{
+			// Continue sequentially with the next frame
+
+			if (!process_single())
+			{
+				throw std::runtime_error("Failed to decode FLAC frame");
+			}
+
+			if (FLAC__STREAM_DECODER_END_OF_STREAM == get_state())
+			{
+				break;
+			}
+		} else
+		{
+			ARCS_LOG(DEBUG1) << "Seek FLAC stream to sample " << pos;
+
+			if (!seek_absolute(pos))
+			{
+				throw std::runtime_error("Failed to seek in FLAC file");
+			}
+		}
+	}
+
+	return pos - first;
+}
+
+
+::FLAC__StreamDecoderReadStatus FlacSampleReader::read_callback(
+		FLAC__byte buffer[], std::size_t* bytes)
+{
+	// No exception must pass libFLAC
+
+	try
+	{
+		*bytes = static_cast<std::size_t>(input_->sgetn(
+					reinterpret_cast<char*>(buffer),
+					static_cast<std::streamsize>(*bytes)));
+
+	} catch (const std::exception& e)
+	{
+		ARCS_LOG_ERROR << "Failed to read FLAC file: " << e.what();
+		return FLAC__STREAM_DECODER_READ_STATUS_ABORT;
+	}
+
+	return *bytes > 0
+		? FLAC__STREAM_DECODER_READ_STATUS_CONTINUE
+		: FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM;
+}
+
+
+::FLAC__StreamDecoderSeekStatus FlacSampleReader::seek_callback(
+		FLAC__uint64 offset)
+{
+	try
+	{
+		if (input_->pubseekpos(static_cast<std::streamoff>(offset),
+					std::ios_base::in) != std::streampos(std::streamoff(-1)))
+		{
+			return FLAC__STREAM_DECODER_SEEK_STATUS_OK;
+		}
+	} catch (const std::exception& e)
+	{
+		ARCS_LOG_ERROR << "Failed to seek in FLAC file: " << e.what();
+	}
+
+	return FLAC__STREAM_DECODER_SEEK_STATUS_ERROR;
+}
+
+
+::FLAC__StreamDecoderTellStatus FlacSampleReader::tell_callback(
+		FLAC__uint64* offset)
+{
+	const auto pos = std::streamoff {
+		input_->pubseekoff(0, std::ios_base::cur, std::ios_base::in) };
+
+	if (pos < 0)
+	{
+		return FLAC__STREAM_DECODER_TELL_STATUS_ERROR;
+	}
+
+	*offset = static_cast<FLAC__uint64>(pos);
+	return FLAC__STREAM_DECODER_TELL_STATUS_OK;
+}
+
+
+::FLAC__StreamDecoderLengthStatus FlacSampleReader::length_callback(
+		FLAC__uint64* length)
+{
+	try
+	{
+		const auto pos { input_->pubseekoff(0, std::ios_base::cur,
+				std::ios_base::in) };
+		const auto end = std::streamoff { input_->pubseekoff(0,
+				std::ios_base::end, std::ios_base::in) };
+
+		input_->pubseekpos(pos, std::ios_base::in);
+
+		if (end >= 0)
+		{
+			*length = static_cast<FLAC__uint64>(end);
+			return FLAC__STREAM_DECODER_LENGTH_STATUS_OK;
+		}
+	} catch (const std::exception& e)
+	{
+		ARCS_LOG_ERROR << "Failed to seek in FLAC file: " << e.what();
+	}
+
+	return FLAC__STREAM_DECODER_LENGTH_STATUS_ERROR;
+}
+
+
+bool FlacSampleReader::eof_callback()
+{
+	try
+	{
+		return std::streambuf::traits_type::eof() == input_->sgetc();
+
+	} catch (...)
+	{
+		return true;
+	}
+}
+
+
+::FLAC__StreamDecoderWriteStatus FlacSampleReader::write_callback(
+		const ::FLAC__Frame* frame, const FLAC__int32* const buffer[])
+{
+	frame_first_ = frame->header.number.sample_number;
+	frame_.resize(frame->header.blocksize);
+
+	for (std::size_t i = 0; i < frame_.size(); ++i)
+	{
+		frame_[i] = static_cast<std::uint16_t>(buffer[0][i])
+			| static_cast<Sample>(static_cast<std::uint16_t>(buffer[1][i])) << 16;
+	}
+
+	return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+
+void FlacSampleReader::metadata_callback(const ::FLAC__StreamMetadata* metadata)
+{
+	if (FLAC__METADATA_TYPE_STREAMINFO != metadata->type)
+	{
+		return;
+	}
+
+	const auto& info = metadata->data.stream_info;
+
+	// An MD5 of all zeros declares that the encoder did not compute it
+
+	auto md5 = std::array<std::uint8_t, 16> {};
+	std::copy(std::begin(info.md5sum), std::end(info.md5sum), md5.begin());
+
+	if (std::any_of(md5.begin(), md5.end(),
+				[](const std::uint8_t b) { return b != 0; }))
+	{
+		md5_ = digest::to_hex(md5);
+	}
+
+	total_samples_ = info.total_samples;
+	is_cdda_ = info.channels       == CDDA_CHANNELS
+		&& info.bits_per_sample == CDDA_BITS_PER_SAMPLE
+		&& info.sample_rate     == CDDA_SAMPLE_RATE
+		&& info.total_samples   >  0;
+}
+
+
+void FlacSampleReader::error_callback(::FLAC__StreamDecoderErrorStatus status)
+{
+	ARCS_LOG_WARNING << "FLAC decoder error: "
+		<< ::FLAC__StreamDecoderErrorStatusString[status];
+}
+
+#endif
+
+} // namespace
+
+
+// SampleReader
+
+
+std::string SampleReader::do_embedded_md5() const
+{
+	return {};
+}
+
+
+std::size_t SampleReader::total_samples() const
+{
+	return do_total_samples();
+}
+
+
+std::size_t SampleReader::read(const std::size_t first,
+		const std::size_t count, Sample* buffer)
+{
+	return do_read(first, count, buffer);
+}
+
+
+std::string SampleReader::embedded_md5() const
+{
+	return do_embedded_md5();
+}
+
+
+// open_sample_reader
+
+
+Format detect_format(const std::string& filename)
+{
+	auto magic = std::array<char, 4> {};
+	auto in = std::ifstream { filename, std::ios::in | std::ios::binary };
+
+	if (!in.read(magic.data(), magic.size()))
+	{
+		return Format::OTHER;
+	}
+
+	const auto format = std::string(magic.data(), magic.size());
+
+	if ("RIFF" == format)
+	{
+		return Format::WAV;
+	}
+
+#ifdef ARCSTOOLS_WITH_FLAC
+	if ("fLaC" == format)
+	{
+		return Format::FLAC;
+	}
+#endif
+
+	return Format::OTHER;
+}
+
+
+std::size_t reader_memory(const Format format,
+		const io::InputOptions& options, const std::size_t file_size)
+{
+	if (Format::OTHER == format)
+	{
+		return 0;
+	}
+
+	return SAMPLE_BUFFER_MEMORY + io::input_memory(options, file_size)
+		+ (Format::FLAC == format ? FLAC_DECODER_MEMORY : 0);
+}
+
+
+std::unique_ptr<SampleReader> open_sample_reader(const std::string& filename,
+		const io::InputOptions& options)
+{
+	auto magic = std::array<char, 4> {};
+	{
+		auto in = std::ifstream { filename, std::ios::in | std::ios::binary };
+
+		if (!in)
+		{
+			throw std::runtime_error("Could not open audio file: " + filename);
+		}
+
+		in.read(magic.data(), magic.size());
+	}
+
+	const auto format = std::string(magic.data(), magic.size());
+
+	if ("RIFF" == format)
+	{
+		auto reader = std::make_unique<WavSampleReader>(
+				io::open_input(filename, options));
+
+		if (reader->is_cdda())
+		{
+			return reader;
+		}
+
+		ARCS_LOG_INFO << "RIFF/WAV file does not contain PCM encoded CDDA";
+		return nullptr;
+	}
+
+#ifdef ARCSTOOLS_WITH_FLAC
+	if ("fLaC" == format)
+	{
+		auto reader = std::make_unique<FlacSampleReader>(
+				io::open_input(filename, options), filename);
+
+		if (reader->is_cdda())
+		{
+			return reader;
+		}
+
+		ARCS_LOG_INFO << "FLAC file does not contain CDDA";
+		return nullptr;
+	}
+#endif
+
+	ARCS_LOG_DEBUG << "No random access sample reader for " << filename;
+	return nullptr;
+}
+
+
+// SampleStream
+
+
+SampleStream::SampleStream(std::istream& in, std::vector<char> prefix,
+		const std::size_t limit)
+	: in_           { in }
+	, prefix_       { std::move(prefix) }
+	, limit_        { limit }
+	, samples_read_ { 0 }
+	, bytes_        { /* empty */ }
+{
+	// empty
+}
+
+
+std::size_t SampleStream::read(const std::size_t count, Sample* buffer)
+{
+	const auto total = std::min(count, limit_ - samples_read_);
+
+	bytes_.resize(total * CDDA_BYTES_PER_SAMPLE);
+
+	const auto from_prefix = std::min(prefix_.size(), bytes_.size());
+	std::copy_n(prefix_.begin(), from_prefix, bytes_.begin());
+	prefix_.erase(prefix_.begin(), std::next(prefix_.begin(),
+				static_cast<std::ptrdiff_t>(from_prefix)));
+
+	auto size = from_prefix;
+
+	if (size < bytes_.size())
+	{
+		in_.read(bytes_.data() + size,
+				static_cast<std::streamsize>(bytes_.size() - size));
+		size += static_cast<std::size_t>(in_.gcount());
+
+		if (in_.bad())
+		{
+			throw std::runtime_error("Failed to read samples from stream");
+		}
+	}
+
+	const auto samples = size / CDDA_BYTES_PER_SAMPLE;
+
+	if (samples < total && size % CDDA_BYTES_PER_SAMPLE != 0)
+	{
+		ARCS_LOG_WARNING << "Audio stream ends within a sample, "
+			<< (size % CDDA_BYTES_PER_SAMPLE) << " bytes ignored";
+	}
+
+	const auto* bytes { reinterpret_cast<const unsigned char*>(bytes_.data()) };
+
+	for (std::size_t i = 0; i < samples; ++i)
+	{
+		buffer[i] = le32(bytes + i * CDDA_BYTES_PER_SAMPLE);
+	}
+
+	samples_read_ += samples;
+
+	return samples;
+}
+
+
+std::size_t SampleStream::samples_read() const
+{
+	return samples_read_;
+}
+
+
+// open_sample_stream
+
+
+std::unique_ptr<SampleStream> open_sample_stream(std::istream& in)
+{
+	const auto unlimited = std::numeric_limits<std::size_t>::max();
+
+	auto header = std::vector<char>(12);
+	in.read(header.data(), static_cast<std::streamsize>(header.size()));
+	header.resize(static_cast<std::size_t>(in.gcount()));
+
+	const auto magic = std::string(header.data(),
+			std::min(header.size(), std::size_t { 4 }));
+
+	if ("fLaC" == magic)
+	{
+		throw std::runtime_error("FLAC is not supported on a stream, "
+				"pass RIFF/WAV or raw CDDA samples instead");
+	}
+
+	if ("RIFF" != magic || header.size() < 12
+			|| std::string(header.data() + 8, 4) != "WAVE")
+	{
+		ARCS_LOG_INFO << "Read raw CDDA samples from stream";
+
+		return std::make_unique<SampleStream>(in, std::move(header),
+				unlimited);
+	}
+
+	// Skip all chunks up to the data chunk, the stream cannot seek
+
+	auto chunk    = std::array<char, 8> {};
+	auto fmt      = std::array<unsigned char, 26> {};
+	auto fmt_size = std::size_t { 0 };
+
+	while (in.read(chunk.data(), chunk.size()))
+	{
+		const auto* bytes { reinterpret_cast<const unsigned char*>(
+				chunk.data()) };
+		const auto id   = std::string(chunk.data(), 4);
+		const auto size = std::size_t { le32(bytes + 4) };
+
+		if (id == "data")
+		{
+			if (0 == fmt_size || !is_cdda_format(fmt.data(), fmt_size))
+			{
+				throw std::runtime_error(
+						"RIFF/WAV stream does not contain PCM encoded CDDA");
+			}
+
+			ARCS_LOG_INFO << "Read RIFF/WAV samples from stream";
+
+			// A size of 0 indicates a header written before the data
+			return std::make_unique<SampleStream>(in, std::vector<char>{},
+					0 == size ? unlimited : size / CDDA_BYTES_PER_SAMPLE);
+		}
+
+		auto skip = size + (size % 2);
+
+		if (id == "fmt ")
+		{
+			fmt_size = std::min(size, fmt.size());
+			in.read(reinterpret_cast<char*>(fmt.data()),
+					static_cast<std::streamsize>(fmt_size));
+
+			if (!in || fmt_size < 16)
+			{
+				throw std::runtime_error("Malformed fmt chunk in RIFF/WAV stream");
+			}
+
+			skip -= fmt_size;
+		}
+
+		in.ignore(static_cast<std::streamsize>(skip));
+	}
+
+	throw std::runtime_error("RIFF/WAV stream has no data chunk");
+}
+
+} // namespace pcm
+} // namespace v_1_0_0
+} // namespace arcsapp
+
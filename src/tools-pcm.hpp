@@ -0,0 +1,262 @@
+#ifndef __ARCSTOOLS_TOOLS_PCM_HPP__
+#define __ARCSTOOLS_TOOLS_PCM_HPP__
+
+/**
+ * \file
+ *
+ * \brief Access to the CDDA samples of audio files and streams.
+ */
+
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint32_t
+#include <istream>     // for istream
+#include <memory>      // for unique_ptr
+#include <string>      // for string
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_IO_HPP__
+#include "tools-io.hpp"       // for InputOptions
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+
+/**
+ * \brief Tools and helpers for reading PCM samples from audio files.
+ *
+ * The readers in this namespace complement the libarcsdec readers: they
+ * provide random access to any range of samples, which enables to process
+ * different parts of the same audio file concurrently, and sequential access
+ * to audio streams that cannot be opened as a file. Only CDDA compliant
+ * audio, i.e. 16 bit stereo with 44.1 kHz, is supported.
+ */
+namespace pcm
+{
+
+/**
+ * \brief A stereo sample of 16 bit per channel.
+ *
+ * The left channel is stored in the lower 16 bits, the right channel in the
+ * higher 16 bits, which is the sample representation used by AccurateRip.
+ */
+using Sample = std::uint32_t;
+
+
+/**
+ * \brief Interface: random access to the samples of an audio file.
+ *
+ * A SampleReader is not required to be thread-safe. Concurrent readers on the
+ * same file are to be created by calling open_sample_reader() for each of
+ * them.
+ */
+class SampleReader
+{
+	virtual std::size_t do_total_samples() const
+	= 0;
+
+	virtual std::size_t do_read(const std::size_t first,
+			const std::size_t count, Sample* buffer)
+	= 0;
+
+	virtual std::string do_embedded_md5() const;
+
+public:
+
+	/**
+	 * \brief Virtual default destructor.
+	 */
+	virtual ~SampleReader() noexcept = default;
+
+	/**
+	 * \brief Total number of samples in the audio file.
+	 *
+	 * \return Total number of samples
+	 */
+	std::size_t total_samples() const;
+
+	/**
+	 * \brief Read a range of samples.
+	 *
+	 * Reads \c count samples starting with the 0-based sample index \c first.
+	 * Reading sequential ranges is expected to be faster than reading random
+	 * ranges.
+	 *
+	 * \param[in]  first  Index of the first sample to read
+	 * \param[in]  count  Number of samples to read
+	 * \param[out] buffer Buffer for at least \c count samples
+	 *
+	 * \return Number of samples actually read, less than \c count only at the
+	 * end of the audio data
+	 *
+	 * \throws std::runtime_error If reading fails
+	 */
+	std::size_t read(const std::size_t first, const std::size_t count,
+			Sample* buffer);
+
+	/**
+	 * \brief MD5 of all samples as declared by the audio file.
+	 *
+	 * FLAC files declare the MD5 of their decoded samples in their STREAMINFO
+	 * block. The MD5 of all samples read can be compared to this value to
+	 * check the integrity of the audio file. The default implementation
+	 * declares no MD5.
+	 *
+	 * \return MD5 as 32 lowercase hexadecimal digits, empty if not declared
+	 */
+	std::string embedded_md5() const;
+};
+
+
+/**
+ * \brief Audio formats distinguished by open_sample_reader().
+ */
+enum class Format
+{
+	WAV,  //!< RIFF/WAV file
+	FLAC, //!< FLAC file, only if arcs-tools is compiled with libFLAC++
+	OTHER //!< Any other format, to be read by libarcsdec
+};
+
+
+/**
+ * \brief Detect the format of an audio file by its first bytes.
+ *
+ * Whether the file contains CDDA is not checked.
+ *
+ * \param[in] filename Name of the audio file
+ *
+ * \return Format of the file, Format::OTHER if it cannot be read
+ */
+Format detect_format(const std::string& filename);
+
+
+/**
+ * \brief Estimated memory of a SampleReader and the calculation it feeds.
+ *
+ * Accounts for the input buffers, the decoder and the sample buffer of the
+ * calculation. For Format::OTHER, 0 is returned since no SampleReader exists.
+ *
+ * \param[in] format    Format of the audio file
+ * \param[in] options   Options for reading the bytes of the audio file
+ * \param[in] file_size Size of the audio file in bytes
+ *
+ * \return Estimated memory in bytes
+ */
+std::size_t reader_memory(const Format format,
+		const io::InputOptions& options, const std::size_t file_size);
+
+
+/**
+ * \brief Open a SampleReader for the specified audio file.
+ *
+ * RIFF/WAV files with PCM encoded CDDA are supported. FLAC files are supported
+ * if arcs-tools is compiled with libFLAC++.
+ *
+ * If the format of the file is not supported, \c nullptr is returned and the
+ * caller is expected to fall back on libarcsdec.
+ *
+ * \param[in] filename Name of the audio file
+ * \param[in] options  Options for reading the bytes of the audio file
+ *
+ * \return SampleReader for the file or \c nullptr
+ *
+ * \throws std::runtime_error If the file cannot be opened
+ */
+std::unique_ptr<SampleReader> open_sample_reader(const std::string& filename,
+		const io::InputOptions& options = io::InputOptions {});
+
+
+/**
+ * \brief Sequential access to the samples of an audio stream.
+ *
+ * A SampleStream reads each sample exactly once in order, hence it can read
+ * from pipes that do not support seeking.
+ */
+class SampleStream final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] in     Stream positioned at the first byte to read
+	 * \param[in] prefix Bytes already read from \c in that precede them
+	 * \param[in] limit  Maximal number of samples to read
+	 */
+	SampleStream(std::istream& in, std::vector<char> prefix,
+			const std::size_t limit);
+
+	/**
+	 * \brief Read the next samples.
+	 *
+	 * \param[in]  count  Number of samples to read
+	 * \param[out] buffer Buffer for at least \c count samples
+	 *
+	 * \return Number of samples actually read, less than \c count only at the
+	 * end of the audio data
+	 *
+	 * \throws std::runtime_error If reading fails
+	 */
+	std::size_t read(const std::size_t count, Sample* buffer);
+
+	/**
+	 * \brief Number of samples read so far.
+	 *
+	 * \return Number of samples read
+	 */
+	std::size_t samples_read() const;
+
+private:
+
+	/**
+	 * \brief The input stream.
+	 */
+	std::istream& in_;
+
+	/**
+	 * \brief Bytes to read before reading from the input stream.
+	 */
+	std::vector<char> prefix_;
+
+	/**
+	 * \brief Maximal number of samples to read.
+	 */
+	std::size_t limit_;
+
+	/**
+	 * \brief Number of samples read so far.
+	 */
+	std::size_t samples_read_;
+
+	/**
+	 * \brief Buffer for raw bytes.
+	 */
+	std::vector<char> bytes_;
+};
+
+
+/**
+ * \brief Open a SampleStream on an audio stream.
+ *
+ * The stream is expected to contain either a RIFF/WAV file with PCM encoded
+ * CDDA or raw CDDA samples, i.e. 16 bit stereo little endian PCM. If the
+ * RIFF/WAV header specifies a data size of 0, the data is read until the end
+ * of the stream, which supports writers that cannot seek back to complete the
+ * header.
+ *
+ * \param[in] in The audio stream, e.g. std::cin
+ *
+ * \return SampleStream on the audio data
+ *
+ * \throws std::runtime_error If the stream contains unsupported audio
+ */
+std::unique_ptr<SampleStream> open_sample_stream(std::istream& in);
+
+} // namespace pcm
+} // namespace v_1_0_0
+} // namespace arcsapp
+
+#endif
+
@@ -0,0 +1,756 @@
+/**
+ * \file tools-plan.cpp Planning pass that estimates the cost of a calculation
+ */
+
+#ifndef __ARCSTOOLS_TOOLS_PLAN_HPP__
+#include "tools-plan.hpp"
+#endif
+
+#include <algorithm>   // for max, min, min_element
+#include <chrono>      // for steady_clock, duration
+#include <cstdint>     // for uint32_t
+#include <fstream>     // for ifstream, ofstream
+#include <iomanip>     // for fixed, setprecision, setw, setfill
+#include <memory>      // for make_unique, unique_ptr
+#include <sstream>     // for istringstream, ostringstream
+#include <stdexcept>   // for runtime_error
+#include <system_error> // for error_code
+#include <utility>     // for move
+
+#if __cplusplus >= 201703L
+#include <filesystem>
+#endif
+
+#ifndef __LIBARCSTK_LOGGING_HPP__
+#include <arcstk/logging.hpp>
+#endif
+#ifndef __LIBARCSDEC_CALCULATORS_HPP__
+#include <arcsdec/calculators.hpp>  // for ARCSCalculator, AudioInfo
+#endif
+
+#ifndef __ARCSTOOLS_TOOLS_KERNEL_HPP__
+#include "tools-kernel.hpp"         // for select
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+namespace plan
+{
+
+namespace
+{
+
+/**
+ * \brief Samples read by a pcm::SampleReader to measure its rate.
+ *
+ * This is 30 seconds of CDDA.
+ */
+constexpr std::size_t CALIBRATION_SAMPLES = 30 * 44100;
+
+/**
+ * \brief Samples read at once to measure the rate of a pcm::SampleReader.
+ */
+constexpr std::size_t CALIBRATION_CHUNK_SAMPLES = 65536;
+
+/**
+ * \brief Bytes per MiB in the tables.
+ */
+constexpr double MIB = 1024.0 * 1024.0;
+
+
+/**
+ * \brief A number with a fixed number of decimals.
+ */
+std::string fixed(const double value, const int decimals)
+{
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(decimals) << value;
+	return out.str();
+}
+
+
+/**
+ * \brief A string as JSON string literal.
+ */
+std::string quoted(const std::string& s)
+{
+	std::ostringstream out;
+	out << '"';
+
+	for (const auto c : s)
+	{
+		switch (c)
+		{
+			case '"':  out << "\\\""; break;
+			case '\\': out << "\\\\"; break;
+			case '\n': out << "\\n";  break;
+			case '\r': out << "\\r";  break;
+			case '\t': out << "\\t";  break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20)
+				{
+					out << "\\u" << std::hex << std::setw(4)
+						<< std::setfill('0') << static_cast<int>(c)
+						<< std::dec << std::setfill(' ');
+				} else
+				{
+					out << c;
+				}
+		}
+	}
+
+	out << '"';
+	return out.str();
+}
+
+
+/**
+ * \brief TRUE iff a reader type is read by a pcm::SampleReader.
+ */
+bool is_builtin(const std::string& reader)
+{
+	return 0 == reader.rfind("builtin/", 0);
+}
+
+
+/**
+ * \brief Accumulated plans of the files of a reader type.
+ */
+struct ReaderTotal final
+{
+	std::size_t files   = 0;
+	std::size_t samples = 0;
+	std::size_t bytes   = 0;
+	double seconds      = 0;
+};
+
+
+/**
+ * \brief Accumulate the planned files by reader type.
+ */
+std::map<std::string, ReaderTotal> totals_by_reader(const Plan& plan)
+{
+	auto totals = std::map<std::string, ReaderTotal> {};
+
+	for (const auto& album : plan.albums)
+	{
+		for (const auto& file : album.files)
+		{
+			auto& total { totals[file.reader] };
+
+			++total.files;
+			total.samples += file.samples;
+			total.bytes   += file.bytes;
+			total.seconds += file.seconds;
+		}
+	}
+
+	return totals;
+}
+
+
+/**
+ * \brief Sum of the accumulated plans of all reader types.
+ */
+ReaderTotal total_of(const std::map<std::string, ReaderTotal>& totals)
+{
+	auto total = ReaderTotal {};
+
+	for (const auto& [ reader, t ] : totals)
+	{
+		total.files   += t.files;
+		total.samples += t.samples;
+		total.bytes   += t.bytes;
+		total.seconds += t.seconds;
+	}
+
+	return total;
+}
+
+
+/**
+ * \brief Layout of the plan tables.
+ */
+std::unique_ptr<table::StringTableLayout> create_layout()
+{
+	auto l = std::make_unique<table::StringTableLayout>();
+
+	l->set_row_labels(false);
+	l->set_row_header_delims(true);
+
+	return l;
+}
+
+} // namespace
+
+
+std::string reader_type(const selection::Decoder decoder,
+		const pcm::Format format)
+{
+	const auto prefix { selection::Decoder::SAMPLE_READER == decoder
+		? std::string { "builtin/" } : std::string { "libarcsdec/" } };
+
+	switch (format)
+	{
+		case pcm::Format::WAV:  return prefix + "wav";
+		case pcm::Format::FLAC: return prefix + "flac";
+		default:                return prefix + "other";
+	}
+}
+
+
+// Calibration
+
+
+Calibration::Calibration()
+	: rates_ { /* empty */ }
+{
+	// empty
+}
+
+
+void Calibration::read(std::istream& in)
+{
+	auto line    = std::string {};
+	auto line_no = std::size_t { 0 };
+
+	while (std::getline(in, line))
+	{
+		++line_no;
+
+		if (line.empty() || '#' == line.front())
+		{
+			continue;
+		}
+
+		auto fields = std::istringstream { line };
+		auto reader = std::string {};
+		auto rate   = double { 0 };
+
+		if (!(fields >> reader >> rate) || rate <= 0)
+		{
+			std::ostringstream msg;
+			msg << "Calibration line " << line_no << " does not declare a "
+				<< "reader type and a rate";
+
+			throw std::runtime_error(msg.str());
+		}
+
+		set_rate(reader, rate);
+	}
+}
+
+
+bool Calibration::read(const std::string& filename)
+{
+	auto in = std::ifstream { filename };
+
+	if (!in)
+	{
+		return false;
+	}
+
+	read(in);
+
+	return true;
+}
+
+
+void Calibration::write(std::ostream& out) const
+{
+	out << "# reader type, samples per second\n";
+
+	for (const auto& [ reader, rate ] : rates_)
+	{
+		out << reader << ' ' << fixed(rate, 0) << '\n';
+	}
+}
+
+
+void Calibration::write(const std::string& filename) const
+{
+	auto out = std::ofstream { filename };
+
+	write(out);
+
+	if (!out)
+	{
+		throw std::runtime_error("Could not write calibration: " + filename);
+	}
+}
+
+
+bool Calibration::contains(const std::string& reader) const
+{
+	return rates_.find(reader) != rates_.end();
+}
+
+
+double Calibration::rate(const std::string& reader) const
+{
+	const auto r { rates_.find(reader) };
+
+	return r != rates_.end() ? r->second : 0;
+}
+
+
+void Calibration::set_rate(const std::string& reader, const double rate)
+{
+	rates_[reader] = rate;
+}
+
+
+const std::map<std::string, double>& Calibration::rates() const
+{
+	return rates_;
+}
+
+
+// plan_album
+
+
+AlbumPlan plan_album(const calc::ChecksumCalculator& calculator,
+		const batch::Album& album)
+{
+	auto result = AlbumPlan { album.metafile, {}, {}, 0 };
+
+	if (result.name.empty() && !album.audiofiles.empty())
+	{
+		result.name = album.audiofiles.front();
+	}
+
+	auto audiofiles = std::vector<std::string> {};
+
+	try
+	{
+		audiofiles = calculator.audiofiles(album.audiofiles, album.metafile);
+
+	} catch (const std::exception& e)
+	{
+		result.error = "Cannot parse " + album.metafile + ": " + e.what();
+		return result;
+	}
+
+	if (audiofiles.empty())
+	{
+		result.error = "No audio files";
+		return result;
+	}
+
+	// Only the headers are read to determine the sizes
+
+	auto info { arcsdec::AudioInfo{} };
+
+	if (calculator.audio_selection())
+	{
+		info.set_selection(calculator.audio_selection());
+	}
+
+	for (const auto& audiofile : audiofiles)
+	{
+		try
+		{
+			if (calc::STDIN_FILENAME == audiofile)
+			{
+				throw std::runtime_error("Standard input cannot be planned");
+			}
+
+			const auto size { info.size(audiofile) };
+
+			if (!size || size->zero())
+			{
+				throw std::runtime_error("Contains no samples");
+			}
+
+			auto ec = std::error_code {};
+			const auto bytes { std::filesystem::file_size(audiofile, ec) };
+
+			const auto format  { pcm::detect_format(audiofile) };
+			const auto decoder {
+				calculator.decoder(format, audiofiles.size()) };
+
+			result.files.push_back(FilePlan { audiofile,
+					reader_type(decoder, format),
+					static_cast<std::size_t>(size->total_samples()),
+					ec ? 0 : static_cast<std::size_t>(bytes), 0 });
+
+		} catch (const std::exception& e)
+		{
+			result.error = "Audio file " + audiofile + ": " + e.what();
+			result.files.clear();
+			return result;
+		}
+	}
+
+	return result;
+}
+
+
+// measure
+
+
+double measure(const calc::ChecksumCalculator& calculator,
+		const FilePlan& file, const selection::Decoder decoder)
+{
+	using clock = std::chrono::steady_clock;
+
+	auto samples = std::size_t { 0 };
+	const auto start { clock::now() };
+
+	if (selection::Decoder::SAMPLE_READER == decoder)
+	{
+		// Read and sum up the first samples like a calculation does
+
+		const auto reader { pcm::open_sample_reader(file.filename,
+				calculator.input_options()) };
+
+		if (!reader)
+		{
+			throw std::runtime_error("No reader for " + file.filename);
+		}
+
+		const auto kernel { kernel::select(calculator.engine()) };
+		const auto total  {
+			std::min(reader->total_samples(), CALIBRATION_SAMPLES) };
+
+		auto buffer = std::vector<pcm::Sample>(CALIBRATION_CHUNK_SAMPLES);
+		auto lo = std::uint32_t { 0 };
+		auto hi = std::uint32_t { 0 };
+
+		while (samples < total)
+		{
+			const auto read { reader->read(samples,
+					std::min(buffer.size(), total - samples), buffer.data()) };
+
+			if (0 == read)
+			{
+				break;
+			}
+
+			kernel(buffer.data(), read, samples + 1, &lo, &hi);
+			samples += read;
+		}
+	} else
+	{
+		// libarcsdec offers no partial calculation
+
+		auto arcs { arcsdec::ARCSCalculator{} };
+
+		if (calculator.audio_selection())
+		{
+			arcs.set_selection(calculator.audio_selection());
+		}
+
+		arcs.calculate({ file.filename }, true, true);
+		samples = file.samples;
+	}
+
+	const std::chrono::duration<double> seconds { clock::now() - start };
+
+	if (0 == samples || seconds.count() <= 0)
+	{
+		throw std::runtime_error("No samples read from " + file.filename);
+	}
+
+	return samples / seconds.count();
+}
+
+
+// calibrate
+
+
+std::size_t calibrate(Calibration& calibration,
+		const calc::ChecksumCalculator& calculator,
+		const std::vector<AlbumPlan>& albums)
+{
+	// The smallest file of each reader type without a rate
+
+	auto smallest = std::map<std::string, const FilePlan*> {};
+
+	for (const auto& album : albums)
+	{
+		for (const auto& file : album.files)
+		{
+			if (calibration.contains(file.reader))
+			{
+				continue;
+			}
+
+			auto& s { smallest[file.reader] };
+
+			if (!s || file.samples < s->samples)
+			{
+				s = &file;
+			}
+		}
+	}
+
+	auto measured = std::size_t { 0 };
+
+	for (const auto& [ reader, file ] : smallest)
+	{
+		const auto decoder { is_builtin(reader)
+			? selection::Decoder::SAMPLE_READER
+			: selection::Decoder::LIBARCSDEC };
+
+		try
+		{
+			const auto rate { measure(calculator, *file, decoder) };
+
+			ARCS_LOG_INFO << "Calibrate " << reader << " on "
+				<< file->filename << ": " << fixed(rate, 0)
+				<< " samples per second";
+
+			calibration.set_rate(reader, rate);
+			++measured;
+
+		} catch (const std::exception& e)
+		{
+			ARCS_LOG_WARNING << "Cannot calibrate " << reader << " on "
+				<< file->filename << ": " << e.what();
+		}
+	}
+
+	return measured;
+}
+
+
+// schedule
+
+
+double schedule(const std::vector<double>& seconds,
+		const std::size_t workers)
+{
+	// Times at which the workers become available. The workers are few,
+	// thus the earliest is searched instead of kept in a heap.
+
+	auto available = std::vector<double>(std::max<std::size_t>(workers, 1));
+
+	auto end = double { 0 };
+
+	for (const auto s : seconds)
+	{
+		auto& earliest { *std::min_element(available.begin(),
+				available.end()) };
+
+		earliest += s;
+
+		end = std::max(end, earliest);
+	}
+
+	return end;
+}
+
+
+// predict
+
+
+Plan predict(std::vector<AlbumPlan> albums, const Calibration& calibration,
+		const std::size_t workers, const bool batch)
+{
+	auto album_seconds = std::vector<double> {};
+
+	for (auto& album : albums)
+	{
+		auto file_seconds = std::vector<double> {};
+
+		for (auto& file : album.files)
+		{
+			const auto rate { calibration.rate(file.reader) };
+
+			file.seconds = rate > 0 ? file.samples / rate : 0;
+			file_seconds.push_back(file.seconds);
+		}
+
+		if (batch)
+		{
+			album.seconds = schedule(file_seconds, 1);
+
+		} else if (1 == album.files.size()
+				&& is_builtin(album.files.front().reader))
+		{
+			album.seconds = file_seconds.front() / std::max<std::size_t>(
+					workers, 1);
+		} else
+		{
+			album.seconds = schedule(file_seconds, workers);
+		}
+
+		album_seconds.push_back(album.seconds);
+	}
+
+	const auto seconds { batch
+		? schedule(album_seconds, workers)
+		: schedule(album_seconds, 1) };
+
+	return Plan { std::move(albums), workers, seconds };
+}
+
+
+// to_json
+
+
+std::string to_json(const Plan& plan, const Calibration& calibration)
+{
+	const auto totals { totals_by_reader(plan) };
+	const auto total  { total_of(totals) };
+	const auto bytes_per_sample { sizeof(pcm::Sample) };
+
+	std::ostringstream out;
+
+	out << "{\n  \"threads\": " << plan.workers << ",\n  \"albums\": [";
+
+	for (auto a = plan.albums.begin(); a != plan.albums.end(); ++a)
+	{
+		out << (a == plan.albums.begin() ? "\n" : ",\n")
+			<< "    {\n      \"album\": " << quoted(a->name) << ",\n";
+
+		if (!a->error.empty())
+		{
+			out << "      \"error\": " << quoted(a->error) << ",\n";
+		}
+
+		out << "      \"seconds\": " << fixed(a->seconds, 3) << ",\n"
+			<< "      \"files\": [";
+
+		for (auto f = a->files.begin(); f != a->files.end(); ++f)
+		{
+			out << (f == a->files.begin() ? "\n" : ",\n")
+				<< "        { \"file\": " << quoted(f->filename)
+				<< ", \"reader\": " << quoted(f->reader)
+				<< ", \"samples\": " << f->samples
+				<< ", \"compressed_bytes\": " << f->bytes
+				<< ", \"decoded_bytes\": " << f->samples * bytes_per_sample
+				<< ", \"seconds\": " << fixed(f->seconds, 3) << " }";
+		}
+
+		out << (a->files.empty() ? "]\n" : "\n      ]\n") << "    }";
+	}
+
+	out << (plan.albums.empty() ? "]" : "\n  ]") << ",\n  \"readers\": [";
+
+	for (auto r = totals.begin(); r != totals.end(); ++r)
+	{
+		out << (r == totals.begin() ? "\n" : ",\n")
+			<< "    { \"reader\": " << quoted(r->first)
+			<< ", \"files\": " << r->second.files
+			<< ", \"samples\": " << r->second.samples
+			<< ", \"compressed_bytes\": " << r->second.bytes
+			<< ", \"decoded_bytes\": " << r->second.samples * bytes_per_sample
+			<< ", \"samples_per_second\": "
+			<< fixed(calibration.rate(r->first), 0)
+			<< ", \"seconds\": " << fixed(r->second.seconds, 3) << " }";
+	}
+
+	out << (totals.empty() ? "]" : "\n  ]") << ",\n  \"total\": {"
+		<< " \"files\": " << total.files
+		<< ", \"samples\": " << total.samples
+		<< ", \"compressed_bytes\": " << total.bytes
+		<< ", \"decoded_bytes\": " << total.samples * bytes_per_sample
+		<< ", \"cpu_seconds\": " << fixed(total.seconds, 3)
+		<< ", \"wall_seconds\": " << fixed(plan.seconds, 3) << " }\n}\n";
+
+	return out.str();
+}
+
+
+// file_table
+
+
+table::StringTable file_table(const Plan& plan)
+{
+	table::StringTable t { "Audio files", 0, 7 };
+	t.set_layout(create_layout());
+
+	t.set_col_label(0, "Album");
+	t.set_col_label(1, "File");
+	t.set_col_label(2, "Reader");
+	t.set_col_label(3, "Samples");
+	t.set_col_label(4, "MiB");
+	t.set_col_label(5, "Decoded MiB");
+	t.set_col_label(6, "Seconds");
+
+	for (auto col = 3; col < 7; ++col)
+	{
+		t.set_align(col, table::Align::RIGHT);
+	}
+
+	auto row = 0;
+
+	for (const auto& album : plan.albums)
+	{
+		for (const auto& file : album.files)
+		{
+			t.cell(row, 0) = album.name;
+			t.cell(row, 1) = file.filename;
+			t.cell(row, 2) = file.reader;
+			t.cell(row, 3) = std::to_string(file.samples);
+			t.cell(row, 4) = fixed(file.bytes / MIB, 1);
+			t.cell(row, 5) = fixed(file.samples * sizeof(pcm::Sample) / MIB,
+					1);
+			t.cell(row, 6) = fixed(file.seconds, 1);
+			++row;
+		}
+	}
+
+	return t;
+}
+
+
+// reader_table
+
+
+table::StringTable reader_table(const Plan& plan,
+		const Calibration& calibration)
+{
+	const auto totals { totals_by_reader(plan) };
+	const auto total  { total_of(totals) };
+
+	table::StringTable t { "Predicted wall time of " + fixed(plan.seconds, 1)
+		+ " seconds with " + std::to_string(plan.workers) + " threads",
+		0, 7 };
+	t.set_layout(create_layout());
+
+	t.set_col_label(0, "Reader");
+	t.set_col_label(1, "Files");
+	t.set_col_label(2, "Samples");
+	t.set_col_label(3, "MiB");
+	t.set_col_label(4, "Decoded MiB");
+	t.set_col_label(5, "Samples/s");
+	t.set_col_label(6, "Seconds");
+
+	for (auto col = 1; col < 7; ++col)
+	{
+		t.set_align(col, table::Align::RIGHT);
+	}
+
+	const auto add = [&t](const int row, const std::string& reader,
+			const ReaderTotal& r, const std::string& rate)
+	{
+		t.cell(row, 0) = reader;
+		t.cell(row, 1) = std::to_string(r.files);
+		t.cell(row, 2) = std::to_string(r.samples);
+		t.cell(row, 3) = fixed(r.bytes / MIB, 1);
+		t.cell(row, 4) = fixed(r.samples * sizeof(pcm::Sample) / MIB, 1);
+		t.cell(row, 5) = rate;
+		t.cell(row, 6) = fixed(r.seconds, 1);
+	};
+
+	auto row = 0;
+
+	for (const auto& [ reader, r ] : totals)
+	{
+		add(row++, reader, r, fixed(calibration.rate(reader), 0));
+	}
+
+	add(row, "total", total, "");
+
+	return t;
+}
+
+} // namespace plan
+} // namespace v_1_0_0
+} // namespace arcsapp
+
@@ -0,0 +1,360 @@
+#ifndef __ARCSTOOLS_TOOLS_PLAN_HPP__
+#define __ARCSTOOLS_TOOLS_PLAN_HPP__
+
+/**
+ * \file
+ *
+ * \brief Planning pass that estimates the cost of a calculation.
+ */
+
+#include <cstddef>     // for size_t
+#include <istream>     // for istream
+#include <map>         // for map
+#include <ostream>     // for ostream
+#include <string>      // for string
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TABLE_HPP__
+#include "table.hpp"                // for StringTable
+#endif
+#ifndef __ARCSTOOLS_TOOLS_BATCH_HPP__
+#include "tools-batch.hpp"          // for Album
+#endif
+#ifndef __ARCSTOOLS_TOOLS_CALC_HPP__
+#include "tools-calc.hpp"           // for ChecksumCalculator
+#endif
+#ifndef __ARCSTOOLS_TOOLS_PCM_HPP__
+#include "tools-pcm.hpp"            // for Format
+#endif
+#ifndef __ARCSTOOLS_TOOLS_SELECTION_HPP__
+#include "tools-selection.hpp"      // for Decoder
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+
+/**
+ * \brief Tools and helpers for estimating the cost of a calculation.
+ *
+ * A plan reads only the metadata files and the headers of the audio files.
+ * The time to calculate each audio file follows from its number of samples
+ * and the rate of its reader type. The rates are measured on the local
+ * machine and kept in a Calibration.
+ */
+namespace plan
+{
+
+/**
+ * \brief Reader type of an audio file.
+ *
+ * The reader type is the decoder followed by the format, e.g. 'builtin/flac'
+ * for a FLAC file read by a pcm::SampleReader or 'libarcsdec/other' for a
+ * file in any other format.
+ *
+ * \param[in] decoder Decoder of the audio file
+ * \param[in] format  Format of the audio file
+ *
+ * \return Name of the reader type
+ */
+std::string reader_type(const selection::Decoder decoder,
+		const pcm::Format format);
+
+
+/**
+ * \brief Planned calculation of an audio file.
+ */
+struct FilePlan final
+{
+	/**
+	 * \brief Name of the audio file.
+	 */
+	std::string filename;
+
+	/**
+	 * \brief Reader type of the audio file.
+	 */
+	std::string reader;
+
+	/**
+	 * \brief Number of samples declared by the header.
+	 */
+	std::size_t samples;
+
+	/**
+	 * \brief Size of the audio file in bytes.
+	 */
+	std::size_t bytes;
+
+	/**
+	 * \brief Predicted time to calculate the file by a single thread.
+	 */
+	double seconds;
+};
+
+
+/**
+ * \brief Planned calculation of an album.
+ */
+struct AlbumPlan final
+{
+	/**
+	 * \brief Name of the album, its metafile or its first audio file.
+	 */
+	std::string name;
+
+	/**
+	 * \brief Planned audio files.
+	 */
+	std::vector<FilePlan> files;
+
+	/**
+	 * \brief Reason why the album cannot be planned, empty if it can.
+	 */
+	std::string error;
+
+	/**
+	 * \brief Predicted time to calculate the album.
+	 */
+	double seconds;
+};
+
+
+/**
+ * \brief Rates of the reader types on the local machine.
+ *
+ * A calibration file contains one reader type per line, followed by
+ * whitespace and its rate in samples per second. Empty lines and lines
+ * starting with '#' are ignored.
+ */
+class Calibration final
+{
+public:
+
+	/**
+	 * \brief Constructor for an empty calibration.
+	 */
+	Calibration();
+
+	/**
+	 * \brief Read rates from a stream.
+	 *
+	 * \param[in] in Stream to read
+	 *
+	 * \throws std::runtime_error If a line is malformed
+	 */
+	void read(std::istream& in);
+
+	/**
+	 * \brief Read rates from a calibration file.
+	 *
+	 * \param[in] filename Name of the calibration file
+	 *
+	 * \return FALSE iff the file does not exist
+	 *
+	 * \throws std::runtime_error If a line is malformed
+	 */
+	bool read(const std::string& filename);
+
+	/**
+	 * \brief Write all rates to a stream.
+	 *
+	 * \param[in] out Stream to write
+	 */
+	void write(std::ostream& out) const;
+
+	/**
+	 * \brief Write all rates to a calibration file.
+	 *
+	 * \param[in] filename Name of the calibration file
+	 *
+	 * \throws std::runtime_error If the file cannot be written
+	 */
+	void write(const std::string& filename) const;
+
+	/**
+	 * \brief TRUE iff the rate of a reader type is known.
+	 *
+	 * \param[in] reader Reader type
+	 *
+	 * \return TRUE iff \c reader has a rate
+	 */
+	bool contains(const std::string& reader) const;
+
+	/**
+	 * \brief Rate of a reader type.
+	 *
+	 * \param[in] reader Reader type
+	 *
+	 * \return Samples per second, 0 if unknown
+	 */
+	double rate(const std::string& reader) const;
+
+	/**
+	 * \brief Set the rate of a reader type.
+	 *
+	 * \param[in] reader Reader type
+	 * \param[in] rate   Samples per second
+	 */
+	void set_rate(const std::string& reader, const double rate);
+
+	/**
+	 * \brief All rates by reader type.
+	 *
+	 * \return Rates by reader type
+	 */
+	const std::map<std::string, double>& rates() const;
+
+private:
+
+	/**
+	 * \brief Samples per second by reader type.
+	 */
+	std::map<std::string, double> rates_;
+};
+
+
+/**
+ * \brief Plan the calculation of an album.
+ *
+ * Parses the metafile and reads the headers of the audio files. The
+ * predicted times are left 0.
+ *
+ * \param[in] calculator The calculator configured for the calculation
+ * \param[in] album      The album to plan
+ *
+ * \return Plan of the album
+ */
+AlbumPlan plan_album(const calc::ChecksumCalculator& calculator,
+		const batch::Album& album);
+
+
+/**
+ * \brief Measure the rate of a reader type on an audio file.
+ *
+ * A pcm::SampleReader reads and sums up at most 30 seconds of samples.
+ * libarcsdec calculates the entire file.
+ *
+ * \param[in] calculator The calculator configured for the calculation
+ * \param[in] file       The audio file to measure
+ * \param[in] decoder    The decoder of the audio file
+ *
+ * \return Samples per second
+ *
+ * \throws std::runtime_error If the file cannot be read
+ */
+double measure(const calc::ChecksumCalculator& calculator,
+		const FilePlan& file, const selection::Decoder decoder);
+
+
+/**
+ * \brief Measure each reader type of the albums without a rate.
+ *
+ * Each reader type is measured on its smallest audio file.
+ *
+ * \param[in,out] calibration The calibration to complete
+ * \param[in]     calculator  The calculator configured for the calculation
+ * \param[in]     albums      The planned albums
+ *
+ * \return Number of reader types measured
+ */
+std::size_t calibrate(Calibration& calibration,
+		const calc::ChecksumCalculator& calculator,
+		const std::vector<AlbumPlan>& albums);
+
+
+/**
+ * \brief Time to process jobs by a number of workers.
+ *
+ * The jobs are started in order, each by the first worker available, as
+ * the thread pools of arcs-tools do.
+ *
+ * \param[in] seconds Time of each job
+ * \param[in] workers Number of workers
+ *
+ * \return Time until the last job is completed
+ */
+double schedule(const std::vector<double>& seconds,
+		const std::size_t workers);
+
+
+/**
+ * \brief Planned calculation of all albums.
+ */
+struct Plan final
+{
+	/**
+	 * \brief Planned albums.
+	 */
+	std::vector<AlbumPlan> albums;
+
+	/**
+	 * \brief Number of threads.
+	 */
+	std::size_t workers;
+
+	/**
+	 * \brief Predicted wall time.
+	 */
+	double seconds;
+};
+
+
+/**
+ * \brief Predict the time of the planned albums.
+ *
+ * In a batch, each album is calculated by a single thread and the threads
+ * process different albums. Otherwise, the files of the single album are
+ * calculated concurrently and a single file is split among the threads if
+ * it is read by a pcm::SampleReader.
+ *
+ * \param[in] albums      The planned albums
+ * \param[in] calibration The rates of the reader types
+ * \param[in] workers     Number of threads
+ * \param[in] batch       TRUE iff the albums are processed as a batch
+ *
+ * \return Plan with the predicted times
+ */
+Plan predict(std::vector<AlbumPlan> albums, const Calibration& calibration,
+		const std::size_t workers, const bool batch);
+
+
+/**
+ * \brief Plan as JSON.
+ *
+ * \param[in] plan        The plan
+ * \param[in] calibration The rates of the reader types
+ *
+ * \return JSON object of the plan
+ */
+std::string to_json(const Plan& plan, const Calibration& calibration);
+
+
+/**
+ * \brief Table of the planned audio files.
+ *
+ * \param[in] plan The plan
+ *
+ * \return Table with a row per audio file
+ */
+table::StringTable file_table(const Plan& plan);
+
+
+/**
+ * \brief Table of the reader types of a plan.
+ *
+ * \param[in] plan        The plan
+ * \param[in] calibration The rates of the reader types
+ *
+ * \return Table with a row per reader type and a row for the total
+ */
+table::StringTable reader_table(const Plan& plan,
+		const Calibration& calibration);
+
+} // namespace plan
+} // namespace v_1_0_0
+} // namespace arcsapp
+
+#endif
+
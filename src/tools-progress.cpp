@@ -0,0 +1,413 @@
+/**
+ * \file tools-progress.cpp Live progress and throughput of calculations
+ */
+
+#ifndef __ARCSTOOLS_TOOLS_PROGRESS_HPP__
+#include "tools-progress.hpp"
+#endif
+
+#include <algorithm>   // for remove_if
+#include <iomanip>     // for setfill, setprecision, setw
+#include <sstream>     // for ostringstream
+#include <utility>     // for move
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+namespace progress
+{
+
+namespace
+{
+
+/**
+ * \brief Decoded bytes per sample.
+ */
+constexpr std::size_t BYTES_PER_SAMPLE = 4;
+
+/**
+ * \brief Maximal number of files in a line.
+ */
+constexpr std::size_t MAX_FILES = 4;
+
+
+/**
+ * \brief Seconds between two points in time.
+ */
+double seconds(const Clock::time_point from, const Clock::time_point to)
+{
+	return std::chrono::duration<double>(to - from).count();
+}
+
+
+/**
+ * \brief Time in seconds as H:MM:SS.
+ */
+std::string hms(const double seconds)
+{
+	const auto s { static_cast<long long>(seconds + 0.5) };
+
+	auto out = std::ostringstream {};
+	out << s / 3600 << ':'
+		<< std::setfill('0') << std::setw(2) << s / 60 % 60 << ':'
+		<< std::setfill('0') << std::setw(2) << s % 60;
+
+	return out.str();
+}
+
+
+/**
+ * \brief Filename without its directories.
+ */
+std::string basename(const std::string& filename)
+{
+	const auto pos { filename.find_last_of('/') };
+
+	return pos == std::string::npos ? filename : filename.substr(pos + 1);
+}
+
+
+/**
+ * \brief SampleReader that counts the samples it reads.
+ */
+class ProgressReader final : public pcm::SampleReader
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] reader The reader to wrap
+	 * \param[in] file   The counter of the file
+	 */
+	ProgressReader(std::unique_ptr<pcm::SampleReader> reader,
+			const std::shared_ptr<FileProgress>& file);
+
+private:
+
+	std::size_t do_total_samples() const final;
+
+	std::size_t do_read(const std::size_t first, const std::size_t count,
+			pcm::Sample* buffer) final;
+
+	std::string do_embedded_md5() const final;
+
+	/**
+	 * \brief The wrapped reader.
+	 */
+	std::unique_ptr<pcm::SampleReader> reader_;
+
+	/**
+	 * \brief The counter of the file.
+	 */
+	std::shared_ptr<FileProgress> file_;
+};
+
+
+ProgressReader::ProgressReader(std::unique_ptr<pcm::SampleReader> reader,
+		const std::shared_ptr<FileProgress>& file)
+	: reader_ { std::move(reader) }
+	, file_   { file }
+{
+	// empty
+}
+
+
+std::size_t ProgressReader::do_total_samples() const
+{
+	return reader_->total_samples();
+}
+
+
+std::size_t ProgressReader::do_read(const std::size_t first,
+		const std::size_t count, pcm::Sample* buffer)
+{
+	const auto n { reader_->read(first, count, buffer) };
+
+	file_->add(n);
+
+	return n;
+}
+
+
+std::string ProgressReader::do_embedded_md5() const
+{
+	return reader_->embedded_md5();
+}
+
+} // namespace
+
+
+// FileProgress
+
+
+FileProgress::FileProgress(const std::string& filename,
+		const std::size_t total)
+	: filename_ { filename }
+	, total_    { total }
+	, done_     { 0 }
+{
+	// empty
+}
+
+
+const std::string& FileProgress::filename() const
+{
+	return filename_;
+}
+
+
+std::size_t FileProgress::total() const
+{
+	return total_;
+}
+
+
+std::size_t FileProgress::done() const
+{
+	return done_.load(std::memory_order_relaxed);
+}
+
+
+void FileProgress::add(const std::size_t samples)
+{
+	done_.fetch_add(samples, std::memory_order_relaxed);
+}
+
+
+// Reporter
+
+
+Reporter::Reporter(const std::chrono::milliseconds interval,
+		std::ostream& out)
+	: interval_          { interval }
+	, out_               { out }
+	, start_             { Clock::now() }
+	, mutex_             { /* default */ }
+	, files_             { /* empty */ }
+	, completed_samples_ { 0 }
+	, albums_            { 0 }
+	, albums_done_       { 0 }
+	, last_time_         { start_ }
+	, last_samples_      { 0 }
+	, stop_signal_       { /* default */ }
+	, stop_              { false }
+	, thread_            { /* empty */ }
+{
+	if (interval_.count() > 0)
+	{
+		thread_ = std::thread { &Reporter::run, this };
+	}
+}
+
+
+Reporter::~Reporter() noexcept
+{
+	{
+		const std::lock_guard<std::mutex> lock { mutex_ };
+		stop_ = true;
+	}
+	stop_signal_.notify_all();
+
+	if (thread_.joinable())
+	{
+		thread_.join();
+	}
+
+	try
+	{
+		out_ << final_line() << std::endl;
+	} catch (...)
+	{
+		// Nothing to report
+	}
+}
+
+
+std::shared_ptr<FileProgress> Reporter::start_file(
+		const std::string& filename, const std::size_t total)
+{
+	auto file { std::make_shared<FileProgress>(filename, total) };
+
+	const std::lock_guard<std::mutex> lock { mutex_ };
+	files_.push_back(file);
+
+	return file;
+}
+
+
+void Reporter::add_albums(const std::size_t albums)
+{
+	const std::lock_guard<std::mutex> lock { mutex_ };
+	albums_ += albums;
+}
+
+
+void Reporter::album_done()
+{
+	const std::lock_guard<std::mutex> lock { mutex_ };
+	++albums_done_;
+}
+
+
+std::string Reporter::line()
+{
+	const std::lock_guard<std::mutex> lock { mutex_ };
+
+	const auto now     { Clock::now() };
+	const auto samples { collect() };
+	const auto elapsed { seconds(start_, now) };
+	const auto delta   { seconds(last_time_, now) };
+	const auto rate    { delta > 0
+		? static_cast<double>(samples - last_samples_) / delta : 0.0 };
+
+	last_time_    = now;
+	last_samples_ = samples;
+
+	auto out = std::ostringstream {};
+	out << std::fixed << std::setprecision(1) << "PROGRESS: ";
+
+	if (albums_ > 0)
+	{
+		out << albums_done_ << '/' << albums_ << " albums, "
+			<< (elapsed > 0 ? albums_done_ * 60 / elapsed : 0.0)
+			<< " albums/min | ";
+	}
+
+	auto remaining = std::size_t { 0 };
+	auto shown     = std::size_t { 0 };
+
+	for (const auto& file : files_)
+	{
+		const auto done { std::min(file->done(), file->total()) };
+
+		remaining += file->total() - done;
+
+		if (shown < MAX_FILES)
+		{
+			out << (shown ? ", " : "") << basename(file->filename()) << ' '
+				<< (file->total() ? done * 100 / file->total() : 0) << '%';
+		}
+
+		++shown;
+	}
+
+	if (shown > MAX_FILES)
+	{
+		out << ", +" << shown - MAX_FILES << " more";
+	}
+
+	if (shown == 0)
+	{
+		out << "no files";
+	}
+
+	out << " | " << rate * BYTES_PER_SAMPLE / 1000000 << " MB/s, "
+		<< rate / 1000000 << "M samples/s";
+
+	if (albums_ > 0 && albums_done_ > 0)
+	{
+		out << " | ETA "
+			<< hms(elapsed * (albums_ - albums_done_) / albums_done_);
+	} else if (remaining > 0 && rate > 0)
+	{
+		out << " | ETA " << hms(remaining / rate);
+	}
+
+	return out.str();
+}
+
+
+std::string Reporter::final_line()
+{
+	const std::lock_guard<std::mutex> lock { mutex_ };
+
+	const auto samples { collect() };
+	const auto elapsed { seconds(start_, Clock::now()) };
+	const auto bytes   { static_cast<double>(samples * BYTES_PER_SAMPLE) };
+
+	auto out = std::ostringstream {};
+	out << std::fixed << std::setprecision(1) << "PROGRESS: done | ";
+
+	if (albums_ > 0)
+	{
+		out << albums_done_ << '/' << albums_ << " albums | ";
+	}
+
+	out << bytes / 1000000 << " MB in " << hms(elapsed) << ", "
+		<< (elapsed > 0 ? bytes / 1000000 / elapsed : 0.0) << " MB/s";
+
+	return out.str();
+}
+
+
+void Reporter::report()
+{
+	const auto text { line() };
+
+	const std::lock_guard<std::mutex> lock { mutex_ };
+	out_ << text << std::endl;
+}
+
+
+void Reporter::run()
+{
+	std::unique_lock<std::mutex> lock { mutex_ };
+
+	while (!stop_signal_.wait_for(lock, interval_, [this]{ return stop_; }))
+	{
+		lock.unlock();
+		report();
+		lock.lock();
+	}
+}
+
+
+std::size_t Reporter::collect()
+{
+	// A file no reader holds anymore is completed: since only start_file()
+	// hands out the counters, its use count cannot increase again.
+
+	auto active = std::size_t { 0 };
+
+	files_.erase(std::remove_if(files_.begin(), files_.end(),
+		[this](const std::shared_ptr<FileProgress>& file)
+		{
+			if (file.use_count() > 1)
+			{
+				return false;
+			}
+
+			completed_samples_ += file->done();
+			return true;
+		}), files_.end());
+
+	for (const auto& file : files_)
+	{
+		active += file->done();
+	}
+
+	return completed_samples_ + active;
+}
+
+
+// track
+
+
+std::unique_ptr<pcm::SampleReader> track(
+		std::unique_ptr<pcm::SampleReader> reader,
+		const std::shared_ptr<FileProgress>& file)
+{
+	if (!reader || !file)
+	{
+		return reader;
+	}
+
+	return std::make_unique<ProgressReader>(std::move(reader), file);
+}
+
+} // namespace progress
+} // namespace v_1_0_0
+} // namespace arcsapp
+
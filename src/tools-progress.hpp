@@ -0,0 +1,300 @@
+#ifndef __ARCSTOOLS_TOOLS_PROGRESS_HPP__
+#define __ARCSTOOLS_TOOLS_PROGRESS_HPP__
+
+/**
+ * \file
+ *
+ * \brief Live progress and throughput of calculations.
+ */
+
+#include <atomic>              // for atomic
+#include <chrono>              // for milliseconds, steady_clock
+#include <condition_variable>  // for condition_variable
+#include <cstddef>             // for size_t
+#include <iostream>            // for cerr
+#include <memory>              // for shared_ptr, unique_ptr
+#include <mutex>               // for mutex
+#include <ostream>             // for ostream
+#include <string>              // for string
+#include <thread>              // for thread
+#include <vector>              // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_PCM_HPP__
+#include "tools-pcm.hpp"      // for Sample, SampleReader
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+
+/**
+ * \brief Tools and helpers for reporting the progress of calculations.
+ *
+ * Each audio file read by a pcm::SampleReader counts its samples in a
+ * FileProgress. The readers add to the counter by a relaxed atomic addition
+ * per block of samples and never lock. A Reporter samples the counters of
+ * all files in a background thread and writes a line per interval.
+ *
+ * Files read by libarcsdec are not counted while they are read.
+ */
+namespace progress
+{
+
+/**
+ * \brief Clock of the progress.
+ */
+using Clock = std::chrono::steady_clock;
+
+
+/**
+ * \brief Samples of an audio file read so far.
+ */
+class FileProgress final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] filename Name of the audio file
+	 * \param[in] total    Total number of samples of the audio file
+	 */
+	FileProgress(const std::string& filename, const std::size_t total);
+
+	/**
+	 * \brief Name of the audio file.
+	 *
+	 * \return Name of the audio file
+	 */
+	const std::string& filename() const;
+
+	/**
+	 * \brief Total number of samples of the audio file.
+	 *
+	 * \return Total number of samples
+	 */
+	std::size_t total() const;
+
+	/**
+	 * \brief Number of samples read so far.
+	 *
+	 * \return Number of samples read
+	 */
+	std::size_t done() const;
+
+	/**
+	 * \brief Add samples read.
+	 *
+	 * \param[in] samples Number of samples read
+	 */
+	void add(const std::size_t samples);
+
+private:
+
+	/**
+	 * \brief Name of the audio file.
+	 */
+	std::string filename_;
+
+	/**
+	 * \brief Total number of samples.
+	 */
+	std::size_t total_;
+
+	/**
+	 * \brief Number of samples read so far.
+	 */
+	std::atomic<std::size_t> done_;
+};
+
+
+/**
+ * \brief Writes the progress of all files and albums in intervals.
+ *
+ * A line looks like:
+ *
+ * PROGRESS: 3/10 albums, 2.5 albums/min | a.flac 45% | 152.3 MB/s,
+ * 38.1M samples/s | ETA 0:05:12
+ *
+ * The rates refer to the last interval, the bytes are the decoded bytes of
+ * the samples. The ETA follows from the albums completed if the total number
+ * of albums is known and from the samples of the files in progress otherwise.
+ * When the Reporter is destroyed, it writes a final line with the totals.
+ */
+class Reporter final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * An interval of 0 starts no background thread, the lines are only
+	 * written by report().
+	 *
+	 * \param[in] interval Time between two lines
+	 * \param[in] out      Stream to write the lines to
+	 */
+	explicit Reporter(const std::chrono::milliseconds interval,
+			std::ostream& out = std::cerr);
+
+	/**
+	 * \brief Destructor.
+	 *
+	 * Stops the background thread and writes the final line.
+	 */
+	~Reporter() noexcept;
+
+	Reporter(const Reporter&) = delete;
+	Reporter& operator=(const Reporter&) = delete;
+
+	/**
+	 * \brief Start to count the samples of an audio file.
+	 *
+	 * The file is in progress as long as the returned object is held by
+	 * any reader.
+	 *
+	 * \param[in] filename Name of the audio file
+	 * \param[in] total    Total number of samples of the audio file
+	 *
+	 * \return Counter of the samples of the file
+	 */
+	std::shared_ptr<FileProgress> start_file(const std::string& filename,
+			const std::size_t total);
+
+	/**
+	 * \brief Add to the total number of albums.
+	 *
+	 * \param[in] albums Number of albums to add
+	 */
+	void add_albums(const std::size_t albums);
+
+	/**
+	 * \brief Count a completed album.
+	 */
+	void album_done();
+
+	/**
+	 * \brief Current progress line.
+	 *
+	 * The rates refer to the time since the previous line.
+	 *
+	 * \return Progress line without newline
+	 */
+	std::string line();
+
+	/**
+	 * \brief Final line with the totals.
+	 *
+	 * \return Final line without newline
+	 */
+	std::string final_line();
+
+	/**
+	 * \brief Write the current progress line.
+	 */
+	void report();
+
+private:
+
+	/**
+	 * \brief Write lines until stopped.
+	 */
+	void run();
+
+	/**
+	 * \brief Total number of samples read, completed files removed.
+	 *
+	 * Expects mutex_ to be held by the caller.
+	 *
+	 * \return Total number of samples read
+	 */
+	std::size_t collect();
+
+	/**
+	 * \brief Time between two lines.
+	 */
+	const std::chrono::milliseconds interval_;
+
+	/**
+	 * \brief Stream to write the lines to.
+	 */
+	std::ostream& out_;
+
+	/**
+	 * \brief Start of the calculation.
+	 */
+	const Clock::time_point start_;
+
+	/**
+	 * \brief Guards the files, the counters and the stream.
+	 */
+	std::mutex mutex_;
+
+	/**
+	 * \brief Files in progress.
+	 */
+	std::vector<std::shared_ptr<FileProgress>> files_;
+
+	/**
+	 * \brief Samples of the files completed.
+	 */
+	std::size_t completed_samples_;
+
+	/**
+	 * \brief Total number of albums, 0 if unknown.
+	 */
+	std::size_t albums_;
+
+	/**
+	 * \brief Number of albums completed.
+	 */
+	std::size_t albums_done_;
+
+	/**
+	 * \brief Time of the previous line.
+	 */
+	Clock::time_point last_time_;
+
+	/**
+	 * \brief Samples read at the time of the previous line.
+	 */
+	std::size_t last_samples_;
+
+	/**
+	 * \brief Signals the background thread to stop.
+	 */
+	std::condition_variable stop_signal_;
+
+	/**
+	 * \brief TRUE iff the background thread is to stop.
+	 */
+	bool stop_;
+
+	/**
+	 * \brief The background thread.
+	 */
+	std::thread thread_;
+};
+
+
+/**
+ * \brief Count the samples read by a reader.
+ *
+ * If either \c reader or \c file is \c nullptr, \c reader is returned as is.
+ *
+ * \param[in] reader The reader to count
+ * \param[in] file   The counter of the file
+ *
+ * \return Reader that adds the samples it reads to \c file
+ */
+std::unique_ptr<pcm::SampleReader> track(
+		std::unique_ptr<pcm::SampleReader> reader,
+		const std::shared_ptr<FileProgress>& file);
+
+} // namespace progress
+} // namespace v_1_0_0
+} // namespace arcsapp
+
+#endif
+
@@ -0,0 +1,340 @@
+/**
+ * \file tools-selection.cpp Reuse of reader selections and calculators
+ */
+
+#ifndef __ARCSTOOLS_TOOLS_SELECTION_HPP__
+#include "tools-selection.hpp"
+#endif
+
+#include <algorithm>   // for find_if, min
+#include <cstdint>     // for uint8_t, uint32_t
+#include <fstream>     // for ifstream
+#include <iomanip>     // for hex, setw, setfill
+#include <sstream>     // for ostringstream
+#include <utility>     // for move
+
+#ifndef __LIBARCSTK_LOGGING_HPP__
+#include <arcstk/logging.hpp>
+#endif
+
+#ifndef __LIBARCSDEC_CALCULATORS_HPP__
+#include <arcsdec/calculators.hpp>  // for ARCSCalculator
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+namespace selection
+{
+
+namespace
+{
+
+/**
+ * \brief Read a little endian 16 bit value.
+ */
+std::uint32_t le16(const unsigned char* b)
+{
+	return static_cast<std::uint32_t>(b[0])
+		| static_cast<std::uint32_t>(b[1]) << 8;
+}
+
+
+/**
+ * \brief Read a little endian 32 bit value.
+ */
+std::uint32_t le32(const unsigned char* b)
+{
+	return le16(b) | le16(b + 2) << 16;
+}
+
+
+/**
+ * \brief Signature of a RIFF/WAV file from the parameters of its fmt chunk.
+ *
+ * \return Signature, empty if the fmt chunk is not within the bytes
+ */
+Signature riff_signature(const unsigned char* b, const std::size_t size)
+{
+	auto pos = std::size_t { 12 };
+
+	while (pos + 8 <= size)
+	{
+		const auto chunk_size { le32(b + pos + 4) };
+
+		if (std::string(b + pos, b + pos + 4) == "fmt ")
+		{
+			if (chunk_size < 16 || pos + 8 + 16 > size)
+			{
+				break;
+			}
+
+			const auto fmt { b + pos + 8 };
+
+			std::ostringstream out;
+			out << "RIFF/WAVE format=" << le16(fmt)
+				<< " channels=" << le16(fmt + 2)
+				<< " rate="     << le32(fmt + 4)
+				<< " bits="     << le16(fmt + 14);
+
+			return out.str();
+		}
+
+		pos += 8 + chunk_size + (chunk_size & 1);
+	}
+
+	return Signature {};
+}
+
+
+/**
+ * \brief Signature of a FLAC file from the parameters of its STREAMINFO.
+ *
+ * \return Signature, empty if STREAMINFO is not the first metadata block
+ */
+Signature flac_signature(const unsigned char* b, const std::size_t size)
+{
+	if (size < 8 + 18 || (b[4] & 0x7F) != 0)
+	{
+		return Signature {};
+	}
+
+	const auto info { b + 8 };
+
+	const auto rate { static_cast<std::uint32_t>(info[10]) << 12
+		| static_cast<std::uint32_t>(info[11]) << 4
+		| static_cast<std::uint32_t>(info[12]) >> 4 };
+	const auto channels { ((info[12] >> 1) & 0x07) + 1 };
+	const auto bits { (((info[12] & 0x01) << 4) | (info[13] >> 4)) + 1 };
+
+	std::ostringstream out;
+	out << "fLaC rate=" << rate << " channels=" << channels
+		<< " bits=" << bits;
+
+	return out.str();
+}
+
+} // namespace
+
+
+Signature signature_of(const std::string& filename)
+{
+	auto bytes = std::vector<unsigned char>(SIGNATURE_BYTES);
+	auto in = std::ifstream { filename, std::ios::in | std::ios::binary };
+
+	in.read(reinterpret_cast<char*>(bytes.data()),
+			static_cast<std::streamsize>(bytes.size()));
+
+	const auto size { static_cast<std::size_t>(in.gcount()) };
+
+	if (size < 12)
+	{
+		return Signature {};
+	}
+
+	const auto magic { std::string(bytes.begin(), bytes.begin() + 4) };
+
+	if ("RIFF" == magic
+			&& std::string(bytes.begin() + 8, bytes.begin() + 12) == "WAVE")
+	{
+		return riff_signature(bytes.data(), size);
+	}
+
+	if ("fLaC" == magic)
+	{
+		return flac_signature(bytes.data(), size);
+	}
+
+	// Other formats are identified by their magic bytes, skipping the size
+	// of the file that containers like RIFF or FORM declare after their magic
+
+	std::ostringstream out;
+	out << "magic=" << std::hex << std::setfill('0');
+
+	for (const std::size_t i : { 0u, 1u, 2u, 3u, 8u, 9u, 10u, 11u })
+	{
+		out << std::setw(2) << static_cast<unsigned>(bytes[i]);
+	}
+
+	return out.str();
+}
+
+
+// CalculatorLease
+
+
+CalculatorLease::CalculatorLease(SelectionCache* cache,
+		const ChecksumTypeset& types, FileReaderSelection* selection,
+		std::unique_ptr<ARCSCalculator> calculator)
+	: cache_      { cache }
+	, types_      { types }
+	, selection_  { selection }
+	, calculator_ { std::move(calculator) }
+{
+	// empty
+}
+
+
+CalculatorLease::~CalculatorLease() noexcept
+{
+	try
+	{
+		cache_->release(types_, selection_, std::move(calculator_));
+	} catch (...)
+	{
+		// The calculator is destroyed instead of being reused
+	}
+}
+
+
+ARCSCalculator& CalculatorLease::operator*() const
+{
+	return *calculator_;
+}
+
+
+ARCSCalculator* CalculatorLease::operator->() const
+{
+	return calculator_.get();
+}
+
+
+// SelectionCache
+
+
+SelectionCache::SelectionCache()
+	: decoders_    { /* empty */ }
+	, idle_        { /* empty */ }
+	, hits_        { 0 }
+	, misses_      { 0 }
+	, calculators_ { 0 }
+	, mutex_       { /* default */ }
+{
+	// empty
+}
+
+
+SelectionCache::~SelectionCache() noexcept
+= default;
+
+
+std::optional<Decoder> SelectionCache::find(const Signature& signature)
+{
+	if (signature.empty())
+	{
+		++misses_;
+		return std::nullopt;
+	}
+
+	const std::lock_guard<std::mutex> lock(mutex_);
+
+	const auto decoder { decoders_.find(signature) };
+
+	if (decoder == decoders_.end())
+	{
+		++misses_;
+		return std::nullopt;
+	}
+
+	++hits_;
+	return decoder->second;
+}
+
+
+void SelectionCache::insert(const Signature& signature, const Decoder decoder)
+{
+	if (signature.empty())
+	{
+		return;
+	}
+
+	const std::lock_guard<std::mutex> lock(mutex_);
+
+	const auto [ entry, inserted ] = decoders_.emplace(signature, decoder);
+
+	if (inserted)
+	{
+		ARCS_LOG_DEBUG << "Select "
+			<< (Decoder::LIBARCSDEC == decoder ? "libarcsdec" : "sample reader")
+			<< " for " << signature;
+	} else
+	{
+		entry->second = decoder;
+	}
+}
+
+
+CalculatorLease SelectionCache::acquire(const ChecksumTypeset& types,
+		FileReaderSelection* selection)
+{
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+
+		const auto idle { std::find_if(idle_.begin(), idle_.end(),
+				[&types,selection](const IdleCalculator& c)
+				{
+					return c.selection == selection && c.types == types;
+				}) };
+
+		if (idle != idle_.end())
+		{
+			auto calculator { std::move(idle->calculator) };
+			idle_.erase(idle);
+
+			return CalculatorLease { this, types, selection,
+				std::move(calculator) };
+		}
+	}
+
+	// Create the calculator outside the lock, creation is the expensive part
+
+	auto calculator { std::make_unique<ARCSCalculator>(types) };
+
+	if (selection)
+	{
+		calculator->set_selection(selection);
+	}
+
+	++calculators_;
+
+	return CalculatorLease { this, types, selection, std::move(calculator) };
+}
+
+
+std::size_t SelectionCache::hits() const
+{
+	return hits_;
+}
+
+
+std::size_t SelectionCache::misses() const
+{
+	return misses_;
+}
+
+
+std::size_t SelectionCache::calculators() const
+{
+	return calculators_;
+}
+
+
+void SelectionCache::release(const ChecksumTypeset& types,
+		FileReaderSelection* selection,
+		std::unique_ptr<ARCSCalculator> calculator)
+{
+	if (!calculator)
+	{
+		return;
+	}
+
+	const std::lock_guard<std::mutex> lock(mutex_);
+
+	idle_.push_back({ types, selection, std::move(calculator) });
+}
+
+} // namespace selection
+} // namespace v_1_0_0
+} // namespace arcsapp
+
@@ -0,0 +1,309 @@
+#ifndef __ARCSTOOLS_TOOLS_SELECTION_HPP__
+#define __ARCSTOOLS_TOOLS_SELECTION_HPP__
+
+/**
+ * \file
+ *
+ * \brief Reuse of reader selections and calculators across audio files.
+ */
+
+#ifndef __LIBARCSTK_CALCULATE_HPP__
+#include <arcstk/calculate.hpp>        // for checksum::type
+#endif
+
+#include <atomic>      // for atomic
+#include <cstddef>     // for size_t
+#include <map>         // for map
+#include <memory>      // for unique_ptr
+#include <mutex>       // for mutex
+#include <optional>    // for optional
+#include <string>      // for string
+#include <unordered_set> // for unordered_set
+#include <vector>      // for vector
+
+
+// forward declarations
+namespace arcsdec
+{
+inline namespace v_1_0_0
+{
+class ARCSCalculator;
+class FileReaderSelection;
+} // namespace v_1_0_0
+} // namespace arcsdec
+
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+
+/**
+ * \brief Tools and helpers for selecting the reader of an audio file once.
+ *
+ * Each audio file is either read by a SampleReader of this application or by
+ * libarcsdec. Files of the same format with the same codec parameters are
+ * read by the same reader, thus the selection is remembered by the signature
+ * of the file. The ARCSCalculator instances that read files by libarcsdec
+ * are pooled and reused for the next file with the same checksum types and
+ * FileReaderSelection.
+ */
+namespace selection
+{
+
+using arcsdec::ARCSCalculator;
+using arcsdec::FileReaderSelection;
+
+
+/**
+ * \brief Checksum types of an ARCSCalculator.
+ */
+using ChecksumTypeset = std::unordered_set<arcstk::checksum::type>;
+
+
+/**
+ * \brief Format signature of an audio file.
+ *
+ * The signature consists of the magic bytes of the file and, for RIFF/WAV
+ * and FLAC, of the codec parameters declared in the header.
+ */
+using Signature = std::string;
+
+
+/**
+ * \brief Number of bytes read from the start of a file for its signature.
+ */
+constexpr std::size_t SIGNATURE_BYTES = 4096;
+
+
+/**
+ * \brief Signature of an audio file.
+ *
+ * \param[in] filename Name of the audio file
+ *
+ * \return Signature of \c filename, empty if the file cannot be read
+ */
+Signature signature_of(const std::string& filename);
+
+
+/**
+ * \brief Readers an audio file can be selected for.
+ */
+enum class Decoder
+{
+	SAMPLE_READER, //!< A pcm::SampleReader of this application
+	LIBARCSDEC     //!< The FileReaderSelection of libarcsdec
+};
+
+
+class SelectionCache;
+
+
+/**
+ * \brief An ARCSCalculator borrowed from a SelectionCache.
+ *
+ * The calculator is returned to its cache on destruction.
+ */
+class CalculatorLease final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] cache      Cache to return the calculator to
+	 * \param[in] types      Checksum types of the calculator
+	 * \param[in] selection  Selection of the calculator or \c nullptr
+	 * \param[in] calculator The calculator to lease
+	 */
+	CalculatorLease(SelectionCache* cache, const ChecksumTypeset& types,
+			FileReaderSelection* selection,
+			std::unique_ptr<ARCSCalculator> calculator);
+
+	CalculatorLease(const CalculatorLease&) = delete;
+	CalculatorLease& operator=(const CalculatorLease&) = delete;
+
+	/**
+	 * \brief Destructor, returns the calculator to its cache.
+	 */
+	~CalculatorLease() noexcept;
+
+	/**
+	 * \brief The calculator.
+	 *
+	 * \return The calculator
+	 */
+	ARCSCalculator& operator*() const;
+
+	/**
+	 * \brief The calculator.
+	 *
+	 * \return The calculator
+	 */
+	ARCSCalculator* operator->() const;
+
+private:
+
+	/**
+	 * \brief Cache to return the calculator to.
+	 */
+	SelectionCache* cache_;
+
+	/**
+	 * \brief Checksum types of the calculator.
+	 */
+	ChecksumTypeset types_;
+
+	/**
+	 * \brief Selection of the calculator or \c nullptr.
+	 */
+	FileReaderSelection* selection_;
+
+	/**
+	 * \brief The calculator.
+	 */
+	std::unique_ptr<ARCSCalculator> calculator_;
+};
+
+
+/**
+ * \brief Selected readers by signature and a pool of ARCSCalculators.
+ *
+ * A single instance can be shared by the calculations of multiple albums
+ * and used from multiple threads. The pool applies to the default selection
+ * of libarcsdec as well as to a selection of a specific reader, e.g. an
+ * IdSelection, since the calculators are distinguished by their selection.
+ */
+class SelectionCache final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 */
+	SelectionCache();
+
+	SelectionCache(const SelectionCache&) = delete;
+	SelectionCache& operator=(const SelectionCache&) = delete;
+
+	/**
+	 * \brief Destructor.
+	 */
+	~SelectionCache() noexcept;
+
+	/**
+	 * \brief Look up the reader selected for a signature.
+	 *
+	 * \param[in] signature The signature to look up
+	 *
+	 * \return The reader selected for \c signature if present
+	 */
+	std::optional<Decoder> find(const Signature& signature);
+
+	/**
+	 * \brief Remember the reader selected for a signature.
+	 *
+	 * An empty signature is not remembered.
+	 *
+	 * \param[in] signature The signature of the file read
+	 * \param[in] decoder   The reader selected for the file
+	 */
+	void insert(const Signature& signature, const Decoder decoder);
+
+	/**
+	 * \brief Borrow an ARCSCalculator.
+	 *
+	 * An idle calculator with the same types and selection is reused, else a
+	 * new calculator is created.
+	 *
+	 * \param[in] types     Checksum types to calculate
+	 * \param[in] selection Selection of audio readers, \c nullptr for the
+	 *                      default selection of libarcsdec
+	 *
+	 * \return Lease of a calculator for \c types and \c selection
+	 */
+	CalculatorLease acquire(const ChecksumTypeset& types,
+			FileReaderSelection* selection);
+
+	/**
+	 * \brief Number of successful lookups.
+	 *
+	 * \return Number of lookups that found a reader
+	 */
+	std::size_t hits() const;
+
+	/**
+	 * \brief Number of failed lookups.
+	 *
+	 * \return Number of lookups that found no reader
+	 */
+	std::size_t misses() const;
+
+	/**
+	 * \brief Number of calculators created by this instance.
+	 *
+	 * \return Number of calculators created
+	 */
+	std::size_t calculators() const;
+
+private:
+
+	friend CalculatorLease;
+
+	/**
+	 * \brief A calculator that is not leased.
+	 */
+	struct IdleCalculator final
+	{
+		ChecksumTypeset types;
+		FileReaderSelection* selection;
+		std::unique_ptr<ARCSCalculator> calculator;
+	};
+
+	/**
+	 * \brief Return a leased calculator.
+	 *
+	 * \param[in] types      Checksum types of the calculator
+	 * \param[in] selection  Selection of the calculator
+	 * \param[in] calculator The calculator to return
+	 */
+	void release(const ChecksumTypeset& types, FileReaderSelection* selection,
+			std::unique_ptr<ARCSCalculator> calculator);
+
+	/**
+	 * \brief Reader selected for each signature.
+	 */
+	std::map<Signature, Decoder> decoders_;
+
+	/**
+	 * \brief Calculators that are not leased.
+	 */
+	std::vector<IdleCalculator> idle_;
+
+	/**
+	 * \brief Number of successful lookups.
+	 */
+	std::atomic<std::size_t> hits_;
+
+	/**
+	 * \brief Number of failed lookups.
+	 */
+	std::atomic<std::size_t> misses_;
+
+	/**
+	 * \brief Number of calculators created.
+	 */
+	std::atomic<std::size_t> calculators_;
+
+	/**
+	 * \brief Guard for the readers and the calculators.
+	 */
+	std::mutex mutex_;
+};
+
+} // namespace selection
+} // namespace v_1_0_0
+} // namespace arcsapp
+
+#endif
+
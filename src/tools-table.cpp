@@ -92,6 +92,24 @@ std::string DefaultLabel<ATTR::THEIRS>()
 template<>
 std::string DefaultLabel<ATTR::CONFIDENCE>() { return "cnf"; };
 
+template<>
+std::string DefaultLabel<ATTR::SHIFT>() { return "Shift"; };
+
+template<>
+std::string DefaultLabel<ATTR::DIGEST_CRC32>() { return "CRC32"; };
+
+template<>
+std::string DefaultLabel<ATTR::DIGEST_CRC32_NOSILENCE>() { return "CRC32ns"; };
+
+template<>
+std::string DefaultLabel<ATTR::DIGEST_CTDB>() { return "CTDB"; };
+
+template<>
+std::string DefaultLabel<ATTR::DIGEST_MD5>() { return "MD5"; };
+
+template<>
+std::string DefaultLabel<ATTR::MD5_CHECK>() { return "MD5check"; };
+
 
 // DecorationInterface
 
@@ -293,7 +311,8 @@ RowTableComposer::RowTableComposer(const std::size_t entries,
 
 	// Columns that appear exactly once
 	for(const auto& c : { this->field_idx(ATTR::TRACK),
-			this->field_idx(ATTR::OFFSET), this->field_idx(ATTR::LENGTH) })
+			this->field_idx(ATTR::OFFSET), this->field_idx(ATTR::LENGTH),
+			this->field_idx(ATTR::SHIFT) })
 	{
 		if (c >= 0)
 		{
@@ -477,6 +496,13 @@ TableComposerBuilder::TableComposerBuilder()
 		{ ATTR::CHECKSUM_ARCS1, DefaultLabel<ATTR::CHECKSUM_ARCS1>() },
 		{ ATTR::THEIRS,         DefaultLabel<ATTR::THEIRS>()         },
 		{ ATTR::CONFIDENCE,     DefaultLabel<ATTR::CONFIDENCE>()     },
+		{ ATTR::SHIFT,          DefaultLabel<ATTR::SHIFT>()          },
+		{ ATTR::DIGEST_CRC32,   DefaultLabel<ATTR::DIGEST_CRC32>()   },
+		{ ATTR::DIGEST_CRC32_NOSILENCE,
+			DefaultLabel<ATTR::DIGEST_CRC32_NOSILENCE>() },
+		{ ATTR::DIGEST_CTDB,    DefaultLabel<ATTR::DIGEST_CTDB>()    },
+		{ ATTR::DIGEST_MD5,     DefaultLabel<ATTR::DIGEST_MD5>()     },
+		{ ATTR::MD5_CHECK,      DefaultLabel<ATTR::MD5_CHECK>()      },
 	}
 {
 	// empty
@@ -810,6 +836,35 @@ AddField<ATTR::CHECKSUM_ARCS2>::AddField(const Checksums* checksums,
 }
 
 
+void AddField<ATTR::MD5_CHECK>::do_create(TableComposer* c,
+		const int record_idx) const
+{
+	const auto track { static_cast<std::size_t>(record_idx) };
+
+	auto value = std::string { "-" };
+
+	if (track < md5_status_->size())
+	{
+		switch (md5_status_->at(track))
+		{
+			case calc::MD5Status::MATCH:    value = "ok";     break;
+			case calc::MD5Status::MISMATCH: value = "FAILED"; break;
+			default: break;
+		}
+	}
+
+	add_field(c, record_idx, ATTR::MD5_CHECK, value);
+}
+
+
+AddField<ATTR::MD5_CHECK>::AddField(
+		const std::vector<calc::MD5Status>* md5_status)
+	: md5_status_ { md5_status }
+{
+	/* empty */
+}
+
+
 // formatted
 
 
@@ -828,6 +883,7 @@ TableCreator::TableCreator()
 	, table_layout_           { /* empty */ }
 	, arid_layout_            { /* empty */ }
 	, checksum_layout_        { /* empty */ }
+	, md5_status_             { /* empty */ }
 {
 	// empty
 }
@@ -846,6 +902,19 @@ const TableComposerBuilder* TableCreator::builder() const
 }
 
 
+void TableCreator::set_md5_status(
+		const std::vector<calc::MD5Status>& md5_status)
+{
+	md5_status_ = md5_status;
+}
+
+
+const std::vector<calc::MD5Status>& TableCreator::md5_status() const
+{
+	return md5_status_;
+}
+
+
 void TableCreator::set_table_layout(std::unique_ptr<StringTableLayout> l)
 {
 	table_layout_ = std::move(l);
@@ -8,7 +8,7 @@
  */
 
 #include <cstddef>      // for size_t
-#include <cstdint>      // for uint8_t
+#include <cstdint>      // for uint16_t
 #include <map>          // for map
 #include <memory>       // for unique_ptr
 #include <string>       // for string
@@ -286,7 +286,13 @@ enum class ATTR : int
 	CHECKSUM_ARCS1,
 	CHECKSUM_ARCS2,
 	THEIRS,
-	CONFIDENCE
+	CONFIDENCE,
+	SHIFT,
+	DIGEST_CRC32,
+	DIGEST_CRC32_NOSILENCE,
+	DIGEST_CTDB,
+	DIGEST_MD5,
+	MD5_CHECK
 };
 
 
@@ -295,7 +301,7 @@ enum class ATTR : int
  *
  * Must be less than sizeof(print_flag_t).
  */
-constexpr int MAX_ATTR = 7;
+constexpr int MAX_ATTR = 13;
 
 
 /**
@@ -1022,6 +1028,23 @@ public:
 	 */
 	const TableComposerBuilder* builder() const;
 
+	/**
+	 * \brief Set the results of checking the MD5 declared by the audio files.
+	 *
+	 * If the list is not empty, a column with the result for each track is
+	 * printed.
+	 *
+	 * \param[in] md5_status Result of the MD5 check for each track
+	 */
+	void set_md5_status(const std::vector<calc::MD5Status>& md5_status);
+
+	/**
+	 * \brief The results of checking the MD5 declared by the audio files.
+	 *
+	 * \return Result of the MD5 check for each track
+	 */
+	const std::vector<calc::MD5Status>& md5_status() const;
+
 protected:
 
 	/**
@@ -1029,7 +1052,7 @@ protected:
 	 *
 	 * Is an unsigned numeric type.
 	 */
-	using print_flag_t = Flags<ATTR, uint8_t>;
+	using print_flag_t = Flags<ATTR, uint16_t>;
 
 	/**
 	 * \brief Type for the ordering of the optional default fields.
@@ -1177,6 +1200,11 @@ private:
 	 * \brief Format for the Checksums.
 	 */
 	std::unique_ptr<ChecksumLayout> checksum_layout_;
+
+	/**
+	 * \brief Result of the MD5 check for each track.
+	 */
+	std::vector<calc::MD5Status> md5_status_;
 };
 
 
@@ -1317,6 +1345,19 @@ public:
 	AddField(const Checksums* checksums, const ChecksumLayout* layout);
 };
 
+
+template <>
+class AddField<ATTR::MD5_CHECK> final : public FieldCreator
+{
+	const std::vector<calc::MD5Status>* md5_status_;
+
+	void do_create(TableComposer* c, const int record_idx) const final;
+
+public:
+
+	AddField(const std::vector<calc::MD5Status>* md5_status);
+};
+
 #pragma GCC diagnostic pop
 
 } // namespace table
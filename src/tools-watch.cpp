@@ -0,0 +1,427 @@
+/**
+ * \file tools-watch.cpp Watching a directory tree for albums that are ripped
+ */
+
+#ifndef __ARCSTOOLS_TOOLS_WATCH_HPP__
+#include "tools-watch.hpp"
+#endif
+
+#include <algorithm>   // for max, min
+#include <filesystem>  // for path, directory_iterator, is_directory, ...
+#include <stdexcept>   // for runtime_error
+#include <system_error> // for error_code
+#include <utility>     // for move
+
+#ifdef ARCSTOOLS_WITH_INOTIFY
+#include <cerrno>         // for errno, EINTR, EAGAIN
+#include <cstring>        // for strerror
+#include <poll.h>         // for poll, pollfd, POLLIN
+#include <sys/inotify.h>  // for inotify_init1, inotify_add_watch, ...
+#include <unistd.h>       // for read, close
+#endif
+
+#ifndef __LIBARCSTK_LOGGING_HPP__
+#include <arcstk/logging.hpp>
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+namespace watch
+{
+
+namespace fs = std::filesystem;
+
+
+// Tracker
+
+
+Tracker::Tracker(const std::chrono::milliseconds settle)
+	: settle_  { settle }
+	, pending_ { /* empty */ }
+{
+	// empty
+}
+
+
+void Tracker::opened(const std::string& dir, const std::string& file,
+		const Clock::time_point now)
+{
+	auto& pending { pending_[dir] };
+
+	pending.open.insert(file);
+	pending.last = now;
+}
+
+
+void Tracker::created(const std::string& dir, const std::string& file,
+		const Clock::time_point now)
+{
+	// An entry that is already gone or cannot be examined is not written
+
+	const auto path { fs::path { dir } / file };
+	auto ec = std::error_code {};
+
+	if (fs::is_regular_file(fs::symlink_status(path, ec))
+			&& 1 == fs::hard_link_count(path, ec))
+	{
+		opened(dir, file, now);
+	} else
+	{
+		closed(dir, file, now);
+	}
+}
+
+
+void Tracker::closed(const std::string& dir, const std::string& file,
+		const Clock::time_point now)
+{
+	auto& pending { pending_[dir] };
+
+	pending.open.erase(file);
+	pending.last = now;
+}
+
+
+std::vector<std::string> Tracker::take_ready(const Clock::time_point now)
+{
+	auto ready = std::vector<std::string> {};
+
+	for (auto p = pending_.begin(); p != pending_.end(); )
+	{
+		if (p->second.open.empty() && now - p->second.last >= settle_)
+		{
+			ready.push_back(p->first);
+			p = pending_.erase(p);
+		} else
+		{
+			++p;
+		}
+	}
+
+	return ready;
+}
+
+
+std::chrono::milliseconds Tracker::timeout(const Clock::time_point now) const
+{
+	using std::chrono::duration_cast;
+	using std::chrono::milliseconds;
+
+	auto timeout = milliseconds { -1 };
+
+	for (const auto& [ dir, pending ] : pending_)
+	{
+		if (!pending.open.empty())
+		{
+			continue; // Becomes ready only by a further event
+		}
+
+		const auto left { std::max(milliseconds { 0 },
+				duration_cast<milliseconds>(pending.last + settle_ - now)) };
+
+		timeout = timeout.count() < 0 ? left : std::min(timeout, left);
+	}
+
+	return timeout;
+}
+
+
+#ifdef ARCSTOOLS_WITH_INOTIFY
+
+namespace
+{
+
+/**
+ * \brief Pass every metafile in a directory to \c found.
+ */
+void report_albums(const std::string& dir,
+		const std::function<void(batch::Album&&)>& found)
+{
+	auto ec = std::error_code {};
+	auto entry = fs::directory_iterator { dir, ec };
+
+	for (; !ec && entry != fs::directory_iterator {}; entry.increment(ec))
+	{
+		auto type_ec = std::error_code {};
+
+		if (entry->is_regular_file(type_ec)
+				&& batch::is_metafile(entry->path().string()))
+		{
+			found(batch::Album { entry->path().generic_string(), {} });
+		}
+	}
+
+	if (ec)
+	{
+		ARCS_LOG_WARNING << "Skip unreadable directory " << dir << ": "
+			<< ec.message();
+	}
+}
+
+
+/**
+ * \brief Events to watch in each directory.
+ */
+constexpr auto WATCH_MASK = IN_CREATE | IN_MODIFY | IN_CLOSE_WRITE
+	| IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_ONLYDIR;
+
+
+/**
+ * \brief An inotify instance and the directories it watches.
+ */
+class Inotify final
+{
+public:
+
+	Inotify()
+		: fd_   { ::inotify_init1(IN_CLOEXEC) }
+		, dirs_ { /* empty */ }
+	{
+		if (fd_ < 0)
+		{
+			throw std::runtime_error(std::string { "Could not initialize "
+					"inotify: " } + std::strerror(errno));
+		}
+	}
+
+	Inotify(const Inotify&) = delete;
+	Inotify& operator=(const Inotify&) = delete;
+
+	~Inotify() noexcept
+	{
+		::close(fd_);
+	}
+
+	/**
+	 * \brief Watch a directory and all of its subdirectories.
+	 *
+	 * \return The directories watched
+	 */
+	std::vector<std::string> add_tree(const std::string& root)
+	{
+		auto added = std::vector<std::string> {};
+
+		add(root, added);
+
+		auto ec = std::error_code {};
+		auto entry = fs::recursive_directory_iterator { root,
+			fs::directory_options::skip_permission_denied, ec };
+
+		for (; !ec && entry != fs::recursive_directory_iterator {};
+				entry.increment(ec))
+		{
+			auto type_ec = std::error_code {};
+
+			if (entry->is_directory(type_ec) && !entry->is_symlink(type_ec))
+			{
+				add(entry->path().string(), added);
+			}
+		}
+
+		return added;
+	}
+
+	/**
+	 * \brief Directory of a watch descriptor, empty if not watched.
+	 */
+	std::string dir(const int wd) const
+	{
+		const auto d { dirs_.find(wd) };
+		return d != dirs_.end() ? d->second : std::string {};
+	}
+
+	/**
+	 * \brief Forget a watch descriptor that was removed by the kernel.
+	 */
+	void remove(const int wd)
+	{
+		dirs_.erase(wd);
+	}
+
+	/**
+	 * \brief File descriptor of the inotify instance.
+	 */
+	int fd() const
+	{
+		return fd_;
+	}
+
+private:
+
+	void add(const std::string& dir, std::vector<std::string>& added)
+	{
+		const auto wd { ::inotify_add_watch(fd_, dir.c_str(), WATCH_MASK) };
+
+		if (wd < 0)
+		{
+			ARCS_LOG_WARNING << "Could not watch " << dir << ": "
+				<< std::strerror(errno);
+			return;
+		}
+
+		dirs_[wd] = dir;
+		added.push_back(dir);
+	}
+
+	/**
+	 * \brief The inotify file descriptor.
+	 */
+	int fd_;
+
+	/**
+	 * \brief Watched directory for each watch descriptor.
+	 */
+	std::map<int, std::string> dirs_;
+};
+
+} // namespace
+
+#endif
+
+
+bool is_supported()
+{
+#ifdef ARCSTOOLS_WITH_INOTIFY
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+#ifdef ARCSTOOLS_WITH_INOTIFY
+
+void watch_albums(const std::string& root,
+		const std::chrono::milliseconds settle,
+		const std::function<void(batch::Album&&)>& found)
+{
+	auto error = std::error_code {};
+
+	if (!fs::is_directory(root, error))
+	{
+		throw std::runtime_error("Not a directory: " + root);
+	}
+
+	auto inotify = Inotify {};
+	auto tracker = Tracker { settle };
+
+	const auto dirs { inotify.add_tree(root) };
+
+	ARCS_LOG_INFO << "Watch " << dirs.size() << " directories in " << root;
+
+	alignas(inotify_event) char buffer[64 * 1024];
+
+	while (true)
+	{
+		auto fds = pollfd { inotify.fd(), POLLIN, 0 };
+		const auto wait { tracker.timeout(Clock::now()) };
+
+		if (::poll(&fds, 1, static_cast<int>(wait.count())) < 0)
+		{
+			if (EINTR == errno)
+			{
+				continue;
+			}
+
+			throw std::runtime_error(std::string { "Could not wait for file "
+					"events: " } + std::strerror(errno));
+		}
+
+		if (fds.revents & POLLIN)
+		{
+			const auto length { ::read(inotify.fd(), buffer, sizeof buffer) };
+
+			if (length < 0 && EINTR != errno && EAGAIN != errno)
+			{
+				throw std::runtime_error(std::string { "Could not read file "
+						"events: " } + std::strerror(errno));
+			}
+
+			const auto now { Clock::now() };
+
+			for (auto p = buffer; length > 0 && p < buffer + length; )
+			{
+				const auto event { reinterpret_cast<const inotify_event*>(p) };
+				p += sizeof(inotify_event) + event->len;
+
+				if (event->mask & IN_Q_OVERFLOW)
+				{
+					ARCS_LOG_WARNING << "File events were lost";
+					continue;
+				}
+
+				if (event->mask & IN_IGNORED)
+				{
+					inotify.remove(event->wd);
+					continue;
+				}
+
+				const auto dir { inotify.dir(event->wd) };
+
+				if (dir.empty() || 0 == event->len)
+				{
+					continue;
+				}
+
+				const auto name { std::string { event->name } };
+
+				if (event->mask & IN_ISDIR)
+				{
+					// New directories may already contain files, thus they
+					// are considered as written
+
+					if (event->mask & (IN_CREATE | IN_MOVED_TO))
+					{
+						const auto subdir {
+							(fs::path { dir } / name).string() };
+
+						for (const auto& d : inotify.add_tree(subdir))
+						{
+							tracker.closed(d, {}, now);
+						}
+					}
+
+					continue;
+				}
+
+				if (event->mask & IN_CREATE)
+				{
+					tracker.created(dir, name, now);
+
+				} else if (event->mask & IN_MODIFY)
+				{
+					tracker.opened(dir, name, now);
+				} else
+				{
+					tracker.closed(dir, name, now);
+				}
+			}
+		}
+
+		for (const auto& dir : tracker.take_ready(Clock::now()))
+		{
+			ARCS_LOG_DEBUG << "Directory " << dir << " is complete";
+
+			report_albums(dir, found);
+		}
+	}
+}
+
+#else
+
+void watch_albums(const std::string& /* root */,
+		const std::chrono::milliseconds /* settle */,
+		const std::function<void(batch::Album&&)>& /* found */)
+{
+	throw std::runtime_error("Watching directories is not supported by this "
+			"build, it requires Linux inotify");
+}
+
+#endif
+
+} // namespace watch
+} // namespace v_1_0_0
+} // namespace arcsapp
+
@@ -0,0 +1,184 @@
+#ifndef __ARCSTOOLS_TOOLS_WATCH_HPP__
+#define __ARCSTOOLS_TOOLS_WATCH_HPP__
+
+/**
+ * \file
+ *
+ * \brief Watching a directory tree for albums that are ripped.
+ */
+
+#include <chrono>      // for milliseconds, steady_clock
+#include <functional>  // for function
+#include <map>         // for map
+#include <set>         // for set
+#include <string>      // for string
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_BATCH_HPP__
+#include "tools-batch.hpp"    // for Album
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+
+/**
+ * \brief Tools and helpers for watching directories.
+ */
+namespace watch
+{
+
+/**
+ * \brief Clock for the events in a watched tree.
+ */
+using Clock = std::chrono::steady_clock;
+
+
+/**
+ * \brief Default time a directory has to be idle to be considered complete.
+ */
+constexpr auto SETTLE_TIME = std::chrono::milliseconds { 2000 };
+
+
+/**
+ * \brief Tracks the files written in each directory of a watched tree.
+ *
+ * A directory is ready as soon as every file written to it is closed and no
+ * file was written for the settle time. A ripper usually writes the audio
+ * files and the cuesheet of an album one after another, thus an album is
+ * reported once after the last of its files is closed.
+ */
+class Tracker final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] settle Time a directory has to be idle to be ready
+	 */
+	explicit Tracker(const std::chrono::milliseconds settle);
+
+	/**
+	 * \brief Register that a file is written.
+	 *
+	 * \param[in] dir  Directory of the file
+	 * \param[in] file Name of the file
+	 * \param[in] now  Time of the event
+	 */
+	void opened(const std::string& dir, const std::string& file,
+			const Clock::time_point now);
+
+	/**
+	 * \brief Register that an entry is created in a directory.
+	 *
+	 * A regular file with a single link is created by opening it and is
+	 * written until it is closed. Other entries, like symbolic links, hard
+	 * links, FIFOs or device files, are not followed by a close and are only
+	 * registered as an event in the directory.
+	 *
+	 * \param[in] dir  Directory of the entry
+	 * \param[in] file Name of the entry
+	 * \param[in] now  Time of the event
+	 */
+	void created(const std::string& dir, const std::string& file,
+			const Clock::time_point now);
+
+	/**
+	 * \brief Register that a file is completely written.
+	 *
+	 * This also applies to files that are moved to the directory.
+	 *
+	 * \param[in] dir  Directory of the file
+	 * \param[in] file Name of the file
+	 * \param[in] now  Time of the event
+	 */
+	void closed(const std::string& dir, const std::string& file,
+			const Clock::time_point now);
+
+	/**
+	 * \brief Remove and return each directory that is ready.
+	 *
+	 * \param[in] now Current time
+	 *
+	 * \return Directories that are ready in lexicographical order
+	 */
+	std::vector<std::string> take_ready(const Clock::time_point now);
+
+	/**
+	 * \brief Time until the next directory could become ready.
+	 *
+	 * \param[in] now Current time
+	 *
+	 * \return Time to wait, negative if no directory is pending
+	 */
+	std::chrono::milliseconds timeout(const Clock::time_point now) const;
+
+private:
+
+	/**
+	 * \brief Files written to a directory since it was last ready.
+	 */
+	struct Pending final
+	{
+		/**
+		 * \brief Files opened but not yet closed.
+		 */
+		std::set<std::string> open { /* empty */ };
+
+		/**
+		 * \brief Time of the last event.
+		 */
+		Clock::time_point last { /* epoch */ };
+	};
+
+	/**
+	 * \brief Time a directory has to be idle to be ready.
+	 */
+	std::chrono::milliseconds settle_;
+
+	/**
+	 * \brief Pending directories.
+	 */
+	std::map<std::string, Pending> pending_;
+};
+
+
+/**
+ * \brief TRUE iff directories can be watched by this build.
+ *
+ * Watching requires Linux inotify.
+ *
+ * \return TRUE iff watch_albums() is supported
+ */
+bool is_supported();
+
+
+/**
+ * \brief Watch a directory tree for albums that are written.
+ *
+ * Each directory of the tree is watched, including directories created while
+ * watching. As soon as a directory is ready as defined by Tracker, every
+ * metafile in it is passed to \c found as an Album without audio files. Thus,
+ * an album is reported again if any of its files is rewritten.
+ *
+ * This function does not return unless an error occurs. Callback \c found is
+ * called on the calling thread.
+ *
+ * \param[in] root   Root directory of the tree
+ * \param[in] settle Time a directory has to be idle to be ready
+ * \param[in] found  Callback for each album that is ready
+ *
+ * \throws std::runtime_error If \c root cannot be watched or watching fails
+ */
+void watch_albums(const std::string& root,
+		const std::chrono::milliseconds settle,
+		const std::function<void(batch::Album&&)>& found);
+
+} // namespace watch
+} // namespace v_1_0_0
+} // namespace arcsapp
+
+#endif
+
@@ -0,0 +1,242 @@
+/**
+ * \file tools-window.cpp Checksums of fixed windows within tracks
+ */
+
+#ifndef __ARCSTOOLS_TOOLS_WINDOW_HPP__
+#include "tools-window.hpp"
+#endif
+
+#include <algorithm>   // for max
+#include <fstream>     // for ifstream, ofstream
+#include <iomanip>     // for setfill, setw
+#include <sstream>     // for istringstream, ostringstream
+#include <stdexcept>   // for invalid_argument, runtime_error
+
+#ifndef __LIBARCSTK_LOGGING_HPP__
+#include <arcstk/logging.hpp>
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+namespace window
+{
+
+namespace
+{
+
+/**
+ * \brief Throw a runtime_error for a malformed line.
+ */
+[[noreturn]] void malformed(const std::size_t line_no, const std::string& what)
+{
+	std::ostringstream msg;
+	msg << "Window file line " << line_no << ": " << what;
+
+	throw std::runtime_error(msg.str());
+}
+
+} // namespace
+
+
+// to_windows
+
+
+Windows to_windows(const std::size_t frames,
+		const std::vector<digest::Digests>& digests)
+{
+	auto windows = Windows { frames, {} };
+	windows.tracks.reserve(digests.size());
+
+	for (const auto& d : digests)
+	{
+		windows.tracks.push_back(d.windows());
+	}
+
+	return windows;
+}
+
+
+// write
+
+
+void write(std::ostream& out, const Windows& windows)
+{
+	out << "# window " << windows.frames << '\n';
+
+	for (std::size_t t = 0; t < windows.tracks.size(); ++t)
+	{
+		for (std::size_t w = 0; w < windows.tracks[t].size(); ++w)
+		{
+			out << (t + 1) << ' ' << w << ' '
+				<< std::hex << std::uppercase << std::setw(8)
+				<< std::setfill('0') << windows.tracks[t][w]
+				<< std::dec << '\n';
+		}
+	}
+}
+
+
+void write(const std::string& filename, const Windows& windows)
+{
+	auto out = std::ofstream { filename };
+
+	if (!out)
+	{
+		throw std::runtime_error("Could not write window file: " + filename);
+	}
+
+	write(out, windows);
+
+	if (!out)
+	{
+		throw std::runtime_error("Could not write window file: " + filename);
+	}
+}
+
+
+// read
+
+
+Windows read(std::istream& in)
+{
+	auto windows = Windows { 0, {} };
+	auto line    = std::string {};
+	auto line_no = std::size_t { 0 };
+
+	while (std::getline(in, line))
+	{
+		++line_no;
+
+		if (!line.empty() && '\r' == line.back())
+		{
+			line.pop_back();
+		}
+
+		if (line.empty())
+		{
+			continue;
+		}
+
+		auto fields = std::istringstream { line };
+
+		if ('#' == line.front())
+		{
+			auto hash = std::string {};
+			auto key  = std::string {};
+			fields >> hash >> key;
+
+			if ("window" == key && !(fields >> windows.frames))
+			{
+				malformed(line_no, "window size expected");
+			}
+
+			continue;
+		}
+
+		auto track = std::size_t { 0 };
+		auto index = std::size_t { 0 };
+		auto crc   = std::uint32_t { 0 };
+
+		if (!(fields >> track >> index >> std::hex >> crc) || track < 1)
+		{
+			malformed(line_no, "track, window and CRC32 expected");
+		}
+
+		if (track < windows.tracks.size()
+				|| track > windows.tracks.size() + 1)
+		{
+			malformed(line_no, "tracks are not in order");
+		}
+
+		if (track > windows.tracks.size())
+		{
+			windows.tracks.emplace_back();
+		}
+
+		if (index != windows.tracks.back().size())
+		{
+			malformed(line_no, "windows are not in order");
+		}
+
+		windows.tracks.back().push_back(crc);
+	}
+
+	if (0 == windows.frames)
+	{
+		throw std::runtime_error("Window file does not declare a window size");
+	}
+
+	ARCS_LOG_DEBUG << "Read windows of " << windows.tracks.size() << " tracks";
+
+	return windows;
+}
+
+
+Windows read(const std::string& filename)
+{
+	auto in = std::ifstream { filename };
+
+	if (!in)
+	{
+		throw std::runtime_error("Could not read window file: " + filename);
+	}
+
+	return read(in);
+}
+
+
+// compare
+
+
+std::vector<Difference> compare(const Windows& lhs, const Windows& rhs)
+{
+	if (lhs.frames != rhs.frames)
+	{
+		throw std::invalid_argument("Cannot compare windows of "
+				+ std::to_string(lhs.frames) + " and "
+				+ std::to_string(rhs.frames) + " frames");
+	}
+
+	if (lhs.tracks.size() != rhs.tracks.size())
+	{
+		throw std::invalid_argument("Cannot compare windows of "
+				+ std::to_string(lhs.tracks.size()) + " and "
+				+ std::to_string(rhs.tracks.size()) + " tracks");
+	}
+
+	auto differences = std::vector<Difference> {};
+
+	for (std::size_t t = 0; t < lhs.tracks.size(); ++t)
+	{
+		const auto& l { lhs.tracks[t] };
+		const auto& r { rhs.tracks[t] };
+
+		const auto total { std::max(l.size(), r.size()) };
+
+		for (std::size_t w = 0; w < total; ++w)
+		{
+			if (w < l.size() && w < r.size() && l[w] == r[w])
+			{
+				continue;
+			}
+
+			if (!differences.empty() && differences.back().track == t + 1
+					&& differences.back().last + 1 == w)
+			{
+				differences.back().last = w;
+			} else
+			{
+				differences.push_back({ t + 1, w, w });
+			}
+		}
+	}
+
+	return differences;
+}
+
+} // namespace window
+} // namespace v_1_0_0
+} // namespace arcsapp
+
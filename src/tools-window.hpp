@@ -0,0 +1,173 @@
+#ifndef __ARCSTOOLS_TOOLS_WINDOW_HPP__
+#define __ARCSTOOLS_TOOLS_WINDOW_HPP__
+
+/**
+ * \file
+ *
+ * \brief Checksums of fixed windows within tracks to localize damage.
+ */
+
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint32_t
+#include <istream>     // for istream
+#include <ostream>     // for ostream
+#include <string>      // for string
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_DIGEST_HPP__
+#include "tools-digest.hpp"   // for Digests
+#endif
+
+namespace arcsapp
+{
+inline namespace v_1_0_0
+{
+
+/**
+ * \brief Window checksums of two rips are compared to localize damage.
+ *
+ * Each track is divided in windows of a fixed number of frames, starting with
+ * the first frame of the track. The CRC32 of each window is calculated along
+ * with the ARCSs. If the same album is ripped twice, the windows with
+ * different CRC32 values tell which sectors have to be read again.
+ */
+namespace window
+{
+
+/**
+ * \brief Number of samples in a frame.
+ */
+constexpr std::size_t SAMPLES_PER_FRAME = 588;
+
+/**
+ * \brief Number of frames per second.
+ */
+constexpr std::size_t FRAMES_PER_SECOND = 75;
+
+
+/**
+ * \brief Window checksums of the tracks of an album.
+ */
+struct Windows final
+{
+	/**
+	 * \brief Number of frames per window.
+	 */
+	std::size_t frames;
+
+	/**
+	 * \brief CRC32 of each window for each track.
+	 */
+	std::vector<std::vector<std::uint32_t>> tracks;
+};
+
+
+/**
+ * \brief Consecutive windows of a track whose checksums differ.
+ */
+struct Difference final
+{
+	/**
+	 * \brief 1-based number of the track.
+	 */
+	std::size_t track;
+
+	/**
+	 * \brief 0-based index of the first differing window.
+	 */
+	std::size_t first;
+
+	/**
+	 * \brief 0-based index of the last differing window.
+	 */
+	std::size_t last;
+};
+
+
+/**
+ * \brief Collect the windows from the digests of the tracks.
+ *
+ * \param[in] frames  Number of frames per window
+ * \param[in] digests Digests of each track, calculated with windows
+ *
+ * \return Window checksums of the tracks
+ */
+Windows to_windows(const std::size_t frames,
+		const std::vector<digest::Digests>& digests);
+
+
+/**
+ * \brief Write window checksums.
+ *
+ * The first line is '# window' followed by the number of frames per window.
+ * Each following line consists of the 1-based track number, the 0-based
+ * window index and the CRC32 as 8 hexadecimal digits, separated by a blank.
+ * Thus, the windows of two rips can also be compared by plain diff.
+ *
+ * \param[in] out     Stream to write to
+ * \param[in] windows Window checksums to write
+ */
+void write(std::ostream& out, const Windows& windows);
+
+
+/**
+ * \brief Write window checksums to a file.
+ *
+ * \param[in] filename Name of the file
+ * \param[in] windows  Window checksums to write
+ *
+ * \throws std::runtime_error If the file cannot be written
+ *
+ * \see write(std::ostream&, const Windows&)
+ */
+void write(const std::string& filename, const Windows& windows);
+
+
+/**
+ * \brief Read window checksums.
+ *
+ * \param[in] in Stream to read from
+ *
+ * \return Window checksums read
+ *
+ * \throws std::runtime_error If the input is malformed
+ *
+ * \see write(std::ostream&, const Windows&)
+ */
+Windows read(std::istream& in);
+
+
+/**
+ * \brief Read window checksums from a file.
+ *
+ * \param[in] filename Name of the file
+ *
+ * \return Window checksums read
+ *
+ * \throws std::runtime_error If the file cannot be read or is malformed
+ */
+Windows read(const std::string& filename);
+
+
+/**
+ * \brief Compare the window checksums of two rips.
+ *
+ * Windows that exist in only one of the rips count as different. Consecutive
+ * differing windows of a track are combined to a single Difference.
+ *
+ * \param[in] lhs Window checksums of one rip
+ * \param[in] rhs Window checksums of the other rip
+ *
+ * \return Differences in the order of tracks and windows
+ *
+ * \throws std::invalid_argument If the window sizes or the number of tracks
+ * differ
+ */
+std::vector<Difference> compare(const Windows& lhs, const Windows& rhs);
+
+} // namespace window
+} // namespace v_1_0_0
+} // namespace arcsapp
+
+#endif
+
@@ -0,0 +1,80 @@
+#include "catch2/catch_test_macros.hpp"
+
+#ifndef __ARCSTOOLS_APPALL_HPP__
+#include "app-all.hpp"
+#endif
+
+
+TEST_CASE ( "ARAllConfigurator", "[ARAllConfigurator]" )
+{
+	using arcsapp::ARAllConfigurator;
+	using arcsapp::OPTION;
+	using arcsapp::ALL;
+
+	SECTION ("List of supported options is sound and complete")
+	{
+		ARAllConfigurator conf1;
+
+		const auto supported { conf1.supported_options() };
+
+		CHECK ( 26 == supported.size() );
+
+		CHECK ( contains(ALL::READERID, supported) );
+		CHECK ( contains(ALL::PARSERID, supported) );
+		CHECK ( contains(ALL::LIST_TOC_FORMATS, supported) );
+		CHECK ( contains(ALL::LIST_AUDIO_FORMATS, supported) );
+		CHECK ( contains(ALL::METAFILE, supported) );
+		CHECK ( contains(ALL::NOTRACKS, supported) );
+		CHECK ( contains(ALL::NOFILENAMES, supported) );
+		CHECK ( contains(ALL::NOOFFSETS, supported) );
+		CHECK ( contains(ALL::NOLENGTHS, supported) );
+		CHECK ( contains(ALL::NOLABELS, supported) );
+		CHECK ( contains(ALL::COLDELIM, supported) );
+		CHECK ( contains(ALL::THREADS, supported) );
+		CHECK ( contains(ALL::CACHE, supported) );
+		CHECK ( contains(ALL::CACHEKEY, supported) );
+		CHECK ( contains(ALL::READAHEAD, supported) );
+		CHECK ( contains(ALL::BUFFERSIZE, supported) );
+		CHECK ( contains(ALL::IO, supported) );
+		CHECK ( contains(ALL::CHECKMD5, supported) );
+		CHECK ( contains(ALL::PROGRESS, supported) );
+		CHECK ( contains(ALL::RESPONSEFILE, supported) );
+
+		CHECK ( contains(OPTION::HELP, supported) );
+		CHECK ( contains(OPTION::VERSION, supported) );
+		CHECK ( contains(OPTION::VERBOSITY, supported) );
+		CHECK ( contains(OPTION::QUIET, supported) );
+		CHECK ( contains(OPTION::LOGFILE, supported) );
+		CHECK ( contains(OPTION::OUTFILE, supported) );
+	}
+
+	SECTION ("Input with -m and -r is ok")
+	{
+		const int argc = 6;
+		const char* argv[] = { "arcstk-all",
+			"-m", "foo/foo.cue", "foo/foo.wav", "-r", "foo/foo.bin"
+		};
+
+		ARAllConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+		options1 = conf1.configure_options(std::move(options1));
+
+		CHECK ( options1->value(ALL::METAFILE) == "foo/foo.cue" );
+		CHECK ( options1->value(ALL::RESPONSEFILE) == "foo/foo.bin" );
+		CHECK ( options1->arguments()->size() == 1 );
+	}
+
+	SECTION ("Audio files without metafile are refused")
+	{
+		const int argc = 2;
+		const char* argv[] = { "arcstk-all", "foo/foo.wav" };
+
+		ARAllConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+}
+
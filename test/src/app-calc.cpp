@@ -21,7 +21,7 @@ TEST_CASE ( "ARCalcConfigurator", "[ARCalcConfigurator]" )
 
 		const auto supported { conf1.supported_options() };
 
-		CHECK ( 26 == supported.size() );
+		CHECK ( 51 == supported.size() );
 
 		CHECK ( contains(CALC::READERID, supported) );
 		CHECK ( contains(CALC::PARSERID, supported) );
@@ -36,6 +36,14 @@ TEST_CASE ( "ARCalcConfigurator", "[ARCalcConfigurator]" )
 		CHECK ( contains(CALC::COLDELIM, supported) );
 		CHECK ( contains(CALC::PRINTID, supported) );
 		CHECK ( contains(CALC::PRINTURL, supported) );
+		CHECK ( contains(CALC::THREADS, supported) );
+		CHECK ( contains(CALC::CACHE, supported) );
+		CHECK ( contains(CALC::CACHEKEY, supported) );
+		CHECK ( contains(CALC::READAHEAD, supported) );
+		CHECK ( contains(CALC::BUFFERSIZE, supported) );
+		CHECK ( contains(CALC::IO, supported) );
+		CHECK ( contains(CALC::CHECKMD5, supported) );
+		CHECK ( contains(CALC::PROGRESS, supported) );
 		CHECK ( contains(CALC::FIRST, supported) );
 		CHECK ( contains(CALC::LAST, supported) );
 		CHECK ( contains(CALC::ALBUM, supported) );
@@ -43,6 +51,23 @@ TEST_CASE ( "ARCalcConfigurator", "[ARCalcConfigurator]" )
 		CHECK ( contains(CALC::NOV2, supported) );
 		CHECK ( contains(CALC::SUMSONLY, supported) );
 		CHECK ( contains(CALC::TRACKSASCOLS, supported) );
+		CHECK ( contains(CALC::BATCH, supported) );
+		CHECK ( contains(CALC::DIGESTS, supported) );
+		CHECK ( contains(CALC::WINDOWS, supported) );
+		CHECK ( contains(CALC::WINDOWSIZE, supported) );
+		CHECK ( contains(CALC::COMPAREWINDOWS, supported) );
+		CHECK ( contains(CALC::PREFLIGHT, supported) );
+		CHECK ( contains(CALC::RECURSIVE, supported) );
+		CHECK ( contains(CALC::WATCH, supported) );
+		CHECK ( contains(CALC::RESUME, supported) );
+		CHECK ( contains(CALC::MAXMEMORY, supported) );
+		CHECK ( contains(CALC::DEVICEREADERS, supported) );
+		CHECK ( contains(CALC::PIN, supported) );
+		CHECK ( contains(CALC::ENGINE, supported) );
+		CHECK ( contains(CALC::TIMEOUTALBUM, supported) );
+		CHECK ( contains(CALC::TIMEOUTFILE, supported) );
+		CHECK ( contains(CALC::PLAN, supported) );
+		CHECK ( contains(CALC::CALIBRATION, supported) );
 
 		CHECK ( contains(OPTION::HELP, supported) );
 		CHECK ( contains(OPTION::VERSION, supported) );
@@ -88,6 +113,484 @@ TEST_CASE ( "ARCalcConfigurator", "[ARCalcConfigurator]" )
 		CHECK ( not options1->is_set(CALC::LIST_AUDIO_FORMATS) );
 	}
 
+	SECTION ("Single dash is an audio file argument for stdin")
+	{
+		const int argc = 4;
+		const char* argv[] = { "arcstk-calc",
+			"--metafile", "foo/foo.cue", "-"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+		options1 = conf1.configure_options(std::move(options1));
+
+		CHECK ( options1->argument(0) == "-" );
+		CHECK ( options1->is_set(CALC::ALBUM) );
+	}
+
+	SECTION ("Option --batch triggers album mode")
+	{
+		const int argc = 3;
+		const char* argv[] = { "arcstk-calc",
+			"--batch", "albums.txt"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+		options1 = conf1.configure_options(std::move(options1));
+
+		CHECK ( options1->is_set(CALC::ALBUM) );
+		CHECK ( options1->is_set(CALC::FIRST) );
+		CHECK ( options1->is_set(CALC::LAST)  );
+	}
+
+	SECTION ("Option --batch cannot be combined with input files")
+	{
+		const int argc = 4;
+		const char* argv[] = { "arcstk-calc",
+			"--batch", "albums.txt", "foo/foo.wav"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+
+	SECTION ("Option --recursive triggers album mode")
+	{
+		const int argc = 3;
+		const char* argv[] = { "arcstk-calc",
+			"--recursive", "music"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+		options1 = conf1.configure_options(std::move(options1));
+
+		CHECK ( options1->is_set(CALC::ALBUM) );
+		CHECK ( options1->is_set(CALC::FIRST) );
+		CHECK ( options1->is_set(CALC::LAST)  );
+	}
+
+	SECTION ("Option --recursive cannot be combined with --batch")
+	{
+		const int argc = 5;
+		const char* argv[] = { "arcstk-calc",
+			"--recursive", "music", "--batch", "albums.txt"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+
+	SECTION ("Option --watch cannot be combined with --recursive")
+	{
+		const int argc = 5;
+		const char* argv[] = { "arcstk-calc",
+			"--watch", "incoming", "--recursive", "music"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+
+	SECTION ("Option --preflight accepts mode 'skip' in batch mode")
+	{
+		const int argc = 4;
+		const char* argv[] = { "arcstk-calc",
+			"--batch", "albums.txt", "--preflight=skip"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+		options1 = conf1.configure_options(std::move(options1));
+
+		CHECK ( options1->value(CALC::PREFLIGHT) == "skip" );
+	}
+
+	SECTION ("Option --preflight requires --batch")
+	{
+		const int argc = 3;
+		const char* argv[] = { "arcstk-calc",
+			"--preflight=abort", "foo/foo.wav"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+
+	SECTION ("Option --resume is accepted in batch mode")
+	{
+		const int argc = 4;
+		const char* argv[] = { "arcstk-calc",
+			"--batch", "albums.txt", "--resume=journal.txt"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+		options1 = conf1.configure_options(std::move(options1));
+
+		CHECK ( options1->value(CALC::RESUME) == "journal.txt" );
+	}
+
+	SECTION ("Option --resume requires --batch or --recursive")
+	{
+		const int argc = 3;
+		const char* argv[] = { "arcstk-calc",
+			"--resume=journal.txt", "foo/foo.wav"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+
+	SECTION ("Option --max-memory uses a thread per core by default")
+	{
+		const int argc = 4;
+		const char* argv[] = { "arcstk-calc",
+			"--batch", "albums.txt", "--max-memory=1536"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+		options1 = conf1.configure_options(std::move(options1));
+
+		CHECK ( options1->value(CALC::MAXMEMORY) == "1536" );
+		CHECK ( options1->value(CALC::THREADS) == "0" );
+	}
+
+	SECTION ("Option --max-memory requires multiple albums")
+	{
+		const int argc = 3;
+		const char* argv[] = { "arcstk-calc",
+			"--max-memory=1536", "foo/foo.wav"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+
+	SECTION ("Option --max-memory must not be 0")
+	{
+		const int argc = 4;
+		const char* argv[] = { "arcstk-calc",
+			"--batch", "albums.txt", "--max-memory=0"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+
+	SECTION ("Option --device-readers accepts 0 for no limit")
+	{
+		const int argc = 4;
+		const char* argv[] = { "arcstk-calc",
+			"--recursive", "music", "--device-readers=0"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+		options1 = conf1.configure_options(std::move(options1));
+
+		CHECK ( options1->value(CALC::DEVICEREADERS) == "0" );
+	}
+
+	SECTION ("Option --device-readers requires multiple albums")
+	{
+		const int argc = 3;
+		const char* argv[] = { "arcstk-calc",
+			"--device-readers=2", "foo/foo.wav"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+
+	SECTION ("Option --pin accepts known placements")
+	{
+		const int argc = 3;
+		const char* argv[] = { "arcstk-calc",
+			"--pin=spread", "foo/foo.wav"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+		options1 = conf1.configure_options(std::move(options1));
+
+		CHECK ( options1->value(CALC::PIN) == "spread" );
+	}
+
+	SECTION ("Option --pin rejects unknown placements")
+	{
+		const int argc = 3;
+		const char* argv[] = { "arcstk-calc",
+			"--pin=diagonal", "foo/foo.wav"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+
+	SECTION ("Option --engine defaults to scalar")
+	{
+		const int argc = 2;
+		const char* argv[] = { "arcstk-calc", "foo/foo.wav" };
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+		options1 = conf1.configure_options(std::move(options1));
+
+		CHECK ( options1->value(CALC::ENGINE) == "scalar" );
+	}
+
+	SECTION ("Option --engine rejects unknown engines")
+	{
+		const int argc = 3;
+		const char* argv[] = { "arcstk-calc",
+			"--engine=gpu", "foo/foo.wav"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+
+	SECTION ("Option --timeout-per-album accepts seconds")
+	{
+		const int argc = 4;
+		const char* argv[] = { "arcstk-calc",
+			"--recursive", "music", "--timeout-per-album=60"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+		options1 = conf1.configure_options(std::move(options1));
+
+		CHECK ( options1->value(CALC::TIMEOUTALBUM) == "60" );
+		CHECK ( not options1->is_set(CALC::TIMEOUTFILE) );
+	}
+
+	SECTION ("Option --timeout-per-file requires --batch, --recursive or "
+			"--watch")
+	{
+		const int argc = 3;
+		const char* argv[] = { "arcstk-calc",
+			"--timeout-per-file=10", "foo/foo.wav"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+
+	SECTION ("Option --plan accepts table and json")
+	{
+		const int argc = 4;
+		const char* argv[] = { "arcstk-calc",
+			"--batch", "albums.txt", "--plan=json"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+		options1 = conf1.configure_options(std::move(options1));
+
+		CHECK ( options1->value(CALC::PLAN) == "json" );
+	}
+
+	SECTION ("Option --plan rejects unknown formats")
+	{
+		const int argc = 3;
+		const char* argv[] = { "arcstk-calc",
+			"--plan=xml", "foo/foo.wav"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+
+	SECTION ("Option --calibration requires --plan")
+	{
+		const int argc = 3;
+		const char* argv[] = { "arcstk-calc",
+			"--calibration=rates.txt", "foo/foo.wav"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+
+	SECTION ("Option --preflight accepts only known modes")
+	{
+		const int argc = 4;
+		const char* argv[] = { "arcstk-calc",
+			"--batch", "albums.txt", "--preflight=ignore"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+
+	SECTION ("Option --cache-key accepts only known modes")
+	{
+		const int argc = 5;
+		const char* argv[] = { "arcstk-calc",
+			"--cache", "cachedir", "--cache-key=inode", "foo/foo.wav"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+
+	SECTION ("Read-ahead is disabled if not specified")
+	{
+		const int argc = 2;
+		const char* argv[] = { "arcstk-calc", "foo/foo.wav" };
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+		options1 = conf1.configure_options(std::move(options1));
+
+		CHECK ( options1->value(CALC::READAHEAD)  == "0"    );
+		CHECK ( options1->value(CALC::BUFFERSIZE) == "1024" );
+		CHECK ( options1->value(CALC::IO)         == "stdio" );
+	}
+
+	SECTION ("Option --buffer-size does not accept 0")
+	{
+		const int argc = 5;
+		const char* argv[] = { "arcstk-calc",
+			"--read-ahead", "4", "--buffer-size=0", "foo/foo.wav"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+
+	SECTION ("Option --io accepts only known backends")
+	{
+		const int argc = 3;
+		const char* argv[] = { "arcstk-calc", "--io=uring", "foo/foo.wav" };
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+
+	SECTION ("Option --digests is parsed in order without duplicates")
+	{
+		using arcsapp::digest::DigestType;
+
+		const int argc = 3;
+		const char* argv[] = { "arcstk-calc",
+			"--digests=md5,crc32,md5", "foo/foo.wav"
+		};
+
+		const ARCalcConfigurator conf1;
+		const auto config = conf1.create(conf1.read_options(argc, argv));
+
+		CHECK ( config->object<std::vector<DigestType>>(CALC::DIGESTS)
+				== std::vector<DigestType> { DigestType::MD5,
+					DigestType::CRC32 } );
+	}
+
+	SECTION ("Option --digests refuses unknown digests")
+	{
+		const int argc = 3;
+		const char* argv[] = { "arcstk-calc",
+			"--digests=crc32,sha1", "foo/foo.wav"
+		};
+
+		const ARCalcConfigurator conf1;
+
+		CHECK_THROWS ( conf1.create(conf1.read_options(argc, argv)) );
+	}
+
+	SECTION ("Option --window-size defaults to one second")
+	{
+		const int argc = 3;
+		const char* argv[] = { "arcstk-calc",
+			"--windows=foo.windows", "foo/foo.wav"
+		};
+
+		const ARCalcConfigurator conf1;
+		const auto config = conf1.create(conf1.read_options(argc, argv));
+
+		CHECK ( config->object<std::size_t>(CALC::WINDOWSIZE) == 75 );
+	}
+
+	SECTION ("Option --window-size must not be 0")
+	{
+		const int argc = 4;
+		const char* argv[] = { "arcstk-calc",
+			"--windows=foo.windows", "--window-size=0", "foo/foo.wav"
+		};
+
+		ARCalcConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+
 	SECTION ("No calculation requested leads to unmodified options object")
 	{
 		const int argc = 3;
@@ -18,7 +18,7 @@ TEST_CASE ( "ARIdConfigurator", "[ARIdConfigurator]" )
 
 		const auto supported { conf1.supported_options() };
 
-		CHECK ( 18 == supported.size() );
+		CHECK ( 21 == supported.size() );
 
 		CHECK ( contains(ARIdOptions::READERID, supported) );
 		CHECK ( contains(ARIdOptions::PARSERID, supported) );
@@ -32,6 +32,9 @@ TEST_CASE ( "ARIdConfigurator", "[ARIdConfigurator]" )
 		CHECK ( contains(ARIdOptions::PROFILE, supported) );
 		CHECK ( contains(ARIdOptions::URLPREFIX, supported) );
 		CHECK ( contains(ARIdOptions::AUDIOFILE, supported) );
+		CHECK ( contains(ARIdOptions::IO, supported) );
+		CHECK ( contains(ARIdOptions::RECURSIVE, supported) );
+		CHECK ( contains(ARIdOptions::THREADS, supported) );
 
 		CHECK ( contains(OPTION::HELP, supported) );
 		CHECK ( contains(OPTION::VERSION, supported) );
@@ -40,5 +43,47 @@ TEST_CASE ( "ARIdConfigurator", "[ARIdConfigurator]" )
 		CHECK ( contains(OPTION::LOGFILE, supported) );
 		CHECK ( contains(OPTION::OUTFILE, supported) );
 	}
+
+	SECTION ("Option --recursive cannot be combined with a metafile")
+	{
+		const int argc = 3;
+		const char* argv[] = { "arcstk-id",
+			"--recursive=music", "foo/foo.cue"
+		};
+
+		ARIdConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+
+		CHECK_THROWS ( conf1.configure_options(std::move(options1)) );
+	}
+
+	SECTION ("Option --threads sets the threads of --recursive")
+	{
+		const int argc = 3;
+		const char* argv[] = { "arcstk-id",
+			"--recursive=music", "--threads=3"
+		};
+
+		ARIdConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+		options1 = conf1.configure_options(std::move(options1));
+
+		CHECK ( options1->value(ARIdOptions::THREADS) == "3" );
+	}
+
+	SECTION ("Option --threads defaults to one thread per CPU")
+	{
+		const int argc = 2;
+		const char* argv[] = { "arcstk-id", "--recursive=music" };
+
+		ARIdConfigurator conf1;
+
+		auto options1 = conf1.read_options(argc, argv);
+		options1 = conf1.configure_options(std::move(options1));
+
+		CHECK ( options1->value(ARIdOptions::THREADS) == "0" );
+	}
 }
 
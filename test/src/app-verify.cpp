@@ -21,7 +21,7 @@ TEST_CASE ( "ARVerifyConfigurator", "[ARVerifyConfigurator]" )
 
 		const auto supported { conf1.supported_options() };
 
-		CHECK ( 29 == supported.size() );
+		CHECK ( 38 == supported.size() );
 
 		CHECK ( contains(VERIFY::READERID, supported) );
 		CHECK ( contains(VERIFY::PARSERID, supported) );
@@ -36,6 +36,14 @@ TEST_CASE ( "ARVerifyConfigurator", "[ARVerifyConfigurator]" )
 		CHECK ( contains(VERIFY::COLDELIM, supported) );
 		CHECK ( contains(VERIFY::PRINTID, supported) );
 		CHECK ( contains(VERIFY::PRINTURL, supported) );
+		CHECK ( contains(VERIFY::THREADS, supported) );
+		CHECK ( contains(VERIFY::CACHE, supported) );
+		CHECK ( contains(VERIFY::CACHEKEY, supported) );
+		CHECK ( contains(VERIFY::READAHEAD, supported) );
+		CHECK ( contains(VERIFY::BUFFERSIZE, supported) );
+		CHECK ( contains(VERIFY::IO, supported) );
+		CHECK ( contains(VERIFY::CHECKMD5, supported) );
+		CHECK ( contains(VERIFY::PROGRESS, supported) );
 		CHECK ( contains(VERIFY::NOFIRST, supported) );
 		CHECK ( contains(VERIFY::NOLAST, supported) );
 		CHECK ( contains(VERIFY::NOALBUM, supported) );
@@ -45,6 +53,7 @@ TEST_CASE ( "ARVerifyConfigurator", "[ARVerifyConfigurator]" )
 		CHECK ( contains(VERIFY::BOOLEAN, supported) );
 		CHECK ( contains(VERIFY::NOOUTPUT, supported) );
 		CHECK ( contains(VERIFY::CONFIDENCE, supported) );
+		CHECK ( contains(VERIFY::OFFSETRANGE, supported) );
 
 		CHECK ( contains(OPTION::HELP, supported) );
 		CHECK ( contains(OPTION::VERSION, supported) );
@@ -233,5 +242,38 @@ TEST_CASE ( "ARVerifyConfigurator", "[ARVerifyConfigurator]" )
 		CHECK ( std::vector<uint32_t>{ 1, 2, 3 } ==
 				config->object<std::vector<uint32_t>>(VERIFY::REFVALUES) );
 	}
+
+	SECTION ("Option --offset-range is parsed with and without sign")
+	{
+		for (const auto& range : { "--offset-range=2940",
+				"--offset-range=\u00B12940", "--offset-range=+-2940" })
+		{
+			const int argc = 4;
+			const char* argv[] = { "arcstk-verify", range,
+				"--refvalues=1,2,3", "foo/foo.wav"
+			};
+
+			const ARVerifyConfigurator vconf;
+			const auto config = vconf.create(vconf.read_options(argc, argv));
+
+			CHECK ( 2940 == config->object<std::size_t>(VERIFY::OFFSETRANGE) );
+		}
+	}
+
+	SECTION ("Option --offset-range refuses invalid ranges")
+	{
+		for (const auto& range : { "--offset-range=-5",
+				"--offset-range=44101" })
+		{
+			const int argc = 4;
+			const char* argv[] = { "arcstk-verify", range,
+				"--refvalues=1,2,3", "foo/foo.wav"
+			};
+
+			const ARVerifyConfigurator vconf;
+
+			CHECK_THROWS ( vconf.create(vconf.read_options(argc, argv)) );
+		}
+	}
 }
 
@@ -0,0 +1,264 @@
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/benchmark/catch_benchmark.hpp"
+
+#include <cstdint>     // for uint32_t
+#include <cstdio>      // for remove
+#include <cstdlib>     // for getenv
+#include <fstream>     // for ofstream
+#include <sstream>     // for istringstream
+#include <stdexcept>   // for invalid_argument
+#include <string>      // for string, getline, to_string
+#include <vector>      // for vector
+
+#include <sched.h>     // for cpu_set_t, CPU_ISSET, sched_getaffinity
+
+#ifndef __ARCSTOOLS_TOOLS_AFFINITY_HPP__
+#include "tools-affinity.hpp"
+#endif
+#ifndef __ARCSTOOLS_TOOLS_ARCS_HPP__
+#include "tools-arcs.hpp"
+#endif
+#ifndef __ARCSTOOLS_TOOLS_PARALLEL_HPP__
+#include "tools-parallel.hpp"
+#endif
+#ifndef __ARCSTOOLS_TOOLS_PCM_HPP__
+#include "tools-pcm.hpp"
+#endif
+
+
+namespace
+{
+
+/**
+ * \brief Write a RIFF/WAV file with \c samples samples of CDDA.
+ */
+void write_cdda(const std::string& filename, const std::uint32_t samples)
+{
+	const auto put32 = [](std::ofstream& out, const std::uint32_t v)
+	{
+		for (auto i = 0; i < 4; ++i)
+		{
+			out.put(static_cast<char>((v >> (8 * i)) & 0xFF));
+		}
+	};
+
+	auto out = std::ofstream { filename, std::ios::binary };
+
+	out.write("RIFF", 4); put32(out, 36 + samples * 4);
+	out.write("WAVE", 4);
+	out.write("fmt ", 4); put32(out, 16);
+	put32(out, 1 | 2 << 16);       // PCM, stereo
+	put32(out, 44100);
+	put32(out, 44100 * 4);
+	put32(out, 4 | 16 << 16);      // block align, bits per sample
+	out.write("data", 4); put32(out, samples * 4);
+
+	for (std::uint32_t i = 0; i < samples; ++i)
+	{
+		put32(out, i * 2654435761u);
+	}
+}
+
+} // namespace
+
+
+TEST_CASE ( "to_placement()", "[affinity]" )
+{
+	using arcsapp::affinity::Placement;
+	using arcsapp::affinity::name;
+	using arcsapp::affinity::to_placement;
+
+	SECTION ( "Names of placements are accepted" )
+	{
+		CHECK ( to_placement("none")    == Placement::NONE    );
+		CHECK ( to_placement("compact") == Placement::COMPACT );
+		CHECK ( to_placement("spread")  == Placement::SPREAD  );
+
+		CHECK ( name(Placement::SPREAD) == "spread" );
+	}
+
+	SECTION ( "Unknown names are rejected" )
+	{
+		CHECK_THROWS_AS ( to_placement("scatter"), std::invalid_argument );
+	}
+}
+
+
+TEST_CASE ( "parse_cpu_list()", "[affinity]" )
+{
+	using arcsapp::affinity::Cpu;
+	using arcsapp::affinity::parse_cpu_list;
+
+	SECTION ( "Ranges and single CPUs are parsed" )
+	{
+		CHECK ( parse_cpu_list("0-3,8,10-11\n")
+				== std::vector<Cpu> { 0, 1, 2, 3, 8, 10, 11 } );
+	}
+
+	SECTION ( "Empty list has no CPUs" )
+	{
+		CHECK ( parse_cpu_list("").empty() );
+	}
+
+	SECTION ( "Malformed list is rejected" )
+	{
+		CHECK_THROWS_AS ( parse_cpu_list("0-x"), std::invalid_argument );
+	}
+}
+
+
+TEST_CASE ( "cpu_order()", "[affinity]" )
+{
+	using arcsapp::affinity::Cpu;
+	using arcsapp::affinity::Placement;
+	using arcsapp::affinity::Topology;
+	using arcsapp::affinity::cpu_order;
+
+	const auto nodes = Topology { { 0, 1, 2 }, { 4, 5 } };
+
+	SECTION ( "Compact fills each node before the next" )
+	{
+		CHECK ( cpu_order(Placement::COMPACT, nodes)
+				== std::vector<Cpu> { 0, 1, 2, 4, 5 } );
+	}
+
+	SECTION ( "Spread takes turns between the nodes" )
+	{
+		CHECK ( cpu_order(Placement::SPREAD, nodes)
+				== std::vector<Cpu> { 0, 4, 1, 5, 2 } );
+	}
+
+	SECTION ( "None pins no worker" )
+	{
+		CHECK ( cpu_order(Placement::NONE, nodes).empty() );
+	}
+}
+
+
+TEST_CASE ( "pinning()", "[affinity]" )
+{
+	using arcsapp::affinity::Placement;
+	using arcsapp::affinity::pinning;
+	using arcsapp::affinity::topology;
+
+	SECTION ( "Topology contains the CPUs of this process" )
+	{
+		const auto nodes { topology() };
+
+		REQUIRE ( not nodes.empty() );
+		CHECK ( not nodes.front().empty() );
+	}
+
+	SECTION ( "No placement requires no initialization" )
+	{
+		CHECK ( not pinning(Placement::NONE) );
+	}
+
+	SECTION ( "Compact placement pins the first worker to the first CPU" )
+	{
+		const auto first_cpu { topology().front().front() };
+
+		auto pinned = false;
+
+		arcsapp::parallel::TaskPool pool { 1, pinning(Placement::COMPACT) };
+
+		pool.submit([&pinned,first_cpu]
+			{
+				auto set = cpu_set_t {};
+				CPU_ZERO(&set);
+				::sched_getaffinity(0, sizeof set, &set);
+
+				pinned = CPU_COUNT(&set) == 1 && CPU_ISSET(first_cpu, &set);
+			});
+
+		pool.wait();
+
+		CHECK ( pinned );
+	}
+}
+
+
+/**
+ * \brief Compare the throughput of the placements.
+ *
+ * Each run calculates the checksums of every file by one thread per CPU. To
+ * measure existing files, pass their names in ARCSTOOLS_BENCHMARK_FILES,
+ * separated by ':'. Otherwise 8 RIFF/WAV files of 32 MiB are created.
+ */
+TEST_CASE ( "Placements", "[affinity][.][benchmark]" )
+{
+	using arcsapp::affinity::Placement;
+	using arcsapp::affinity::pinning;
+	using arcsapp::arcs::calculate_tracks;
+	using arcsapp::arcs::track_ranges;
+	using arcsapp::parallel::worker_count;
+	using arcsapp::pcm::open_sample_reader;
+
+	auto files = std::vector<std::string> {};
+	auto created = false;
+
+	if (const auto list = std::getenv("ARCSTOOLS_BENCHMARK_FILES"))
+	{
+		std::istringstream in { list };
+
+		for (std::string file; std::getline(in, file, ':');)
+		{
+			files.push_back(file);
+		}
+	} else
+	{
+		for (auto i = 0; i < 8; ++i)
+		{
+			files.push_back("test-affinity-bench" + std::to_string(i)
+					+ ".wav");
+			write_cdda(files.back(), 8 * 1024 * 1024);
+		}
+
+		created = true;
+	}
+
+	const auto workers { worker_count(0) };
+
+	const auto calculate_files = [&files,workers](const Placement placement)
+	{
+		auto total = std::size_t { 0 };
+
+		for (const auto& file : files)
+		{
+			const auto samples { open_sample_reader(file)->total_samples() };
+
+			const auto sums { calculate_tracks(
+					[&file]{ return open_sample_reader(file); },
+					track_ranges({ 0 }, samples), workers, nullptr,
+					pinning(placement)) };
+
+			total += sums.size();
+		}
+
+		return total;
+	};
+
+	BENCHMARK ( "not pinned" )
+	{
+		return calculate_files(Placement::NONE);
+	};
+
+	BENCHMARK ( "pinned compact" )
+	{
+		return calculate_files(Placement::COMPACT);
+	};
+
+	BENCHMARK ( "pinned spread" )
+	{
+		return calculate_files(Placement::SPREAD);
+	};
+
+	if (created)
+	{
+		for (const auto& file : files)
+		{
+			std::remove(file.c_str());
+		}
+	}
+}
+
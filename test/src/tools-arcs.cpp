@@ -0,0 +1,481 @@
+#include "catch2/catch_test_macros.hpp"
+
+#include <algorithm>   // for copy
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint32_t, uint64_t
+#include <limits>      // for numeric_limits
+#include <memory>      // for unique_ptr, make_unique
+#include <sstream>     // for istringstream
+#include <stdexcept>   // for invalid_argument, runtime_error
+#include <string>      // for string
+#include <utility>     // for pair
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_ARCS_HPP__
+#include "tools-arcs.hpp"
+#endif
+
+
+namespace
+{
+
+using arcsapp::pcm::Sample;
+using arcsapp::pcm::SampleReader;
+
+/**
+ * \brief SampleReader on a vector of samples.
+ */
+class VectorSampleReader final : public SampleReader
+{
+	const std::vector<Sample>& samples_;
+
+	std::size_t do_total_samples() const final
+	{
+		return samples_.size();
+	}
+
+	std::size_t do_read(const std::size_t first, const std::size_t count,
+			Sample* buffer) final
+	{
+		auto i = std::size_t { 0 };
+		for (; i < count && first + i < samples_.size(); ++i)
+		{
+			buffer[i] = samples_[first + i];
+		}
+		return i;
+	}
+
+public:
+
+	explicit VectorSampleReader(const std::vector<Sample>& samples)
+		: samples_ { samples }
+	{
+		// empty
+	}
+};
+
+
+/**
+ * \brief Pseudo random samples.
+ */
+std::vector<Sample> make_samples(const std::size_t total)
+{
+	auto samples = std::vector<Sample>(total);
+	auto x = std::uint32_t { 0x12345678 };
+
+	for (auto& s : samples)
+	{
+		x = x * 1664525 + 1013904223;
+		s = x;
+	}
+
+	return samples;
+}
+
+
+/**
+ * \brief Straightforward reference implementation of ARCSv1 and ARCSv2.
+ */
+std::pair<std::uint32_t, std::uint32_t> reference_arcs(
+		const std::vector<Sample>& samples, const std::size_t first,
+		const std::size_t length, const bool is_first, const bool is_last)
+{
+	auto v1 = std::uint32_t { 0 };
+	auto v2 = std::uint32_t { 0 };
+
+	for (std::size_t m = 1; m <= length; ++m)
+	{
+		if (is_first && m < 2940)          { continue; }
+		if (is_last  && m > length - 2940) { continue; }
+
+		const auto p = std::uint64_t { m } * samples[first + m - 1];
+
+		v1 += static_cast<std::uint32_t>(p);
+		v2 += static_cast<std::uint32_t>(p)
+			+ static_cast<std::uint32_t>(p >> 32);
+	}
+
+	return { v1, v2 };
+}
+
+} // namespace
+
+
+TEST_CASE ( "ARCSAccumulator", "[arcs]" )
+{
+	using arcsapp::arcs::ARCSAccumulator;
+
+	const auto samples { make_samples(20000) };
+
+	SECTION ( "Sums of split ranges equal sum of entire range" )
+	{
+		ARCSAccumulator entire { 1, 2940, 20000 - 2940 };
+		entire.update(samples.data(), samples.size());
+
+		ARCSAccumulator part1 { 1, 2940, 20000 - 2940 };
+		part1.update(samples.data(), 1000);
+		part1.update(samples.data() + 1000, 6000);
+
+		CHECK ( part1.multiplier() == 7001 );
+
+		ARCSAccumulator part2 { 7001, 2940, 20000 - 2940 };
+		part2.update(samples.data() + 7000, 13000);
+
+		part1.merge(part2);
+
+		const auto [ v1, v2 ] = reference_arcs(samples, 0, 20000, true, true);
+
+		CHECK ( entire.arcs1() == v1 );
+		CHECK ( entire.arcs2() == v2 );
+		CHECK ( part1.arcs1()  == v1 );
+		CHECK ( part1.arcs2()  == v2 );
+	}
+
+	SECTION ( "Range outside of the counted multipliers sums to 0" )
+	{
+		ARCSAccumulator acc { 1, 2940, 20000 };
+		acc.update(samples.data(), 2939);
+
+		CHECK ( acc.arcs1() == 0 );
+		CHECK ( acc.arcs2() == 0 );
+	}
+}
+
+
+TEST_CASE ( "track_ranges()", "[arcs]" )
+{
+	using arcsapp::arcs::track_ranges;
+
+	SECTION ( "Ranges respect skipped samples of first and last track" )
+	{
+		const auto ranges { track_ranges({ 0, 10000, 25000 }, 40000) };
+
+		REQUIRE ( ranges.size() == 3 );
+
+		CHECK ( ranges[0].first      == 0 );
+		CHECK ( ranges[0].length     == 10000 );
+		CHECK ( ranges[0].check_from == 2940 );
+		CHECK ( ranges[0].check_to   == 10000 );
+
+		CHECK ( ranges[1].first      == 10000 );
+		CHECK ( ranges[1].length     == 15000 );
+		CHECK ( ranges[1].check_from == 1 );
+		CHECK ( ranges[1].check_to   == 15000 );
+
+		CHECK ( ranges[2].first      == 25000 );
+		CHECK ( ranges[2].length     == 15000 );
+		CHECK ( ranges[2].check_from == 1 );
+		CHECK ( ranges[2].check_to   == 15000 - 2940 );
+	}
+
+	SECTION ( "Non-ascending offsets are rejected" )
+	{
+		CHECK_THROWS_AS ( track_ranges({ 0, 5000, 5000 }, 40000),
+				std::invalid_argument );
+		CHECK_THROWS_AS ( track_ranges({ 0, 5000 }, 4000),
+				std::invalid_argument );
+	}
+}
+
+
+TEST_CASE ( "calculate_tracks()", "[arcs]" )
+{
+	using arcsapp::arcs::calculate_tracks;
+	using arcsapp::arcs::track_ranges;
+
+	const auto samples { make_samples(3000000) };
+	const auto offsets = std::vector<std::size_t> { 588, 1000000, 1700000 };
+	const auto tracks { track_ranges(offsets, samples.size()) };
+
+	const auto open = [&samples]
+	{
+		return std::make_unique<VectorSampleReader>(samples);
+	};
+
+	SECTION ( "Concurrent result equals sequential reference" )
+	{
+		for (const auto workers : { 1u, 2u, 3u, 8u })
+		{
+			const auto sums { calculate_tracks(open, tracks, workers) };
+
+			REQUIRE ( sums.size() == 3 );
+
+			for (std::size_t t = 0; t < tracks.size(); ++t)
+			{
+				const auto [ v1, v2 ] = reference_arcs(samples,
+						tracks[t].first, tracks[t].length, 0 == t, 2 == t);
+
+				CHECK ( sums[t].arcs1() == v1 );
+				CHECK ( sums[t].arcs2() == v2 );
+			}
+		}
+	}
+
+	SECTION ( "Digests cover the samples of each track" )
+	{
+		using arcsapp::digest::Digests;
+		using arcsapp::digest::DigestType;
+
+		const auto types = std::vector<DigestType> { DigestType::CRC32,
+			DigestType::MD5 };
+
+		auto digests = std::vector<Digests>(tracks.size(), Digests { types });
+
+		const auto sums { calculate_tracks(open, tracks, 3, &digests) };
+
+		for (std::size_t t = 0; t < tracks.size(); ++t)
+		{
+			const auto [ v1, v2 ] = reference_arcs(samples,
+					tracks[t].first, tracks[t].length, 0 == t, 2 == t);
+
+			CHECK ( sums[t].arcs1() == v1 );
+			CHECK ( sums[t].arcs2() == v2 );
+
+			Digests reference { types };
+			reference.update(samples.data() + tracks[t].first,
+					tracks[t].length);
+
+			CHECK ( digests[t].value(DigestType::CRC32)
+					== reference.value(DigestType::CRC32) );
+			CHECK ( digests[t].value(DigestType::MD5)
+					== reference.value(DigestType::MD5) );
+		}
+	}
+
+	SECTION ( "Too short audio throws" )
+	{
+		const auto long_tracks { track_ranges(offsets, samples.size() + 1) };
+
+		CHECK_THROWS_AS ( calculate_tracks(open, long_tracks, 2),
+				std::runtime_error );
+	}
+}
+
+
+TEST_CASE ( "calculate_stream()", "[arcs]" )
+{
+	using arcsapp::arcs::calculate_stream;
+	using arcsapp::pcm::SampleStream;
+
+	const auto samples { make_samples(300000) };
+
+	auto bytes = std::string {};
+	for (const auto s : samples)
+	{
+		for (auto shift = 0; shift < 32; shift += 8)
+		{
+			bytes.push_back(static_cast<char>((s >> shift) & 0xFF));
+		}
+	}
+
+	const auto unlimited = std::numeric_limits<std::size_t>::max();
+
+	SECTION ( "Streamed result equals sequential reference" )
+	{
+		const auto offsets = std::vector<std::size_t> { 588, 100000, 250000 };
+
+		std::istringstream in { bytes };
+		SampleStream stream { in, {}, unlimited };
+
+		const auto [ sums, total ] =
+			calculate_stream(stream, offsets, true, true);
+
+		CHECK ( total == samples.size() );
+		REQUIRE ( sums.size() == 3 );
+
+		const auto ends = std::vector<std::size_t> {
+			offsets[1], offsets[2], samples.size() };
+
+		for (std::size_t t = 0; t < offsets.size(); ++t)
+		{
+			const auto [ v1, v2 ] = reference_arcs(samples, offsets[t],
+					ends[t] - offsets[t], 0 == t, 2 == t);
+
+			CHECK ( sums[t].arcs1() == v1 );
+			CHECK ( sums[t].arcs2() == v2 );
+		}
+	}
+
+	SECTION ( "Streamed digests cover the samples of each track" )
+	{
+		using arcsapp::digest::Digests;
+		using arcsapp::digest::DigestType;
+
+		const auto offsets = std::vector<std::size_t> { 588, 100000, 250000 };
+		const auto types = std::vector<DigestType> { DigestType::MD5 };
+
+		std::istringstream in { bytes };
+		SampleStream stream { in, {}, unlimited };
+
+		auto digests = std::vector<Digests>(offsets.size(), Digests { types });
+
+		calculate_stream(stream, offsets, true, true, &digests);
+
+		const auto ends = std::vector<std::size_t> {
+			offsets[1], offsets[2], samples.size() };
+
+		for (std::size_t t = 0; t < offsets.size(); ++t)
+		{
+			Digests reference { types };
+			reference.update(samples.data() + offsets[t], ends[t] - offsets[t]);
+
+			CHECK ( digests[t].value(DigestType::MD5)
+					== reference.value(DigestType::MD5) );
+		}
+	}
+
+	SECTION ( "Read audio file equals stream and updates file digests" )
+	{
+		using arcsapp::digest::Digests;
+		using arcsapp::digest::DigestType;
+
+		const auto offsets = std::vector<std::size_t> { 588, 100000, 250000 };
+		const auto types = std::vector<DigestType> { DigestType::MD5 };
+
+		std::istringstream in { bytes };
+		SampleStream stream { in, {}, unlimited };
+
+		const auto [ stream_sums, stream_total ] =
+			calculate_stream(stream, offsets, true, true);
+
+		VectorSampleReader reader { samples };
+		Digests file_digests { types };
+
+		const auto [ sums, total ] =
+			calculate_stream(reader, offsets, true, true, nullptr,
+					&file_digests);
+
+		CHECK ( total == stream_total );
+		REQUIRE ( sums.size() == stream_sums.size() );
+
+		for (std::size_t t = 0; t < sums.size(); ++t)
+		{
+			CHECK ( sums[t].arcs1() == stream_sums[t].arcs1() );
+			CHECK ( sums[t].arcs2() == stream_sums[t].arcs2() );
+		}
+
+		Digests reference { types };
+		reference.update(samples.data(), samples.size());
+
+		CHECK ( file_digests.value(DigestType::MD5)
+				== reference.value(DigestType::MD5) );
+	}
+
+	SECTION ( "Single track respects the flags" )
+	{
+		for (const auto is_last : { false, true })
+		{
+			std::istringstream in { bytes };
+			SampleStream stream { in, {}, unlimited };
+
+			const auto [ sums, total ] =
+				calculate_stream(stream, { 0 }, false, is_last);
+
+			const auto [ v1, v2 ] = reference_arcs(samples, 0, total, false,
+					is_last);
+
+			CHECK ( sums.at(0).arcs1() == v1 );
+			CHECK ( sums.at(0).arcs2() == v2 );
+		}
+	}
+
+	SECTION ( "Stream ending before the last track throws" )
+	{
+		std::istringstream in { bytes };
+		SampleStream stream { in, {}, unlimited };
+
+		CHECK_THROWS_AS ( calculate_stream(stream, { 0, 300001 }, true, true),
+				std::runtime_error );
+	}
+}
+
+TEST_CASE ( "shifted_arcs1()", "[arcs]" )
+{
+	using arcsapp::arcs::calculate_shifted;
+	using arcsapp::arcs::shifted_arcs1;
+	using arcsapp::arcs::track_ranges;
+
+	const auto max_shift = std::size_t { 2940 };
+
+	const auto samples { make_samples(300000) };
+	const auto offsets = std::vector<std::size_t> { 588, 100000, 200000 };
+	const auto tracks { track_ranges(offsets, samples.size()) };
+
+	// Samples surrounded by silence for the shifts beyond the audio file
+	auto padded = std::vector<Sample>(samples.size() + 2 * max_shift, 0);
+	std::copy(samples.begin(), samples.end(), padded.begin() + max_shift);
+
+	SECTION ( "Each shift equals the ARCSv1 of the shifted samples" )
+	{
+		for (std::size_t t = 0; t < tracks.size(); ++t)
+		{
+			VectorSampleReader reader { samples };
+
+			const auto sums { shifted_arcs1(reader, tracks[t], max_shift) };
+
+			REQUIRE ( sums.size() == 2 * max_shift + 1 );
+
+			for (const auto shift : { -2940, -2939, -1, 0, 1, 588, 2940 })
+			{
+				const auto v1 { reference_arcs(padded,
+						tracks[t].first + max_shift + shift, tracks[t].length,
+						0 == t, 2 == t).first };
+
+				CHECK ( sums[max_shift + shift] == v1 );
+			}
+		}
+	}
+
+	SECTION ( "Concurrent result equals single track results" )
+	{
+		const auto open = [&samples]
+		{
+			return std::make_unique<VectorSampleReader>(samples);
+		};
+
+		const auto all { calculate_shifted(open, tracks, 10, 3) };
+
+		REQUIRE ( all.size() == 3 );
+
+		for (std::size_t t = 0; t < tracks.size(); ++t)
+		{
+			VectorSampleReader reader { samples };
+
+			CHECK ( all[t] == shifted_arcs1(reader, tracks[t], 10) );
+		}
+	}
+}
+
+
+TEST_CASE ( "find_shift()", "[arcs]" )
+{
+	using arcsapp::arcs::find_shift;
+
+	// Shifts -3 to +3
+	const auto sums = std::vector<std::uint32_t> { 7, 5, 1, 2, 3, 5, 4 };
+
+	SECTION ( "Shift of a single match is found" )
+	{
+		CHECK ( find_shift(sums, { 4 }) == 3 );
+		CHECK ( find_shift(sums, { 7 }) == -3 );
+		CHECK ( find_shift(sums, { 2 }) == 0 );
+	}
+
+	SECTION ( "Shift with the smallest absolute value is preferred" )
+	{
+		CHECK ( find_shift(sums, { 5 }) == -2 );
+		CHECK ( find_shift(sums, { 7, 3 }) == 1 );
+	}
+
+	SECTION ( "No match yields no shift" )
+	{
+		CHECK ( !find_shift(sums, { 9 }) );
+		CHECK ( !find_shift(sums, {}) );
+	}
+
+	SECTION ( "No sums yield no shift" )
+	{
+		CHECK ( !find_shift({}, { 2 }) );
+	}
+}
+
@@ -0,0 +1,112 @@
+#include "catch2/catch_test_macros.hpp"
+
+#include <algorithm>   // for sort
+#include <filesystem>  // for create_directories, remove_all
+#include <fstream>     // for ofstream
+#include <mutex>       // for mutex, lock_guard
+#include <sstream>     // for istringstream
+#include <stdexcept>   // for runtime_error
+#include <string>      // for string
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_BATCH_HPP__
+#include "tools-batch.hpp"
+#endif
+
+
+TEST_CASE ( "read_manifest()", "[batch]" )
+{
+	using arcsapp::batch::read_manifest;
+
+	SECTION ( "Metafiles with and without audio files are read in order" )
+	{
+		auto in = std::istringstream {
+			"# Comment\n"
+			"album1/album1.cue\n"
+			"\n"
+			"album 2/album2.cue\ttrack 1.flac\ttrack 2.flac\r\n"
+			"album3/album3.cue\timage.wav\n"
+		};
+
+		const auto albums { read_manifest(in) };
+
+		REQUIRE ( albums.size() == 3 );
+
+		CHECK ( albums[0].metafile == "album1/album1.cue" );
+		CHECK ( albums[0].audiofiles.empty() );
+
+		CHECK ( albums[1].metafile == "album 2/album2.cue" );
+		REQUIRE ( albums[1].audiofiles.size() == 2 );
+		CHECK ( albums[1].audiofiles[0] == "track 1.flac" );
+		CHECK ( albums[1].audiofiles[1] == "track 2.flac" );
+
+		CHECK ( albums[2].metafile == "album3/album3.cue" );
+		REQUIRE ( albums[2].audiofiles.size() == 1 );
+		CHECK ( albums[2].audiofiles[0] == "image.wav" );
+	}
+
+	SECTION ( "Line without metafile is rejected" )
+	{
+		auto in = std::istringstream { "album1.cue\n\taudio.wav\n" };
+
+		CHECK_THROWS_AS ( read_manifest(in), std::runtime_error );
+	}
+
+	SECTION ( "Missing manifest file is rejected" )
+	{
+		CHECK_THROWS_AS ( read_manifest("no-such-manifest.txt"),
+				std::runtime_error );
+	}
+}
+
+
+TEST_CASE ( "find_albums()", "[batch]" )
+{
+	using arcsapp::batch::Album;
+	using arcsapp::batch::find_albums;
+
+	namespace fs = std::filesystem;
+
+	const auto root { fs::temp_directory_path() / "arcstk-test-find-albums" };
+	fs::remove_all(root);
+
+	fs::create_directories(root / "a");
+	fs::create_directories(root / "b" / "c");
+	fs::create_directories(root / "d");
+
+	for (const auto& file : { "a/a.cue", "b/c/c.CUE", "b/c/c.wav", "d/d.txt" })
+	{
+		std::ofstream { root / file };
+	}
+
+	SECTION ( "Metafiles in all subdirectories are found" )
+	{
+		auto mutex  = std::mutex {};
+		auto albums = std::vector<std::string> {};
+
+		find_albums(root.string(), 3,
+			[&](Album&& album)
+			{
+				const std::lock_guard<std::mutex> lock(mutex);
+
+				CHECK ( album.audiofiles.empty() );
+				albums.push_back(album.metafile);
+			});
+
+		std::sort(albums.begin(), albums.end());
+
+		REQUIRE ( albums.size() == 2 );
+
+		CHECK ( albums[0] == (root / "a" / "a.cue").generic_string() );
+		CHECK ( albums[1] == (root / "b" / "c" / "c.CUE").generic_string() );
+	}
+
+	SECTION ( "A root that is not a directory is rejected" )
+	{
+		CHECK_THROWS_AS ( find_albums((root / "a" / "a.cue").string(), 1,
+				[](Album&&) { /* empty */ }), std::runtime_error );
+	}
+
+	fs::remove_all(root);
+}
+
@@ -0,0 +1,222 @@
+#include "catch2/catch_test_macros.hpp"
+
+#include <filesystem>  // for remove_all
+#include <fstream>     // for ofstream
+#include <stdexcept>   // for runtime_error
+#include <string>      // for string
+
+#ifndef __ARCSTOOLS_TOOLS_CACHE_HPP__
+#include "tools-cache.hpp"
+#endif
+
+
+TEST_CASE ( "file_identity()", "[cache]" )
+{
+	using arcsapp::cache::file_identity;
+
+	SECTION ( "Identity of an existing file contains its size" )
+	{
+		const auto filename = std::string { "test-cache-identity.bin" };
+		{
+			std::ofstream out { filename, std::ios::binary };
+			out << "0123456789";
+		}
+
+		const auto id { file_identity(filename) };
+
+		CHECK ( id.size == 10 );
+		CHECK ( id.inode != 0 );
+
+		std::filesystem::remove(filename);
+	}
+
+	SECTION ( "Missing file is rejected" )
+	{
+		CHECK_THROWS_AS ( file_identity("no-such-file.wav"),
+				std::runtime_error );
+	}
+}
+
+
+TEST_CASE ( "content_identity()", "[cache]" )
+{
+	using arcsapp::cache::content_identity;
+
+	const auto write = [](const std::string& filename, const char fill)
+	{
+		std::ofstream out { filename, std::ios::binary };
+		out << std::string(200000, 'x') << fill << std::string(100000, 'y');
+	};
+
+	SECTION ( "Copies of a file have the same identity" )
+	{
+		write("test-cache-content1.bin", 'a');
+		write("test-cache-content2.bin", 'a');
+
+		const auto id1 { content_identity("test-cache-content1.bin", 75000) };
+		const auto id2 { content_identity("test-cache-content2.bin", 75000) };
+
+		CHECK ( id1.device == id2.device );
+		CHECK ( id1.inode  == id2.inode  );
+		CHECK ( id1.size   == 300001 );
+		CHECK ( id1.mtime  == 75000 );
+
+		std::filesystem::remove("test-cache-content1.bin");
+		std::filesystem::remove("test-cache-content2.bin");
+	}
+
+	SECTION ( "Different sample counts lead to different identities" )
+	{
+		write("test-cache-content1.bin", 'a');
+
+		const auto id1 { content_identity("test-cache-content1.bin", 75000) };
+		const auto id2 { content_identity("test-cache-content1.bin", 75001) };
+
+		CHECK ( id1.inode != id2.inode );
+
+		std::filesystem::remove("test-cache-content1.bin");
+	}
+
+	SECTION ( "Missing file is rejected" )
+	{
+		CHECK_THROWS_AS ( content_identity("no-such-file.wav", 0),
+				std::runtime_error );
+	}
+}
+
+
+TEST_CASE ( "ChecksumCache", "[cache]" )
+{
+	using arcsapp::cache::ChecksumCache;
+	using arcsapp::cache::CacheKey;
+	using arcsapp::cache::CacheValue;
+	using arcsapp::cache::FIRST_TRACK;
+	using arcsapp::cache::IMAGE;
+
+	const auto dir = std::string { "test-cache-dir" };
+	std::filesystem::remove_all(dir);
+
+	const auto key = CacheKey { { 1, 42, 1000, 123456789 }, 0, 0, 3,
+		FIRST_TRACK };
+
+	SECTION ( "Inserted value is found" )
+	{
+		ChecksumCache cache { dir };
+
+		CHECK ( !cache.find(key) );
+
+		cache.insert(key, CacheValue { 1234, 3, 0x11111111, 0x22222222 });
+
+		const auto value { cache.find(key) };
+
+		REQUIRE ( value );
+		CHECK ( value->length == 1234 );
+		CHECK ( value->types  == 3 );
+		CHECK ( value->arcs1  == 0x11111111 );
+		CHECK ( value->arcs2  == 0x22222222 );
+		CHECK ( cache.size() == 1 );
+
+		CHECK ( cache.hits()   == 1 );
+		CHECK ( cache.misses() == 1 );
+	}
+
+	SECTION ( "Value persists when the cache is reopened" )
+	{
+		{
+			ChecksumCache cache { dir };
+			cache.insert(key, CacheValue { 1234, 3, 1, 2 });
+		}
+
+		ChecksumCache cache { dir };
+
+		REQUIRE ( cache.find(key) );
+		CHECK ( cache.find(key)->arcs2 == 2 );
+	}
+
+	SECTION ( "Changed file replaces the outdated entry" )
+	{
+		ChecksumCache cache { dir };
+		cache.insert(key, CacheValue { 1234, 3, 1, 2 });
+
+		auto changed { key };
+		changed.file.mtime += 1;
+
+		CHECK ( !cache.find(changed) );
+
+		cache.insert(changed, CacheValue { 1234, 3, 3, 4 });
+
+		CHECK ( !cache.find(key) );
+		REQUIRE ( cache.find(changed) );
+		CHECK ( cache.find(changed)->arcs1 == 3 );
+		CHECK ( cache.size() == 1 );
+	}
+
+	SECTION ( "Calculation context is part of the key" )
+	{
+		ChecksumCache cache { dir };
+		cache.insert(key, CacheValue { 1234, 3, 1, 2 });
+
+		auto other_types { key };
+		other_types.types = 1;
+
+		auto other_flags { key };
+		other_flags.flags = 0;
+
+		auto track { key };
+		track.toc   = 77;
+		track.track = 1;
+		track.flags = IMAGE;
+
+		CHECK ( !cache.find(other_types) );
+		CHECK ( !cache.find(other_flags) );
+		CHECK ( !cache.find(track) );
+	}
+
+	SECTION ( "Cache grows and keeps all entries" )
+	{
+		ChecksumCache cache { dir };
+
+		for (std::uint64_t i = 0; i < 10000; ++i)
+		{
+			auto k { key };
+			k.file.inode = i;
+			cache.insert(k, CacheValue { 1, 3, static_cast<std::uint32_t>(i),
+					0 });
+		}
+
+		CHECK ( cache.size() == 10000 );
+
+		// A second instance sees the replaced cache file
+
+		ChecksumCache other { dir };
+
+		for (std::uint64_t i = 0; i < 10000; i += 999)
+		{
+			auto k { key };
+			k.file.inode = i;
+			REQUIRE ( other.find(k) );
+			CHECK ( other.find(k)->arcs1 == i );
+		}
+	}
+
+	SECTION ( "Eviction keeps the number of entries below the maximum" )
+	{
+		ChecksumCache cache { dir, 100 };
+
+		for (std::uint64_t i = 0; i < 1000; ++i)
+		{
+			auto k { key };
+			k.file.inode = i;
+			cache.insert(k, CacheValue { 1, 3, 0, 0 });
+		}
+
+		CHECK ( cache.size() <= 100 );
+
+		auto last { key };
+		last.file.inode = 999;
+		CHECK ( cache.find(last) );
+	}
+
+	std::filesystem::remove_all(dir);
+}
+
@@ -0,0 +1,131 @@
+#include "catch2/catch_test_macros.hpp"
+
+#include <chrono>      // for milliseconds
+#include <memory>      // for unique_ptr, make_unique
+#include <thread>      // for sleep_for
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_DEADLINE_HPP__
+#include "tools-deadline.hpp"
+#endif
+
+
+namespace
+{
+
+/**
+ * \brief SampleReader on samples in memory.
+ */
+class MemoryReader final : public arcsapp::pcm::SampleReader
+{
+	std::vector<arcsapp::pcm::Sample> samples_;
+
+	std::size_t do_total_samples() const final
+	{
+		return samples_.size();
+	}
+
+	std::size_t do_read(const std::size_t first, const std::size_t count,
+			arcsapp::pcm::Sample* buffer) final
+	{
+		auto n = std::size_t { 0 };
+
+		for (; n < count && first + n < samples_.size(); ++n)
+		{
+			buffer[n] = samples_[first + n];
+		}
+
+		return n;
+	}
+
+public:
+
+	explicit MemoryReader(const std::size_t total)
+		: samples_(total, 1)
+	{
+		// empty
+	}
+};
+
+} // namespace
+
+
+TEST_CASE ( "Deadline", "[deadline]" )
+{
+	using arcsapp::deadline::Deadline;
+	using arcsapp::deadline::TimeoutException;
+
+	SECTION ( "Default deadline never passes" )
+	{
+		const Deadline deadline;
+
+		CHECK ( not deadline.is_set() );
+		CHECK ( not deadline.expired() );
+		CHECK_NOTHROW ( deadline.check() );
+	}
+
+	SECTION ( "Timeout of 0 never passes" )
+	{
+		const Deadline deadline { std::chrono::milliseconds { 0 }, "album" };
+
+		CHECK ( not deadline.is_set() );
+		CHECK_NOTHROW ( deadline.check() );
+	}
+
+	SECTION ( "Deadline passes after its timeout" )
+	{
+		const Deadline deadline { std::chrono::milliseconds { 1 }, "album" };
+
+		std::this_thread::sleep_for(std::chrono::milliseconds { 5 });
+
+		CHECK ( deadline.is_set() );
+		CHECK ( deadline.expired() );
+		CHECK_THROWS_AS ( deadline.check(), TimeoutException );
+	}
+
+	SECTION ( "earliest() chooses the deadline that passes first" )
+	{
+		const Deadline never;
+		const Deadline soon  { std::chrono::milliseconds { 1000 },  "soon" };
+		const Deadline later { std::chrono::milliseconds { 60000 }, "later" };
+
+		CHECK ( &never.earliest(soon) == &soon );
+		CHECK ( &soon.earliest(never) == &soon );
+		CHECK ( &later.earliest(soon) == &soon );
+		CHECK ( &soon.earliest(later) == &soon );
+	}
+}
+
+
+TEST_CASE ( "guard()", "[deadline]" )
+{
+	using arcsapp::deadline::Deadline;
+	using arcsapp::deadline::TimeoutException;
+	using arcsapp::deadline::guard;
+	using arcsapp::pcm::Sample;
+
+	auto buffer = std::vector<Sample>(100);
+
+	SECTION ( "No reader is not wrapped" )
+	{
+		const Deadline deadline { std::chrono::milliseconds { 1 }, "file" };
+
+		CHECK ( guard(nullptr, deadline) == nullptr );
+	}
+
+	SECTION ( "Guarded reader reads until the deadline passes" )
+	{
+		const Deadline deadline { std::chrono::milliseconds { 50 }, "file" };
+
+		auto reader { guard(std::make_unique<MemoryReader>(1000), deadline) };
+
+		CHECK ( reader->total_samples() == 1000 );
+		CHECK ( reader->read(0, 100, buffer.data()) == 100 );
+
+		std::this_thread::sleep_for(std::chrono::milliseconds { 60 });
+
+		CHECK_THROWS_AS ( reader->read(100, 100, buffer.data()),
+				TimeoutException );
+	}
+}
+
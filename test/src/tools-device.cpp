@@ -0,0 +1,63 @@
+#include "catch2/catch_test_macros.hpp"
+
+#include <cstdio>      // for remove
+#include <fstream>     // for ofstream
+#include <string>      // for string
+
+#ifndef __ARCSTOOLS_TOOLS_DEVICE_HPP__
+#include "tools-device.hpp"
+#endif
+
+
+TEST_CASE ( "device_of()", "[device]" )
+{
+	using arcsapp::device::UNKNOWN_DEVICE;
+	using arcsapp::device::device_of;
+
+	SECTION ( "Files in the same directory are on the same device" )
+	{
+		const auto file1 = std::string { "test_device_1.txt" };
+		const auto file2 = std::string { "test_device_2.txt" };
+		{
+			std::ofstream out1 { file1 };
+			std::ofstream out2 { file2 };
+		}
+
+		CHECK ( device_of(file1) != UNKNOWN_DEVICE );
+		CHECK ( device_of(file1) == device_of(file2) );
+
+		std::remove(file1.c_str());
+		std::remove(file2.c_str());
+	}
+
+	SECTION ( "Missing file is on unknown device" )
+	{
+		CHECK ( device_of("test_device_missing.txt") == UNKNOWN_DEVICE );
+	}
+}
+
+
+TEST_CASE ( "ReaderLimits", "[device]" )
+{
+	using arcsapp::device::Medium;
+	using arcsapp::device::ReaderLimits;
+	using arcsapp::device::UNKNOWN_DEVICE;
+	using arcsapp::device::medium_of;
+
+	SECTION ( "Unknown device is not limited by default" )
+	{
+		ReaderLimits limits;
+
+		CHECK ( medium_of(UNKNOWN_DEVICE) == Medium::UNKNOWN );
+		CHECK ( limits.readers(UNKNOWN_DEVICE) == 0 );
+	}
+
+	SECTION ( "Fixed limit applies to every device" )
+	{
+		ReaderLimits limits { 2 };
+
+		CHECK ( limits.readers(UNKNOWN_DEVICE) == 2 );
+		CHECK ( limits.readers(12345) == 2 );
+	}
+}
+
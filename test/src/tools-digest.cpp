@@ -0,0 +1,264 @@
+#include "catch2/catch_test_macros.hpp"
+
+#include <algorithm>   // for min
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint8_t, uint32_t
+#include <iomanip>     // for setfill, setw
+#include <sstream>     // for ostringstream
+#include <stdexcept>   // for invalid_argument
+#include <string>      // for string
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_DIGEST_HPP__
+#include "tools-digest.hpp"
+#endif
+
+
+namespace
+{
+
+/**
+ * \brief Bytes of a string.
+ */
+std::vector<std::uint8_t> bytes(const std::string& s)
+{
+	return std::vector<std::uint8_t>(s.begin(), s.end());
+}
+
+
+/**
+ * \brief Hexadecimal representation of an MD5 value.
+ */
+std::string hex(const arcsapp::digest::MD5& md5)
+{
+	static const auto digits = std::string { "0123456789abcdef" };
+
+	auto result = std::string {};
+
+	for (const auto b : md5.value())
+	{
+		result += digits[b >> 4];
+		result += digits[b & 0x0F];
+	}
+
+	return result;
+}
+
+
+/**
+ * \brief Hexadecimal representation of a CRC32 value.
+ */
+std::string hex(const std::uint32_t crc)
+{
+	auto out = std::ostringstream {};
+
+	out << std::hex << std::uppercase << std::setw(8) << std::setfill('0')
+		<< crc;
+
+	return out.str();
+}
+
+
+/**
+ * \brief Samples with some silent channels.
+ */
+std::vector<arcsapp::pcm::Sample> make_samples(
+		const std::size_t total = 10000)
+{
+	auto samples = std::vector<arcsapp::pcm::Sample>(total);
+
+	for (std::uint32_t i = 0; i < samples.size(); ++i)
+	{
+		samples[i] = i * 2654435761u;
+
+		if (i % 7  == 0) { samples[i] &= 0xFFFF0000; }
+		if (i % 11 == 0) { samples[i] &= 0x0000FFFF; }
+	}
+
+	return samples;
+}
+
+} // namespace
+
+
+TEST_CASE ( "to_types()", "[digest]" )
+{
+	using arcsapp::digest::DigestType;
+	using arcsapp::digest::name;
+	using arcsapp::digest::to_types;
+
+	SECTION ( "Names are parsed in order without duplicates" )
+	{
+		CHECK ( to_types("md5,crc32,md5,crc32-nosilence")
+			== std::vector<DigestType> { DigestType::MD5, DigestType::CRC32,
+				DigestType::CRC32_NOSILENCE } );
+	}
+
+	SECTION ( "Names and types correspond" )
+	{
+		for (const auto& n : { "crc32", "crc32-nosilence", "ctdb", "md5" })
+		{
+			CHECK ( name(to_types(n).front()) == n );
+		}
+	}
+
+	SECTION ( "Unknown name is rejected" )
+	{
+		CHECK_THROWS_AS ( to_types("crc32,sha1"), std::invalid_argument );
+	}
+}
+
+
+TEST_CASE ( "CRC32", "[digest]" )
+{
+	using arcsapp::digest::CRC32;
+
+	SECTION ( "Check value is correct" )
+	{
+		const auto input { bytes("123456789") };
+
+		CRC32 crc;
+		crc.update(input.data(), input.size());
+
+		CHECK ( crc.value() == 0xCBF43926 );
+	}
+
+	SECTION ( "Updates in parts equal a single update" )
+	{
+		const auto input { bytes("123456789") };
+
+		CRC32 crc;
+		crc.update(input.data(), 4);
+		crc.update(input.data() + 4, 5);
+
+		CHECK ( crc.value() == 0xCBF43926 );
+	}
+}
+
+
+TEST_CASE ( "MD5", "[digest]" )
+{
+	using arcsapp::digest::MD5;
+
+	SECTION ( "Test suite values of RFC 1321 are correct" )
+	{
+		MD5 empty;
+		CHECK ( hex(empty) == "d41d8cd98f00b204e9800998ecf8427e" );
+
+		const auto abc { bytes("abc") };
+		MD5 md5;
+		md5.update(abc.data(), abc.size());
+		CHECK ( hex(md5) == "900150983cd24fb0d6963f7d28e17f72" );
+
+		const auto digits { bytes("1234567890123456789012345678901234567890"
+				"1234567890123456789012345678901234567890") };
+		MD5 md5_digits;
+		md5_digits.update(digits.data(), digits.size());
+		CHECK ( hex(md5_digits) == "57edf4a22be3c955ac49da2e2107b67a" );
+	}
+
+	SECTION ( "Updates of odd sizes equal a single update" )
+	{
+		const auto input { bytes(std::string(1000000, 'a')) };
+
+		MD5 md5;
+		for (std::size_t done = 0; done < input.size(); done += 999)
+		{
+			md5.update(input.data() + done,
+					std::min(std::size_t { 999 }, input.size() - done));
+		}
+
+		CHECK ( hex(md5) == "7707d6ae4e027c70eea2a935c2296f21" );
+	}
+}
+
+
+TEST_CASE ( "Digests", "[digest]" )
+{
+	using arcsapp::digest::Digests;
+	using arcsapp::digest::DigestType;
+
+	const auto samples { make_samples() };
+
+	SECTION ( "All digests are calculated in one pass" )
+	{
+		Digests digests { { DigestType::CRC32, DigestType::CRC32_NOSILENCE,
+			DigestType::MD5 } };
+
+		digests.update(samples.data(), 3000);
+		digests.update(samples.data() + 3000, samples.size() - 3000);
+
+		CHECK ( digests.value(DigestType::CRC32) == "52C78288" );
+		CHECK ( digests.value(DigestType::CRC32_NOSILENCE) == "4297B816" );
+		CHECK ( digests.value(DigestType::MD5)
+				== "65e4fbb0d3d81c1a0cfa4a26bcc94489" );
+	}
+
+	SECTION ( "Digest not requested is rejected" )
+	{
+		Digests digests { { DigestType::CRC32 } };
+
+		digests.update(samples.data(), samples.size());
+
+		CHECK ( digests.value(DigestType::CRC32) == "52C78288" );
+		CHECK_THROWS_AS ( digests.value(DigestType::MD5),
+				std::invalid_argument );
+	}
+
+	SECTION ( "CTDB digest skips the first and the last samples" )
+	{
+		using arcsapp::digest::CTDB_SKIP_SAMPLES;
+
+		const auto track { make_samples(30000) };
+
+		Digests digests { { DigestType::CTDB } };
+
+		// Parts smaller and larger than the samples skipped
+
+		digests.update(track.data(), 1000);
+		digests.update(track.data() + 1000, 7000);
+		digests.update(track.data() + 8000, 13000);
+		digests.update(track.data() + 21000, 9000);
+
+		Digests expected { { DigestType::CRC32 } };
+		expected.update(track.data() + CTDB_SKIP_SAMPLES,
+				track.size() - 2 * CTDB_SKIP_SAMPLES);
+
+		CHECK ( digests.value(DigestType::CTDB)
+				== expected.value(DigestType::CRC32) );
+	}
+
+	SECTION ( "CTDB digest of a track shorter than the samples skipped" )
+	{
+		Digests digests { { DigestType::CTDB } };
+
+		digests.update(samples.data(), samples.size());
+
+		CHECK ( digests.value(DigestType::CTDB) == "00000000" );
+	}
+
+	SECTION ( "Windows are the CRC32 of their samples" )
+	{
+		Digests digests { {}, 4000 };
+
+		digests.update(samples.data(), 2500);
+		digests.update(samples.data() + 2500, samples.size() - 2500);
+
+		const auto windows { digests.windows() };
+
+		REQUIRE ( windows.size() == 3 );
+
+		for (std::size_t w = 0; w < windows.size(); ++w)
+		{
+			const auto first { w * 4000 };
+			const auto count { std::min(std::size_t { 4000 },
+					samples.size() - first) };
+
+			Digests window { { DigestType::CRC32 } };
+			window.update(samples.data() + first, count);
+
+			CHECK ( window.value(DigestType::CRC32) == hex(windows[w]) );
+		}
+	}
+}
+
@@ -0,0 +1,421 @@
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/benchmark/catch_benchmark.hpp"
+
+#include <atomic>      // for atomic
+#include <cstdio>      // for remove
+#include <cstdlib>     // for getenv
+#include <fstream>     // for ofstream
+#include <istream>     // for istream
+#include <iterator>    // for istreambuf_iterator
+#include <sstream>     // for istringstream
+#include <stdexcept>   // for invalid_argument, runtime_error
+#include <string>      // for string, getline
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_IO_HPP__
+#include "tools-io.hpp"
+#endif
+#ifndef __ARCSTOOLS_TOOLS_PARALLEL_HPP__
+#include "tools-parallel.hpp"
+#endif
+
+
+namespace
+{
+
+/**
+ * \brief Write a file with \c size bytes of a simple pattern.
+ */
+std::string write_pattern(const std::string& filename, const std::size_t size)
+{
+	auto content = std::string(size, '\0');
+
+	for (std::size_t i = 0; i < size; ++i)
+	{
+		content[i] = static_cast<char>(i * 31 % 251);
+	}
+
+	std::ofstream out { filename, std::ios::binary };
+	out << content;
+
+	return content;
+}
+
+
+/**
+ * \brief Read all bytes from a stream buffer.
+ */
+std::string read_all(std::streambuf& buffer)
+{
+	std::istream in { &buffer };
+
+	return std::string {
+		std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+}
+
+} // namespace
+
+
+TEST_CASE ( "to_backend()", "[io]" )
+{
+	using arcsapp::io::Backend;
+	using arcsapp::io::name;
+	using arcsapp::io::to_backend;
+
+	SECTION ( "Names of backends are accepted" )
+	{
+		CHECK ( to_backend("stdio")    == Backend::STDIO );
+		CHECK ( to_backend("mmap")     == Backend::MMAP  );
+		CHECK ( to_backend("io_uring") == Backend::URING );
+
+		CHECK ( name(Backend::URING) == "io_uring" );
+	}
+
+	SECTION ( "Unknown names are rejected" )
+	{
+		CHECK_THROWS_AS ( to_backend("uring"), std::invalid_argument );
+	}
+}
+
+
+TEST_CASE ( "input_memory()", "[io]" )
+{
+	using arcsapp::io::Backend;
+	using arcsapp::io::InputOptions;
+	using arcsapp::io::input_memory;
+
+	auto options = InputOptions {};
+	options.buffer_size = 1000;
+
+	SECTION ( "Read-ahead accounts for its buffers" )
+	{
+		options.read_ahead = 4;
+		CHECK ( input_memory(options, 1000000) == 4000 );
+
+		options.read_ahead = 1;
+		CHECK ( input_memory(options, 1000000) == 2000 );
+	}
+
+	SECTION ( "io_uring accounts for the reads in flight" )
+	{
+		options.backend = Backend::URING;
+		CHECK ( input_memory(options, 1000000) ==
+				arcsapp::io::DEFAULT_URING_DEPTH * 1000 );
+	}
+
+	SECTION ( "Memory mapping accounts for the entire file" )
+	{
+		options.backend = Backend::MMAP;
+		CHECK ( input_memory(options, 1000000) == 1000000 );
+	}
+}
+
+
+TEST_CASE ( "ReadAheadBuffer", "[io]" )
+{
+	using arcsapp::io::ReadAheadBuffer;
+	using arcsapp::io::StallCounters;
+
+	const auto filename = std::string { "test-io-readahead.bin" };
+	const auto content { write_pattern(filename, 100000) };
+
+	SECTION ( "File is read completely in order" )
+	{
+		auto counters = StallCounters {};
+
+		ReadAheadBuffer buffer { filename, 3, 4096, &counters };
+		std::istream in { &buffer };
+
+		const auto read = std::string {
+			std::istreambuf_iterator<char>(in),
+			std::istreambuf_iterator<char>() };
+
+		CHECK ( read == content );
+		CHECK ( counters.buffers == 25 );
+	}
+
+	SECTION ( "Seeking restarts reading at the new position" )
+	{
+		ReadAheadBuffer buffer { filename, 2, 4096, nullptr };
+		std::istream in { &buffer };
+
+		auto bytes = std::string(10, '\0');
+
+		in.seekg(50000);
+		in.read(&bytes[0], 10);
+		CHECK ( bytes == content.substr(50000, 10) );
+		CHECK ( in.tellg() == 50010 );
+
+		in.seekg(50005);
+		in.read(&bytes[0], 10);
+		CHECK ( bytes == content.substr(50005, 10) );
+
+		in.seekg(-10, std::ios::end);
+		in.read(&bytes[0], 10);
+		CHECK ( bytes == content.substr(99990, 10) );
+
+		in.seekg(3);
+		in.read(&bytes[0], 10);
+		CHECK ( bytes == content.substr(3, 10) );
+	}
+
+	SECTION ( "Reading beyond the end fails" )
+	{
+		ReadAheadBuffer buffer { filename, 2, 4096, nullptr };
+		std::istream in { &buffer };
+
+		auto bytes = std::string(10, '\0');
+
+		in.seekg(99995);
+		in.read(&bytes[0], 10);
+
+		CHECK ( in.gcount() == 5 );
+		CHECK ( in.eof() );
+	}
+
+	std::remove(filename.c_str());
+}
+
+
+TEST_CASE ( "MappedBuffer", "[io]" )
+{
+	using arcsapp::io::MappedBuffer;
+
+	const auto filename = std::string { "test-io-mmap.bin" };
+	const auto content { write_pattern(filename, 100000) };
+
+	SECTION ( "File is read completely in order" )
+	{
+		MappedBuffer buffer { filename };
+
+		CHECK ( read_all(buffer) == content );
+	}
+
+	SECTION ( "Seeking moves within the file" )
+	{
+		MappedBuffer buffer { filename };
+		std::istream in { &buffer };
+
+		auto bytes = std::string(10, '\0');
+
+		in.seekg(-10, std::ios::end);
+		in.read(&bytes[0], 10);
+		CHECK ( bytes == content.substr(99990, 10) );
+
+		in.seekg(3);
+		in.read(&bytes[0], 10);
+		CHECK ( bytes == content.substr(3, 10) );
+		CHECK ( in.tellg() == 13 );
+	}
+
+	SECTION ( "Empty file has no bytes" )
+	{
+		std::ofstream { "test-io-empty.bin" };
+
+		MappedBuffer buffer { "test-io-empty.bin" };
+
+		CHECK ( read_all(buffer).empty() );
+
+		std::remove("test-io-empty.bin");
+	}
+
+	std::remove(filename.c_str());
+}
+
+
+TEST_CASE ( "UringBuffer", "[io]" )
+{
+	using arcsapp::io::StallCounters;
+	using arcsapp::io::UringBuffer;
+	using arcsapp::io::uring_available;
+
+	if (!uring_available())
+	{
+		WARN ( "io_uring is not available, UringBuffer is not tested" );
+		return;
+	}
+
+	const auto filename = std::string { "test-io-uring.bin" };
+	const auto content { write_pattern(filename, 100000) };
+
+	SECTION ( "File is read completely in order" )
+	{
+		auto counters = StallCounters {};
+
+		UringBuffer buffer { filename, 4, 4096, &counters };
+
+		CHECK ( read_all(buffer) == content );
+		CHECK ( counters.buffers == 25 );
+	}
+
+	SECTION ( "Seeking restarts reading at the new position" )
+	{
+		UringBuffer buffer { filename, 2, 4096, nullptr };
+		std::istream in { &buffer };
+
+		auto bytes = std::string(10, '\0');
+
+		in.seekg(50000);
+		in.read(&bytes[0], 10);
+		CHECK ( bytes == content.substr(50000, 10) );
+		CHECK ( in.tellg() == 50010 );
+
+		in.seekg(-10, std::ios::end);
+		in.read(&bytes[0], 10);
+		CHECK ( bytes == content.substr(99990, 10) );
+
+		in.seekg(3);
+		in.read(&bytes[0], 10);
+		CHECK ( bytes == content.substr(3, 10) );
+	}
+
+	std::remove(filename.c_str());
+}
+
+
+TEST_CASE ( "open_input()", "[io]" )
+{
+	using arcsapp::io::InputOptions;
+	using arcsapp::io::open_input;
+
+	SECTION ( "Missing file is rejected with and without read-ahead" )
+	{
+		auto options = InputOptions {};
+
+		CHECK_THROWS_AS ( open_input("no-such-file.wav", options),
+				std::runtime_error );
+
+		options.read_ahead = 4;
+
+		CHECK_THROWS_AS ( open_input("no-such-file.wav", options),
+				std::runtime_error );
+	}
+
+	SECTION ( "All backends read the same bytes" )
+	{
+		using arcsapp::io::Backend;
+
+		const auto filename = std::string { "test-io-backends.bin" };
+		const auto content { write_pattern(filename, 100000) };
+
+		for (const auto backend : { Backend::STDIO, Backend::MMAP,
+				Backend::URING })
+		{
+			auto options = InputOptions {};
+			options.backend     = backend;
+			options.buffer_size = 8192;
+
+			CHECK ( read_all(*open_input(filename, options)) == content );
+
+			options.read_ahead = 3;
+
+			CHECK ( read_all(*open_input(filename, options)) == content );
+		}
+
+		std::remove(filename.c_str());
+	}
+}
+
+
+/**
+ * \brief Compare the backends on reading a batch of files concurrently.
+ *
+ * Hidden, run it explicitly by tag [benchmark]. To measure actual device
+ * bandwidth, pass existing files in ARCSTOOLS_BENCHMARK_FILES, separated by
+ * ':', and drop the page cache before each run. Otherwise 8 files of 32 MiB
+ * are created and read from the page cache.
+ */
+TEST_CASE ( "I/O backends", "[io][.][benchmark]" )
+{
+	using arcsapp::io::Backend;
+	using arcsapp::io::InputOptions;
+	using arcsapp::io::open_input;
+	using arcsapp::parallel::TaskPool;
+
+	auto files = std::vector<std::string> {};
+	auto created = false;
+
+	if (const auto list = std::getenv("ARCSTOOLS_BENCHMARK_FILES"))
+	{
+		std::istringstream in { list };
+
+		for (std::string file; std::getline(in, file, ':');)
+		{
+			files.push_back(file);
+		}
+	} else
+	{
+		for (auto i = 0; i < 8; ++i)
+		{
+			files.push_back("test-io-bench" + std::to_string(i) + ".bin");
+			write_pattern(files.back(), 32 * 1024 * 1024);
+		}
+
+		created = true;
+	}
+
+	const auto read_files = [&files](const InputOptions& options)
+	{
+		auto total = std::atomic<std::size_t> { 0 };
+
+		TaskPool pool { 4 };
+
+		for (const auto& file : files)
+		{
+			pool.submit([&total,&file,&options]
+			{
+				auto input { open_input(file, options) };
+				auto bytes = std::vector<char>(64 * 1024);
+
+				for (auto n = input->sgetn(bytes.data(), bytes.size()); n > 0;
+						n = input->sgetn(bytes.data(), bytes.size()))
+				{
+					total += static_cast<std::size_t>(n);
+				}
+			});
+		}
+
+		pool.wait();
+
+		return total.load();
+	};
+
+	auto options = InputOptions {};
+
+	BENCHMARK ( "stdio" )
+	{
+		options.backend = Backend::STDIO;
+		options.read_ahead = 0;
+		return read_files(options);
+	};
+
+	BENCHMARK ( "stdio with read-ahead" )
+	{
+		options.backend = Backend::STDIO;
+		options.read_ahead = 4;
+		return read_files(options);
+	};
+
+	BENCHMARK ( "mmap" )
+	{
+		options.backend = Backend::MMAP;
+		options.read_ahead = 0;
+		return read_files(options);
+	};
+
+	BENCHMARK ( "io_uring" )
+	{
+		options.backend = Backend::URING;
+		options.read_ahead = 0;
+		return read_files(options);
+	};
+
+	if (created)
+	{
+		for (const auto& file : files)
+		{
+			std::remove(file.c_str());
+		}
+	}
+}
+
@@ -0,0 +1,178 @@
+#include "catch2/catch_test_macros.hpp"
+
+#include <chrono>      // for milliseconds
+#include <filesystem>  // for create_directories, remove, remove_all,...
+#include <fstream>     // for ifstream, ofstream
+#include <string>      // for string, getline
+#include <thread>      // for sleep_for
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_JOURNAL_HPP__
+#include "tools-journal.hpp"
+#endif
+
+
+TEST_CASE ( "Fnv1a", "[journal]" )
+{
+	using arcsapp::journal::Fnv1a;
+
+	SECTION ( "Empty hash is the offset basis" )
+	{
+		CHECK ( Fnv1a {}.value() == 0xcbf29ce484222325 );
+	}
+
+	SECTION ( "Consecutive strings are not confused" )
+	{
+		CHECK ( Fnv1a {}.add("ab").add("c").value()
+				!= Fnv1a {}.add("a").add("bc").value() );
+	}
+}
+
+
+TEST_CASE ( "album_key()", "[journal]" )
+{
+	using arcsapp::batch::Album;
+	using arcsapp::journal::Journal;
+	using arcsapp::journal::album_key;
+
+	namespace fs = std::filesystem;
+
+	const auto dir { fs::temp_directory_path() / "arcstk-test-album-key" };
+	fs::create_directories(dir);
+
+	const auto cue     { (dir / "album.cue").string() };
+	const auto wav     { (dir / "album.wav").string() };
+	const auto journal { (dir / "journal.txt").string() };
+	fs::remove(journal);
+
+	std::ofstream { cue } << "FILE \"album.wav\" WAVE\n"
+		"  TRACK 01 AUDIO\n    INDEX 01 00:00:00\n";
+	std::ofstream { wav } << "RIFF";
+
+	// The album names no audio files, they are resolved from the cuesheet
+
+	const auto album { Album { cue, {} } };
+	const auto audiofiles { std::vector<std::string> { wav } };
+
+	SECTION ( "The key is stable while no file changes" )
+	{
+		CHECK ( album_key(album, audiofiles) == album_key(album, audiofiles) );
+	}
+
+	SECTION ( "A changed audio file under an unchanged cue changes the key" )
+	{
+		const auto before { album_key(album, audiofiles) };
+
+		{
+			auto j = Journal { journal };
+			j.append(before, 1, cue);
+		}
+
+		std::ofstream { wav } << "RIFF, re-ripped";
+
+		const auto after { album_key(album, audiofiles) };
+
+		CHECK ( after != before );
+
+		auto j = Journal { journal };
+
+		CHECK ( j.contains(before) );
+		CHECK ( not j.contains(after) );
+	}
+
+	fs::remove_all(dir);
+}
+
+
+TEST_CASE ( "Journal", "[journal]" )
+{
+	using arcsapp::journal::Journal;
+
+	namespace fs = std::filesystem;
+
+	const auto file { fs::temp_directory_path() / "arcstk-test-journal.txt" };
+	fs::remove(file);
+
+	SECTION ( "Appended albums are found when resuming" )
+	{
+		{
+			auto journal = Journal { file.string(), 2 };
+
+			CHECK ( journal.size() == 0 );
+
+			journal.append(0x1234, 0xabcd, "a/a.cue");
+			journal.append(0xffffffffffffffff, 0, "b/b.cue");
+			journal.append(0x42, 1, "c/c.cue");
+
+			CHECK ( journal.contains(0x42) );
+		}
+
+		auto journal = Journal { file.string() };
+
+		CHECK ( journal.size() == 3 );
+		CHECK ( journal.contains(0x1234) );
+		CHECK ( journal.contains(0xffffffffffffffff) );
+		CHECK ( journal.contains(0x42) );
+		CHECK ( not journal.contains(0xabcd) );
+	}
+
+	SECTION ( "Entries are written in groups" )
+	{
+		auto journal = Journal { file.string(), 2 };
+
+		journal.append(1, 1, "a/a.cue");
+		CHECK ( fs::file_size(file) == 0 );
+
+		journal.append(2, 2, "b/b.cue");
+		CHECK ( fs::file_size(file) > 0 );
+	}
+
+	SECTION ( "Entries are written after the interval" )
+	{
+		auto journal = Journal { file.string(), 64,
+			std::chrono::milliseconds { 50 } };
+
+		journal.append(1, 1, "a/a.cue");
+		CHECK ( fs::file_size(file) == 0 );
+
+		std::this_thread::sleep_for(std::chrono::milliseconds { 500 });
+		CHECK ( fs::file_size(file) > 0 );
+
+		journal.append(2, 2, "b/b.cue");
+		CHECK ( Journal { file.string() }.size() == 1 );
+
+		std::this_thread::sleep_for(std::chrono::milliseconds { 500 });
+		CHECK ( Journal { file.string() }.size() == 2 );
+	}
+
+	SECTION ( "An incomplete last line does not corrupt the next entry" )
+	{
+		{
+			auto out = std::ofstream { file };
+			out << "0000000000000001 0000000000000001 a/a.cue\n000000";
+		}
+
+		{
+			auto journal = Journal { file.string(), 1 };
+
+			CHECK ( journal.size() == 1 );
+
+			journal.append(2, 2, "b/b.cue");
+		}
+
+		auto in   = std::ifstream { file };
+		auto line = std::string {};
+
+		std::getline(in, line);
+		std::getline(in, line);
+		CHECK ( line == "000000" );
+
+		std::getline(in, line);
+		CHECK ( line == "0000000000000002 0000000000000002 b/b.cue" );
+
+		CHECK ( Journal { file.string() }.size() == 2 );
+	}
+
+	fs::remove(file);
+}
+
@@ -0,0 +1,199 @@
+#include "catch2/catch_test_macros.hpp"
+
+#include <chrono>      // for steady_clock, duration
+#include <cstdint>     // for uint32_t, uint64_t
+#include <iostream>    // for cout
+#include <random>      // for mt19937
+#include <stdexcept>   // for invalid_argument
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_ARCS_HPP__
+#include "tools-arcs.hpp"
+#endif
+#ifndef __ARCSTOOLS_TOOLS_KERNEL_HPP__
+#include "tools-kernel.hpp"
+#endif
+
+
+namespace
+{
+
+/**
+ * \brief Random samples.
+ */
+std::vector<std::uint32_t> random_samples(const std::size_t count)
+{
+	auto samples = std::vector<std::uint32_t>(count);
+	auto random  = std::mt19937 { 4711 };
+
+	for (auto& s : samples)
+	{
+		s = static_cast<std::uint32_t>(random());
+	}
+
+	return samples;
+}
+
+} // namespace
+
+
+TEST_CASE ( "to_engine()", "[kernel]" )
+{
+	using arcsapp::kernel::Engine;
+	using arcsapp::kernel::name;
+	using arcsapp::kernel::to_engine;
+
+	SECTION ( "Names of engines are accepted" )
+	{
+		CHECK ( to_engine("scalar")  == Engine::SCALAR  );
+		CHECK ( to_engine("simd")    == Engine::SIMD    );
+		CHECK ( to_engine("checked") == Engine::CHECKED );
+
+		CHECK ( name(Engine::SIMD) == "simd" );
+	}
+
+	SECTION ( "Unknown names are rejected" )
+	{
+		CHECK_THROWS_AS ( to_engine("gpu"), std::invalid_argument );
+	}
+}
+
+
+TEST_CASE ( "vector_kernel()", "[kernel]" )
+{
+	using arcsapp::kernel::Isa;
+	using arcsapp::kernel::scalar;
+	using arcsapp::kernel::supported_isas;
+	using arcsapp::kernel::vector_kernel;
+
+	const auto samples { random_samples(1000) };
+
+	SECTION ( "Each supported vector kernel sums up like the scalar kernel" )
+	{
+		for (const auto isa : supported_isas())
+		{
+			const auto kernel { vector_kernel(isa) };
+
+			// All remainders of the vector width and odd start multipliers
+
+			for (const auto count : { 0, 1, 7, 15, 16, 17, 33, 1000 })
+			{
+				for (const auto multiplier : { 1ull, 2940ull, 4000000001ull })
+				{
+					auto lo = std::uint32_t { 17 };
+					auto hi = std::uint32_t { 23 };
+					auto expected_lo = lo;
+					auto expected_hi = hi;
+
+					scalar(samples.data(), count, multiplier,
+							&expected_lo, &expected_hi);
+					kernel(samples.data(), count, multiplier, &lo, &hi);
+
+					CHECK ( lo == expected_lo );
+					CHECK ( hi == expected_hi );
+				}
+			}
+		}
+	}
+
+	SECTION ( "Multipliers beyond 32 bits fall back on the scalar kernel" )
+	{
+		const auto kernel { vector_kernel(arcsapp::kernel::detect_isa()) };
+		const auto multiplier { std::uint64_t { 1 } << 33 };
+
+		auto lo = std::uint32_t { 0 };
+		auto hi = std::uint32_t { 0 };
+		auto expected_lo = lo;
+		auto expected_hi = hi;
+
+		scalar(samples.data(), 64, multiplier, &expected_lo, &expected_hi);
+		kernel(samples.data(), 64, multiplier, &lo, &hi);
+
+		CHECK ( lo == expected_lo );
+		CHECK ( hi == expected_hi );
+	}
+
+	SECTION ( "No instruction set has the scalar kernel" )
+	{
+		CHECK ( vector_kernel(Isa::NONE) == &scalar );
+	}
+}
+
+
+TEST_CASE ( "ARCSAccumulator with engines", "[kernel]" )
+{
+	using arcsapp::arcs::ARCSAccumulator;
+	using arcsapp::kernel::Engine;
+
+	const auto samples { random_samples(44100) };
+
+	ARCSAccumulator scalar  { 1, 2940, 44100 - 2940, Engine::SCALAR  };
+	ARCSAccumulator simd    { 1, 2940, 44100 - 2940, Engine::SIMD    };
+	ARCSAccumulator checked { 1, 2940, 44100 - 2940, Engine::CHECKED };
+
+	// Blocks that do not align with the vector width
+
+	for (std::size_t i = 0; i < samples.size(); i += 1001)
+	{
+		const auto n { std::min<std::size_t>(1001, samples.size() - i) };
+
+		scalar.update(samples.data() + i, n);
+		simd.update(samples.data() + i, n);
+		checked.update(samples.data() + i, n);
+	}
+
+	CHECK ( simd.arcs1() == scalar.arcs1() );
+	CHECK ( simd.arcs2() == scalar.arcs2() );
+	CHECK ( checked.arcs1() == scalar.arcs1() );
+	CHECK ( checked.arcs2() == scalar.arcs2() );
+}
+
+
+/**
+ * \brief Throughput of each kernel on this CPU.
+ *
+ * Reports the samples summed up by each kernel in GB/s, each sample counting
+ * 4 bytes.
+ */
+TEST_CASE ( "Kernel throughput", "[kernel][.][benchmark]" )
+{
+	using arcsapp::kernel::Isa;
+	using arcsapp::kernel::Kernel;
+	using arcsapp::kernel::name;
+	using arcsapp::kernel::scalar;
+	using arcsapp::kernel::supported_isas;
+	using arcsapp::kernel::vector_kernel;
+
+	const auto samples { random_samples(16 * 1024 * 1024) };
+	const auto rounds  { 8 };
+
+	const auto measure = [&samples,rounds](const std::string& label,
+			const Kernel kernel)
+	{
+		auto lo = std::uint32_t { 0 };
+		auto hi = std::uint32_t { 0 };
+
+		const auto start { std::chrono::steady_clock::now() };
+
+		for (auto r = 0; r < rounds; ++r)
+		{
+			kernel(samples.data(), samples.size(), 1, &lo, &hi);
+		}
+
+		const std::chrono::duration<double> seconds {
+			std::chrono::steady_clock::now() - start };
+
+		const auto bytes { 4.0 * samples.size() * rounds };
+
+		std::cout << label << ": " << bytes / seconds.count() / 1e9
+			<< " GB/s (" << lo << ", " << hi << ")\n";
+	};
+
+	measure("scalar", scalar);
+
+	for (const auto isa : supported_isas())
+	{
+		measure(name(isa), vector_kernel(isa));
+	}
+}
+
@@ -0,0 +1,358 @@
+#include "catch2/catch_test_macros.hpp"
+
+#include <atomic>      // for atomic
+#include <cstddef>     // for size_t
+#include <chrono>      // for milliseconds
+#include <mutex>       // for mutex, lock_guard
+#include <stdexcept>   // for runtime_error
+#include <string>      // for string, to_string
+#include <thread>      // for sleep_for
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_PARALLEL_HPP__
+#include "tools-parallel.hpp"
+#endif
+
+
+TEST_CASE ( "worker_count()", "" )
+{
+	using arcsapp::parallel::worker_count;
+
+	CHECK ( worker_count(1) == 1 );
+	CHECK ( worker_count(7) == 7 );
+	CHECK ( worker_count(0) >= 1 );
+}
+
+
+TEST_CASE ( "TaskPool", "[taskpool]" )
+{
+	using arcsapp::parallel::TaskPool;
+
+	SECTION ( "Pool has at least one worker" )
+	{
+		TaskPool pool1 { 0 };
+		CHECK ( pool1.size() == 1 );
+
+		TaskPool pool2 { 3 };
+		CHECK ( pool2.size() == 3 );
+	}
+
+	SECTION ( "All submitted tasks are run" )
+	{
+		auto results = std::vector<std::size_t>(100, 0);
+		auto counter = std::atomic<std::size_t> { 0 };
+
+		TaskPool pool { 4 };
+
+		for (std::size_t i = 0; i < results.size(); ++i)
+		{
+			pool.submit([&results,&counter,i]
+				{
+					results[i] = i * 2;
+					++counter;
+				});
+		}
+
+		pool.wait();
+
+		CHECK ( counter == 100 );
+
+		for (std::size_t i = 0; i < results.size(); ++i)
+		{
+			CHECK ( results[i] == i * 2 );
+		}
+	}
+
+	SECTION ( "wait() rethrows exception from task" )
+	{
+		auto counter = std::atomic<std::size_t> { 0 };
+
+		TaskPool pool { 2 };
+
+		pool.submit([&counter]{ ++counter; });
+		pool.submit([]{ throw std::runtime_error("failed"); });
+		pool.submit([&counter]{ ++counter; });
+
+		CHECK_THROWS_AS ( pool.wait(), std::runtime_error );
+		CHECK ( counter == 2 );
+
+		// Error is reported only once
+		CHECK_NOTHROW ( pool.wait() );
+	}
+}
+
+
+TEST_CASE ( "run_ordered()", "[taskpool]" )
+{
+	using arcsapp::parallel::run_ordered;
+
+	SECTION ( "Results are consumed in order" )
+	{
+		auto consumed = std::vector<std::string> {};
+
+		run_ordered<std::string>(20, 4, 8,
+			[](const std::size_t i)
+			{
+				// Early results take longer
+				std::this_thread::sleep_for(std::chrono::milliseconds(20 - i));
+				return std::to_string(i);
+			},
+			[&consumed](const std::size_t i, std::string&& s)
+			{
+				CHECK ( s == std::to_string(i) );
+				consumed.push_back(s);
+			});
+
+		REQUIRE ( consumed.size() == 20 );
+
+		for (std::size_t i = 0; i < consumed.size(); ++i)
+		{
+			CHECK ( consumed[i] == std::to_string(i) );
+		}
+	}
+
+	SECTION ( "Exception is rethrown at the position of its result" )
+	{
+		auto consumed = std::size_t { 0 };
+
+		CHECK_THROWS_AS ( run_ordered<std::size_t>(10, 3, 3,
+			[](const std::size_t i)
+			{
+				if (5 == i)
+				{
+					throw std::runtime_error("failed");
+				}
+				return i;
+			},
+			[&consumed](const std::size_t, std::size_t&&)
+			{
+				++consumed;
+			}), std::runtime_error );
+
+		CHECK ( consumed == 5 );
+	}
+}
+
+
+TEST_CASE ( "MemoryGovernor", "[taskpool]" )
+{
+	using arcsapp::parallel::Admission;
+	using arcsapp::parallel::MemoryGovernor;
+	using arcsapp::parallel::TaskPool;
+
+	SECTION ( "Limit of 0 admits every job immediately" )
+	{
+		MemoryGovernor governor { 0 };
+
+		governor.acquire(1000);
+		governor.acquire(1000);
+
+		CHECK ( governor.admitted() == 2 );
+		CHECK ( governor.deferred() == 0 );
+		CHECK ( governor.peak() == 2000 );
+	}
+
+	SECTION ( "Job exceeding the limit is admitted if no job is running" )
+	{
+		MemoryGovernor governor { 100 };
+
+		{
+			Admission admission { governor, 500 };
+		}
+
+		CHECK ( governor.admitted() == 1 );
+		CHECK ( governor.deferred() == 0 );
+		CHECK ( governor.peak() == 500 );
+	}
+
+	SECTION ( "Running jobs never exceed the limit" )
+	{
+		MemoryGovernor governor { 250 };
+
+		auto running = std::atomic<std::size_t> { 0 };
+		auto max_running = std::atomic<std::size_t> { 0 };
+
+		TaskPool pool { 8 };
+
+		for (auto i = 0; i < 16; ++i)
+		{
+			pool.submit([&]
+				{
+					Admission admission { governor, 100 };
+
+					const auto now { ++running };
+					auto max { max_running.load() };
+					while (now > max && !max_running.compare_exchange_weak(max,
+								now))
+					{
+						// retry
+					}
+
+					std::this_thread::sleep_for(std::chrono::milliseconds(5));
+					--running;
+				});
+		}
+
+		pool.wait();
+
+		CHECK ( max_running <= 2 );
+		CHECK ( governor.admitted() == 16 );
+		CHECK ( governor.deferred() > 0 );
+		CHECK ( governor.peak() <= 250 );
+	}
+}
+
+
+TEST_CASE ( "GroupedTaskPool", "[taskpool]" )
+{
+	using arcsapp::parallel::Group;
+	using arcsapp::parallel::GroupedTaskPool;
+
+	SECTION ( "Running tasks of a group never exceed its limit" )
+	{
+		auto running = std::vector<std::atomic<std::size_t>>(2);
+		auto max_running = std::vector<std::atomic<std::size_t>>(2);
+		auto counter = std::atomic<std::size_t> { 0 };
+
+		GroupedTaskPool pool { 6,
+			[](const Group g) -> std::size_t { return 0 == g ? 1 : 3; } };
+
+		for (auto i = 0; i < 24; ++i)
+		{
+			const auto g { static_cast<Group>(i % 2) };
+
+			pool.submit(g, [&,g]
+				{
+					const auto now { ++running[g] };
+					auto max { max_running[g].load() };
+					while (now > max
+						&& !max_running[g].compare_exchange_weak(max, now))
+					{
+						// retry
+					}
+
+					std::this_thread::sleep_for(std::chrono::milliseconds(2));
+					--running[g];
+					++counter;
+				});
+		}
+
+		pool.wait();
+
+		CHECK ( counter == 24 );
+		CHECK ( max_running[0] == 1 );
+		CHECK ( max_running[1] <= 3 );
+	}
+
+	SECTION ( "Saturated group does not block other groups" )
+	{
+		auto order = std::vector<int> {};
+		auto mutex = std::mutex {};
+
+		GroupedTaskPool pool { 2,
+			[](const Group) -> std::size_t { return 1; } };
+
+		pool.submit(0, [&]
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+				const std::lock_guard<std::mutex> lock(mutex);
+				order.push_back(0);
+			});
+		pool.submit(0, [&]
+			{
+				const std::lock_guard<std::mutex> lock(mutex);
+				order.push_back(1);
+			});
+		pool.submit(1, [&]
+			{
+				const std::lock_guard<std::mutex> lock(mutex);
+				order.push_back(2);
+			});
+
+		pool.wait();
+
+		REQUIRE ( order.size() == 3 );
+		CHECK ( order[0] == 2 );
+		CHECK ( order[1] == 0 );
+		CHECK ( order[2] == 1 );
+	}
+
+	SECTION ( "wait() rethrows exception from task" )
+	{
+		GroupedTaskPool pool { 2,
+			[](const Group) -> std::size_t { return 0; } };
+
+		pool.submit(7, []{ throw std::runtime_error("failed"); });
+
+		CHECK_THROWS_AS ( pool.wait(), std::runtime_error );
+		CHECK_NOTHROW ( pool.wait() );
+	}
+}
+
+
+TEST_CASE ( "run_ordered() by groups", "[taskpool]" )
+{
+	using arcsapp::parallel::Group;
+	using arcsapp::parallel::run_ordered;
+
+	SECTION ( "Results are consumed in order" )
+	{
+		auto consumed = std::vector<std::string> {};
+
+		run_ordered<std::string>(20, 4, 8,
+			[](const std::size_t i) -> Group { return i < 15 ? 0 : 1; },
+			[](const Group) -> std::size_t { return 1; },
+			[](const std::size_t i)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				return std::to_string(i);
+			},
+			[&consumed](const std::size_t i, std::string&& s)
+			{
+				CHECK ( s == std::to_string(i) );
+				consumed.push_back(s);
+			});
+
+		REQUIRE ( consumed.size() == 20 );
+
+		for (std::size_t i = 0; i < consumed.size(); ++i)
+		{
+			CHECK ( consumed[i] == std::to_string(i) );
+		}
+	}
+
+	SECTION ( "At most the window of results is pending" )
+	{
+		auto produced = std::atomic<std::size_t> { 0 };
+		auto max_pending = std::size_t { 0 };
+
+		run_ordered<std::size_t>(40, 2, 5,
+			[](const std::size_t i) -> Group { return i % 2; },
+			[](const Group) -> std::size_t { return 1; },
+			[&produced](const std::size_t i)
+			{
+				++produced;
+				return i;
+			},
+			[&](const std::size_t i, std::size_t&&)
+			{
+				if (0 == i)
+				{
+					// Let the workers run ahead as far as they can
+					std::this_thread::sleep_for(std::chrono::milliseconds(20));
+				}
+
+				// The results from i on are produced, but not consumed yet
+
+				const auto pending { produced - i };
+				if (pending > max_pending)
+				{
+					max_pending = pending;
+				}
+			});
+
+		CHECK ( produced == 40 );
+		CHECK ( max_pending <= 5 );
+	}
+}
+
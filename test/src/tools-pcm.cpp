@@ -0,0 +1,288 @@
+#include "catch2/catch_test_macros.hpp"
+
+#include <cstdint>     // for uint8_t, uint32_t
+#include <cstdio>      // for remove
+#include <fstream>     // for ifstream, ofstream
+#include <sstream>     // for istringstream
+#include <stdexcept>   // for runtime_error
+#include <string>      // for string
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_PCM_HPP__
+#include "tools-pcm.hpp"
+#endif
+
+
+namespace
+{
+
+void put16(std::ofstream& out, const std::uint32_t v)
+{
+	out.put(static_cast<char>(v & 0xFF));
+	out.put(static_cast<char>((v >> 8) & 0xFF));
+}
+
+void put32(std::ofstream& out, const std::uint32_t v)
+{
+	put16(out, v & 0xFFFF);
+	put16(out, v >> 16);
+}
+
+/**
+ * \brief Write a RIFF/WAV file with the specified format and samples.
+ */
+void write_wav(const std::string& filename, const std::uint32_t channels,
+		const std::uint32_t rate, const std::vector<std::uint32_t>& samples,
+		const bool with_size = true)
+{
+	auto out = std::ofstream { filename, std::ios::binary };
+
+	const auto data_size = with_size
+		? static_cast<std::uint32_t>(samples.size() * 4)
+		: std::uint32_t { 0 };
+
+	out.write("RIFF", 4); put32(out, 36 + 10 + data_size);
+	out.write("WAVE", 4);
+
+	out.write("fmt ", 4); put32(out, 16);
+	put16(out, 1);            // PCM
+	put16(out, channels);
+	put32(out, rate);
+	put32(out, rate * 4);
+	put16(out, 4);            // block align
+	put16(out, 16);           // bits per sample
+
+	out.write("LIST", 4); put32(out, 1); // odd sized chunk, padded
+	out.write("x\0", 2);
+
+	out.write("data", 4); put32(out, data_size);
+	for (const auto s : samples)
+	{
+		put32(out, s);
+	}
+}
+
+} // namespace
+
+
+TEST_CASE ( "open_sample_reader()", "[pcm]" )
+{
+	using arcsapp::pcm::open_sample_reader;
+	using arcsapp::pcm::Sample;
+
+	auto samples = std::vector<std::uint32_t>(5000);
+	for (std::size_t i = 0; i < samples.size(); ++i)
+	{
+		samples[i] = static_cast<std::uint32_t>(i * 2654435761u);
+	}
+
+	SECTION ( "RIFF/WAV with CDDA is read at arbitrary positions" )
+	{
+		const auto filename = std::string { "test_pcm_cdda.wav" };
+		write_wav(filename, 2, 44100, samples);
+
+		auto reader { open_sample_reader(filename) };
+
+		REQUIRE ( reader );
+		CHECK ( reader->total_samples() == 5000 );
+
+		auto buffer = std::vector<Sample>(1000);
+
+		CHECK ( reader->read(4000, 1000, buffer.data()) == 1000 );
+		CHECK ( buffer[0]   == samples[4000] );
+		CHECK ( buffer[999] == samples[4999] );
+
+		CHECK ( reader->read(17, 10, buffer.data()) == 10 );
+		CHECK ( buffer[0] == samples[17] );
+		CHECK ( buffer[9] == samples[26] );
+
+		CHECK ( reader->read(4990, 1000, buffer.data()) == 10 );
+		CHECK ( buffer[9] == samples[4999] );
+
+		CHECK ( reader->read(5000, 1000, buffer.data()) == 0 );
+
+		std::remove(filename.c_str());
+	}
+
+	SECTION ( "RIFF/WAV with CDDA is read identically with read-ahead" )
+	{
+		const auto filename = std::string { "test_pcm_cdda_ahead.wav" };
+		write_wav(filename, 2, 44100, samples);
+
+		auto counters = arcsapp::io::StallCounters {};
+		auto options  = arcsapp::io::InputOptions {};
+		options.read_ahead  = 3;
+		options.buffer_size = 4096;
+		options.counters    = &counters;
+
+		auto reader { open_sample_reader(filename, options) };
+
+		REQUIRE ( reader );
+		CHECK ( reader->total_samples() == 5000 );
+
+		auto buffer = std::vector<Sample>(5000);
+
+		CHECK ( reader->read(0, 5000, buffer.data()) == 5000 );
+		CHECK ( buffer == samples );
+
+		CHECK ( reader->read(17, 10, buffer.data()) == 10 );
+		CHECK ( buffer[0] == samples[17] );
+
+		CHECK ( counters.buffers > 0 );
+
+		reader.reset();
+		std::remove(filename.c_str());
+	}
+
+	SECTION ( "RIFF/WAV without CDDA is rejected" )
+	{
+		const auto filename = std::string { "test_pcm_48k.wav" };
+		write_wav(filename, 2, 48000, samples);
+
+		CHECK ( not open_sample_reader(filename) );
+
+		std::remove(filename.c_str());
+	}
+
+	SECTION ( "Unknown format is rejected" )
+	{
+		const auto filename = std::string { "test_pcm_unknown.bin" };
+		{
+			auto out = std::ofstream { filename, std::ios::binary };
+			out << "This is not audio";
+		}
+
+		CHECK ( not open_sample_reader(filename) );
+
+		std::remove(filename.c_str());
+	}
+}
+
+
+TEST_CASE ( "detect_format()", "[pcm]" )
+{
+	using arcsapp::pcm::Format;
+	using arcsapp::pcm::detect_format;
+	using arcsapp::pcm::reader_memory;
+
+	SECTION ( "RIFF/WAV is detected regardless of its content" )
+	{
+		const auto filename = std::string { "test_pcm_format.wav" };
+		write_wav(filename, 2, 48000, std::vector<std::uint32_t>(10));
+
+		CHECK ( detect_format(filename) == Format::WAV );
+
+		std::remove(filename.c_str());
+	}
+
+	SECTION ( "Unknown and missing files are of other format" )
+	{
+		const auto filename = std::string { "test_pcm_format.bin" };
+		{
+			auto out = std::ofstream { filename, std::ios::binary };
+			out << "This is not audio";
+		}
+
+		CHECK ( detect_format(filename) == Format::OTHER );
+		CHECK ( detect_format("test_pcm_missing.wav") == Format::OTHER );
+
+		std::remove(filename.c_str());
+	}
+
+	SECTION ( "Only readers of this module require memory" )
+	{
+		const auto options = arcsapp::io::InputOptions {};
+
+		CHECK ( reader_memory(Format::OTHER, options, 1000000) == 0 );
+		CHECK ( reader_memory(Format::WAV,   options, 1000000) > 0 );
+		CHECK ( reader_memory(Format::FLAC,  options, 1000000)
+				> reader_memory(Format::WAV, options, 1000000) );
+	}
+}
+
+
+TEST_CASE ( "open_sample_stream()", "[pcm]" )
+{
+	using arcsapp::pcm::open_sample_stream;
+
+	const auto samples = std::vector<std::uint32_t> {
+		0x00010002, 0xFFFF0000, 0x12345678, 0x80007FFF, 0x0000FFFF };
+
+	const auto read_all = [](arcsapp::pcm::SampleStream& stream)
+	{
+		auto result = std::vector<std::uint32_t>(16);
+		auto total = std::size_t { 0 };
+
+		for (auto n = stream.read(2, result.data()); n > 0;
+				n = stream.read(2, result.data() + total))
+		{
+			total += n;
+		}
+
+		result.resize(total);
+		return result;
+	};
+
+	SECTION ( "RIFF/WAV with CDDA is read sequentially" )
+	{
+		const auto filename = std::string { "test_pcm_stream.wav" };
+		write_wav(filename, 2, 44100, samples);
+
+		auto in = std::ifstream { filename, std::ios::binary };
+		auto stream { open_sample_stream(in) };
+
+		CHECK ( read_all(*stream) == samples );
+		CHECK ( stream->samples_read() == 5 );
+
+		std::remove(filename.c_str());
+	}
+
+	SECTION ( "RIFF/WAV without data size is read to the end" )
+	{
+		const auto filename = std::string { "test_pcm_stream.wav" };
+		write_wav(filename, 2, 44100, samples, false);
+
+		auto in = std::ifstream { filename, std::ios::binary };
+
+		CHECK ( read_all(*open_sample_stream(in)) == samples );
+
+		std::remove(filename.c_str());
+	}
+
+	SECTION ( "Raw samples are read including the first bytes" )
+	{
+		auto bytes = std::string {};
+		for (const auto s : samples)
+		{
+			for (auto shift = 0; shift < 32; shift += 8)
+			{
+				bytes.push_back(static_cast<char>((s >> shift) & 0xFF));
+			}
+		}
+		bytes.push_back('x'); // incomplete sample
+
+		std::istringstream in { bytes };
+
+		CHECK ( read_all(*open_sample_stream(in)) == samples );
+	}
+
+	SECTION ( "RIFF/WAV without CDDA is rejected" )
+	{
+		const auto filename = std::string { "test_pcm_stream48k.wav" };
+		write_wav(filename, 2, 48000, samples);
+
+		auto in = std::ifstream { filename, std::ios::binary };
+
+		CHECK_THROWS_AS ( open_sample_stream(in), std::runtime_error );
+
+		std::remove(filename.c_str());
+	}
+
+	SECTION ( "FLAC is rejected" )
+	{
+		std::istringstream in { "fLaC and more" };
+
+		CHECK_THROWS_AS ( open_sample_stream(in), std::runtime_error );
+	}
+}
+
@@ -0,0 +1,215 @@
+#include "catch2/catch_test_macros.hpp"
+
+#include <sstream>     // for istringstream, ostringstream
+#include <stdexcept>   // for runtime_error
+#include <string>      // for string
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_PLAN_HPP__
+#include "tools-plan.hpp"
+#endif
+
+
+namespace
+{
+
+/**
+ * \brief Album with files of the specified reader type and samples.
+ */
+arcsapp::plan::AlbumPlan album(const std::string& name,
+		const std::string& reader, const std::vector<std::size_t>& samples)
+{
+	auto a = arcsapp::plan::AlbumPlan { name, {}, {}, 0 };
+
+	for (const auto s : samples)
+	{
+		a.files.push_back(arcsapp::plan::FilePlan {
+				name + "/" + std::to_string(a.files.size()) + ".wav",
+				reader, s, s * 4 + 44, 0 });
+	}
+
+	return a;
+}
+
+} // namespace
+
+
+TEST_CASE ( "reader_type()", "[plan]" )
+{
+	using arcsapp::pcm::Format;
+	using arcsapp::plan::reader_type;
+	using arcsapp::selection::Decoder;
+
+	CHECK ( reader_type(Decoder::SAMPLE_READER, Format::WAV)
+			== "builtin/wav" );
+	CHECK ( reader_type(Decoder::SAMPLE_READER, Format::FLAC)
+			== "builtin/flac" );
+	CHECK ( reader_type(Decoder::LIBARCSDEC, Format::FLAC)
+			== "libarcsdec/flac" );
+	CHECK ( reader_type(Decoder::LIBARCSDEC, Format::OTHER)
+			== "libarcsdec/other" );
+}
+
+
+TEST_CASE ( "Calibration", "[plan]" )
+{
+	using arcsapp::plan::Calibration;
+
+	SECTION ( "Rates are read, comments and empty lines are skipped" )
+	{
+		auto in = std::istringstream { "# comment\n\nbuiltin/wav 1000\n"
+			"libarcsdec/flac\t250.5\n" };
+
+		Calibration c;
+		c.read(in);
+
+		CHECK ( c.rates().size() == 2 );
+		CHECK ( c.contains("builtin/wav") );
+		CHECK ( c.rate("builtin/wav") == 1000 );
+		CHECK ( c.rate("libarcsdec/flac") == 250.5 );
+		CHECK ( not c.contains("builtin/flac") );
+		CHECK ( c.rate("builtin/flac") == 0 );
+	}
+
+	SECTION ( "Written rates are read again" )
+	{
+		Calibration c;
+		c.set_rate("builtin/flac", 123456);
+		c.set_rate("libarcsdec/other", 42);
+
+		auto out = std::ostringstream {};
+		c.write(out);
+
+		auto in = std::istringstream { out.str() };
+
+		Calibration d;
+		d.read(in);
+
+		CHECK ( d.rates() == c.rates() );
+	}
+
+	SECTION ( "Lines without a rate are rejected" )
+	{
+		auto in = std::istringstream { "builtin/wav 1000\nbuiltin/flac\n" };
+
+		Calibration c;
+
+		CHECK_THROWS_AS ( c.read(in), std::runtime_error );
+	}
+
+	SECTION ( "A missing calibration file is no error" )
+	{
+		Calibration c;
+
+		CHECK ( not c.read(std::string { "test_plan_missing.calibration" }) );
+		CHECK ( c.rates().empty() );
+	}
+}
+
+
+TEST_CASE ( "schedule()", "[plan]" )
+{
+	using arcsapp::plan::schedule;
+
+	SECTION ( "A single worker processes the jobs one after another" )
+	{
+		CHECK ( schedule({ 1, 2, 3 }, 1) == 6 );
+	}
+
+	SECTION ( "Each job is started by the first worker available" )
+	{
+		// Worker 1: 4, worker 2: 1 + 1 + 1, the last job starts at 3
+
+		CHECK ( schedule({ 4, 1, 1, 1, 2 }, 2) == 5 );
+	}
+
+	SECTION ( "More workers than jobs take as long as the longest job" )
+	{
+		CHECK ( schedule({ 3, 1, 2 }, 8) == 3 );
+	}
+
+	SECTION ( "No jobs take no time" )
+	{
+		CHECK ( schedule({}, 4) == 0 );
+	}
+}
+
+
+TEST_CASE ( "predict()", "[plan]" )
+{
+	using arcsapp::plan::Calibration;
+	using arcsapp::plan::predict;
+
+	Calibration c;
+	c.set_rate("builtin/wav",     1000);
+	c.set_rate("libarcsdec/wav",   500);
+
+	SECTION ( "In a batch, each album is calculated by a single thread" )
+	{
+		const auto plan { predict({
+				album("a", "builtin/wav", { 1000, 3000 }),
+				album("b", "builtin/wav", { 2000 }),
+				album("c", "libarcsdec/wav", { 500 }) }, c, 2, true) };
+
+		REQUIRE ( plan.albums.size() == 3 );
+
+		CHECK ( plan.albums[0].files[1].seconds == 3 );
+		CHECK ( plan.albums[0].seconds == 4 );
+		CHECK ( plan.albums[1].seconds == 2 );
+		CHECK ( plan.albums[2].seconds == 1 );
+		CHECK ( plan.seconds == 4 );
+		CHECK ( plan.workers == 2 );
+	}
+
+	SECTION ( "A single file of a builtin reader is split among threads" )
+	{
+		const auto plan { predict({
+				album("a", "builtin/wav", { 8000 }) }, c, 4, false) };
+
+		CHECK ( plan.seconds == 2 );
+	}
+
+	SECTION ( "Multiple files of a single album are read concurrently" )
+	{
+		const auto plan { predict({
+				album("a", "libarcsdec/wav", { 1000, 1000, 500 }) },
+				c, 2, false) };
+
+		CHECK ( plan.seconds == 3 );
+	}
+
+	SECTION ( "Files of a reader type without a rate take no time" )
+	{
+		const auto plan { predict({
+				album("a", "libarcsdec/other", { 1000 }) }, c, 1, false) };
+
+		CHECK ( plan.seconds == 0 );
+	}
+}
+
+
+TEST_CASE ( "to_json()", "[plan]" )
+{
+	using arcsapp::plan::Calibration;
+	using arcsapp::plan::predict;
+	using arcsapp::plan::to_json;
+
+	Calibration c;
+	c.set_rate("builtin/wav", 1000);
+
+	auto failed { album("b\"q", "builtin/wav", {}) };
+	failed.error = "Cannot parse";
+
+	const auto plan { predict({ album("a", "builtin/wav", { 2000 }),
+			failed }, c, 1, true) };
+
+	const auto json { to_json(plan, c) };
+
+	CHECK ( json.find("\"threads\": 1") != std::string::npos );
+	CHECK ( json.find("\"album\": \"b\\\"q\"") != std::string::npos );
+	CHECK ( json.find("\"error\": \"Cannot parse\"") != std::string::npos );
+	CHECK ( json.find("\"decoded_bytes\": 8000") != std::string::npos );
+	CHECK ( json.find("\"samples_per_second\": 1000") != std::string::npos );
+	CHECK ( json.find("\"wall_seconds\": 2.000") != std::string::npos );
+}
+
@@ -0,0 +1,174 @@
+#include "catch2/catch_test_macros.hpp"
+
+#include <chrono>      // for milliseconds
+#include <memory>      // for make_shared, make_unique
+#include <sstream>     // for ostringstream
+#include <string>      // for string
+#include <thread>      // for sleep_for
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_PROGRESS_HPP__
+#include "tools-progress.hpp"
+#endif
+
+
+namespace
+{
+
+/**
+ * \brief SampleReader on samples in memory.
+ */
+class MemoryReader final : public arcsapp::pcm::SampleReader
+{
+	std::vector<arcsapp::pcm::Sample> samples_;
+
+	std::size_t do_total_samples() const final
+	{
+		return samples_.size();
+	}
+
+	std::size_t do_read(const std::size_t first, const std::size_t count,
+			arcsapp::pcm::Sample* buffer) final
+	{
+		auto n = std::size_t { 0 };
+
+		for (; n < count && first + n < samples_.size(); ++n)
+		{
+			buffer[n] = samples_[first + n];
+		}
+
+		return n;
+	}
+
+public:
+
+	explicit MemoryReader(const std::size_t total)
+		: samples_(total, 1)
+	{
+		// empty
+	}
+};
+
+
+/**
+ * \brief TRUE iff \c text contains \c part.
+ */
+bool has(const std::string& text, const std::string& part)
+{
+	return text.find(part) != std::string::npos;
+}
+
+} // namespace
+
+
+TEST_CASE ( "track()", "[progress]" )
+{
+	using arcsapp::pcm::Sample;
+	using arcsapp::progress::FileProgress;
+	using arcsapp::progress::track;
+
+	auto buffer = std::vector<Sample>(100);
+
+	SECTION ( "No counter leaves the reader as is" )
+	{
+		CHECK ( track(nullptr, std::make_shared<FileProgress>("a.wav", 10))
+				== nullptr );
+	}
+
+	SECTION ( "Tracked readers add the samples they read to the counter" )
+	{
+		const auto file { std::make_shared<FileProgress>("a.wav", 1000) };
+
+		auto reader1 { track(std::make_unique<MemoryReader>(1000), file) };
+		auto reader2 { track(std::make_unique<MemoryReader>(1000), file) };
+
+		CHECK ( reader1->total_samples() == 1000 );
+		CHECK ( reader1->read(0, 100, buffer.data()) == 100 );
+		CHECK ( reader2->read(950, 100, buffer.data()) == 50 );
+
+		CHECK ( file->done() == 150 );
+	}
+}
+
+
+TEST_CASE ( "Reporter", "[progress]" )
+{
+	using arcsapp::progress::Reporter;
+	using arcsapp::progress::track;
+
+	auto out    = std::ostringstream {};
+	auto buffer = std::vector<arcsapp::pcm::Sample>(500);
+
+	SECTION ( "A line shows the files in progress" )
+	{
+		Reporter reporter { std::chrono::milliseconds { 0 }, out };
+
+		auto reader { track(std::make_unique<MemoryReader>(1000),
+				reporter.start_file("dir/a.wav", 1000)) };
+		reader->read(0, 500, buffer.data());
+
+		const auto line { reporter.line() };
+
+		CHECK ( has(line, "PROGRESS: ") );
+		CHECK ( has(line, "a.wav 50%") );
+		CHECK ( not has(line, "dir/") );
+		CHECK ( has(line, "MB/s") );
+		CHECK ( has(line, "samples/s") );
+		CHECK ( not has(line, "albums") );
+	}
+
+	SECTION ( "Completed files are removed, their samples are kept" )
+	{
+		Reporter reporter { std::chrono::milliseconds { 0 }, out };
+
+		{
+			auto reader { track(std::make_unique<MemoryReader>(1000),
+					reporter.start_file("a.wav", 1000)) };
+			reader->read(0, 500, buffer.data());
+			reader->read(500, 500, buffer.data());
+		}
+
+		CHECK ( has(reporter.line(), "no files") );
+		CHECK ( has(reporter.final_line(), "0.0 MB in") );
+	}
+
+	SECTION ( "A line shows the albums completed" )
+	{
+		Reporter reporter { std::chrono::milliseconds { 0 }, out };
+
+		reporter.add_albums(4);
+		reporter.album_done();
+
+		const auto line { reporter.line() };
+
+		CHECK ( has(line, "1/4 albums, ") );
+		CHECK ( has(line, "albums/min") );
+		CHECK ( has(line, "ETA ") );
+	}
+
+	SECTION ( "The final line is written when the reporter is destroyed" )
+	{
+		{
+			Reporter reporter { std::chrono::milliseconds { 0 }, out };
+			reporter.add_albums(2);
+			reporter.album_done();
+			reporter.album_done();
+		}
+
+		CHECK ( has(out.str(), "PROGRESS: done | 2/2 albums | ") );
+	}
+
+	SECTION ( "Lines are written in the interval" )
+	{
+		{
+			Reporter reporter { std::chrono::milliseconds { 10 }, out };
+			std::this_thread::sleep_for(std::chrono::milliseconds { 50 });
+		}
+
+		const auto text { out.str() };
+
+		CHECK ( has(text, "PROGRESS: no files") );
+		CHECK ( has(text, "PROGRESS: done") );
+	}
+}
+
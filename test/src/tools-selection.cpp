@@ -0,0 +1,171 @@
+#include "catch2/catch_test_macros.hpp"
+
+#include <cstdint>     // for uint32_t
+#include <cstdio>      // for remove
+#include <fstream>     // for ofstream
+#include <string>      // for string
+
+#ifndef __ARCSTOOLS_TOOLS_SELECTION_HPP__
+#include "tools-selection.hpp"
+#endif
+
+
+namespace
+{
+
+/**
+ * \brief Write the header of a RIFF/WAV file with PCM samples.
+ */
+void write_wav_header(const std::string& filename, const std::uint32_t rate,
+		const std::uint32_t bits)
+{
+	const auto put = [](std::ofstream& out, const std::uint32_t v,
+			const int bytes)
+	{
+		for (auto i = 0; i < bytes; ++i)
+		{
+			out.put(static_cast<char>((v >> (8 * i)) & 0xFF));
+		}
+	};
+
+	auto out = std::ofstream { filename, std::ios::binary };
+
+	out.write("RIFF", 4); put(out, 36, 4);
+	out.write("WAVE", 4);
+	out.write("fmt ", 4); put(out, 16, 4);
+	put(out, 1, 2);
+	put(out, 2, 2);
+	put(out, rate, 4);
+	put(out, rate * bits / 4, 4);
+	put(out, bits / 4, 2);
+	put(out, bits, 2);
+	out.write("data", 4); put(out, 0, 4);
+}
+
+} // namespace
+
+
+TEST_CASE ( "signature_of()", "[selection]" )
+{
+	using arcsapp::selection::signature_of;
+
+	SECTION ( "RIFF/WAV files with the same parameters have one signature" )
+	{
+		write_wav_header("test_selection_1.wav", 44100, 16);
+		write_wav_header("test_selection_2.wav", 44100, 16);
+
+		CHECK ( signature_of("test_selection_1.wav")
+				== "RIFF/WAVE format=1 channels=2 rate=44100 bits=16" );
+		CHECK ( signature_of("test_selection_1.wav")
+				== signature_of("test_selection_2.wav") );
+
+		std::remove("test_selection_1.wav");
+		std::remove("test_selection_2.wav");
+	}
+
+	SECTION ( "RIFF/WAV files with other parameters differ in signature" )
+	{
+		write_wav_header("test_selection_1.wav", 44100, 16);
+		write_wav_header("test_selection_2.wav", 48000, 24);
+
+		CHECK ( signature_of("test_selection_1.wav")
+				!= signature_of("test_selection_2.wav") );
+
+		std::remove("test_selection_1.wav");
+		std::remove("test_selection_2.wav");
+	}
+
+	SECTION ( "FLAC signature contains the parameters of STREAMINFO" )
+	{
+		{
+			auto out = std::ofstream { "test_selection.flac",
+				std::ios::binary };
+			const char header[] = { 'f', 'L', 'a', 'C',
+				'\x80', 0, 0, 34,
+				0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+				'\x0A', '\xC4', '\x42', '\xF0' };
+			out.write(header, sizeof header);
+			out << std::string(34 - 14, '\0');
+		}
+
+		CHECK ( signature_of("test_selection.flac")
+				== "fLaC rate=44100 channels=2 bits=16" );
+
+		std::remove("test_selection.flac");
+	}
+
+	SECTION ( "Missing file has no signature" )
+	{
+		CHECK ( signature_of("test_selection_missing.wav").empty() );
+	}
+}
+
+
+TEST_CASE ( "SelectionCache", "[selection]" )
+{
+	using arcsapp::selection::Decoder;
+	using arcsapp::selection::SelectionCache;
+
+	SECTION ( "Selected reader is found by its signature" )
+	{
+		SelectionCache cache;
+
+		CHECK ( not cache.find("fLaC rate=44100 channels=2 bits=16") );
+
+		cache.insert("fLaC rate=44100 channels=2 bits=16",
+				Decoder::SAMPLE_READER);
+		cache.insert("magic=4d414320", Decoder::LIBARCSDEC);
+
+		CHECK ( cache.find("fLaC rate=44100 channels=2 bits=16")
+				== Decoder::SAMPLE_READER );
+		CHECK ( cache.find("magic=4d414320") == Decoder::LIBARCSDEC );
+
+		CHECK ( cache.hits()   == 2 );
+		CHECK ( cache.misses() == 1 );
+	}
+
+	SECTION ( "Empty signature is never found" )
+	{
+		SelectionCache cache;
+
+		cache.insert("", Decoder::LIBARCSDEC);
+
+		CHECK ( not cache.find("") );
+	}
+
+	SECTION ( "Released calculator is reused for the same types" )
+	{
+		using arcstk::checksum::type;
+
+		SelectionCache cache;
+
+		{
+			const auto lease1 { cache.acquire({ type::ARCS2 }, nullptr) };
+		}
+		{
+			const auto lease2 { cache.acquire({ type::ARCS2 }, nullptr) };
+		}
+
+		CHECK ( cache.calculators() == 1 );
+
+		{
+			const auto lease3 { cache.acquire({ type::ARCS1 }, nullptr) };
+		}
+
+		CHECK ( cache.calculators() == 2 );
+	}
+
+	SECTION ( "Leased calculator is not shared" )
+	{
+		using arcstk::checksum::type;
+
+		SelectionCache cache;
+
+		const auto lease1 { cache.acquire({ type::ARCS2 }, nullptr) };
+		const auto lease2 { cache.acquire({ type::ARCS2 }, nullptr) };
+
+		CHECK ( &*lease1 != &*lease2 );
+		CHECK ( cache.calculators() == 2 );
+	}
+}
+
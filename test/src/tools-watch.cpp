@@ -0,0 +1,110 @@
+#include "catch2/catch_test_macros.hpp"
+
+#include <chrono>      // for milliseconds
+#include <filesystem>  // for create_directories, create_symlink, ...
+#include <fstream>     // for ofstream
+#include <string>      // for string
+#include <vector>      // for vector
+
+#ifndef __ARCSTOOLS_TOOLS_WATCH_HPP__
+#include "tools-watch.hpp"
+#endif
+
+
+TEST_CASE ( "Tracker", "[watch]" )
+{
+	using arcsapp::watch::Clock;
+	using arcsapp::watch::Tracker;
+	using std::chrono::milliseconds;
+
+	const auto start { Clock::now() };
+
+	auto tracker = Tracker { milliseconds { 100 } };
+
+	SECTION ( "Nothing is pending initially" )
+	{
+		CHECK ( tracker.take_ready(start).empty() );
+		CHECK ( tracker.timeout(start).count() < 0 );
+	}
+
+	SECTION ( "A directory is ready after the settle time" )
+	{
+		tracker.opened("album", "01.flac", start);
+		tracker.closed("album", "01.flac", start + milliseconds { 10 });
+
+		CHECK ( tracker.timeout(start + milliseconds { 10 })
+				== milliseconds { 100 } );
+		CHECK ( tracker.take_ready(start + milliseconds { 50 }).empty() );
+
+		CHECK ( tracker.take_ready(start + milliseconds { 110 })
+				== std::vector<std::string> { "album" } );
+
+		CHECK ( tracker.take_ready(start + milliseconds { 500 }).empty() );
+	}
+
+	SECTION ( "A directory with an open file is not ready" )
+	{
+		tracker.opened("album", "01.flac", start);
+		tracker.opened("album", "02.flac", start);
+		tracker.closed("album", "01.flac", start);
+
+		CHECK ( tracker.timeout(start).count() < 0 );
+		CHECK ( tracker.take_ready(start + milliseconds { 500 }).empty() );
+
+		tracker.closed("album", "02.flac", start + milliseconds { 500 });
+
+		CHECK ( tracker.take_ready(start + milliseconds { 600 })
+				== std::vector<std::string> { "album" } );
+	}
+
+	SECTION ( "Directories are ready independently" )
+	{
+		tracker.closed("album1", "album1.cue", start);
+		tracker.closed("album2", "album2.cue", start + milliseconds { 50 });
+
+		CHECK ( tracker.timeout(start + milliseconds { 50 })
+				== milliseconds { 50 } );
+
+		CHECK ( tracker.take_ready(start + milliseconds { 100 })
+				== std::vector<std::string> { "album1" } );
+		CHECK ( tracker.take_ready(start + milliseconds { 150 })
+				== std::vector<std::string> { "album2" } );
+	}
+
+	SECTION ( "A created file is open, a created link is not" )
+	{
+		namespace fs = std::filesystem;
+
+		const auto dir { fs::temp_directory_path() / "arcstk-test-watch" };
+		fs::remove_all(dir);
+		fs::create_directories(dir);
+
+		std::ofstream { dir / "01.flac" } << "samples";
+		fs::create_symlink(dir / "01.flac", dir / "02.flac");
+		fs::create_hard_link(dir / "01.flac", dir / "03.flac");
+
+		const auto album { dir.string() };
+
+		tracker.created(album, "02.flac", start);
+		tracker.created(album, "03.flac", start);
+		tracker.created(album, "04.flac", start);
+
+		CHECK ( tracker.take_ready(start + milliseconds { 100 })
+				== std::vector<std::string> { album } );
+
+		fs::remove(dir / "02.flac");
+		fs::remove(dir / "03.flac");
+
+		tracker.created(album, "01.flac", start);
+
+		CHECK ( tracker.take_ready(start + milliseconds { 500 }).empty() );
+
+		tracker.closed(album, "01.flac", start + milliseconds { 500 });
+
+		CHECK ( tracker.take_ready(start + milliseconds { 600 })
+				== std::vector<std::string> { album } );
+
+		fs::remove_all(dir);
+	}
+}
+
@@ -0,0 +1,91 @@
+#include "catch2/catch_test_macros.hpp"
+
+#include <sstream>     // for istringstream, ostringstream
+#include <stdexcept>   // for invalid_argument, runtime_error
+
+#ifndef __ARCSTOOLS_TOOLS_WINDOW_HPP__
+#include "tools-window.hpp"
+#endif
+
+
+TEST_CASE ( "read() and write()", "[window]" )
+{
+	using arcsapp::window::Windows;
+	using arcsapp::window::read;
+	using arcsapp::window::write;
+
+	SECTION ( "Written windows are read identically" )
+	{
+		const auto windows { Windows { 75, {
+			{ 0x0000ABCD, 0x12345678 }, { 0xFFFFFFFF } } } };
+
+		auto out = std::ostringstream {};
+		write(out, windows);
+
+		CHECK ( out.str() ==
+				"# window 75\n1 0 0000ABCD\n1 1 12345678\n2 0 FFFFFFFF\n" );
+
+		auto in = std::istringstream { out.str() };
+		const auto result { read(in) };
+
+		CHECK ( result.frames == 75 );
+		CHECK ( result.tracks == windows.tracks );
+	}
+
+	SECTION ( "Windows out of order are rejected" )
+	{
+		auto in = std::istringstream { "# window 75\n1 1 0000ABCD\n" };
+
+		CHECK_THROWS_AS ( read(in), std::runtime_error );
+	}
+
+	SECTION ( "Missing window size is rejected" )
+	{
+		auto in = std::istringstream { "1 0 0000ABCD\n" };
+
+		CHECK_THROWS_AS ( read(in), std::runtime_error );
+	}
+}
+
+
+TEST_CASE ( "compare()", "[window]" )
+{
+	using arcsapp::window::Windows;
+	using arcsapp::window::compare;
+
+	SECTION ( "Consecutive differing windows are combined" )
+	{
+		const auto lhs { Windows { 75, { { 1, 2, 3, 4, 5 }, { 1, 2 } } } };
+		const auto rhs { Windows { 75, { { 1, 0, 0, 4, 0 }, { 1, 2, 3 } } } };
+
+		const auto differences { compare(lhs, rhs) };
+
+		REQUIRE ( differences.size() == 3 );
+
+		CHECK ( differences[0].track == 1 );
+		CHECK ( differences[0].first == 1 );
+		CHECK ( differences[0].last  == 2 );
+
+		CHECK ( differences[1].track == 1 );
+		CHECK ( differences[1].first == 4 );
+		CHECK ( differences[1].last  == 4 );
+
+		CHECK ( differences[2].track == 2 );
+		CHECK ( differences[2].first == 2 );
+		CHECK ( differences[2].last  == 2 );
+	}
+
+	SECTION ( "Identical windows have no differences" )
+	{
+		const auto windows { Windows { 75, { { 1, 2, 3 } } } };
+
+		CHECK ( compare(windows, windows).empty() );
+	}
+
+	SECTION ( "Different window sizes are rejected" )
+	{
+		CHECK_THROWS_AS ( compare(Windows { 75, {} }, Windows { 150, {} }),
+				std::invalid_argument );
+	}
+}
+